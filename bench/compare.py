@@ -0,0 +1,231 @@
+import argparse
+import json
+import math
+import random
+import sys
+from itertools import combinations
+
+# Compares two xbench JSON reports and fails when an operation got slower.
+#
+# Every benchmark is judged on its per-run samples (ns/element):
+#   - the change is the ratio of the candidate median to the baseline median,
+#   - a bootstrap confidence interval of that ratio must lie entirely above
+#     the allowed slowdown, so one noisy run cannot fail the gate,
+#   - the allowed slowdown is the configured percentage or, when larger, a
+#     multiple of the spread of the baseline runs,
+#   - a Mann-Whitney U test must also reject "same distribution".
+#
+# A benchmark with too few runs for the rank test to ever reach alpha cannot
+# be judged, nor can one missing from the candidate report. Both make the
+# comparison incomplete.
+#
+# Exit status: 0 when nothing regressed, 1 on regressions, 2 on bad input or
+# an incomplete comparison (unless --allow-incomplete).
+
+
+class BenchmarkComparator:
+    def __init__(self, threshold, alpha, confidence, noise_factor, resamples, min_runs):
+        self.threshold = threshold / 100.0
+        self.alpha = alpha
+        self.confidence = confidence
+        self.noise_factor = noise_factor
+        self.resamples = resamples
+        self.min_runs = min_runs
+        self.random = random.Random(0x70F0)
+
+    @staticmethod
+    def load(path):
+        with open(path, 'r') as f:
+            report = json.load(f)
+        results = {}
+        for result in report.get('results', []):
+            samples = result.get('samples') or [result['ns_per_element']['median']]
+            results[result['name']] = {'samples': [float(s) for s in samples], 'result': result}
+        return results
+
+    @staticmethod
+    def median(values):
+        ordered = sorted(values)
+        middle = len(ordered) // 2
+        if len(ordered) % 2:
+            return ordered[middle]
+        return (ordered[middle - 1] + ordered[middle]) / 2.0
+
+    def spread(self, values):
+        """Relative median absolute deviation, scaled to match a standard deviation."""
+        center = self.median(values)
+        if center <= 0.0:
+            return 0.0
+        return 1.4826 * self.median([abs(v - center) for v in values]) / center
+
+    def ratio_interval(self, base, head):
+        """Bootstrap confidence interval of median(head) / median(base)."""
+        ratios = []
+        for _ in range(self.resamples):
+            base_draw = [self.random.choice(base) for _ in base]
+            head_draw = [self.random.choice(head) for _ in head]
+            base_median = self.median(base_draw)
+            if base_median > 0.0:
+                ratios.append(self.median(head_draw) / base_median)
+        if not ratios:
+            return (math.inf, math.inf)
+        ratios.sort()
+        tail = (1.0 - self.confidence) / 2.0
+        low = ratios[int(tail * (len(ratios) - 1))]
+        high = ratios[int((1.0 - tail) * (len(ratios) - 1))]
+        return (low, high)
+
+    @staticmethod
+    def rank_sum(base, head):
+        """Sum of the ranks of head in the pooled samples, ties share their mean rank."""
+        pooled = sorted([(v, 0) for v in base] + [(v, 1) for v in head])
+        ranks = [0.0] * len(pooled)
+        i = 0
+        while i < len(pooled):
+            j = i
+            while j + 1 < len(pooled) and pooled[j + 1][0] == pooled[i][0]:
+                j += 1
+            for k in range(i, j + 1):
+                ranks[k] = (i + j) / 2.0 + 1.0
+            i = j + 1
+        return sum(r for r, (_, side) in zip(ranks, pooled) if side == 1), ranks
+
+    def slower_p_value(self, base, head):
+        """One sided Mann-Whitney U p-value for head being slower than base."""
+        m, n = len(base), len(head)
+        observed, ranks = self.rank_sum(base, head)
+        if math.comb(m + n, n) <= 20000:
+            # Exact permutation distribution of the rank sum for small run counts
+            total = 0
+            extreme = 0
+            for picked in combinations(range(m + n), n):
+                total += 1
+                if sum(ranks[i] for i in picked) >= observed - 1e-9:
+                    extreme += 1
+            return extreme / total
+        mean = n * (m + n + 1) / 2.0
+        variance = m * n * (m + n + 1) / 12.0
+        if variance <= 0.0:
+            return 1.0
+        z = (observed - mean - 0.5) / math.sqrt(variance)
+        return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+    @staticmethod
+    def smallest_p_value(m, n):
+        """Smallest one sided p-value the rank test can give for m and n runs."""
+        return 1.0 / math.comb(m + n, n)
+
+    def check_min_runs(self):
+        """Rejects a --min-runs that could never fail a benchmark at alpha."""
+        if self.smallest_p_value(self.min_runs, self.min_runs) >= self.alpha:
+            needed = self.min_runs
+            while self.smallest_p_value(needed, needed) >= self.alpha:
+                needed += 1
+            raise ValueError('--min-runs %d cannot reach significance at alpha %g, use at least %d runs'
+                             % (self.min_runs, self.alpha, needed))
+
+    def compare(self, base, head):
+        base_median = self.median(base)
+        head_median = self.median(head)
+        change = head_median / base_median - 1.0 if base_median > 0.0 else 0.0
+        allowed = max(self.threshold, self.noise_factor * self.spread(base))
+        low, high = self.ratio_interval(base, head)
+        p_value = self.slower_p_value(base, head)
+
+        if (len(base) < self.min_runs or len(head) < self.min_runs or
+                self.smallest_p_value(len(base), len(head)) >= self.alpha):
+            verdict = 'too few runs'
+        elif low - 1.0 > allowed and p_value < self.alpha:
+            verdict = 'REGRESSION'
+        elif high - 1.0 < -allowed and self.slower_p_value(head, base) < self.alpha:
+            verdict = 'improved'
+        else:
+            verdict = 'ok'
+        return {
+            'base': base_median,
+            'head': head_median,
+            'change': change,
+            'low': low - 1.0,
+            'high': high - 1.0,
+            'allowed': allowed,
+            'p': p_value,
+            'verdict': verdict,
+        }
+
+    def run(self, base_path, head_path, name_filter, show_all, allow_incomplete):
+        self.check_min_runs()
+        base = self.load(base_path)
+        head = self.load(head_path)
+
+        rows = []
+        for name in sorted(base.keys() & head.keys()):
+            if name_filter and name_filter not in name:
+                continue
+            rows.append((name, self.compare(base[name]['samples'], head[name]['samples'])))
+
+        regressions = [row for row in rows if row[1]['verdict'] == 'REGRESSION']
+        undecided = [name for name, row in rows if row['verdict'] == 'too few runs']
+        missing = [name for name in sorted(base.keys() - head.keys()) if not name_filter or name_filter in name]
+        print('%-32s %12s %12s %9s %20s %8s %8s  %s' % (
+            'benchmark', 'base ns/el', 'head ns/el', 'change', 'confidence interval', 'allowed', 'p', 'verdict'))
+        for name, row in rows:
+            if not show_all and row['verdict'] == 'ok':
+                continue
+            print('%-32s %12.3f %12.3f %+8.1f%% [%+7.1f%%, %+7.1f%%] %7.1f%% %8.4f  %s' % (
+                name, row['base'], row['head'], 100.0 * row['change'], 100.0 * row['low'],
+                100.0 * row['high'], 100.0 * row['allowed'], row['p'], row['verdict']))
+
+        for name in missing:
+            print('%-32s missing from %s' % (name, head_path))
+        for name in sorted(head.keys() - base.keys()):
+            if not name_filter or name_filter in name:
+                print('%-32s new in %s' % (name, head_path))
+
+        print('\n%d benchmarks compared, %d regressed beyond %.1f%% (%.0f%% confidence)' % (
+            len(rows), len(regressions), 100.0 * self.threshold, 100.0 * self.confidence))
+        for name, row in regressions:
+            print('  %s: %.3f -> %.3f ns/element (%+.1f%%)' % (name, row['base'], row['head'], 100.0 * row['change']))
+        if regressions:
+            return 1
+
+        # A benchmark that could not be judged may hide a slowdown
+        if undecided or missing:
+            print('%d benchmarks with too few runs, %d missing from %s%s' % (
+                len(undecided), len(missing), head_path, ' (allowed)' if allow_incomplete else ''))
+            return 0 if allow_incomplete else 2
+        return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two xbench JSON reports and fail on slowdowns.')
+    parser.add_argument('base', help='report of the reference build')
+    parser.add_argument('head', help='report of the build under test')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='slowdown in percent always tolerated, noisy benchmarks get more (default 5)')
+    parser.add_argument('--alpha', type=float, default=0.05,
+                        help='significance level of the rank test (default 0.05)')
+    parser.add_argument('--confidence', type=float, default=0.95,
+                        help='confidence level of the median ratio interval (default 0.95)')
+    parser.add_argument('--noise-factor', type=float, default=3.0,
+                        help='multiple of the baseline spread always tolerated (default 3)')
+    parser.add_argument('--resamples', type=int, default=2000,
+                        help='bootstrap resamples per benchmark (default 2000)')
+    parser.add_argument('--min-runs', type=int, default=4,
+                        help='runs needed on both sides before a benchmark can fail (default 4, at least 4 at alpha 0.05)')
+    parser.add_argument('--filter', default=None, help='only compare benchmarks whose name contains this text')
+    parser.add_argument('--all', action='store_true', help='also list benchmarks that did not change')
+    parser.add_argument('--allow-incomplete', action='store_true',
+                        help='exit 0 when benchmarks have too few runs or are missing from head')
+    args = parser.parse_args()
+
+    comparator = BenchmarkComparator(args.threshold, args.alpha, args.confidence,
+                                     args.noise_factor, args.resamples, args.min_runs)
+    try:
+        return comparator.run(args.base, args.head, args.filter, args.all, args.allow_incomplete)
+    except (OSError, ValueError, KeyError) as error:
+        print('compare.py: %s' % error, file=sys.stderr)
+        return 2
+
+
+if __name__ == '__main__':
+    sys.exit(main())
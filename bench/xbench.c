@@ -0,0 +1,789 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fossil/xtofu.h"
+#include "fossil/perf.h"
+#include "fossil/typed.h"
+#include "fossil/query.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#define FSCL_TOFU_BENCH_NULL_DEVICE "NUL"
+#else
+#define FSCL_TOFU_BENCH_NULL_DEVICE "/dev/null"
+#endif
+
+/**
+ * @file xbench.c
+ *
+ * @brief Throughput benchmarks for the public ToFu algorithms.
+ *
+ * Every case is timed over element counts from 10 up to --max (default 10^6,
+ * at most 10^8) and over the element types it accepts. Inputs are rebuilt
+ * outside the timed region before every run, so destructive algorithms are
+ * measured on fresh data. Results go to stderr as a table and to the --json
+ * file for tools that compare runs. Where hardware performance counters can
+ * be opened, cycles, instructions, cache and branch misses per element are
+ * reported as well; --no-perf skips them.
+ *
+ * Usage: xbench [--max N] [--max-quadratic N] [--runs N] [--filter TEXT] [--json FILE] [--no-perf]
+ */
+
+#define FSCL_TOFU_BENCH_MAX_SIZE     100000000
+#define FSCL_TOFU_BENCH_BATCH_WORK   65536
+#define FSCL_TOFU_BENCH_MAX_RUNS     64
+
+// =======================
+// ALLOCATION COUNTING
+// =======================
+
+// With glibc the allocator entry points are wrapped so every allocation the
+// library makes inside a timed region is counted. Elsewhere the counts are
+// reported as null.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define FSCL_TOFU_BENCH_COUNTS 1
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* memory, size_t size);
+extern void __libc_free(void* memory);
+
+static atomic_size_t fscl_tofu_bench_allocations;
+static atomic_size_t fscl_tofu_bench_bytes;
+
+void* malloc(size_t size) {
+    atomic_fetch_add_explicit(&fscl_tofu_bench_allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&fscl_tofu_bench_bytes, size, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    atomic_fetch_add_explicit(&fscl_tofu_bench_allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&fscl_tofu_bench_bytes, count * size, memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* memory, size_t size) {
+    atomic_fetch_add_explicit(&fscl_tofu_bench_allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&fscl_tofu_bench_bytes, size, memory_order_relaxed);
+    return __libc_realloc(memory, size);
+}
+
+void free(void* memory) {
+    __libc_free(memory);
+}
+#endif
+
+/**
+ * Reads the allocation counters.
+ *
+ * @param allocations Receives the number of allocations so far.
+ * @param bytes Receives the number of bytes requested so far.
+ */
+static void fscl_tofu_bench_counters(size_t* allocations, size_t* bytes) {
+#ifdef FSCL_TOFU_BENCH_COUNTS
+    *allocations = atomic_load_explicit(&fscl_tofu_bench_allocations, memory_order_relaxed);
+    *bytes = atomic_load_explicit(&fscl_tofu_bench_bytes, memory_order_relaxed);
+#else
+    *allocations = 0;
+    *bytes = 0;
+#endif
+}
+
+// =======================
+// TIMING
+// =======================
+
+/**
+ * Reads a monotonic clock.
+ *
+ * @return The current time in nanoseconds.
+ */
+static uint64_t fscl_tofu_bench_now(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * UINT64_C(1000000000) + (uint64_t)now.tv_nsec;
+#endif
+}
+
+// =======================
+// INPUT GENERATION
+// =======================
+
+enum {
+    FSCL_TOFU_BENCH_INT = 1 << 0,
+    FSCL_TOFU_BENCH_DOUBLE = 1 << 1,
+    FSCL_TOFU_BENCH_STRING = 1 << 2,
+    FSCL_TOFU_BENCH_ALL = FSCL_TOFU_BENCH_INT | FSCL_TOFU_BENCH_DOUBLE | FSCL_TOFU_BENCH_STRING
+};
+
+static const struct {
+    unsigned mask;
+    ctofu_type type;
+    const char* name;
+} fscl_tofu_bench_types[] = {
+    {FSCL_TOFU_BENCH_INT, TOFU_INT_TYPE, "int"},
+    {FSCL_TOFU_BENCH_DOUBLE, TOFU_DOUBLE_TYPE, "double"},
+    {FSCL_TOFU_BENCH_STRING, TOFU_STRING_TYPE, "string"},
+};
+
+/**
+ * Scrambles an index into a reproducible pseudo random number.
+ *
+ * @param index The index.
+ * @return The scrambled value.
+ */
+static uint64_t fscl_tofu_bench_mix(uint64_t index) {
+    index += UINT64_C(0x9e3779b97f4a7c15);
+    index = (index ^ (index >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    index = (index ^ (index >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return index ^ (index >> 31);
+}
+
+/**
+ * Sets the element at an index of a generated input. Strings are longer than
+ * FSCL_TOFU_SMALL_STRING so they always live on the heap.
+ *
+ * @param element The element to set, zeroed.
+ * @param type The element type.
+ * @param index The index of the element.
+ * @return Error code indicating the success or failure of the operation.
+ */
+static ctofu_error fscl_tofu_bench_element(ctofu* element, ctofu_type type, size_t index) {
+    uint64_t bits = fscl_tofu_bench_mix(index);
+    element->type = type;
+    switch (type) {
+        case TOFU_INT_TYPE:
+            element->data.int_type = (int64_t)(bits % 1000000);
+            return FSCL_TOFU_ERROR_OK;
+        case TOFU_DOUBLE_TYPE:
+            element->data.double_type = (double)(bits >> 11) * 0x1.0p-53;
+            return FSCL_TOFU_ERROR_OK;
+        case TOFU_STRING_TYPE: {
+            char text[64];
+            int length = snprintf(text, sizeof(text), "benchmark string %020llu", (unsigned long long)bits);
+            return fscl_tofu_string_set(element, text, (size_t)length);
+        }
+        default:
+            return FSCL_TOFU_ERROR_INVALID_OPERATION;
+    }
+}
+
+/**
+ * Builds an array input of generated elements.
+ *
+ * @param array Receives the array.
+ * @param type The element type.
+ * @param size The number of elements.
+ * @return Error code indicating the success or failure of the operation.
+ */
+static ctofu_error fscl_tofu_bench_array(ctofu* array, ctofu_type type, size_t size) {
+    memset(array, 0, sizeof(ctofu));
+    array->type = TOFU_ARRAY_TYPE;
+    array->data.array_type.elements = (ctofu*)calloc(size, sizeof(ctofu));
+    if (array->data.array_type.elements == NULL) {
+        return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+    }
+    array->data.array_type.size = size;
+    if (type != TOFU_STRING_TYPE) {
+        array->flags = TOFU_FLAG_SCALARS;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        ctofu_error error = fscl_tofu_bench_element(&array->data.array_type.elements[i], type, i);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            array->data.array_type.size = i;
+            fscl_tofu_value_erase(array);
+            return error;
+        }
+    }
+    return FSCL_TOFU_ERROR_OK;
+}
+
+// =======================
+// CALLBACKS
+// =======================
+
+static int fscl_tofu_bench_triple(int value) {
+    return value * 3;
+}
+
+static bool fscl_tofu_bench_keep_int(const ctofu_data* data) {
+    return data->int_type % 2 == 0;
+}
+
+static bool fscl_tofu_bench_keep_double(const ctofu_data* data) {
+    return data->double_type < 0.5;
+}
+
+static bool fscl_tofu_bench_keep_string(const ctofu_data* data) {
+    return data->string_type[strlen(data->string_type) - 1] % 2 == 0;
+}
+
+static bool fscl_tofu_bench_pick(const ctofu* value) {
+    switch (value->type) {
+        case TOFU_INT_TYPE:
+            return fscl_tofu_bench_keep_int(&value->data);
+        case TOFU_DOUBLE_TYPE:
+            return fscl_tofu_bench_keep_double(&value->data);
+        default:
+            return fscl_tofu_bench_keep_string(&value->data);
+    }
+}
+
+static ctofu fscl_tofu_bench_sum(const ctofu* left, const ctofu* right) {
+    ctofu result;
+    memset(&result, 0, sizeof(result));
+    result.type = left->type;
+    if (left->type == TOFU_DOUBLE_TYPE) {
+        result.data.double_type = left->data.double_type + right->data.double_type;
+    } else {
+        result.data.int_type = left->data.int_type + right->data.int_type;
+    }
+    return result;
+}
+
+// =======================
+// BENCHMARK CASES
+// =======================
+
+/**
+ * Everything one timed call works on; only input is prepared beforehand and
+ * everything is erased after the timed region.
+ */
+typedef struct {
+    ctofu input;       ///< The generated array.
+    ctofu copy;        ///< Output of value_copy.
+    ctofu* parts[2];   ///< Output of partition.
+} ctofu_bench_slot;
+
+static ctofu_error fscl_tofu_bench_create_erase(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    const ctofu* elements = slot->input.data.array_type.elements;
+    for (size_t i = 0; i < slot->input.data.array_type.size; ++i) {
+        ctofu_data data = elements[i].data;
+        ctofu* value = fscl_tofu_create(elements[i].type, &data);
+        if (value == NULL) {
+            return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+        }
+        fscl_tofu_erase(value);
+    }
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error fscl_tofu_bench_accumulate(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    return fscl_tofu_accumulate(&slot->input);
+}
+
+static ctofu_error fscl_tofu_bench_transform(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    return fscl_tofu_transform(&slot->input, fscl_tofu_bench_triple);
+}
+
+static ctofu_error fscl_tofu_bench_sort(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    return fscl_tofu_sort(&slot->input);
+}
+
+static ctofu_error fscl_tofu_bench_search(ctofu_bench_slot* slot, const ctofu* key) {
+    return fscl_tofu_search(&slot->input, (ctofu*)key);
+}
+
+static ctofu_error fscl_tofu_bench_filter(ctofu_bench_slot* slot, const ctofu* key) {
+    switch (key->type) {
+        case TOFU_INT_TYPE:
+            return fscl_tofu_filter(&slot->input, fscl_tofu_bench_keep_int);
+        case TOFU_DOUBLE_TYPE:
+            return fscl_tofu_filter(&slot->input, fscl_tofu_bench_keep_double);
+        default:
+            return fscl_tofu_filter(&slot->input, fscl_tofu_bench_keep_string);
+    }
+}
+
+static ctofu_error fscl_tofu_bench_reverse(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    return fscl_tofu_reverse(&slot->input);
+}
+
+static ctofu_error fscl_tofu_bench_shuffle(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    return fscl_tofu_shuffle(&slot->input);
+}
+
+static ctofu_error fscl_tofu_bench_reduce(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    return fscl_tofu_reduce(&slot->input, fscl_tofu_bench_sum);
+}
+
+static ctofu_error fscl_tofu_bench_partition(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    return fscl_tofu_partition(&slot->input, fscl_tofu_bench_pick, slot->parts);
+}
+
+static ctofu_error fscl_tofu_bench_value_copy(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    return fscl_tofu_value_copy(&slot->input, &slot->copy);
+}
+
+static ctofu_error fscl_tofu_bench_out(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    fscl_tofu_out(slot->input);
+    return FSCL_TOFU_ERROR_OK;
+}
+
+// The typed kernels run on a buffer unpacked from the array and packed back
+static ctofu_error fscl_tofu_bench_typed(ctofu_bench_slot* slot, const ctofu* key, bool sort) {
+    size_t size = slot->input.data.array_type.size;
+    void* buffer = malloc((size ? size : 1) * sizeof(int64_t));
+    if (buffer == NULL) {
+        return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+    }
+
+    ctofu_error error;
+    volatile double sink;
+    if (key->type == TOFU_DOUBLE_TYPE) {
+        double* values = (double*)buffer;
+        error = fscl_tofu_typed_unpack(&slot->input, values);
+        if (error == FSCL_TOFU_ERROR_OK && sort) {
+            fscl_tofu_typed_sort(values, size);
+            error = fscl_tofu_typed_pack(&slot->input, values);
+        } else if (error == FSCL_TOFU_ERROR_OK) {
+            sink = fscl_tofu_typed_sum(values, size);
+        }
+    } else {
+        int64_t* values = (int64_t*)buffer;
+        error = fscl_tofu_typed_unpack(&slot->input, values);
+        if (error == FSCL_TOFU_ERROR_OK && sort) {
+            fscl_tofu_typed_sort(values, size);
+            error = fscl_tofu_typed_pack(&slot->input, values);
+        } else if (error == FSCL_TOFU_ERROR_OK) {
+            sink = (double)fscl_tofu_typed_sum(values, size);
+        }
+    }
+    (void)sink;
+    free(buffer);
+    return error;
+}
+
+static ctofu_error fscl_tofu_bench_typed_sum(ctofu_bench_slot* slot, const ctofu* key) {
+    return fscl_tofu_bench_typed(slot, key, false);
+}
+
+static ctofu_error fscl_tofu_bench_typed_sort(ctofu_bench_slot* slot, const ctofu* key) {
+    return fscl_tofu_bench_typed(slot, key, true);
+}
+
+// Filter, scale and sum in one fused pass over the array
+static ctofu_error fscl_tofu_bench_query(ctofu_bench_slot* slot, const ctofu* key) {
+    (void)key;
+    ctofu_query* query = fscl_tofu_query_create(&slot->input);
+    if (query == NULL) {
+        return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+    }
+
+    ctofu zero = {TOFU_INT_TYPE, 0, {.int_type = 0}};
+    ctofu three = {TOFU_INT_TYPE, 0, {.int_type = 3}};
+    ctofu result;
+    ctofu_error error = fscl_tofu_query_where(query, FSCL_TOFU_QUERY_GREATER, &zero);
+    if (error == FSCL_TOFU_ERROR_OK) {
+        error = fscl_tofu_query_apply(query, FSCL_TOFU_QUERY_MULTIPLY, &three);
+    }
+    if (error == FSCL_TOFU_ERROR_OK) {
+        error = fscl_tofu_query_reduce(query, FSCL_TOFU_QUERY_SUM, &result);
+    }
+    fscl_tofu_query_erase(query);
+    // No positive element at the smallest sizes
+    return error == FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS ? FSCL_TOFU_ERROR_OK : error;
+}
+
+typedef struct {
+    const char* name;   ///< Name of the public operation.
+    unsigned types;     ///< FSCL_TOFU_BENCH_* element types the operation accepts.
+    bool quadratic;     ///< Whether the cost grows with the square of the size.
+    ctofu_error (*run)(ctofu_bench_slot* slot, const ctofu* key);
+} ctofu_bench_case;
+
+static const ctofu_bench_case fscl_tofu_bench_cases[] = {
+    {"create_erase", FSCL_TOFU_BENCH_ALL, false, fscl_tofu_bench_create_erase},
+    {"accumulate", FSCL_TOFU_BENCH_INT, false, fscl_tofu_bench_accumulate},
+    {"transform", FSCL_TOFU_BENCH_INT, false, fscl_tofu_bench_transform},
+    {"sort", FSCL_TOFU_BENCH_INT, true, fscl_tofu_bench_sort},
+    {"search", FSCL_TOFU_BENCH_ALL, false, fscl_tofu_bench_search},
+    {"filter", FSCL_TOFU_BENCH_ALL, false, fscl_tofu_bench_filter},
+    {"reverse", FSCL_TOFU_BENCH_ALL, false, fscl_tofu_bench_reverse},
+    {"shuffle", FSCL_TOFU_BENCH_ALL, false, fscl_tofu_bench_shuffle},
+    {"reduce", FSCL_TOFU_BENCH_INT | FSCL_TOFU_BENCH_DOUBLE, false, fscl_tofu_bench_reduce},
+    {"partition", FSCL_TOFU_BENCH_ALL, false, fscl_tofu_bench_partition},
+    {"value_copy", FSCL_TOFU_BENCH_ALL, false, fscl_tofu_bench_value_copy},
+    {"out", FSCL_TOFU_BENCH_ALL, false, fscl_tofu_bench_out},
+    {"typed_sum", FSCL_TOFU_BENCH_INT | FSCL_TOFU_BENCH_DOUBLE, false, fscl_tofu_bench_typed_sum},
+    {"typed_sort", FSCL_TOFU_BENCH_INT | FSCL_TOFU_BENCH_DOUBLE, false, fscl_tofu_bench_typed_sort},
+    {"query", FSCL_TOFU_BENCH_INT | FSCL_TOFU_BENCH_DOUBLE, false, fscl_tofu_bench_query},
+};
+
+// =======================
+// MEASUREMENT
+// =======================
+
+typedef struct {
+    size_t max_size;        ///< Largest element count.
+    size_t max_quadratic;   ///< Largest element count for quadratic cases.
+    size_t runs;            ///< Timed runs per measurement.
+    const char* filter;     ///< Only names containing this text run, or NULL.
+    FILE* json;             ///< Destination of the JSON report.
+    bool first;             ///< Whether no result has been written yet.
+    bool counters;          ///< Whether hardware counters are read.
+    ctofu_perf perf;        ///< The hardware counters.
+} ctofu_bench_options;
+
+static int fscl_tofu_bench_order(const void* left, const void* right) {
+    double a = *(const double*)left;
+    double b = *(const double*)right;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Erases everything a timed call left in its slots.
+ *
+ * @param slots The slots.
+ * @param count The number of slots.
+ */
+static void fscl_tofu_bench_clear(ctofu_bench_slot* slots, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        fscl_tofu_value_erase(&slots[i].input);
+        fscl_tofu_value_erase(&slots[i].copy);
+        for (size_t part = 0; part < 2; ++part) {
+            if (slots[i].parts[part] != NULL) {
+                fscl_tofu_erase(slots[i].parts[part]);
+            }
+        }
+    }
+    memset(slots, 0, count * sizeof(ctofu_bench_slot));
+}
+
+/**
+ * Formats a table cell, or a dash when the value was not measured.
+ *
+ * @param cell Receives the text.
+ * @param size The size of cell.
+ * @param measured Whether the value was measured.
+ * @param value The value.
+ */
+static void fscl_tofu_bench_cell(char* cell, size_t size, bool measured, double value) {
+    if (measured) {
+        snprintf(cell, size, "%.3f", value);
+    } else {
+        snprintf(cell, size, "-");
+    }
+}
+
+/**
+ * Times one case for one element type and size and reports the result.
+ *
+ * @param options The benchmark options.
+ * @param bench The case.
+ * @param type The index into fscl_tofu_bench_types.
+ * @param size The number of elements.
+ * @return Error code indicating the success or failure of the operation.
+ */
+static ctofu_error fscl_tofu_bench_measure(ctofu_bench_options* options, const ctofu_bench_case* bench,
+                                           size_t type, size_t size) {
+    ctofu_type element_type = fscl_tofu_bench_types[type].type;
+    const char* type_name = fscl_tofu_bench_types[type].name;
+
+    // Small sizes are batched so that every timed region holds enough work
+    size_t work = bench->quadratic ? size * size : size;
+    size_t batch = work >= FSCL_TOFU_BENCH_BATCH_WORK ? 1 : FSCL_TOFU_BENCH_BATCH_WORK / work;
+
+    ctofu_bench_slot* slots = (ctofu_bench_slot*)calloc(batch, sizeof(ctofu_bench_slot));
+    if (slots == NULL) {
+        return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+    }
+
+    // The searched key is the last element, so every search scans the whole array
+    ctofu key;
+    memset(&key, 0, sizeof(key));
+    ctofu_error error = fscl_tofu_bench_element(&key, element_type, size - 1);
+
+    double samples[FSCL_TOFU_BENCH_MAX_RUNS];
+    size_t allocations = 0;
+    size_t bytes = 0;
+    ctofu_perf_sample totals;
+    memset(&totals, 0, sizeof(totals));
+    totals.available = options->counters ? options->perf.available : 0;
+    for (size_t run = 0; run < options->runs && error == FSCL_TOFU_ERROR_OK; ++run) {
+        for (size_t i = 0; i < batch && error == FSCL_TOFU_ERROR_OK; ++i) {
+            error = fscl_tofu_bench_array(&slots[i].input, element_type, size);
+        }
+        if (error != FSCL_TOFU_ERROR_OK) {
+            break;
+        }
+
+        size_t allocations_before;
+        size_t bytes_before;
+        fscl_tofu_bench_counters(&allocations_before, &bytes_before);
+        if (totals.available != 0) {
+            fscl_tofu_perf_begin(&options->perf);
+        }
+        uint64_t start = fscl_tofu_bench_now();
+        for (size_t i = 0; i < batch && error == FSCL_TOFU_ERROR_OK; ++i) {
+            error = bench->run(&slots[i], &key);
+        }
+        uint64_t elapsed = fscl_tofu_bench_now() - start;
+        if (totals.available != 0) {
+            ctofu_perf_sample sample;
+            fscl_tofu_perf_end(&options->perf, &sample);
+            totals.available &= sample.available;
+            for (size_t event = 0; event < FSCL_TOFU_PERF_EVENTS; ++event) {
+                totals.values[event] += sample.values[event];
+            }
+        }
+        size_t allocations_after;
+        size_t bytes_after;
+        fscl_tofu_bench_counters(&allocations_after, &bytes_after);
+
+        fscl_tofu_bench_clear(slots, batch);
+        samples[run] = (double)elapsed / (double)(batch * size);
+        allocations += allocations_after - allocations_before;
+        bytes += bytes_after - bytes_before;
+    }
+    fscl_tofu_value_erase(&key);
+    fscl_tofu_bench_clear(slots, batch);
+    free(slots);
+
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fprintf(stderr, "%-12s %-7s %10zu  failed with error %d\n", bench->name, type_name, size, (int)error);
+        return error;
+    }
+
+    double sorted[FSCL_TOFU_BENCH_MAX_RUNS];
+    memcpy(sorted, samples, options->runs * sizeof(double));
+    qsort(sorted, options->runs, sizeof(double), fscl_tofu_bench_order);
+    double median = options->runs % 2 ? sorted[options->runs / 2]
+                                      : (sorted[options->runs / 2 - 1] + sorted[options->runs / 2]) / 2.0;
+    double calls = (double)(options->runs * batch);
+    double bytes_per_element = (double)bytes / (calls * (double)size);
+    double allocations_per_call = (double)allocations / calls;
+
+    // Counters per element, and instructions per cycle
+    double per_element[FSCL_TOFU_PERF_EVENTS];
+    for (size_t event = 0; event < FSCL_TOFU_PERF_EVENTS; ++event) {
+        per_element[event] = (double)totals.values[event] / (calls * (double)size);
+    }
+    bool has_ipc = fscl_tofu_perf_has(&totals, FSCL_TOFU_PERF_CYCLES) &&
+                   fscl_tofu_perf_has(&totals, FSCL_TOFU_PERF_INSTRUCTIONS) &&
+                   totals.values[FSCL_TOFU_PERF_CYCLES] != 0;
+    double ipc = has_ipc ? (double)totals.values[FSCL_TOFU_PERF_INSTRUCTIONS] /
+                               (double)totals.values[FSCL_TOFU_PERF_CYCLES]
+                         : 0.0;
+
+    char cells[5][32];
+#ifdef FSCL_TOFU_BENCH_COUNTS
+    fscl_tofu_bench_cell(cells[0], sizeof(cells[0]), true, bytes_per_element);
+    fscl_tofu_bench_cell(cells[1], sizeof(cells[1]), true, allocations_per_call);
+#else
+    fscl_tofu_bench_cell(cells[0], sizeof(cells[0]), false, 0.0);
+    fscl_tofu_bench_cell(cells[1], sizeof(cells[1]), false, 0.0);
+#endif
+    fscl_tofu_bench_cell(cells[2], sizeof(cells[2]), has_ipc, ipc);
+    fscl_tofu_bench_cell(cells[3], sizeof(cells[3]), fscl_tofu_perf_has(&totals, FSCL_TOFU_PERF_LLC_MISSES),
+                         per_element[FSCL_TOFU_PERF_LLC_MISSES]);
+    fscl_tofu_bench_cell(cells[4], sizeof(cells[4]), fscl_tofu_perf_has(&totals, FSCL_TOFU_PERF_BRANCH_MISSES),
+                         per_element[FSCL_TOFU_PERF_BRANCH_MISSES]);
+    fprintf(stderr, "%-12s %-7s %10zu %12.3f %12.3f %12.3f %12s %12s %8s %10s %10s\n", bench->name, type_name,
+            size, median, sorted[0], sorted[options->runs - 1], cells[0], cells[1], cells[2], cells[3], cells[4]);
+
+    FILE* json = options->json;
+    fprintf(json, "%s\n    {\"name\": \"%s/%s/%zu\", \"operation\": \"%s\", \"type\": \"%s\", \"size\": %zu, "
+                  "\"batch\": %zu, \"runs\": %zu,\n",
+            options->first ? "" : ",", bench->name, type_name, size, bench->name, type_name, size, batch,
+            options->runs);
+    fprintf(json, "     \"ns_per_element\": {\"median\": %.4f, \"min\": %.4f, \"max\": %.4f},\n     \"samples\": [",
+            median, sorted[0], sorted[options->runs - 1]);
+    for (size_t run = 0; run < options->runs; ++run) {
+        fprintf(json, "%s%.4f", run ? ", " : "", samples[run]);
+    }
+#ifdef FSCL_TOFU_BENCH_COUNTS
+    fprintf(json, "],\n     \"bytes_per_element\": %.4f, \"allocations\": %.2f", bytes_per_element,
+            allocations_per_call);
+#else
+    (void)bytes_per_element;
+    (void)allocations_per_call;
+    fprintf(json, "],\n     \"bytes_per_element\": null, \"allocations\": null");
+#endif
+    if (totals.available != 0) {
+        fprintf(json, ",\n     \"counters_per_element\": {");
+        for (size_t event = 0; event < FSCL_TOFU_PERF_EVENTS; ++event) {
+            fprintf(json, "\"%s\": ", fscl_tofu_perf_name((ctofu_perf_event)event));
+            if (fscl_tofu_perf_has(&totals, (ctofu_perf_event)event)) {
+                fprintf(json, "%.4f, ", per_element[event]);
+            } else {
+                fprintf(json, "null, ");
+            }
+        }
+        if (has_ipc) {
+            fprintf(json, "\"ipc\": %.4f}", ipc);
+        } else {
+            fprintf(json, "\"ipc\": null}");
+        }
+    } else {
+        fprintf(json, ",\n     \"counters_per_element\": null");
+    }
+    fprintf(json, "}");
+    options->first = false;
+    return FSCL_TOFU_ERROR_OK;
+}
+
+// =======================
+// MAIN
+// =======================
+
+/**
+ * Parses a positive count argument.
+ *
+ * @param text The argument.
+ * @param limit The largest accepted value.
+ * @param value Receives the count.
+ * @return true if the argument is a count between 1 and limit.
+ */
+static bool fscl_tofu_bench_count(const char* text, size_t limit, size_t* value) {
+    char* end = NULL;
+    double parsed = strtod(text, &end);
+    if (end == text || *end != '\0' || parsed < 1.0 || parsed > (double)limit) {
+        return false;
+    }
+    *value = (size_t)parsed;
+    return true;
+}
+
+static int fscl_tofu_bench_usage(void) {
+    fprintf(stderr, "usage: xbench [--max N] [--max-quadratic N] [--runs N] [--filter TEXT] [--json FILE] [--no-perf]\n");
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char** argv) {
+    ctofu_bench_options options = {1000000, 10000, 5, NULL, NULL, true, true, {{0}, 0}};
+    const char* json_path = "xbench.json";
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--no-perf") == 0) {
+            options.counters = false;
+            continue;
+        }
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            return fscl_tofu_bench_usage();
+        }
+        bool valid = true;
+        if (strcmp(argv[i], "--max") == 0) {
+            valid = fscl_tofu_bench_count(value, FSCL_TOFU_BENCH_MAX_SIZE, &options.max_size);
+        } else if (strcmp(argv[i], "--max-quadratic") == 0) {
+            valid = fscl_tofu_bench_count(value, FSCL_TOFU_BENCH_MAX_SIZE, &options.max_quadratic);
+        } else if (strcmp(argv[i], "--runs") == 0) {
+            valid = fscl_tofu_bench_count(value, FSCL_TOFU_BENCH_MAX_RUNS, &options.runs);
+        } else if (strcmp(argv[i], "--filter") == 0) {
+            options.filter = value;
+        } else if (strcmp(argv[i], "--json") == 0) {
+            json_path = value;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            return fscl_tofu_bench_usage();
+        }
+        ++i;
+    }
+
+    options.json = fopen(json_path, "w");
+    if (options.json == NULL) {
+        fprintf(stderr, "xbench: cannot write %s\n", json_path);
+        return EXIT_FAILURE;
+    }
+
+    // fscl_tofu_out always prints to stdout, which is not part of the measurement
+    if (freopen(FSCL_TOFU_BENCH_NULL_DEVICE, "w", stdout) == NULL) {
+        fprintf(stderr, "xbench: cannot redirect stdout\n");
+        fclose(options.json);
+        return EXIT_FAILURE;
+    }
+
+    // Counters that cannot be opened, as in most containers, are left out of the report
+    if (options.counters && fscl_tofu_perf_open(&options.perf) != FSCL_TOFU_ERROR_OK) {
+        fprintf(stderr, "xbench: hardware performance counters are unavailable\n");
+        options.counters = false;
+    }
+
+    srand(42);
+#ifdef FSCL_TOFU_BENCH_COUNTS
+    const char* counted = "true";
+#else
+    const char* counted = "false";
+#endif
+    fprintf(options.json, "{\n  \"suite\": \"fscl-xtofu-c\",\n  \"allocations_counted\": %s,\n"
+                          "  \"perf_counters\": %s,\n  \"results\": [",
+            counted, options.counters ? "true" : "false");
+    fprintf(stderr, "%-12s %-7s %10s %12s %12s %12s %12s %12s %8s %10s %10s\n", "operation", "type", "size",
+            "ns/elem", "min", "max", "bytes/elem", "allocs", "ipc", "llc/elem", "brmiss/elem");
+
+    int status = EXIT_SUCCESS;
+    size_t case_count = sizeof(fscl_tofu_bench_cases) / sizeof(fscl_tofu_bench_cases[0]);
+    size_t type_count = sizeof(fscl_tofu_bench_types) / sizeof(fscl_tofu_bench_types[0]);
+    for (size_t c = 0; c < case_count; ++c) {
+        const ctofu_bench_case* bench = &fscl_tofu_bench_cases[c];
+        size_t limit = bench->quadratic && options.max_quadratic < options.max_size ? options.max_quadratic
+                                                                                     : options.max_size;
+        for (size_t t = 0; t < type_count; ++t) {
+            if ((bench->types & fscl_tofu_bench_types[t].mask) == 0) {
+                continue;
+            }
+            char name[64];
+            snprintf(name, sizeof(name), "%s/%s", bench->name, fscl_tofu_bench_types[t].name);
+            if (options.filter != NULL && strstr(name, options.filter) == NULL) {
+                continue;
+            }
+            for (size_t size = 10; size <= limit; size *= 10) {
+                if (fscl_tofu_bench_measure(&options, bench, t, size) != FSCL_TOFU_ERROR_OK) {
+                    status = EXIT_FAILURE;
+                }
+            }
+        }
+    }
+
+    fprintf(options.json, "\n  ]\n}\n");
+    if (options.counters) {
+        fscl_tofu_perf_close(&options.perf);
+    }
+    if (fclose(options.json) != 0) {
+        status = EXIT_FAILURE;
+    }
+    return status;
+}
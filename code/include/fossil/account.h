@@ -0,0 +1,135 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_ACCOUNT_H
+#define FSCL_XTOFU_ACCOUNT_H
+
+/**
+ * @file account.h
+ *
+ * @brief Allocation accounting and memory footprint of tofu values.
+ *
+ * While accounting is on, every block the library allocates for a value
+ * (structures, element, key and value buffers, string storage and shared
+ * blocks) is recorded with its size, the ctofu_type it belongs to and the
+ * public call that asked for it. Nested allocations are charged to the
+ * outermost call, so the strings a value_copy duplicates count as
+ * value_copy. Erasing a value releases the records of what it owned.
+ *
+ * Accounting is meant for diagnosis: records live in a table behind one
+ * lock. Blocks allocated while it was off are never counted, and strings
+ * from fscl_tofu_strdup stay live until a value that took them over is
+ * erased. Interned strings belong to the intern pool and are not counted.
+ */
+
+#include "xtofu.h"
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Public calls allocations are charged to.
+ */
+typedef enum {
+    FSCL_TOFU_ALLOC_CREATE,         ///< fscl_tofu_create.
+    FSCL_TOFU_ALLOC_CREATE_ARRAY,   ///< fscl_tofu_create_array.
+    FSCL_TOFU_ALLOC_STRDUP,         ///< fscl_tofu_strdup.
+    FSCL_TOFU_ALLOC_VALUE_COPY,     ///< fscl_tofu_value_copy.
+    FSCL_TOFU_ALLOC_OTHER,          ///< Everything else, such as parsing, partition and map growth.
+    FSCL_TOFU_ALLOC_APIS            ///< Number of calls.
+} ctofu_alloc_api;
+
+/**
+ * Allocation counts of one category.
+ */
+typedef struct {
+    size_t live_bytes;      ///< Bytes allocated and not freed yet.
+    size_t live_objects;    ///< Blocks allocated and not freed yet.
+    size_t peak_bytes;      ///< Highest live_bytes seen.
+    size_t total_bytes;     ///< Bytes allocated since accounting was first enabled.
+    size_t total_objects;   ///< Blocks allocated since accounting was first enabled.
+} ctofu_alloc_stats;
+
+// =======================
+// ACCOUNTING FUNCTIONS
+// =======================
+
+/**
+ * Turns allocation accounting on or off. The first time it is turned on, a
+ * leak report of whatever is still live is printed to stderr at exit.
+ * Turned off, new blocks are no longer recorded but recorded ones are still
+ * released when freed.
+ *
+ * @param enabled Whether new allocations are recorded.
+ */
+void fscl_tofu_account_enable(bool enabled);
+
+/**
+ * Checks whether allocations are being recorded.
+ *
+ * @return true if accounting is on, false otherwise.
+ */
+bool fscl_tofu_account_enabled(void);
+
+/**
+ * Reads the counts of the blocks belonging to one value type. Element,
+ * key and value buffers count as TOFU_ARRAY_TYPE and TOFU_MAP_TYPE.
+ *
+ * @param type The value type.
+ * @param stats Receives the counts.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_account_by_type(ctofu_type type, ctofu_alloc_stats* stats);
+
+/**
+ * Reads the counts of the blocks charged to one public call.
+ *
+ * @param api The call.
+ * @param stats Receives the counts.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_account_by_api(ctofu_alloc_api api, ctofu_alloc_stats* stats);
+
+/**
+ * Reads the counts over all recorded blocks.
+ *
+ * @param stats Receives the counts.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_account_totals(ctofu_alloc_stats* stats);
+
+/**
+ * Writes the live blocks, grouped by call and by type, to a stream.
+ *
+ * @param stream The stream, such as stderr.
+ * @return The number of live blocks.
+ */
+size_t fscl_tofu_account_report(FILE* stream);
+
+/**
+ * Computes the bytes a value occupies: its own structure plus everything it
+ * owns, recursively. Storage shared with other values is counted in full
+ * for each of them, and interned and inline strings add nothing.
+ *
+ * @param value The value.
+ * @return The footprint in bytes, 0 for NULL.
+ */
+size_t fscl_tofu_footprint(const ctofu* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,244 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_COMPACT_H
+#define FSCL_XTOFU_COMPACT_H
+
+/**
+ * @file compact.h
+ *
+ * @brief Sixteen byte representation of "tofu" values.
+ *
+ * A ctofu is 32 bytes because its data union has to hold the three words of
+ * map_type. A ctofu_compact keeps an 8 byte payload next to its type, flags
+ * and a 32-bit length. Arrays and maps sit behind a single pointer to a
+ * block that holds their size followed by their elements (keys first, then
+ * values, for maps). An array of compact scalars therefore packs four
+ * elements per 64 byte cache line instead of two.
+ *
+ * Strings of up to FSCL_TOFU_COMPACT_SMALL_STRING bytes are stored in the
+ * payload itself. Longer strings are heap copies whose length is kept in
+ * the length field. Interned strings (see intern.h) stay interned and
+ * shared when converted in either direction.
+ *
+ * Values convert to and from ctofu with fscl_tofu_compact_from and
+ * fscl_tofu_compact_to, and the classic algorithms have compact
+ * counterparts that work on the elements in place.
+ */
+
+#include "xtofu.h"
+
+/**
+ * Longest string, in bytes, stored inside a compact value.
+ */
+#define FSCL_TOFU_COMPACT_SMALL_STRING 7
+
+/**
+ * Heap block holding the elements of a compact array or map.
+ */
+typedef struct ctofu_compact_block ctofu_compact_block;
+
+/**
+ * Eight byte payload of a compact value.
+ */
+typedef union {
+    int64_t int_type;             ///< Integer type.
+    uint64_t uint_type;           ///< Unsigned integer type.
+    uint64_t octal_type;          ///< Octal type.
+    uint64_t bitwise_type;        ///< Bitwise type.
+    uint64_t hex_type;            ///< Hexadecimal type.
+    int64_t fixed_type;           ///< Fixed-point type.
+    double double_type;           ///< Double precision floating-point type.
+    float float_type;             ///< Single precision floating-point type.
+    char* string_type;            ///< Heap or interned string.
+    char small_type[FSCL_TOFU_COMPACT_SMALL_STRING + 1]; ///< Inline string (TOFU_FLAG_INLINE).
+    char char_type;               ///< Character type.
+    void* nullptr_type;           ///< Null pointer type.
+    uint64_t qbit_type;           ///< 64-bit quantum bit type.
+    bool boolean_type;            ///< Boolean type.
+    ctofu_compact_block* block;   ///< Elements of an array or map.
+} ctofu_compact_data;
+
+/**
+ * Compact "tofu" value.
+ */
+typedef struct {
+    ctofu_compact_data data;  ///< The payload.
+    uint32_t length;          ///< String length, UINT32_MAX when it does not fit.
+    uint8_t type;             ///< The ctofu_type of the value.
+    uint8_t flags;            ///< Storage flags (TOFU_FLAG_INTERNED or TOFU_FLAG_INLINE).
+    uint16_t reserved;        ///< Unused, zero.
+} ctofu_compact;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// CREATE/ERASE FUNCTIONS
+// =======================
+
+/**
+ * Converts a "tofu" structure, including nested arrays and maps, to its compact form.
+ *
+ * @param value The source "tofu" structure, left untouched.
+ * @param result Receives the compact value, released with fscl_tofu_compact_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_compact_from(const ctofu* value, ctofu_compact* result);
+
+/**
+ * Converts a compact value, including nested arrays and maps, back to a "tofu" structure.
+ *
+ * @param value The compact value, left untouched.
+ * @param result Receives the "tofu" structure, released with fscl_tofu_value_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_compact_to(const ctofu_compact* value, ctofu* result);
+
+/**
+ * Creates a compact array of zeroed elements of one type.
+ *
+ * @param type The element type; arrays and maps start out empty.
+ * @param size The number of elements.
+ * @param result Receives the compact array, released with fscl_tofu_compact_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_compact_array(ctofu_type type, size_t size, ctofu_compact* result);
+
+/**
+ * Releases everything owned by a compact value.
+ *
+ * @param value The compact value, may be NULL.
+ */
+void fscl_tofu_compact_erase(ctofu_compact* value);
+
+// =======================
+// ACCESS FUNCTIONS
+// =======================
+
+/**
+ * Retrieves the type of a compact value.
+ *
+ * @param value The compact value.
+ * @return The type, or TOFU_UNKNOWN_TYPE for NULL.
+ */
+ctofu_type fscl_tofu_compact_type(const ctofu_compact* value);
+
+/**
+ * Retrieves the number of elements of a compact array, or of entries of a compact map.
+ *
+ * @param value The compact value.
+ * @return The number of elements, 0 for other types.
+ */
+size_t fscl_tofu_compact_size(const ctofu_compact* value);
+
+/**
+ * Retrieves the elements of a compact array.
+ *
+ * For maps the first size elements are the keys and the next size elements
+ * the matching values.
+ *
+ * @param value The compact array or map.
+ * @return The elements, or NULL for other types and empty containers.
+ */
+ctofu_compact* fscl_tofu_compact_elements(const ctofu_compact* value);
+
+/**
+ * Retrieves the NUL terminated text of a compact string.
+ *
+ * @param value The compact value.
+ * @return The text, or NULL if the value is not a string.
+ */
+const char* fscl_tofu_compact_string(const ctofu_compact* value);
+
+/**
+ * Retrieves the length of a compact string.
+ *
+ * @param value The compact value.
+ * @return The length in bytes, or 0 if the value is not a string.
+ */
+size_t fscl_tofu_compact_string_length(const ctofu_compact* value);
+
+// =======================
+// ALGORITHM FUNCTIONS
+// =======================
+
+/**
+ * Sums the elements of a compact array.
+ *
+ * Signed integers sum to a TOFU_INT_TYPE, unsigned integers, characters and
+ * booleans to a TOFU_UINT_TYPE, and reals to a TOFU_DOUBLE_TYPE. Integer sums
+ * wrap on overflow.
+ *
+ * @param array The compact array, whose elements must share one type.
+ * @param result Receives the sum.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_compact_accumulate(const ctofu_compact* array, ctofu_compact* result);
+
+/**
+ * Applies a transformation function to every integer element of a compact array.
+ *
+ * @param array The compact array of TOFU_INT_TYPE elements.
+ * @param transformFunc The transformation function.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_compact_transform(ctofu_compact* array, int (*transformFunc)(int));
+
+/**
+ * Sorts a compact array in ascending order.
+ *
+ * Numbers, characters, booleans and strings can be sorted; the elements must
+ * share one type.
+ *
+ * @param array The compact array.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_compact_sort(ctofu_compact* array);
+
+/**
+ * Searches a compact array for the first element equal to key.
+ *
+ * @param array The compact array.
+ * @param key The value to look for.
+ * @param index Optional output for the index of the match.
+ * @return FSCL_TOFU_ERROR_OK if found, FSCL_TOFU_ERROR_TYPE_MISMATCH if not, or another error code.
+ */
+ctofu_error fscl_tofu_compact_search(const ctofu_compact* array, const ctofu_compact* key, size_t* index);
+
+/**
+ * Keeps only the elements of a compact array accepted by a filter function.
+ *
+ * The filter function receives the element as a ctofu_data; strings are
+ * passed through string_type whatever their storage.
+ *
+ * @param array The compact array, filtered in place.
+ * @param filterFunc The filter function.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_compact_filter(ctofu_compact* array, bool (*filterFunc)(const ctofu_data*));
+
+/**
+ * Reverses the elements of a compact array in place.
+ *
+ * @param array The compact array.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_compact_reverse(ctofu_compact* array);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
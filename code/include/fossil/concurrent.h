@@ -0,0 +1,113 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_CONCURRENT_H
+#define FSCL_XTOFU_CONCURRENT_H
+
+/**
+ * @file concurrent.h
+ *
+ * @brief Hash map of "tofu" keys and values shared between threads.
+ *
+ * A ctofu_cmap is split into 64 shards chosen by the high bits of
+ * fscl_tofu_hash. Each shard is a chained hash table whose chains are
+ * published with release stores: lookups take no lock and never retry, they
+ * walk one chain and copy out the value. Writers serialize per shard on a
+ * mutex, so threads updating different shards do not contend.
+ *
+ * Nodes and tables a writer unlinks are reclaimed with epochs: they are
+ * freed only after every reader that could still see them has finished.
+ * Keys and values are stored in shared storage (see shared.h), so handing
+ * a value back to a reader only takes a reference.
+ *
+ * Keys are matched with fscl_tofu_hash and fscl_tofu_compare, so they should
+ * be scalars or strings.
+ */
+
+#include "xtofu.h"
+
+/**
+ * Concurrent hash map.
+ */
+typedef struct ctofu_cmap ctofu_cmap;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// CREATE/ERASE FUNCTIONS
+// =======================
+
+/**
+ * Creates an empty concurrent map.
+ *
+ * @return The map, or NULL if out of memory.
+ */
+ctofu_cmap* fscl_tofu_cmap_create(void);
+
+/**
+ * Frees a concurrent map and everything stored in it.
+ *
+ * No other thread may use the map any more.
+ *
+ * @param map The map, may be NULL.
+ */
+void fscl_tofu_cmap_erase(ctofu_cmap* map);
+
+// =======================
+// ACCESS FUNCTIONS
+// =======================
+
+/**
+ * Retrieves the number of entries, which may already be stale when other threads write.
+ *
+ * @param map The map.
+ * @return The number of entries.
+ */
+size_t fscl_tofu_cmap_size(const ctofu_cmap* map);
+
+/**
+ * Looks up a key without taking any lock.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @param value Optional output for a copy of the value, released with fscl_tofu_value_erase.
+ * @return FSCL_TOFU_ERROR_OK if found, FSCL_TOFU_ERROR_TYPE_MISMATCH if not, or another error code.
+ */
+ctofu_error fscl_tofu_cmap_get(ctofu_cmap* map, const ctofu* key, ctofu* value);
+
+/**
+ * Inserts a key or replaces its value.
+ *
+ * @param map The map.
+ * @param key The key, copied.
+ * @param value The value, copied.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_cmap_set(ctofu_cmap* map, const ctofu* key, const ctofu* value);
+
+/**
+ * Removes a key.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @return FSCL_TOFU_ERROR_OK if removed, FSCL_TOFU_ERROR_TYPE_MISMATCH if it was not present.
+ */
+ctofu_error fscl_tofu_cmap_remove(ctofu_cmap* map, const ctofu* key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
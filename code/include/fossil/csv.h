@@ -0,0 +1,105 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_CSV_H
+#define FSCL_XTOFU_CSV_H
+
+/**
+ * @file csv.h
+ *
+ * @brief Columnar loader turning delimited text into one "tofu" array per column.
+ *
+ * Every column is described by a ctofu_type in a schema and is returned as a
+ * homogeneous TOFU_ARRAY_TYPE value. Files are read in fixed-size chunks, so
+ * only one chunk (plus any record that straddles two chunks) is held at a
+ * time. Within a chunk, records can be split across worker threads at record
+ * boundaries.
+ *
+ * Field conversion by column type:
+ * - TOFU_INT_TYPE, TOFU_FIXED_TYPE: signed decimal.
+ * - TOFU_UINT_TYPE: unsigned decimal.
+ * - TOFU_HEX_TYPE: hexadecimal with an optional 0x prefix.
+ * - TOFU_OCTAL_TYPE: octal with an optional 0o or 0 prefix.
+ * - TOFU_BITWISE_TYPE, TOFU_QBIT_TYPE: binary with an optional 0b prefix, or hexadecimal with 0x.
+ * - TOFU_FLOAT_TYPE, TOFU_DOUBLE_TYPE: decimal floating-point.
+ * - TOFU_BOOLEAN_TYPE: true/false, yes/no, t/f, y/n or 1/0 in any case.
+ * - TOFU_STRING_TYPE, TOFU_CHAR_TYPE: the raw field text (first byte for characters).
+ * - TOFU_NULLPTR_TYPE: the field is skipped and stored as a null pointer.
+ *
+ * Empty numeric fields are stored as zero.
+ */
+
+#include "xtofu.h"
+
+/**
+ * Default number of bytes read from a file per chunk.
+ */
+#define FSCL_TOFU_CSV_CHUNK_SIZE ((size_t)1 << 20)
+
+/**
+ * Options controlling how delimited text is read.
+ */
+typedef struct {
+    char delimiter;       ///< Field separator, ',' for CSV and '\t' for TSV.
+    char quote;           ///< Quote character, or '\0' to disable quoting.
+    bool header;          ///< Skip the first record.
+    size_t threads;       ///< Threads used per chunk, 0 or 1 for single threaded loading.
+    size_t chunk_size;    ///< Bytes read from a file per chunk, 0 for FSCL_TOFU_CSV_CHUNK_SIZE.
+} ctofu_csv_options;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Retrieves the default options for the given delimiter.
+ *
+ * Quoting with '"' is enabled, there is no header and loading is single threaded.
+ *
+ * @param delimiter The field separator.
+ * @return The default options.
+ */
+ctofu_csv_options fscl_tofu_csv_options(char delimiter);
+
+/**
+ * Loads delimited text held in memory into one "tofu" array per column.
+ *
+ * @param data The delimited text.
+ * @param length The number of bytes in data.
+ * @param schema The type of every column.
+ * @param count The number of columns.
+ * @param options The reading options, or NULL for comma separated defaults.
+ * @param columns Receives count TOFU_ARRAY_TYPE values, released with fscl_tofu_value_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_csv_load_buffer(const char* data, size_t length, const ctofu_type* schema, size_t count,
+                                      const ctofu_csv_options* options, ctofu* columns);
+
+/**
+ * Loads a delimited text file into one "tofu" array per column, reading it in chunks.
+ *
+ * @param path The path of the file.
+ * @param schema The type of every column.
+ * @param count The number of columns.
+ * @param options The reading options, or NULL for comma separated defaults.
+ * @param columns Receives count TOFU_ARRAY_TYPE values, released with fscl_tofu_value_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_csv_load_file(const char* path, const ctofu_type* schema, size_t count,
+                                    const ctofu_csv_options* options, ctofu* columns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
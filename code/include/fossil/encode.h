@@ -0,0 +1,254 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_ENCODE_H
+#define FSCL_XTOFU_ENCODE_H
+
+/**
+ * @file encode.h
+ *
+ * @brief Compressed, read-only representations of homogeneous "tofu" arrays.
+ *
+ * Every element of the source array is mapped to a 64-bit key (integers keep
+ * their order, reals and pointers keep their bits, strings are replaced by a
+ * code into a dictionary of distinct strings) and the key sequence is stored
+ * in one of several encodings:
+ *
+ * - TOFU_ENCODING_PACKED: frame of reference plus bit packing of key - minimum.
+ * - TOFU_ENCODING_DELTA: bit-packed differences of a non-decreasing sequence.
+ * - TOFU_ENCODING_DELTA_OF_DELTA: bit-packed second differences, for evenly spaced data.
+ * - TOFU_ENCODING_RUN_LENGTH: one key per run of equal elements.
+ * - TOFU_ENCODING_DICTIONARY: string dictionary with bit-packed codes.
+ * - TOFU_ENCODING_NARROW: integers re-stored in the narrowest 8, 16, 32 or
+ *   64-bit lane whose TOFU_LIMIT_* range (see limits.h) holds every element.
+ *
+ * Encoded arrays are decoded on the fly while iterating, and accumulate,
+ * search and filter run directly on the encoded form: runs and dictionary
+ * entries are evaluated once, and byte aligned packed lanes are scanned
+ * sixteen bytes at a time where SSE2 is available.
+ */
+
+#include "xtofu.h"
+
+/**
+ * Encodings available for a "tofu" array.
+ */
+typedef enum {
+    TOFU_ENCODING_AUTO,            ///< Pick the smallest encoding that applies.
+    TOFU_ENCODING_PACKED,          ///< Frame of reference and bit packing.
+    TOFU_ENCODING_DELTA,           ///< Bit-packed deltas of non-decreasing data.
+    TOFU_ENCODING_DELTA_OF_DELTA,  ///< Bit-packed zigzag second differences.
+    TOFU_ENCODING_RUN_LENGTH,      ///< Run-length encoding.
+    TOFU_ENCODING_DICTIONARY,      ///< Dictionary of strings with packed codes.
+    TOFU_ENCODING_NARROW           ///< Integers in the narrowest lane that fits.
+} ctofu_encoding;
+
+/**
+ * Opaque encoded "tofu" array.
+ */
+typedef struct ctofu_encoded ctofu_encoded;
+
+/**
+ * Cursor decoding an encoded array one element at a time.
+ */
+typedef struct {
+    const ctofu_encoded* source;  ///< The array being walked.
+    size_t index;                 ///< Index of the next element.
+    size_t run;                   ///< Current run for run-length arrays.
+    uint64_t key;                 ///< Key of the previous element for delta arrays.
+    uint64_t delta;               ///< Previous difference for delta-of-delta arrays.
+} ctofu_encoded_iterator;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// CREATE/ERASE FUNCTIONS
+// =======================
+
+/**
+ * Encodes a homogeneous "tofu" array.
+ *
+ * TOFU_ENCODING_DICTIONARY applies to string arrays only, and string arrays
+ * accept only TOFU_ENCODING_DICTIONARY and TOFU_ENCODING_RUN_LENGTH.
+ * TOFU_ENCODING_DELTA requires a non-decreasing sequence of keys, and
+ * TOFU_ENCODING_NARROW applies to integer, character and boolean arrays only.
+ * TOFU_ENCODING_AUTO never picks TOFU_ENCODING_NARROW. Arrays and maps cannot
+ * be encoded. The source array is left untouched.
+ *
+ * @param array The TOFU_ARRAY_TYPE value to encode.
+ * @param encoding The encoding to use, or TOFU_ENCODING_AUTO.
+ * @param result Receives the encoded array, released with fscl_tofu_encoded_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_encode(const ctofu* array, ctofu_encoding encoding, ctofu_encoded** result);
+
+/**
+ * Compacts an integer "tofu" array into the narrowest lane width that holds it.
+ *
+ * The array is scanned once for its smallest and largest element, which are
+ * checked against the TOFU_LIMIT_* ranges of the element type (S8..S64 for
+ * signed integers, U8..U64, HEX8..HEX64, OCT8..OCT64 or BIN8..BIN64 for the
+ * unsigned kinds, BYTE for characters and BOOL for booleans). Every element
+ * is then stored as a lane of that width. All read functions widen the lanes
+ * back to 64 bits transparently.
+ *
+ * @param array The TOFU_ARRAY_TYPE value to compact.
+ * @param result Receives the narrowed array, released with fscl_tofu_encoded_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_narrow(const ctofu* array, ctofu_encoded** result);
+
+/**
+ * Decodes an encoded array back into a plain "tofu" array.
+ *
+ * @param encoded The encoded array.
+ * @param array Receives a TOFU_ARRAY_TYPE value, released with fscl_tofu_value_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_decode(const ctofu_encoded* encoded, ctofu* array);
+
+/**
+ * Erases an encoded array, freeing its memory.
+ *
+ * @param encoded The encoded array, may be NULL.
+ */
+void fscl_tofu_encoded_erase(ctofu_encoded* encoded);
+
+// =======================
+// ACCESS FUNCTIONS
+// =======================
+
+/**
+ * Retrieves the encoding chosen for an encoded array.
+ *
+ * @param encoded The encoded array.
+ * @return The encoding in use.
+ */
+ctofu_encoding fscl_tofu_encoded_kind(const ctofu_encoded* encoded);
+
+/**
+ * Retrieves the element type of an encoded array.
+ *
+ * @param encoded The encoded array.
+ * @return The type of every element.
+ */
+ctofu_type fscl_tofu_encoded_type(const ctofu_encoded* encoded);
+
+/**
+ * Retrieves the number of elements of an encoded array.
+ *
+ * @param encoded The encoded array.
+ * @return The number of elements.
+ */
+size_t fscl_tofu_encoded_size(const ctofu_encoded* encoded);
+
+/**
+ * Retrieves the number of bits every stored entry occupies.
+ *
+ * For narrowed arrays this is the lane width (8, 16, 32 or 64). Run-length
+ * arrays report 64.
+ *
+ * @param encoded The encoded array.
+ * @return The entry width in bits.
+ */
+unsigned fscl_tofu_encoded_width(const ctofu_encoded* encoded);
+
+/**
+ * Retrieves the number of heap bytes held by an encoded array.
+ *
+ * @param encoded The encoded array.
+ * @return The footprint in bytes, including the dictionary strings.
+ */
+size_t fscl_tofu_encoded_bytes(const ctofu_encoded* encoded);
+
+/**
+ * Decodes a single element.
+ *
+ * Packed, narrowed and dictionary arrays decode in constant time, run-length
+ * arrays in logarithmic time and delta arrays in linear time; use an iterator
+ * to walk the whole array. Strings point into the dictionary and stay valid until
+ * the encoded array is erased.
+ *
+ * @param encoded The encoded array.
+ * @param index The index of the element.
+ * @param value Receives the element.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_encoded_get(const ctofu_encoded* encoded, size_t index, ctofu* value);
+
+/**
+ * Creates an iterator positioned before the first element of an encoded array.
+ *
+ * @param encoded The encoded array.
+ * @return The iterator.
+ */
+ctofu_encoded_iterator fscl_tofu_encoded_iterator_start(const ctofu_encoded* encoded);
+
+/**
+ * Decodes the next element of an encoded array.
+ *
+ * Strings point into the dictionary and stay valid until the encoded array is erased.
+ *
+ * @param iterator The iterator.
+ * @param value Receives the element.
+ * @return true if an element was decoded, false once the array is exhausted.
+ */
+bool fscl_tofu_encoded_next(ctofu_encoded_iterator* iterator, ctofu* value);
+
+// =======================
+// ALGORITHM FUNCTIONS
+// =======================
+
+/**
+ * Sums the elements of an encoded array without decoding it.
+ *
+ * Signed integers sum to a TOFU_INT_TYPE, unsigned integers, characters and
+ * booleans to a TOFU_UINT_TYPE, and reals to a TOFU_DOUBLE_TYPE. Integer sums
+ * wrap on overflow.
+ *
+ * @param encoded The encoded array.
+ * @param result Receives the sum.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_encoded_accumulate(const ctofu_encoded* encoded, ctofu* result);
+
+/**
+ * Searches an encoded array for the first element equal to key.
+ *
+ * @param encoded The encoded array.
+ * @param key The value to look for, of the element type.
+ * @param index Optional output for the index of the match.
+ * @return FSCL_TOFU_ERROR_OK if found, FSCL_TOFU_ERROR_TYPE_MISMATCH if not, or another error code.
+ */
+ctofu_error fscl_tofu_encoded_search(const ctofu_encoded* encoded, const ctofu* key, size_t* index);
+
+/**
+ * Collects the elements of an encoded array accepted by a filter function.
+ *
+ * The filter function runs once per run or dictionary entry where the
+ * encoding allows it, rather than once per element.
+ *
+ * @param encoded The encoded array.
+ * @param filterFunc The filter function.
+ * @param result Receives a TOFU_ARRAY_TYPE value, released with fscl_tofu_value_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_encoded_filter(const ctofu_encoded* encoded, bool (*filterFunc)(const ctofu_data*), ctofu* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
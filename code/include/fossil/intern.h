@@ -0,0 +1,141 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_INTERN_H
+#define FSCL_XTOFU_INTERN_H
+
+/**
+ * @file intern.h
+ *
+ * @brief Process-wide pool of shared, reference-counted strings.
+ *
+ * Interning a string returns a handle: a NUL terminated char* that is the same
+ * pointer for every string with the same text, so equality is a pointer
+ * compare and the hash and length are computed once. A TOFU_STRING_TYPE value
+ * holding a handle is marked with TOFU_FLAG_INTERNED; copying it retains the
+ * handle instead of duplicating the text, and erasing it releases the handle.
+ * A string leaves the pool as soon as its last reference is released.
+ *
+ * The pool is split into independently locked shards, so threads interning
+ * different strings rarely contend.
+ *
+ * When interning is enabled with fscl_tofu_intern_enable, fscl_tofu_create,
+ * fscl_tofu_create_array, fscl_tofu_value_copy and the JSON and CSV loaders
+ * intern every string they store, except short strings kept inline when
+ * fscl_tofu_inline_strings_enable is on.
+ */
+
+#include "xtofu.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// POOL FUNCTIONS
+// =======================
+
+/**
+ * Turns automatic interning of new string values on or off.
+ *
+ * Values created while interning was on stay interned after it is turned off.
+ *
+ * @param enabled Whether new string values are interned.
+ */
+void fscl_tofu_intern_enable(bool enabled);
+
+/**
+ * Checks whether new string values are interned automatically.
+ *
+ * @return true if automatic interning is on, false otherwise.
+ */
+bool fscl_tofu_intern_enabled(void);
+
+/**
+ * Retrieves the number of distinct strings currently held by the pool.
+ *
+ * @return The number of live pooled strings.
+ */
+size_t fscl_tofu_intern_count(void);
+
+// =======================
+// HANDLE FUNCTIONS
+// =======================
+
+/**
+ * Acquires the handle of a string, adding it to the pool if needed.
+ *
+ * @param text The text, which need not be NUL terminated.
+ * @param length The number of bytes of text.
+ * @return The handle, owning one reference, or NULL on failure.
+ */
+const char* fscl_tofu_intern_acquire(const char* text, size_t length);
+
+/**
+ * Adds a reference to a handle.
+ *
+ * @param handle The handle.
+ */
+void fscl_tofu_intern_retain(const char* handle);
+
+/**
+ * Drops a reference to a handle, removing the string once no reference remains.
+ *
+ * @param handle The handle, may be NULL.
+ */
+void fscl_tofu_intern_release(const char* handle);
+
+/**
+ * Retrieves the cached length of a handle.
+ *
+ * @param handle The handle.
+ * @return The length in bytes, without the terminator.
+ */
+size_t fscl_tofu_intern_length(const char* handle);
+
+/**
+ * Retrieves the cached hash of a handle.
+ *
+ * @param handle The handle.
+ * @return The hash, equal to fscl_tofu_hash of a string value with the same text.
+ */
+uint64_t fscl_tofu_intern_hash(const char* handle);
+
+// =======================
+// VALUE FUNCTIONS
+// =======================
+
+/**
+ * Stores an interned copy of text in a "tofu" structure.
+ *
+ * @param value Receives a TOFU_STRING_TYPE value, released with fscl_tofu_value_erase.
+ * @param text The NUL terminated text.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_intern_string(ctofu* value, const char* text);
+
+/**
+ * Replaces the heap string of a TOFU_STRING_TYPE value with its interned handle.
+ *
+ * Values that are already interned are left untouched.
+ *
+ * @param value The string value.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_intern(ctofu* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,132 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_JSON_H
+#define FSCL_XTOFU_JSON_H
+
+/**
+ * @file json.h
+ *
+ * @brief Streaming JSON reader and writer for "tofu" values.
+ *
+ * The reader is push based: input may be handed over in chunks of any size,
+ * split at any byte, and values are built directly as "tofu" structures
+ * without an intermediate document tree. Objects become TOFU_MAP_TYPE values
+ * with string keys, arrays become TOFU_ARRAY_TYPE values, and numbers are
+ * mapped onto TOFU_INT_TYPE, TOFU_UINT_TYPE or TOFU_DOUBLE_TYPE depending on
+ * their spelling and range.
+ *
+ * The writer shares its output path with fscl_tofu_out.
+ */
+
+#include <stdio.h>
+#include "xtofu.h"
+
+/**
+ * Maximum nesting depth of arrays and objects accepted by the reader.
+ */
+#define FSCL_TOFU_JSON_MAX_DEPTH 1024
+
+/**
+ * Opaque state of an incremental JSON reader.
+ */
+typedef struct ctofu_json_parser ctofu_json_parser;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// READER FUNCTIONS
+// =======================
+
+/**
+ * Creates a new incremental JSON reader.
+ *
+ * @return A pointer to the newly created reader, or NULL on failure.
+ */
+ctofu_json_parser* fscl_tofu_json_parser_create(void);
+
+/**
+ * Feeds the next chunk of input to the reader.
+ *
+ * Chunks may split tokens at any byte; the reader keeps whatever partial
+ * state it needs until the following chunk arrives.
+ *
+ * @param parser The reader.
+ * @param chunk The bytes to consume.
+ * @param length The number of bytes in the chunk.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_json_parser_feed(ctofu_json_parser* parser, const char* chunk, size_t length);
+
+/**
+ * Signals the end of input and hands the parsed document to the caller.
+ *
+ * On success the caller owns the value stored in result and releases it
+ * with fscl_tofu_value_erase.
+ *
+ * @param parser The reader.
+ * @param result The "tofu" structure receiving the document.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_json_parser_finish(ctofu_json_parser* parser, ctofu* result);
+
+/**
+ * Erases a reader and any partially built values it still holds.
+ *
+ * @param parser The reader to erase.
+ */
+void fscl_tofu_json_parser_erase(ctofu_json_parser* parser);
+
+/**
+ * Parses a complete JSON document held in memory.
+ *
+ * @param text The JSON text.
+ * @param length The number of bytes in text.
+ * @param result The "tofu" structure receiving the document.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_json_parse(const char* text, size_t length, ctofu* result);
+
+// =======================
+// WRITER FUNCTIONS
+// =======================
+
+/**
+ * Writes a "tofu" structure to a stream as JSON.
+ *
+ * Integer flavours (octal, hex, bitwise, qbit, fixed) are written as plain
+ * numbers, characters as one character strings and map keys that are not
+ * strings are written as their JSON text inside a string.
+ *
+ * @param stream The destination stream.
+ * @param value The "tofu" structure to write.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_json_write(FILE* stream, const ctofu* value);
+
+/**
+ * Serializes a "tofu" structure into a newly allocated JSON string.
+ *
+ * @param value The "tofu" structure to serialize.
+ * @param length Optional output for the length of the returned string.
+ * @return The NUL terminated JSON text, to be released with free(), or NULL on failure.
+ */
+char* fscl_tofu_json_stringify(const ctofu* value, size_t* length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -73,7 +73,6 @@ typedef enum {
     TOFU_LIMIT_U32_MIN = 0,
     TOFU_LIMIT_U32_MAX = UINT32_MAX,
     TOFU_LIMIT_U64_MIN = 0,
-    TOFU_LIMIT_U64_MAX = UINT64_MAX,
 
     // Hexadecimal typedefs
     TOFU_LIMIT_HEX8_MIN = 0,
@@ -83,7 +82,6 @@ typedef enum {
     TOFU_LIMIT_HEX32_MIN = 0,
     TOFU_LIMIT_HEX32_MAX = UINT32_MAX,
     TOFU_LIMIT_HEX64_MIN = 0,
-    TOFU_LIMIT_HEX64_MAX = UINT64_MAX,
 
     // Octal typedefs
     TOFU_LIMIT_OCT8_MIN = 0,
@@ -93,7 +91,6 @@ typedef enum {
     TOFU_LIMIT_OCT32_MIN = 0,
     TOFU_LIMIT_OCT32_MAX = UINT32_MAX,
     TOFU_LIMIT_OCT64_MIN = 0,
-    TOFU_LIMIT_OCT64_MAX = UINT64_MAX,
 
     // Binary typedefs
     TOFU_LIMIT_BIN8_MIN = 0,
@@ -103,7 +100,6 @@ typedef enum {
     TOFU_LIMIT_BIN32_MIN = 0,
     TOFU_LIMIT_BIN32_MAX = UINT32_MAX,
     TOFU_LIMIT_BIN64_MIN = 0,
-    TOFU_LIMIT_BIN64_MAX = UINT64_MAX,
 
     // QPoint typedefs with different bit ranges
     TOFU_LIMIT_QPOINT_8_8_MIN = INT16_MIN,
@@ -123,7 +119,6 @@ typedef enum {
     TOFU_LIMIT_PTR_MIN = INTPTR_MIN,
     TOFU_LIMIT_PTR_MAX = INTPTR_MAX,
     TOFU_LIMIT_UPTR_MIN = 0,
-    TOFU_LIMIT_UPTR_MAX = UINTPTR_MAX,
 
     // String typedefs
     TOFU_LIMIT_CSTR_MIN = 0,
@@ -153,17 +148,12 @@ typedef enum {
     TOFU_LIMIT_BOOL_MAX = 1,
 
     TOFU_LIMIT_DATETIME_MIN = 0,
-    TOFU_LIMIT_DATETIME_MAX = UINT64_MAX,
 
     TOFU_LIMIT_CALENDAR_MIN = 0,
-    TOFU_LIMIT_CALENDAR_MAX = UINT64_MAX,
     TOFU_LIMIT_CLOCK_MIN = 0,
-    TOFU_LIMIT_CLOCK_MAX = UINT64_MAX,
 
     TOFU_LIMIT_USIZE_MIN = 0,
-    TOFU_LIMIT_USIZE_MAX = SIZE_MAX,
-    TOFU_LIMIT_SSIZE_MIN = 0,
-    TOFU_LIMIT_SSIZE_MAX = SIZE_MAX
+    TOFU_LIMIT_SSIZE_MIN = 0
 } ctofu_limit;
 
 // Enumerations for min and max values
@@ -184,7 +174,6 @@ enum {
     FSCL_TOFU_LIMIT_U32_MIN = TOFU_LIMIT_U32_MIN,
     FSCL_TOFU_LIMIT_U32_MAX = TOFU_LIMIT_U32_MAX,
     FSCL_TOFU_LIMIT_U64_MIN = TOFU_LIMIT_U64_MIN,
-    FSCL_TOFU_LIMIT_U64_MAX = TOFU_LIMIT_U64_MAX,
 
     FSCL_TOFU_LIMIT_HEX8_MIN = TOFU_LIMIT_HEX8_MIN,
     FSCL_TOFU_LIMIT_HEX8_MAX = TOFU_LIMIT_HEX8_MAX,
@@ -193,7 +182,6 @@ enum {
     FSCL_TOFU_LIMIT_HEX32_MIN = TOFU_LIMIT_HEX32_MIN,
     FSCL_TOFU_LIMIT_HEX32_MAX = TOFU_LIMIT_HEX32_MAX,
     FSCL_TOFU_LIMIT_HEX64_MIN = TOFU_LIMIT_HEX64_MIN,
-    FSCL_TOFU_LIMIT_HEX64_MAX = TOFU_LIMIT_HEX64_MAX,
 
     FSCL_TOFU_LIMIT_OCT8_MIN = TOFU_LIMIT_OCT8_MIN,
     FSCL_TOFU_LIMIT_OCT8_MAX = TOFU_LIMIT_OCT8_MAX,
@@ -202,7 +190,6 @@ enum {
     FSCL_TOFU_LIMIT_OCT32_MIN = TOFU_LIMIT_OCT32_MIN,
     FSCL_TOFU_LIMIT_OCT32_MAX = TOFU_LIMIT_OCT32_MAX,
     FSCL_TOFU_LIMIT_OCT64_MIN = TOFU_LIMIT_OCT64_MIN,
-    FSCL_TOFU_LIMIT_OCT64_MAX = TOFU_LIMIT_OCT64_MAX,
 
     FSCL_TOFU_LIMIT_BIN8_MIN = TOFU_LIMIT_BIN8_MIN,
     FSCL_TOFU_LIMIT_BIN8_MAX = TOFU_LIMIT_BIN8_MAX,
@@ -211,7 +198,6 @@ enum {
     FSCL_TOFU_LIMIT_BIN32_MIN = TOFU_LIMIT_BIN32_MIN,
     FSCL_TOFU_LIMIT_BIN32_MAX = TOFU_LIMIT_BIN32_MAX,
     FSCL_TOFU_LIMIT_BIN64_MIN = TOFU_LIMIT_BIN64_MIN,
-    FSCL_TOFU_LIMIT_BIN64_MAX = TOFU_LIMIT_BIN64_MAX,
 
     FSCL_TOFU_LIMIT_QPOINT_8_8_MIN = TOFU_LIMIT_QPOINT_8_8_MIN,
     FSCL_TOFU_LIMIT_QPOINT_8_8_MAX = TOFU_LIMIT_QPOINT_8_8_MAX,
@@ -228,7 +214,6 @@ enum {
     FSCL_TOFU_LIMIT_PTR_MIN = TOFU_LIMIT_PTR_MIN,
     FSCL_TOFU_LIMIT_PTR_MAX = TOFU_LIMIT_PTR_MAX,
     FSCL_TOFU_LIMIT_UPTR_MIN = TOFU_LIMIT_UPTR_MIN,
-    FSCL_TOFU_LIMIT_UPTR_MAX = TOFU_LIMIT_UPTR_MAX,
 
     FSCL_TOFU_LIMIT_CSTR_MIN = TOFU_LIMIT_CSTR_MIN,
     FSCL_TOFU_LIMIT_CSTR_MAX = TOFU_LIMIT_CSTR_MAX,
@@ -256,19 +241,37 @@ enum {
     FSCL_TOFU_LIMIT_BOOL_MAX = TOFU_LIMIT_BOOL_MAX,
 
     FSCL_TOFU_LIMIT_DATETIME_MIN = TOFU_LIMIT_DATETIME_MIN,
-    FSCL_TOFU_LIMIT_DATETIME_MAX = TOFU_LIMIT_DATETIME_MAX,
 
     FSCL_TOFU_LIMIT_CALENDAR_MIN = TOFU_LIMIT_CALENDAR_MIN,
-    FSCL_TOFU_LIMIT_CALENDAR_MAX = TOFU_LIMIT_CALENDAR_MAX,
     FSCL_TOFU_LIMIT_CLOCK_MIN = TOFU_LIMIT_CLOCK_MIN,
-    FSCL_TOFU_LIMIT_CLOCK_MAX = TOFU_LIMIT_CLOCK_MAX,
 
     FSCL_TOFU_LIMIT_USIZE_MIN = TOFU_LIMIT_USIZE_MIN,
-    FSCL_TOFU_LIMIT_USIZE_MAX = TOFU_LIMIT_USIZE_MAX,
-    FSCL_TOFU_LIMIT_SSIZE_MIN = TOFU_LIMIT_SSIZE_MIN,
-    FSCL_TOFU_LIMIT_SSIZE_MAX = TOFU_LIMIT_SSIZE_MAX
+    FSCL_TOFU_LIMIT_SSIZE_MIN = TOFU_LIMIT_SSIZE_MIN
 };
 
+// Unsigned 64-bit maxima do not fit in an enumeration alongside INT64_MIN
+#define TOFU_LIMIT_U64_MAX UINT64_MAX
+#define TOFU_LIMIT_HEX64_MAX UINT64_MAX
+#define TOFU_LIMIT_OCT64_MAX UINT64_MAX
+#define TOFU_LIMIT_BIN64_MAX UINT64_MAX
+#define TOFU_LIMIT_UPTR_MAX UINTPTR_MAX
+#define TOFU_LIMIT_DATETIME_MAX UINT64_MAX
+#define TOFU_LIMIT_CALENDAR_MAX UINT64_MAX
+#define TOFU_LIMIT_CLOCK_MAX UINT64_MAX
+#define TOFU_LIMIT_USIZE_MAX SIZE_MAX
+#define TOFU_LIMIT_SSIZE_MAX SIZE_MAX
+
+#define FSCL_TOFU_LIMIT_U64_MAX TOFU_LIMIT_U64_MAX
+#define FSCL_TOFU_LIMIT_HEX64_MAX TOFU_LIMIT_HEX64_MAX
+#define FSCL_TOFU_LIMIT_OCT64_MAX TOFU_LIMIT_OCT64_MAX
+#define FSCL_TOFU_LIMIT_BIN64_MAX TOFU_LIMIT_BIN64_MAX
+#define FSCL_TOFU_LIMIT_UPTR_MAX TOFU_LIMIT_UPTR_MAX
+#define FSCL_TOFU_LIMIT_DATETIME_MAX TOFU_LIMIT_DATETIME_MAX
+#define FSCL_TOFU_LIMIT_CALENDAR_MAX TOFU_LIMIT_CALENDAR_MAX
+#define FSCL_TOFU_LIMIT_CLOCK_MAX TOFU_LIMIT_CLOCK_MAX
+#define FSCL_TOFU_LIMIT_USIZE_MAX TOFU_LIMIT_USIZE_MAX
+#define FSCL_TOFU_LIMIT_SSIZE_MAX TOFU_LIMIT_SSIZE_MAX
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,135 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_PERF_H
+#define FSCL_XTOFU_PERF_H
+
+/**
+ * @file perf.h
+ *
+ * @brief Hardware performance counters around tofu operations.
+ *
+ * On Linux the counters come from perf_event_open and count user space
+ * events of the calling thread only. Each counter is opened on its own, so a
+ * machine or container that lacks some events, or forbids perf events
+ * altogether, still runs: the missing counters are just reported as
+ * unavailable. On other systems no counter is ever available.
+ */
+
+#include "xtofu.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Events counted by a ctofu_perf.
+ */
+typedef enum {
+    FSCL_TOFU_PERF_CYCLES,          ///< CPU cycles.
+    FSCL_TOFU_PERF_INSTRUCTIONS,    ///< Retired instructions.
+    FSCL_TOFU_PERF_L1D_MISSES,      ///< Level 1 data cache read misses.
+    FSCL_TOFU_PERF_LLC_MISSES,      ///< Last level cache misses.
+    FSCL_TOFU_PERF_BRANCH_MISSES,   ///< Mispredicted branches.
+    FSCL_TOFU_PERF_EVENTS           ///< Number of events.
+} ctofu_perf_event;
+
+/**
+ * A set of open counters. Only the thread that opened it may use it.
+ */
+typedef struct {
+    int fds[FSCL_TOFU_PERF_EVENTS];   ///< Counter descriptors, -1 when unavailable.
+    uint32_t available;               ///< Bit per event whose counter is open.
+} ctofu_perf;
+
+/**
+ * Counts read from a ctofu_perf.
+ *
+ * When the kernel had to share a counter with others, the count is scaled up
+ * to the whole region.
+ */
+typedef struct {
+    uint64_t values[FSCL_TOFU_PERF_EVENTS];   ///< Event counts, 0 when unavailable.
+    uint32_t available;                       ///< Bit per event that was counted.
+} ctofu_perf_sample;
+
+// =======================
+// PERF FUNCTIONS
+// =======================
+
+/**
+ * Opens the counters for the calling thread.
+ *
+ * @param perf The counters to open.
+ * @return FSCL_TOFU_ERROR_OK when at least one counter opened, else
+ *         FSCL_TOFU_ERROR_INVALID_OPERATION; perf can be used and closed either way.
+ */
+ctofu_error fscl_tofu_perf_open(ctofu_perf* perf);
+
+/**
+ * Closes the counters.
+ *
+ * @param perf The counters.
+ */
+void fscl_tofu_perf_close(ctofu_perf* perf);
+
+/**
+ * Resets the counters and starts counting.
+ *
+ * @param perf The counters.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_perf_begin(ctofu_perf* perf);
+
+/**
+ * Stops counting and reads the counts since fscl_tofu_perf_begin.
+ *
+ * @param perf The counters.
+ * @param sample Receives the counts.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_perf_end(ctofu_perf* perf, ctofu_perf_sample* sample);
+
+/**
+ * Counts the events of a region of code, such as a single tofu operation.
+ *
+ * @param perf The counters.
+ * @param region The code to measure.
+ * @param context Passed to region.
+ * @param sample Receives the counts.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_perf_measure(ctofu_perf* perf, void (*region)(void*), void* context, ctofu_perf_sample* sample);
+
+/**
+ * Checks whether a sample counted an event.
+ *
+ * @param sample The sample.
+ * @param event The event.
+ * @return true if the event was counted, false otherwise.
+ */
+bool fscl_tofu_perf_has(const ctofu_perf_sample* sample, ctofu_perf_event event);
+
+/**
+ * Names an event, for reports.
+ *
+ * @param event The event.
+ * @return A short lowercase name such as "cycles".
+ */
+const char* fscl_tofu_perf_name(ctofu_perf_event event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,231 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_PERSIST_H
+#define FSCL_XTOFU_PERSIST_H
+
+/**
+ * @file persist.h
+ *
+ * @brief Immutable persistent maps and vectors of "tofu" values.
+ *
+ * A ctofu_pmap is a hash array mapped trie and a ctofu_pvec a radix balanced
+ * trie with a separate tail, both 32 ways wide. Every update returns a new
+ * version that shares all untouched nodes with the old one, so it costs
+ * O(log32 n) node allocations instead of a full copy. Versions are never
+ * modified after they are built: any number of threads can read them without
+ * locks, and the nodes are reference counted atomically so versions can be
+ * released from any thread.
+ *
+ * Stored keys and values are copies, made shareable with fscl_tofu_share
+ * (see shared.h) so that copying a node only takes references. Lookups
+ * return pointers into the version, valid until it is released.
+ *
+ * Map keys are compared with fscl_tofu_hash and fscl_tofu_compare, so they
+ * should be scalars or strings.
+ */
+
+#include "xtofu.h"
+
+/**
+ * A version of a persistent map.
+ */
+typedef struct ctofu_pmap ctofu_pmap;
+
+/**
+ * A version of a persistent vector.
+ */
+typedef struct ctofu_pvec ctofu_pvec;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// PERSISTENT MAP FUNCTIONS
+// =======================
+
+/**
+ * Creates an empty persistent map.
+ *
+ * @return The map, or NULL if out of memory. Release it with fscl_tofu_pmap_release.
+ */
+ctofu_pmap* fscl_tofu_pmap_create(void);
+
+/**
+ * Builds a persistent map from the entries of a TOFU_MAP_TYPE value.
+ *
+ * @param map The source map, left untouched. Later duplicate keys win.
+ * @param result Receives the new version.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_pmap_from(const ctofu* map, ctofu_pmap** result);
+
+/**
+ * Copies the entries of a persistent map into a TOFU_MAP_TYPE value.
+ *
+ * @param map The persistent map.
+ * @param result Receives the map, released with fscl_tofu_value_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_pmap_to(const ctofu_pmap* map, ctofu* result);
+
+/**
+ * Takes another reference to a version.
+ *
+ * @param map The version.
+ * @return The same version.
+ */
+ctofu_pmap* fscl_tofu_pmap_retain(ctofu_pmap* map);
+
+/**
+ * Drops a reference to a version, freeing the nodes no other version uses.
+ *
+ * @param map The version, may be NULL.
+ */
+void fscl_tofu_pmap_release(ctofu_pmap* map);
+
+/**
+ * Retrieves the number of entries of a version.
+ *
+ * @param map The version.
+ * @return The number of entries.
+ */
+size_t fscl_tofu_pmap_size(const ctofu_pmap* map);
+
+/**
+ * Looks up the value stored under a key.
+ *
+ * @param map The version.
+ * @param key The key.
+ * @return The value, or NULL if the key is not present.
+ */
+const ctofu* fscl_tofu_pmap_get(const ctofu_pmap* map, const ctofu* key);
+
+/**
+ * Creates a version in which key maps to value.
+ *
+ * @param map The version to start from, left untouched.
+ * @param key The key, copied.
+ * @param value The value, copied.
+ * @param result Receives the new version.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_pmap_set(const ctofu_pmap* map, const ctofu* key, const ctofu* value, ctofu_pmap** result);
+
+/**
+ * Creates a version without a key.
+ *
+ * @param map The version to start from, left untouched.
+ * @param key The key to remove; a missing key yields another reference to map.
+ * @param result Receives the new version.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_pmap_remove(const ctofu_pmap* map, const ctofu* key, ctofu_pmap** result);
+
+// =======================
+// PERSISTENT VECTOR FUNCTIONS
+// =======================
+
+/**
+ * Creates an empty persistent vector.
+ *
+ * @return The vector, or NULL if out of memory. Release it with fscl_tofu_pvec_release.
+ */
+ctofu_pvec* fscl_tofu_pvec_create(void);
+
+/**
+ * Builds a persistent vector from the elements of a TOFU_ARRAY_TYPE value.
+ *
+ * @param array The source array, left untouched.
+ * @param result Receives the new version.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_pvec_from(const ctofu* array, ctofu_pvec** result);
+
+/**
+ * Copies the elements of a persistent vector into a TOFU_ARRAY_TYPE value.
+ *
+ * @param vector The persistent vector.
+ * @param result Receives the array, released with fscl_tofu_value_erase.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_pvec_to(const ctofu_pvec* vector, ctofu* result);
+
+/**
+ * Takes another reference to a version.
+ *
+ * @param vector The version.
+ * @return The same version.
+ */
+ctofu_pvec* fscl_tofu_pvec_retain(ctofu_pvec* vector);
+
+/**
+ * Drops a reference to a version, freeing the nodes no other version uses.
+ *
+ * @param vector The version, may be NULL.
+ */
+void fscl_tofu_pvec_release(ctofu_pvec* vector);
+
+/**
+ * Retrieves the number of elements of a version.
+ *
+ * @param vector The version.
+ * @return The number of elements.
+ */
+size_t fscl_tofu_pvec_size(const ctofu_pvec* vector);
+
+/**
+ * Retrieves an element.
+ *
+ * @param vector The version.
+ * @param index The index of the element.
+ * @return The element, or NULL if index is out of range.
+ */
+const ctofu* fscl_tofu_pvec_get(const ctofu_pvec* vector, size_t index);
+
+/**
+ * Creates a version with one element replaced.
+ *
+ * @param vector The version to start from, left untouched.
+ * @param index The index of the element, which must exist.
+ * @param value The new element, copied.
+ * @param result Receives the new version.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_pvec_set(const ctofu_pvec* vector, size_t index, const ctofu* value, ctofu_pvec** result);
+
+/**
+ * Creates a version with an element appended.
+ *
+ * @param vector The version to start from, left untouched.
+ * @param value The new element, copied.
+ * @param result Receives the new version.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_pvec_push(const ctofu_pvec* vector, const ctofu* value, ctofu_pvec** result);
+
+/**
+ * Creates a version without the last element.
+ *
+ * @param vector The version to start from, left untouched; must not be empty.
+ * @param result Receives the new version.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_pvec_pop(const ctofu_pvec* vector, ctofu_pvec** result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_PROBE_H
+#define FSCL_XTOFU_PROBE_H
+
+/**
+ * @file probe.h
+ *
+ * @brief Tracepoints at the entry and exit of the tofu operations.
+ *
+ * fscl_tofu_sort, fscl_tofu_search, fscl_tofu_filter, fscl_tofu_reduce,
+ * fscl_tofu_value_copy and fscl_tofu_erase report their entry and exit,
+ * with the operation, the element type and the element count, in two ways:
+ *
+ * - USDT probes, when <sys/sdt.h> was found at build time. The provider is
+ *   fscl_tofu, with op__entry(op, type, elements) and
+ *   op__return(op, type, elements, error), so a running process can be
+ *   traced without rebuilding, e.g. with
+ *   bpftrace -e 'usdt:./app:fscl_tofu:op__entry { @[arg0] = count(); }'.
+ *   An unattached probe is a single nop.
+ * - A hook function set with fscl_tofu_probe_set, to forward the events to
+ *   the tracing system of the application. Without a hook a call pays one
+ *   atomic load per event.
+ *
+ * Arrays report the type of their first element, every other value its own
+ * type. The element count is the size of the array or map handed to the
+ * call, 1 for other values, and is reported again unchanged at exit.
+ */
+
+#include "telemetry.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * One entry or exit of an operation.
+ */
+typedef struct {
+    ctofu_telemetry_op op;   ///< The operation.
+    ctofu_type type;         ///< Element type of the value handed to the call.
+    size_t elements;         ///< Element count of the value handed to the call.
+    bool exit;               ///< false at entry, true at exit.
+    ctofu_error error;       ///< Result of the call, FSCL_TOFU_ERROR_OK at entry.
+} ctofu_probe_event;
+
+/**
+ * Receives probe events, on the thread making the call.
+ *
+ * @param event The event.
+ * @param context The context given to fscl_tofu_probe_set.
+ */
+typedef void (*ctofu_probe_hook)(const ctofu_probe_event* event, void* context);
+
+// =======================
+// PROBE FUNCTIONS
+// =======================
+
+/**
+ * Sets the function receiving probe events. Meant to be called once at
+ * startup; a hook replaced while other threads are inside tofu calls may
+ * still receive an event or see the new context.
+ *
+ * @param hook The function, NULL to stop receiving events.
+ * @param context Passed to every call of the hook.
+ */
+void fscl_tofu_probe_set(ctofu_probe_hook hook, void* context);
+
+/**
+ * Checks whether the library was built with USDT probes.
+ *
+ * @return true if the probes can be attached to, false otherwise.
+ */
+bool fscl_tofu_probe_usdt(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,272 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_QUERY_H
+#define FSCL_XTOFU_QUERY_H
+
+/**
+ * @file query.h
+ *
+ * @brief Lazy pipelines over "tofu" arrays, run in one fused pass.
+ *
+ * A ctofu_query records stages (filter, where, map, apply, skip and take)
+ * over an array without touching it. Nothing runs until one of the run
+ * functions (reduce, fold, collect or group) is called. The run then walks
+ * the array once, in batches of FSCL_TOFU_QUERY_BATCH elements: each batch
+ * goes through every stage and straight into the result, so no array is
+ * built between stages and the source array is never modified.
+ *
+ *     ctofu_query* query = fscl_tofu_query_create(numbers);
+ *     fscl_tofu_query_where(query, FSCL_TOFU_QUERY_GREATER, &zero);
+ *     fscl_tofu_query_apply(query, FSCL_TOFU_QUERY_MULTIPLY, &two);
+ *     fscl_tofu_query_reduce(query, FSCL_TOFU_QUERY_SUM, &total);
+ *     fscl_tofu_query_erase(query);
+ *
+ * The built-in stages (where, apply and the reductions) work on
+ * TOFU_INT_TYPE, TOFU_UINT_TYPE, TOFU_DOUBLE_TYPE and TOFU_FLOAT_TYPE
+ * elements. When a batch holds one of these types only, its values are
+ * loaded into a flat buffer and each built-in stage is a single loop over
+ * it that the compiler can vectorize. Callback stages see the elements
+ * one at a time.
+ *
+ * With fscl_tofu_query_threads the array is split into contiguous slices
+ * run on separate threads, and the partial results are combined in array
+ * order. Callbacks must then be safe to call from several threads, and
+ * fold functions must be associative. Queries with skip or take stages
+ * always run on the calling thread, and stop reading the array at the end
+ * of the batch in which the last take stage is satisfied.
+ *
+ * The array must stay unchanged while a query runs; a query can be run
+ * any number of times.
+ */
+
+#include "xtofu.h"
+
+/**
+ * Recorded pipeline over a "tofu" array.
+ */
+typedef struct ctofu_query ctofu_query;
+
+/**
+ * Comparisons of the built-in where stage, element on the left.
+ */
+typedef enum {
+    FSCL_TOFU_QUERY_LESS,           ///< element < operand
+    FSCL_TOFU_QUERY_LESS_EQUAL,     ///< element <= operand
+    FSCL_TOFU_QUERY_EQUAL,          ///< element == operand
+    FSCL_TOFU_QUERY_NOT_EQUAL,      ///< element != operand
+    FSCL_TOFU_QUERY_GREATER_EQUAL,  ///< element >= operand
+    FSCL_TOFU_QUERY_GREATER         ///< element > operand
+} ctofu_query_compare;
+
+/**
+ * Operations of the built-in apply stage, element on the left.
+ * Integers wrap around on overflow.
+ */
+typedef enum {
+    FSCL_TOFU_QUERY_ADD,       ///< element + operand
+    FSCL_TOFU_QUERY_SUBTRACT,  ///< element - operand
+    FSCL_TOFU_QUERY_MULTIPLY   ///< element * operand
+} ctofu_query_arith;
+
+/**
+ * Built-in reductions.
+ */
+typedef enum {
+    FSCL_TOFU_QUERY_COUNT,  ///< Number of elements, a TOFU_UINT_TYPE value.
+    FSCL_TOFU_QUERY_SUM,    ///< Sum, of the element type (TOFU_DOUBLE_TYPE for floats).
+    FSCL_TOFU_QUERY_MIN,    ///< Smallest element.
+    FSCL_TOFU_QUERY_MAX     ///< Largest element.
+} ctofu_query_reduction;
+
+/**
+ * Decides whether an element goes on through the pipeline.
+ */
+typedef bool (*ctofu_query_predicate)(const ctofu* element, void* context);
+
+/**
+ * Computes a new value from an element. result starts zeroed and is owned
+ * by the query afterwards.
+ */
+typedef ctofu_error (*ctofu_query_function)(const ctofu* element, ctofu* result, void* context);
+
+// Elements pushed through the stages together
+#define FSCL_TOFU_QUERY_BATCH 256
+
+// Most stages a query can record
+#define FSCL_TOFU_QUERY_MAX_STAGES 16
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// CREATE/ERASE FUNCTIONS
+// =======================
+
+/**
+ * Creates an empty query over an array. The query refers to the array, it
+ * does not copy it.
+ *
+ * @param array A TOFU_ARRAY_TYPE value that outlives the query.
+ * @return The query, or NULL if array is not an array or out of memory.
+ */
+ctofu_query* fscl_tofu_query_create(const ctofu* array);
+
+/**
+ * Frees a query. The array is left alone.
+ *
+ * @param query The query, may be NULL.
+ */
+void fscl_tofu_query_erase(ctofu_query* query);
+
+/**
+ * Sets how many threads a run may use. Slices are never smaller than a
+ * few thousand elements, so small arrays still run on one thread.
+ *
+ * @param query The query.
+ * @param threads The thread limit, 0 or 1 to run on the calling thread only.
+ */
+void fscl_tofu_query_threads(ctofu_query* query, size_t threads);
+
+// =======================
+// STAGE FUNCTIONS
+// =======================
+
+/**
+ * Keeps the elements for which a predicate returns true.
+ *
+ * @param query The query.
+ * @param predicate The predicate.
+ * @param context Passed to every call of the predicate.
+ * @return FSCL_TOFU_ERROR_OK, or FSCL_TOFU_ERROR_INVALID_OPERATION when
+ *         predicate is NULL or the query has FSCL_TOFU_QUERY_MAX_STAGES stages.
+ */
+ctofu_error fscl_tofu_query_filter(ctofu_query* query, ctofu_query_predicate predicate, void* context);
+
+/**
+ * Keeps the numeric elements that compare true against an operand, which
+ * is converted to the type of each element.
+ *
+ * @param query The query.
+ * @param compare The comparison.
+ * @param operand A numeric value, copied into the query.
+ * @return FSCL_TOFU_ERROR_OK, or FSCL_TOFU_ERROR_INVALID_OPERATION when the
+ *         operand is not numeric or the query is full.
+ */
+ctofu_error fscl_tofu_query_where(ctofu_query* query, ctofu_query_compare compare, const ctofu* operand);
+
+/**
+ * Replaces every element by the value a function computes from it.
+ *
+ * @param query The query.
+ * @param function The function; an error it returns stops the run.
+ * @param context Passed to every call of the function.
+ * @return FSCL_TOFU_ERROR_OK, or FSCL_TOFU_ERROR_INVALID_OPERATION when
+ *         function is NULL or the query is full.
+ */
+ctofu_error fscl_tofu_query_map(ctofu_query* query, ctofu_query_function function, void* context);
+
+/**
+ * Combines every numeric element with an operand, which is converted to
+ * the type of each element. The element keeps its type.
+ *
+ * @param query The query.
+ * @param arith The operation.
+ * @param operand A numeric value, copied into the query.
+ * @return FSCL_TOFU_ERROR_OK, or FSCL_TOFU_ERROR_INVALID_OPERATION when the
+ *         operand is not numeric or the query is full.
+ */
+ctofu_error fscl_tofu_query_apply(ctofu_query* query, ctofu_query_arith arith, const ctofu* operand);
+
+/**
+ * Drops the first count elements that reach this stage.
+ *
+ * @param query The query.
+ * @param count The number of elements to drop.
+ * @return FSCL_TOFU_ERROR_OK, or FSCL_TOFU_ERROR_INVALID_OPERATION when the query is full.
+ */
+ctofu_error fscl_tofu_query_skip(ctofu_query* query, size_t count);
+
+/**
+ * Lets only the first count elements that reach this stage through.
+ *
+ * @param query The query.
+ * @param count The number of elements to keep.
+ * @return FSCL_TOFU_ERROR_OK, or FSCL_TOFU_ERROR_INVALID_OPERATION when the query is full.
+ */
+ctofu_error fscl_tofu_query_take(ctofu_query* query, size_t count);
+
+// =======================
+// RUN FUNCTIONS
+// =======================
+
+/**
+ * Runs the query and reduces what comes out with a built-in reduction.
+ *
+ * @param query The query.
+ * @param reduction The reduction.
+ * @param result Receives the result, its previous contents are not erased.
+ * @return FSCL_TOFU_ERROR_OK, FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS when no
+ *         element came out (except for FSCL_TOFU_QUERY_COUNT),
+ *         FSCL_TOFU_ERROR_TYPE_MISMATCH when a non-numeric element or
+ *         elements of different types reach a numeric stage, or the error of a callback.
+ */
+ctofu_error fscl_tofu_query_reduce(ctofu_query* query, ctofu_query_reduction reduction, ctofu* result);
+
+/**
+ * Runs the query and folds what comes out the way fscl_tofu_reduce does:
+ * the first element starts the running result, and function receives the
+ * running result and the next element.
+ *
+ * @param query The query.
+ * @param function The fold function, associative when the query runs on several threads.
+ * @param result Receives the result, released with fscl_tofu_value_erase.
+ * @return FSCL_TOFU_ERROR_OK, FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS when no
+ *         element came out, or an error from a stage.
+ */
+ctofu_error fscl_tofu_query_fold(ctofu_query* query, ctofu (*function)(const ctofu*, const ctofu*), ctofu* result);
+
+/**
+ * Runs the query and stores what comes out in a new array. The array is
+ * allocated once, at the size of the source, and trimmed at the end.
+ *
+ * @param query The query.
+ * @param result Receives a TOFU_ARRAY_TYPE value, released with fscl_tofu_value_erase.
+ * @return FSCL_TOFU_ERROR_OK, FSCL_TOFU_ERROR_MEMORY_CORRUPTION if out of
+ *         memory, or an error from a stage.
+ */
+ctofu_error fscl_tofu_query_collect(ctofu_query* query, ctofu* result);
+
+/**
+ * Runs the query, groups what comes out by key and reduces each group
+ * with a built-in reduction. Keys are matched with fscl_tofu_hash and
+ * fscl_tofu_compare, so they should be scalars or strings.
+ *
+ * @param query The query.
+ * @param key Computes the key of an element, NULL to use the element itself.
+ * @param context Passed to every call of key.
+ * @param reduction The reduction applied to the elements of each group.
+ * @param result Receives a TOFU_MAP_TYPE value with one entry per key, in
+ *        order of first appearance, released with fscl_tofu_value_erase.
+ * @return FSCL_TOFU_ERROR_OK, FSCL_TOFU_ERROR_MEMORY_CORRUPTION if out of
+ *         memory, or an error from a stage.
+ */
+ctofu_error fscl_tofu_query_group(ctofu_query* query, ctofu_query_function key, void* context,
+                                  ctofu_query_reduction reduction, ctofu* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,169 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_QUEUE_H
+#define FSCL_XTOFU_QUEUE_H
+
+/**
+ * @file queue.h
+ *
+ * @brief Bounded lock-free queues that hand "tofu" values between threads.
+ *
+ * A queue is a ring buffer of ctofu structures stored by value. Pushing
+ * moves a value into the queue: the structure is copied bit for bit and the
+ * caller's copy is zeroed, so strings, arrays and maps change owner without
+ * being duplicated. Popping moves the value back out.
+ *
+ * FSCL_TOFU_QUEUE_SPSC queues allow one producer and one consumer thread and
+ * cost one release store per operation (or per batch). FSCL_TOFU_QUEUE_MPMC
+ * queues allow any number of both and use a sequence number per slot. In
+ * both, the producer and consumer indices sit on separate cache lines.
+ *
+ * The try functions never block. The blocking ones sleep on a futex
+ * (WaitOnAddress on Windows) and are only woken when a waiter is known to
+ * exist. fscl_tofu_queue_close wakes every sleeper.
+ */
+
+#include "xtofu.h"
+
+/**
+ * Bounded queue of "tofu" values.
+ */
+typedef struct ctofu_queue ctofu_queue;
+
+/**
+ * Threads allowed on each end of a queue.
+ */
+typedef enum {
+    FSCL_TOFU_QUEUE_SPSC,  ///< One producer, one consumer.
+    FSCL_TOFU_QUEUE_MPMC   ///< Any number of producers and consumers.
+} ctofu_queue_kind;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// CREATE/ERASE FUNCTIONS
+// =======================
+
+/**
+ * Creates an empty queue.
+ *
+ * @param kind The threads allowed on each end.
+ * @param capacity The number of values it can hold, rounded up to a power of two.
+ * @return The queue, or NULL if out of memory or capacity is 0.
+ */
+ctofu_queue* fscl_tofu_queue_create(ctofu_queue_kind kind, size_t capacity);
+
+/**
+ * Erases the values left in a queue and frees it.
+ *
+ * No other thread may use the queue any more.
+ *
+ * @param queue The queue, may be NULL.
+ */
+void fscl_tofu_queue_erase(ctofu_queue* queue);
+
+/**
+ * Closes a queue: pushes fail from now on and pops fail once it is empty.
+ * Every blocked thread is woken.
+ *
+ * @param queue The queue.
+ */
+void fscl_tofu_queue_close(ctofu_queue* queue);
+
+/**
+ * Retrieves the number of values in a queue, which may already be stale.
+ *
+ * @param queue The queue.
+ * @return The number of values.
+ */
+size_t fscl_tofu_queue_size(const ctofu_queue* queue);
+
+/**
+ * Retrieves the capacity of a queue.
+ *
+ * @param queue The queue.
+ * @return The number of values it can hold.
+ */
+size_t fscl_tofu_queue_capacity(const ctofu_queue* queue);
+
+// =======================
+// PUSH/POP FUNCTIONS
+// =======================
+
+/**
+ * Moves a value into a queue if there is room.
+ *
+ * @param queue The queue.
+ * @param value The value, zeroed once it has been moved.
+ * @return FSCL_TOFU_ERROR_OK, FSCL_TOFU_ERROR_BUFFER_OVERFLOW if full, or
+ *         FSCL_TOFU_ERROR_INVALID_OPERATION if closed.
+ */
+ctofu_error fscl_tofu_queue_try_push(ctofu_queue* queue, ctofu* value);
+
+/**
+ * Moves a value into a queue, waiting for room.
+ *
+ * @param queue The queue.
+ * @param value The value, zeroed once it has been moved.
+ * @return FSCL_TOFU_ERROR_OK, or FSCL_TOFU_ERROR_INVALID_OPERATION if the queue was closed.
+ */
+ctofu_error fscl_tofu_queue_push(ctofu_queue* queue, ctofu* value);
+
+/**
+ * Moves the oldest value out of a queue if there is one.
+ *
+ * @param queue The queue.
+ * @param value Receives the value.
+ * @return FSCL_TOFU_ERROR_OK, or FSCL_TOFU_ERROR_BUFFER_UNDERFLOW if empty.
+ */
+ctofu_error fscl_tofu_queue_try_pop(ctofu_queue* queue, ctofu* value);
+
+/**
+ * Moves the oldest value out of a queue, waiting for one.
+ *
+ * @param queue The queue.
+ * @param value Receives the value.
+ * @return FSCL_TOFU_ERROR_OK, or FSCL_TOFU_ERROR_BUFFER_UNDERFLOW if the queue was closed and is empty.
+ */
+ctofu_error fscl_tofu_queue_pop(ctofu_queue* queue, ctofu* value);
+
+/**
+ * Moves several values into a queue.
+ *
+ * @param queue The queue.
+ * @param values The values; each one moved is zeroed.
+ * @param count The number of values.
+ * @param block Wait until all of them are moved (or the queue is closed).
+ * @return The number of values moved, always from the front of values.
+ */
+size_t fscl_tofu_queue_push_batch(ctofu_queue* queue, ctofu* values, size_t count, bool block);
+
+/**
+ * Moves several values out of a queue.
+ *
+ * @param queue The queue.
+ * @param values Receives the values.
+ * @param count The most values to take.
+ * @param block Wait until at least one value is available (or the queue is closed).
+ * @return The number of values taken.
+ */
+size_t fscl_tofu_queue_pop_batch(ctofu_queue* queue, ctofu* values, size_t count, bool block);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,96 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_RECLAIM_H
+#define FSCL_XTOFU_RECLAIM_H
+
+/**
+ * @file reclaim.h
+ *
+ * @brief Background thread that erases "tofu" values off the caller's path.
+ *
+ * Erasing a large nested value touches every string and container in it.
+ * fscl_tofu_erase_async moves the value into a bounded queue instead, and a
+ * reclaimer thread erases it later, so the caller pays for one move. When
+ * the queue is full the caller either waits for room (backpressure) or gets
+ * FSCL_TOFU_ERROR_BUFFER_OVERFLOW back.
+ *
+ * The reclaimer starts with the first asynchronous erase, or explicitly with
+ * fscl_tofu_reclaim_start. fscl_tofu_reclaim_drain waits until everything
+ * handed over so far is erased, and fscl_tofu_reclaim_stop also ends the
+ * thread, for shutdown and tests.
+ */
+
+#include "xtofu.h"
+
+/**
+ * Number of values the reclaimer queue holds when started implicitly.
+ */
+#define FSCL_TOFU_RECLAIM_CAPACITY 256
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// RECLAIMER FUNCTIONS
+// =======================
+
+/**
+ * Starts the reclaimer thread, doing nothing if it already runs.
+ *
+ * @param capacity Number of values that may wait in its queue.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_reclaim_start(size_t capacity);
+
+/**
+ * Waits until the reclaimer has erased every value handed to it so far.
+ */
+void fscl_tofu_reclaim_drain(void);
+
+/**
+ * Drains the reclaimer and ends its thread. A later asynchronous erase
+ * starts a new one.
+ *
+ * No other thread may hand values over while the reclaimer stops.
+ */
+void fscl_tofu_reclaim_stop(void);
+
+/**
+ * Counts the values handed over but not erased yet.
+ *
+ * @return The number of pending values.
+ */
+size_t fscl_tofu_reclaim_pending(void);
+
+/**
+ * Hands a value to the reclaimer thread, which erases it later.
+ *
+ * The value is moved and left zeroed on success. Values that own no storage
+ * are only zeroed, and if the reclaimer cannot be started the value is
+ * erased right away.
+ *
+ * @param value The value to erase.
+ * @param block Whether to wait for room when the queue is full.
+ * @return Error code indicating the success or failure of the operation;
+ *         FSCL_TOFU_ERROR_BUFFER_OVERFLOW when the queue is full and block is
+ *         false, in which case value is left untouched.
+ */
+ctofu_error fscl_tofu_erase_async(ctofu* value, bool block);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,76 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_SHARED_H
+#define FSCL_XTOFU_SHARED_H
+
+/**
+ * @file shared.h
+ *
+ * @brief Reference counted, copy-on-write arrays, maps and strings.
+ *
+ * fscl_tofu_share moves the storage of a value (and of every array, map and
+ * string nested in it) into blocks that carry an atomic reference count;
+ * the value is then marked with TOFU_FLAG_SHARED. Copying a shared value
+ * with fscl_tofu_value_copy only takes another reference, and erasing it
+ * drops one, freeing the block with the last reference.
+ *
+ * The in-place algorithms (fscl_tofu_sort, fscl_tofu_transform,
+ * fscl_tofu_reverse, fscl_tofu_reduce, fscl_tofu_shuffle and
+ * fscl_tofu_for_each) and fscl_tofu_value_setter call fscl_tofu_unique
+ * first, so the first write to a container that is still shared clones that
+ * container alone; its nested shared elements are retained, not copied.
+ * Code that writes to elements directly must call fscl_tofu_unique itself.
+ */
+
+#include "xtofu.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Moves a value and everything nested in it into reference counted storage.
+ *
+ * The value must own its strings and element storage, as it would for
+ * fscl_tofu_value_erase. Inline and interned strings, empty containers and
+ * scalars are already cheap to copy and are left as they are.
+ *
+ * @param value The value to share.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_share(ctofu* value);
+
+/**
+ * Gives a shared value storage of its own if other references exist.
+ *
+ * Only the top-level container is cloned; nested shared values are retained.
+ *
+ * @param value The value about to be modified.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_unique(ctofu* value);
+
+/**
+ * Retrieves the number of values sharing the storage of a value.
+ *
+ * @param value The value.
+ * @return The reference count, 1 for values that are not shared.
+ */
+size_t fscl_tofu_references(const ctofu* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
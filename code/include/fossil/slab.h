@@ -0,0 +1,79 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_SLAB_H
+#define FSCL_XTOFU_SLAB_H
+
+/**
+ * @file slab.h
+ *
+ * @brief Optional slab allocator for "tofu" structures and small arrays.
+ *
+ * When enabled, fscl_tofu_create and fscl_tofu_create_array take their
+ * ctofu structures and element buffers of up to FSCL_TOFU_SLAB_LARGEST bytes
+ * from fixed-size blocks carved out of 64 KiB slabs. Every thread keeps its
+ * own free list per block size, so creating and erasing a value is a couple
+ * of pointer operations. Lists that grow long hand a batch of blocks back to
+ * a global depot, and empty lists refill from it with a batch under one lock.
+ *
+ * Slab memory is kept for reuse and never returned to the system. When a
+ * thread exits, the blocks on its free lists go back to the depot, where
+ * they are handed out in batches to the threads that refill next.
+ *
+ * While the allocator is on, structures from fscl_tofu_create and
+ * fscl_tofu_create_array must be released with fscl_tofu_erase or
+ * fscl_tofu_value_erase, never with free(). Blocks handed out stay valid
+ * after it is turned off.
+ */
+
+#include "xtofu.h"
+
+/**
+ * Largest allocation, in bytes, served from slabs.
+ */
+#define FSCL_TOFU_SLAB_LARGEST 256
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// SLAB FUNCTIONS
+// =======================
+
+/**
+ * Turns the slab allocator on or off for new structures.
+ *
+ * @param enabled Whether new structures come from slabs.
+ */
+void fscl_tofu_slab_enable(bool enabled);
+
+/**
+ * Checks whether new structures come from slabs.
+ *
+ * @return true if the slab allocator is on, false otherwise.
+ */
+bool fscl_tofu_slab_enabled(void);
+
+/**
+ * Counts the slabs allocated so far.
+ *
+ * @return The number of slabs.
+ */
+size_t fscl_tofu_slab_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
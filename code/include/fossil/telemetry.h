@@ -0,0 +1,129 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_TELEMETRY_H
+#define FSCL_XTOFU_TELEMETRY_H
+
+/**
+ * @file telemetry.h
+ *
+ * @brief Call counts and latency histograms of the tofu operations.
+ *
+ * Only compiled in when the library is built with -Dwith_telemetry=enabled
+ * (which defines FSCL_TOFU_TELEMETRY); otherwise the operations carry no
+ * instrumentation at all and these functions report that nothing is
+ * recorded.
+ *
+ * Every thread records into a shard of its own, so recording takes no locks
+ * and no atomic read-modify-write. Shards are summed when statistics are
+ * read. Latencies go into log-linear buckets (8 per power of two, about
+ * 12% apart) from 1 ns up to about 36 minutes, in the manner of HDR
+ * histograms. Bytes count what the library asked the allocator for during
+ * the call.
+ */
+
+#include "xtofu.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Operations that are recorded.
+ */
+typedef enum {
+    FSCL_TOFU_TELEMETRY_CREATE,
+    FSCL_TOFU_TELEMETRY_CREATE_ARRAY,
+    FSCL_TOFU_TELEMETRY_ERASE,
+    FSCL_TOFU_TELEMETRY_ACCUMULATE,
+    FSCL_TOFU_TELEMETRY_TRANSFORM,
+    FSCL_TOFU_TELEMETRY_FILTER,
+    FSCL_TOFU_TELEMETRY_SORT,
+    FSCL_TOFU_TELEMETRY_SEARCH,
+    FSCL_TOFU_TELEMETRY_REVERSE,
+    FSCL_TOFU_TELEMETRY_REDUCE,
+    FSCL_TOFU_TELEMETRY_SHUFFLE,
+    FSCL_TOFU_TELEMETRY_PARTITION,
+    FSCL_TOFU_TELEMETRY_VALUE_COPY,
+    FSCL_TOFU_TELEMETRY_OUT,
+    FSCL_TOFU_TELEMETRY_OPS   ///< Number of operations.
+} ctofu_telemetry_op;
+
+/**
+ * Statistics of one operation, summed over all threads.
+ */
+typedef struct {
+    uint64_t calls;      ///< Number of calls.
+    uint64_t elements;   ///< Elements handed to the calls (array or map size, 1 for other values).
+    uint64_t bytes;      ///< Bytes allocated during the calls.
+    uint64_t total_ns;   ///< Time spent in the calls.
+    uint64_t min_ns;     ///< Fastest call, 0 without calls.
+    uint64_t max_ns;     ///< Slowest call.
+    uint64_t p50_ns;     ///< Median latency.
+    uint64_t p90_ns;     ///< 90th percentile latency.
+    uint64_t p99_ns;     ///< 99th percentile latency.
+    uint64_t p999_ns;    ///< 99.9th percentile latency.
+} ctofu_telemetry_stats;
+
+// =======================
+// TELEMETRY FUNCTIONS
+// =======================
+
+/**
+ * Checks whether the library was built with telemetry.
+ *
+ * @return true if operations are recorded, false otherwise.
+ */
+bool fscl_tofu_telemetry_enabled(void);
+
+/**
+ * Names an operation, as used for the keys of a snapshot.
+ *
+ * @param op The operation.
+ * @return The name of the public function without its prefix, such as "sort".
+ */
+const char* fscl_tofu_telemetry_name(ctofu_telemetry_op op);
+
+/**
+ * Reads the statistics of one operation.
+ *
+ * @param op The operation.
+ * @param stats Receives the statistics.
+ * @return Error code indicating the success or failure of the operation;
+ *         FSCL_TOFU_ERROR_INVALID_OPERATION when telemetry is not compiled in.
+ */
+ctofu_error fscl_tofu_telemetry_read(ctofu_telemetry_op op, ctofu_telemetry_stats* stats);
+
+/**
+ * Returns the statistics of every operation as a map, keyed by operation
+ * name, of maps with the uint fields of ctofu_telemetry_stats ("calls",
+ * "elements", "bytes", "total_ns", "min_ns", "max_ns", "p50_ns", "p90_ns",
+ * "p99_ns" and "p999_ns").
+ *
+ * @param snapshot Receives the map, to be released with fscl_tofu_value_erase.
+ * @return Error code indicating the success or failure of the operation;
+ *         FSCL_TOFU_ERROR_INVALID_OPERATION when telemetry is not compiled in.
+ */
+ctofu_error fscl_tofu_telemetry_snapshot(ctofu* snapshot);
+
+/**
+ * Clears the statistics. Calls that other threads are recording meanwhile
+ * may survive the reset in part.
+ */
+void fscl_tofu_telemetry_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
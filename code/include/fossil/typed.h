@@ -0,0 +1,277 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_TYPED_H
+#define FSCL_XTOFU_TYPED_H
+
+/**
+ * @file typed.h
+ *
+ * @brief Kernels specialized at compile time for one scalar type.
+ *
+ * The operations of xtofu.h look at the type of every element they touch.
+ * When the element type is known where the call is written, the kernels
+ * here work on a plain C buffer of that type instead, so the loops are
+ * monomorphic and the compiler can inline and vectorize them. Every kernel
+ * is generated from the one FSCL_TOFU_TYPED_KERNELS template for int64_t,
+ * uint64_t, double and float, and the fscl_tofu_typed_* macros pick the
+ * right one from the buffer type with _Generic:
+ *
+ *     int64_t values[] = {3, 1, 2};
+ *     fscl_tofu_typed_sort(values, 3);
+ *     int64_t total = fscl_tofu_typed_sum(values, 3);
+ *
+ * fscl_tofu_typed_unpack and fscl_tofu_typed_pack move the elements of a
+ * "tofu" array of TOFU_INT_TYPE, TOFU_UINT_TYPE, TOFU_DOUBLE_TYPE or
+ * TOFU_FLOAT_TYPE in and out of such a buffer.
+ *
+ * Integer sums wrap around on overflow. Floating point sums add four
+ * interleaved partial sums, float ones in double precision, so they may
+ * differ from a left-to-right sum in the last bits. Sorting orders with <,
+ * so NaNs end up in unspecified places.
+ */
+
+#include "xtofu.h"
+#include "shared.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =======================
+// KERNEL TEMPLATE
+// =======================
+
+// Below this many elements the sort switches to insertion sort
+#define FSCL_TOFU_TYPED_SMALL_SORT 16
+
+/**
+ * Defines the kernels of one scalar type.
+ *
+ * @param name Suffix of the kernel names, such as int64.
+ * @param T The element type.
+ * @param S The type sums are accumulated in.
+ * @param R The type sums are returned in.
+ * @param field The ctofu_data member holding a T.
+ * @param tofu_type The ctofu_type of elements holding a T.
+ */
+#define FSCL_TOFU_TYPED_KERNELS(name, T, S, R, field, tofu_type)                                      \
+    static inline R fscl_tofu_typed_sum_##name(const T* values, size_t count) {                      \
+        S sums[4] = {0, 0, 0, 0};                                                                     \
+        size_t i = 0;                                                                                 \
+        for (; i + 4 <= count; i += 4) {                                                              \
+            sums[0] += (S)values[i];                                                                  \
+            sums[1] += (S)values[i + 1];                                                              \
+            sums[2] += (S)values[i + 2];                                                              \
+            sums[3] += (S)values[i + 3];                                                              \
+        }                                                                                             \
+        for (; i < count; ++i) {                                                                      \
+            sums[0] += (S)values[i];                                                                  \
+        }                                                                                             \
+        return (R)((sums[0] + sums[1]) + (sums[2] + sums[3]));                                        \
+    }                                                                                                 \
+                                                                                                      \
+    static inline size_t fscl_tofu_typed_search_##name(const T* values, size_t count, T key) {       \
+        for (size_t i = 0; i < count; ++i) {                                                          \
+            if (values[i] == key) {                                                                   \
+                return i;                                                                             \
+            }                                                                                         \
+        }                                                                                             \
+        return SIZE_MAX;                                                                              \
+    }                                                                                                 \
+                                                                                                      \
+    static inline void fscl_tofu_typed_insertion_##name(T* values, size_t count) {                   \
+        for (size_t i = 1; i < count; ++i) {                                                          \
+            T value = values[i];                                                                      \
+            size_t j = i;                                                                             \
+            for (; j > 0 && value < values[j - 1]; --j) {                                             \
+                values[j] = values[j - 1];                                                            \
+            }                                                                                         \
+            values[j] = value;                                                                        \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    static inline void fscl_tofu_typed_heapsort_##name(T* values, size_t count) {                    \
+        for (size_t end = count, start = count / 2; end > 1;) {                                       \
+            size_t root;                                                                              \
+            if (start > 0) {                                                                          \
+                root = --start;                                                                       \
+            } else {                                                                                  \
+                --end;                                                                                \
+                T top = values[0];                                                                    \
+                values[0] = values[end];                                                              \
+                values[end] = top;                                                                    \
+                root = 0;                                                                             \
+            }                                                                                         \
+            for (size_t child; (child = 2 * root + 1) < end; root = child) {                          \
+                if (child + 1 < end && values[child] < values[child + 1]) {                           \
+                    ++child;                                                                          \
+                }                                                                                     \
+                if (!(values[root] < values[child])) {                                                \
+                    break;                                                                            \
+                }                                                                                     \
+                T swap = values[root];                                                                \
+                values[root] = values[child];                                                         \
+                values[child] = swap;                                                                 \
+            }                                                                                         \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    static inline void fscl_tofu_typed_introsort_##name(T* values, size_t count, unsigned depth) {   \
+        while (count > FSCL_TOFU_TYPED_SMALL_SORT) {                                                  \
+            if (depth-- == 0) {                                                                       \
+                fscl_tofu_typed_heapsort_##name(values, count);                                       \
+                return;                                                                               \
+            }                                                                                         \
+            /* Median of three as pivot, parked at the end */                                         \
+            size_t middle = count / 2;                                                                \
+            T a = values[0], b = values[middle], c = values[count - 1];                               \
+            size_t pick = (a < b) ? ((b < c) ? middle : (a < c) ? count - 1 : 0)                      \
+                                  : ((a < c) ? 0 : (b < c) ? count - 1 : middle);                     \
+            T pivot = values[pick];                                                                   \
+            values[pick] = values[count - 1];                                                         \
+            values[count - 1] = pivot;                                                                \
+            /* Branch-free Lomuto partition */                                                        \
+            size_t store = 0;                                                                         \
+            for (size_t i = 0; i + 1 < count; ++i) {                                                  \
+                T value = values[i];                                                                  \
+                values[i] = values[store];                                                            \
+                values[store] = value;                                                                \
+                store += value < pivot;                                                               \
+            }                                                                                         \
+            values[count - 1] = values[store];                                                        \
+            values[store] = pivot;                                                                    \
+            /* Recurse into the smaller side, loop over the larger one */                             \
+            if (store < count - store - 1) {                                                          \
+                fscl_tofu_typed_introsort_##name(values, store, depth);                               \
+                values += store + 1;                                                                  \
+                count -= store + 1;                                                                   \
+            } else {                                                                                  \
+                fscl_tofu_typed_introsort_##name(values + store + 1, count - store - 1, depth);       \
+                count = store;                                                                        \
+            }                                                                                         \
+        }                                                                                             \
+        fscl_tofu_typed_insertion_##name(values, count);                                              \
+    }                                                                                                 \
+                                                                                                      \
+    static inline void fscl_tofu_typed_sort_##name(T* values, size_t count) {                        \
+        unsigned depth = 0;                                                                           \
+        for (size_t n = count; n > 1; n >>= 1) {                                                      \
+            depth += 2;                                                                               \
+        }                                                                                             \
+        fscl_tofu_typed_introsort_##name(values, count, depth);                                       \
+    }                                                                                                 \
+                                                                                                      \
+    static inline ctofu_error fscl_tofu_typed_unpack_##name(const ctofu* array, T* values) {         \
+        if (array == NULL || values == NULL) {                                                        \
+            return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);                                     \
+        }                                                                                             \
+        if (array->type != TOFU_ARRAY_TYPE) {                                                         \
+            return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);                                \
+        }                                                                                             \
+        const ctofu* elements = array->data.array_type.elements;                                      \
+        bool mismatch = false;                                                                        \
+        for (size_t i = 0; i < array->data.array_type.size; ++i) {                                    \
+            mismatch |= elements[i].type != tofu_type;                                                \
+            values[i] = elements[i].data.field;                                                       \
+        }                                                                                             \
+        return mismatch ? fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION) : FSCL_TOFU_ERROR_OK;    \
+    }                                                                                                 \
+                                                                                                      \
+    static inline ctofu_error fscl_tofu_typed_pack_##name(ctofu* array, const T* values) {           \
+        if (array == NULL || values == NULL) {                                                        \
+            return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);                                     \
+        }                                                                                             \
+        if (array->type != TOFU_ARRAY_TYPE) {                                                         \
+            return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);                                \
+        }                                                                                             \
+        ctofu* elements = array->data.array_type.elements;                                            \
+        for (size_t i = 0; i < array->data.array_type.size; ++i) {                                    \
+            if (elements[i].type != tofu_type) {                                                      \
+                return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);                            \
+            }                                                                                         \
+        }                                                                                             \
+        ctofu_error error = fscl_tofu_unique(array);                                                  \
+        if (error != FSCL_TOFU_ERROR_OK) {                                                            \
+            return error;                                                                             \
+        }                                                                                             \
+        elements = array->data.array_type.elements;                                                   \
+        for (size_t i = 0; i < array->data.array_type.size; ++i) {                                    \
+            elements[i].data.field = values[i];                                                       \
+        }                                                                                             \
+        return FSCL_TOFU_ERROR_OK;                                                                    \
+    }
+
+// =======================
+// TYPED KERNELS
+// =======================
+
+FSCL_TOFU_TYPED_KERNELS(int64, int64_t, uint64_t, int64_t, int_type, TOFU_INT_TYPE)
+FSCL_TOFU_TYPED_KERNELS(uint64, uint64_t, uint64_t, uint64_t, uint_type, TOFU_UINT_TYPE)
+FSCL_TOFU_TYPED_KERNELS(double, double, double, double, double_type, TOFU_DOUBLE_TYPE)
+FSCL_TOFU_TYPED_KERNELS(float, float, double, double, float_type, TOFU_FLOAT_TYPE)
+
+#ifndef __cplusplus
+
+/**
+ * Picks the kernel of a buffer type.
+ *
+ * @param kernel The kernel name without its type suffix.
+ * @param values The buffer, an int64_t, uint64_t, double or float pointer.
+ */
+#define FSCL_TOFU_TYPED_SELECT(kernel, values)          \
+    _Generic((values),                                  \
+        int64_t*: kernel##_int64,                       \
+        const int64_t*: kernel##_int64,                 \
+        uint64_t*: kernel##_uint64,                     \
+        const uint64_t*: kernel##_uint64,               \
+        double*: kernel##_double,                       \
+        const double*: kernel##_double,                 \
+        float*: kernel##_float,                         \
+        const float*: kernel##_float)
+
+/**
+ * Sums a buffer; int64_t and uint64_t sums wrap around, float sums are double.
+ */
+#define fscl_tofu_typed_sum(values, count) FSCL_TOFU_TYPED_SELECT(fscl_tofu_typed_sum, values)(values, count)
+
+/**
+ * Finds the first element equal to key, SIZE_MAX when there is none.
+ */
+#define fscl_tofu_typed_search(values, count, key) \
+    FSCL_TOFU_TYPED_SELECT(fscl_tofu_typed_search, values)(values, count, key)
+
+/**
+ * Sorts a buffer in ascending order, in O(n log n) time and not stably.
+ */
+#define fscl_tofu_typed_sort(values, count) FSCL_TOFU_TYPED_SELECT(fscl_tofu_typed_sort, values)(values, count)
+
+/**
+ * Copies the elements of a "tofu" array into a buffer of its size; fails
+ * with FSCL_TOFU_ERROR_INVALID_OPERATION if an element has another type.
+ */
+#define fscl_tofu_typed_unpack(array, values) FSCL_TOFU_TYPED_SELECT(fscl_tofu_typed_unpack, values)(array, values)
+
+/**
+ * Copies a buffer of its size back into the elements of a "tofu" array;
+ * changes nothing unless every element already has the buffer's type.
+ */
+#define fscl_tofu_typed_pack(array, values) FSCL_TOFU_TYPED_SELECT(fscl_tofu_typed_pack, values)(array, values)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -111,6 +111,11 @@ typedef enum {
     TOFU_UNKNOWN_TYPE        ///< Unknown data type.
 } ctofu_type;
 
+/**
+ * Longest string, in bytes, that fits inline in a "tofu" structure.
+ */
+#define FSCL_TOFU_SMALL_STRING 22
+
 /**
  * Union to hold data of different types in the "tofu" data structure.
  */
@@ -137,13 +142,38 @@ typedef union {
         struct ctofu* value;    ///< Value type for a map.
         size_t size;            ///< Size of the map.
     } map_type;
+    struct {
+        char* text;             ///< Heap text, the same pointer as string_type.
+        size_t length;          ///< Length of the text in bytes.
+    } sized_type;               ///< String with a known length (TOFU_FLAG_SIZED).
+    struct {
+        char text[FSCL_TOFU_SMALL_STRING + 1]; ///< NUL terminated text.
+        uint8_t length;                        ///< Length of the text in bytes.
+    } small_type;               ///< Short string stored in place (TOFU_FLAG_INLINE).
 } ctofu_data;
 
+/**
+ * Flags describing how the data of a "tofu" structure is stored.
+ *
+ * Plain values have no flags set. Values built by hand must zero the flags
+ * (for example with memset or an empty initializer) before use.
+ * TOFU_FLAG_SCALARS is a hint set by fscl_tofu_create_array; code that stores
+ * a string or container into such an array by hand must clear it.
+ */
+enum {
+    TOFU_FLAG_INTERNED = 1u << 0,  ///< string_type is a handle owned by the intern pool.
+    TOFU_FLAG_INLINE = 1u << 1,    ///< The string lives in small_type, string_type is not valid.
+    TOFU_FLAG_SIZED = 1u << 2,     ///< sized_type.length holds the length of string_type.
+    TOFU_FLAG_SHARED = 1u << 3,    ///< The string, array or map storage is reference counted (see shared.h).
+    TOFU_FLAG_SCALARS = 1u << 4    ///< The array holds no strings or containers, so erasing it skips the elements.
+};
+
 /**
  * Struct to represent the data and its type in the "tofu" data structure.
  */
 struct ctofu {
     ctofu_type type;  ///< The data type of the "tofu" structure.
+    uint32_t flags;   ///< Storage flags (TOFU_FLAG_*), zero for plain values.
     ctofu_data data;  ///< The data stored in the "tofu" structure.
 };
 
@@ -176,6 +206,8 @@ extern "C"
 
 /**
  * Creates a new "tofu" structure with the specified type and optional initial value.
+ * Strings are copied; an array value takes over its elements buffer, which
+ * fscl_tofu_erase frees.
  *
  * @param type The data type of the "tofu" structure.
  * @param value Optional initial value for the "tofu" structure.
@@ -185,6 +217,7 @@ ctofu* fscl_tofu_create(ctofu_type type, ctofu_data* value);
 
 /**
  * Creates a new "tofu" array with the specified type and size, initialized with variable arguments.
+ * String arguments are copied, so the caller keeps ownership of them.
  *
  * @param type The data type of the "tofu" array.
  * @param size The size of the "tofu" array.
@@ -194,7 +227,8 @@ ctofu* fscl_tofu_create(ctofu_type type, ctofu_data* value);
 ctofu* fscl_tofu_create_array(ctofu_type type, size_t size, ...);
 
 /**
- * Erases a single "tofu" structure, freeing its memory.
+ * Erases a single "tofu" structure, freeing its memory together with
+ * everything it owns (see fscl_tofu_value_erase).
  *
  * @param value The "tofu" structure to erase.
  * @return Error code indicating the success or failure of the operation.
@@ -203,6 +237,8 @@ ctofu_error fscl_tofu_erase(ctofu* value);
 
 /**
  * Erases an array of "tofu" structures, freeing their memory.
+ * The elements are erased as well, and the array is left with type
+ * TOFU_INVALID_TYPE; the structure itself is not freed.
  *
  * @param array The array of "tofu" structures to erase.
  * @return Error code indicating the success or failure of the operation.
@@ -259,6 +295,7 @@ ctofu_error fscl_tofu_search(ctofu* objects, ctofu* key);
 
 /**
  * Filters elements in the "tofu" structure based on the provided filter function.
+ * Kept elements are moved forward in place, rejected ones are erased.
  *
  * @param objects The "tofu" structure to filter.
  * @param filterFunc The filter function applied to each element.
@@ -294,6 +331,8 @@ ctofu_error fscl_tofu_compare(ctofu* right, ctofu* left);
 
 /**
  * Reduces the elements in the "tofu" structure using the provided reduction function.
+ * The function receives the running result and the next element; the final
+ * result is left as the only element of the array.
  *
  * @param objects The "tofu" structure to reduce.
  * @param reduceFunc The reduction function applied to pairs of elements.
@@ -322,6 +361,7 @@ ctofu_error fscl_tofu_for_each(ctofu* objects, void (*forEachFunc)(ctofu*));
  * The predicate signature should be: bool (*partitionFunc)(const ctofu* element);
  * The function returns a new "tofu" structure containing two arrays: elements satisfying the predicate
  * and elements not satisfying the predicate.
+ * The elements are moved into the partitions, leaving objects an empty array.
  *
  * @param objects The "tofu" structure.
  * @param partitionFunc The predicate function.
@@ -357,15 +397,68 @@ void fscl_tofu_out(const ctofu value);
  */
 char* fscl_tofu_strdup(const char* source);
 
+/**
+ * Computes a 64-bit hash of a "tofu" structure.
+ *
+ * Values that compare equal hash equally: strings hash their text (interned
+ * strings return the hash cached in the pool), reals treat -0.0 as 0.0, and
+ * arrays and maps combine the hashes of their elements.
+ *
+ * @param value The "tofu" structure to hash.
+ * @return The hash value.
+ */
+uint64_t fscl_tofu_hash(const ctofu* value);
 
 /**
- * Retrieves a descriptive error message for the given "tofu" error code.
+ * Passes a "tofu" error code through. A failure is also recorded as the last
+ * error of the calling thread; use fscl_tofu_error_message for its text.
  *
  * @param error The "tofu" error code.
- * @return A descriptive error message.
+ * @return The same error code.
  */
 ctofu_error fscl_tofu_error(ctofu_error error);
 
+/**
+ * Where and why the last failing call of a thread failed. Only failures
+ * fill it in, successful calls leave it alone.
+ */
+typedef struct {
+    ctofu_error code;        ///< The error, FSCL_TOFU_ERROR_OK when nothing failed yet.
+    const char* function;    ///< Library function that raised it, which may be an internal helper; NULL when unknown.
+    size_t index;            ///< Element at fault, SIZE_MAX when the error is not about one element.
+    ctofu_type type;         ///< Type at fault, TOFU_INVALID_TYPE when none.
+} ctofu_error_context;
+
+/**
+ * Receives the diagnostics the library used to print.
+ *
+ * @param context The failure the diagnostic is about.
+ * @param message The diagnostic, without a trailing newline.
+ * @param user The pointer given to fscl_tofu_set_log_sink.
+ */
+typedef void (*ctofu_log_sink)(const ctofu_error_context* context, const char* message, void* user);
+
+/**
+ * Returns the last error raised on the calling thread.
+ *
+ * @return The error context, owned by the thread and valid until it exits.
+ */
+const ctofu_error_context* fscl_tofu_last_error(void);
+
+/**
+ * Resets the last error of the calling thread to FSCL_TOFU_ERROR_OK.
+ */
+void fscl_tofu_clear_error(void);
+
+/**
+ * Sets where diagnostics go. Without a sink, the default, they are dropped;
+ * the error context is recorded either way.
+ *
+ * @param sink The function receiving diagnostics, NULL to drop them.
+ * @param user Passed to every call of the sink.
+ */
+void fscl_tofu_set_log_sink(ctofu_log_sink sink, void* user);
+
 /**
  * Copies the value of a "tofu" structure to another.
  *
@@ -386,6 +479,10 @@ void fscl_tofu_value_setter(const ctofu* source, ctofu* dest);
 /**
  * Erases the value of a "tofu" structure, freeing any associated resources.
  *
+ * Nested arrays and maps are walked with an explicit stack rather than by
+ * recursion, arrays marked TOFU_FLAG_SCALARS are freed without visiting
+ * their elements, and the value is left zeroed so erasing it again is safe.
+ *
  * @param value The "tofu" structure to erase the value of.
  */
 void fscl_tofu_value_erase(ctofu* value);
@@ -422,6 +519,108 @@ bool fscl_tofu_not_cnullptr(const ctofu* value);
  */
 bool fscl_tofu_its_cnullptr(const ctofu* value);
 
+// =======================
+// MOVE FUNCTIONS
+// =======================
+
+/**
+ * Moves a value into dest, erasing what dest held before.
+ *
+ * The heap storage of source changes owner without being copied, and
+ * source is left zeroed (a valid, empty value).
+ *
+ * @param source The value to move from.
+ * @param dest The value to move into, which must hold a valid value.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_value_move(ctofu* source, ctofu* dest);
+
+/**
+ * Moves a value into a slot of an array, erasing the previous element.
+ *
+ * @param array The array.
+ * @param index The slot to replace.
+ * @param value The value to move, left zeroed on success.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_array_move_in(ctofu* array, size_t index, ctofu* value);
+
+/**
+ * Moves an element out of an array, leaving a zeroed value in its slot.
+ *
+ * @param array The array.
+ * @param index The slot to take from.
+ * @param value Receives the element; its previous contents are not erased.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_array_take(ctofu* array, size_t index, ctofu* value);
+
+/**
+ * Moves a key and value into a map. When the key is already present only
+ * its value is replaced and the moved key is erased.
+ *
+ * @param map The map.
+ * @param key The key to move, left zeroed on success.
+ * @param value The value to move, left zeroed on success.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_map_move_entry(ctofu* map, ctofu* key, ctofu* value);
+
+// =======================
+// STRING FUNCTIONS
+// =======================
+
+/**
+ * Stores a copy of text in a "tofu" structure.
+ *
+ * Text of at most FSCL_TOFU_SMALL_STRING bytes is kept inline without any
+ * allocation; longer text goes to the heap (or the intern pool when it is
+ * enabled) together with its length. Read the result with
+ * fscl_tofu_string_data rather than string_type, which is not valid for
+ * inline strings.
+ *
+ * @param value Receives a TOFU_STRING_TYPE value, released with fscl_tofu_value_erase.
+ * @param text The text, which need not be NUL terminated.
+ * @param length The number of bytes of text.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_string_set(ctofu* value, const char* text, size_t length);
+
+/**
+ * Retrieves the NUL terminated text of a string value, wherever it is stored.
+ *
+ * @param value The "tofu" structure.
+ * @return The text, or NULL if the value is not a string.
+ */
+const char* fscl_tofu_string_data(const ctofu* value);
+
+/**
+ * Retrieves the length of a string value without scanning it where the
+ * length is already known.
+ *
+ * @param value The "tofu" structure.
+ * @return The length in bytes, or 0 if the value is not a string.
+ */
+size_t fscl_tofu_string_length(const ctofu* value);
+
+/**
+ * Turns inline storage of short strings on or off for every string the
+ * library creates (fscl_tofu_create, fscl_tofu_value_copy and the loaders).
+ *
+ * Off by default, because inline strings must be read through
+ * fscl_tofu_string_data instead of string_type.
+ *
+ * @param enabled Whether short strings are stored inline.
+ */
+void fscl_tofu_inline_strings_enable(bool enabled);
+
+/**
+ * Checks whether short strings are stored inline.
+ *
+ * @return true if inline storage is on, false otherwise.
+ */
+bool fscl_tofu_inline_strings_enabled(void);
+
 // =======================
 // ITERATOR FUNCTIONS
 // =======================
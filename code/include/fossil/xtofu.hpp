@@ -0,0 +1,463 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_HPP
+#define FSCL_XTOFU_HPP
+
+/**
+ * @file xtofu.hpp
+ *
+ * @brief C++17 interface over the "tofu" structure, header only.
+ *
+ * fossil::tofu::value owns one "tofu" structure: copying it goes through
+ * fscl_tofu_value_copy, moving it hands the storage over without touching
+ * the heap, and the destructor releases it with fscl_tofu_value_erase, so
+ * no explicit erase call is needed.
+ *
+ * fossil::tofu::array_view and fossil::tofu::span<T> look into an array
+ * without owning it. A span checks once that every element has the type
+ * matching T; after that its random access iterators hand out T& straight
+ * into the union of each element, so the standard algorithms, including the
+ * parallel overloads of <execution>, work on the array in place:
+ *
+ *     auto numbers = fossil::tofu::value::array({3, 1, 2});
+ *     auto items = numbers.span_of<int64_t>();
+ *     std::sort(items.begin(), items.end());
+ *
+ * A span over T (rather than const T) makes shared storage unique first
+ * (see shared.h). The views are invalidated by anything that reallocates or
+ * erases the array. Failures are reported by throwing fossil::tofu::error.
+ */
+
+#include "xtofu.h"
+#include "shared.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace fossil::tofu {
+
+// =======================
+// ERRORS
+// =======================
+
+/**
+ * Exception thrown when an operation of the library fails.
+ */
+class error : public std::runtime_error {
+public:
+    explicit error(ctofu_error code) : std::runtime_error(fscl_tofu_error_message(code)), code_(code) {}
+
+    /**
+     * @return The error code the library returned.
+     */
+    ctofu_error code() const noexcept { return code_; }
+
+private:
+    ctofu_error code_;
+};
+
+/**
+ * Throws when a library call did not succeed.
+ *
+ * @param code The error code returned by the library.
+ */
+inline void check(ctofu_error code) {
+    if (code != FSCL_TOFU_ERROR_OK) {
+        throw error(code);
+    }
+}
+
+// =======================
+// TYPE TRAITS
+// =======================
+
+/**
+ * Maps a C++ type to the "tofu" type and the union member holding it.
+ * Only the types below have a member of their own.
+ */
+template <typename T>
+struct traits;
+
+#define FSCL_TOFU_TRAITS(T, tofu_type, field)                  \
+    template <>                                                \
+    struct traits<T> {                                         \
+        static constexpr ctofu_type type = tofu_type;          \
+        static constexpr T ctofu_data::*member = &ctofu_data::field; \
+    };
+
+FSCL_TOFU_TRAITS(int64_t, TOFU_INT_TYPE, int_type)
+FSCL_TOFU_TRAITS(uint64_t, TOFU_UINT_TYPE, uint_type)
+FSCL_TOFU_TRAITS(double, TOFU_DOUBLE_TYPE, double_type)
+FSCL_TOFU_TRAITS(float, TOFU_FLOAT_TYPE, float_type)
+FSCL_TOFU_TRAITS(bool, TOFU_BOOLEAN_TYPE, boolean_type)
+FSCL_TOFU_TRAITS(char, TOFU_CHAR_TYPE, char_type)
+
+#undef FSCL_TOFU_TRAITS
+
+/**
+ * The type a C++ arithmetic value is stored as: the exact type when it has
+ * a member of its own, otherwise int64_t or uint64_t by signedness.
+ */
+template <typename T>
+using stored_t = std::conditional_t<
+    std::is_same_v<T, bool> || std::is_same_v<T, char> || std::is_floating_point_v<T>, T,
+    std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+template <typename T>
+inline constexpr bool is_stored_v = std::is_arithmetic_v<T> && !std::is_same_v<T, long double>;
+
+/**
+ * Accesses the data of a "tofu" structure as T without looking at its type.
+ *
+ * @param value A "tofu" structure whose type is traits<T>::type.
+ * @return The union member holding the data.
+ */
+template <typename T>
+inline T& as(ctofu& value) noexcept {
+    return value.data.*traits<T>::member;
+}
+
+template <typename T>
+inline const T& as(const ctofu& value) noexcept {
+    return value.data.*traits<T>::member;
+}
+
+// =======================
+// ITERATORS AND VIEWS
+// =======================
+
+/**
+ * Random access iterator yielding the T of consecutive "tofu" elements.
+ */
+template <typename T>
+class element_iterator {
+    using slot_type = std::conditional_t<std::is_const_v<T>, const ctofu, ctofu>;
+    using member_type = std::remove_const_t<T>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = member_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    element_iterator() noexcept = default;
+    explicit element_iterator(slot_type* slot) noexcept : slot_(slot) {}
+
+    // A mutable iterator converts to a const one
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    element_iterator(const element_iterator<U>& other) noexcept : slot_(other.slot()) {}
+
+    slot_type* slot() const noexcept { return slot_; }
+
+    reference operator*() const noexcept { return slot_->data.*traits<member_type>::member; }
+    pointer operator->() const noexcept { return &**this; }
+    reference operator[](difference_type offset) const noexcept { return *(*this + offset); }
+
+    element_iterator& operator++() noexcept { ++slot_; return *this; }
+    element_iterator& operator--() noexcept { --slot_; return *this; }
+    element_iterator operator++(int) noexcept { element_iterator old = *this; ++slot_; return old; }
+    element_iterator operator--(int) noexcept { element_iterator old = *this; --slot_; return old; }
+    element_iterator& operator+=(difference_type offset) noexcept { slot_ += offset; return *this; }
+    element_iterator& operator-=(difference_type offset) noexcept { slot_ -= offset; return *this; }
+
+    friend element_iterator operator+(element_iterator it, difference_type offset) noexcept { return it += offset; }
+    friend element_iterator operator+(difference_type offset, element_iterator it) noexcept { return it += offset; }
+    friend element_iterator operator-(element_iterator it, difference_type offset) noexcept { return it -= offset; }
+    friend difference_type operator-(element_iterator a, element_iterator b) noexcept { return a.slot_ - b.slot_; }
+
+    friend bool operator==(element_iterator a, element_iterator b) noexcept { return a.slot_ == b.slot_; }
+    friend bool operator!=(element_iterator a, element_iterator b) noexcept { return a.slot_ != b.slot_; }
+    friend bool operator<(element_iterator a, element_iterator b) noexcept { return a.slot_ < b.slot_; }
+    friend bool operator>(element_iterator a, element_iterator b) noexcept { return a.slot_ > b.slot_; }
+    friend bool operator<=(element_iterator a, element_iterator b) noexcept { return a.slot_ <= b.slot_; }
+    friend bool operator>=(element_iterator a, element_iterator b) noexcept { return a.slot_ >= b.slot_; }
+
+private:
+    slot_type* slot_ = nullptr;
+};
+
+/**
+ * Non-owning typed view of an array whose elements all hold T. Use
+ * span<const T> for read-only access.
+ */
+template <typename T>
+class span {
+    using slot_type = std::conditional_t<std::is_const_v<T>, const ctofu, ctofu>;
+
+public:
+    using element_type = T;
+    using value_type = std::remove_const_t<T>;
+    using size_type = std::size_t;
+    using iterator = element_iterator<T>;
+
+    span() noexcept = default;
+
+    /**
+     * Views the elements of an array.
+     *
+     * @param array A TOFU_ARRAY_TYPE value whose elements all have type traits<T>::type.
+     * @throws error TYPE_MISMATCH when array is not such an array, or the
+     *         error of fscl_tofu_unique for a mutable span over shared storage.
+     */
+    explicit span(slot_type& array) {
+        if (array.type != TOFU_ARRAY_TYPE) {
+            throw error(FSCL_TOFU_ERROR_TYPE_MISMATCH);
+        }
+        if constexpr (!std::is_const_v<T>) {
+            check(fscl_tofu_unique(&array));
+        }
+        slots_ = array.data.array_type.elements;
+        size_ = array.data.array_type.size;
+        for (size_type i = 0; i < size_; ++i) {
+            if (slots_[i].type != traits<value_type>::type) {
+                throw error(FSCL_TOFU_ERROR_TYPE_MISMATCH);
+            }
+        }
+    }
+
+    // A mutable span converts to a const one
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    span(const span<U>& other) noexcept : slots_(other.begin().slot()), size_(other.size()) {}
+
+    iterator begin() const noexcept { return iterator(slots_); }
+    iterator end() const noexcept { return iterator(slots_ + size_); }
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    T& operator[](size_type index) const noexcept { return slots_[index].data.*traits<value_type>::member; }
+
+private:
+    slot_type* slots_ = nullptr;
+    size_type size_ = 0;
+};
+
+/**
+ * Non-owning view of the elements of an array, whatever their types.
+ */
+class array_view {
+public:
+    using value_type = ctofu;
+    using size_type = std::size_t;
+    using iterator = const ctofu*;
+
+    array_view() noexcept = default;
+
+    /**
+     * @param array A TOFU_ARRAY_TYPE value.
+     * @throws error TYPE_MISMATCH when array is not an array.
+     */
+    explicit array_view(const ctofu& array) {
+        if (array.type != TOFU_ARRAY_TYPE) {
+            throw error(FSCL_TOFU_ERROR_TYPE_MISMATCH);
+        }
+        slots_ = array.data.array_type.elements;
+        size_ = array.data.array_type.size;
+    }
+
+    iterator begin() const noexcept { return slots_; }
+    iterator end() const noexcept { return slots_ + size_; }
+    size_type size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    const ctofu& operator[](size_type index) const noexcept { return slots_[index]; }
+
+private:
+    const ctofu* slots_ = nullptr;
+    size_type size_ = 0;
+};
+
+// =======================
+// OWNING VALUE
+// =======================
+
+/**
+ * Owns one "tofu" structure and everything it points to.
+ */
+class value {
+public:
+    /**
+     * Creates a TOFU_NULLPTR_TYPE value.
+     */
+    value() noexcept { reset(); }
+
+    value(std::nullptr_t) noexcept { reset(); }
+
+    /**
+     * Stores an arithmetic value, integers widened to int64_t or uint64_t.
+     */
+    template <typename T, typename = std::enable_if_t<is_stored_v<T>>>
+    value(T data) noexcept {
+        using S = stored_t<T>;
+        reset();
+        raw_.type = traits<S>::type;
+        raw_.data.*traits<S>::member = static_cast<S>(data);
+    }
+
+    /**
+     * Stores a copy of text (see fscl_tofu_string_set).
+     */
+    value(std::string_view text) {
+        reset();
+        check(fscl_tofu_string_set(&raw_, text.data(), text.size()));
+    }
+
+    value(const char* text) : value(std::string_view(text)) {}
+
+    value(const value& other) {
+        reset();
+        if (other.empty_container()) {
+            raw_.type = other.raw_.type;
+            return;
+        }
+        check(fscl_tofu_value_copy(&other.raw_, &raw_));
+    }
+
+    value(value&& other) noexcept : raw_(other.raw_) { other.reset(); }
+
+    value& operator=(value other) noexcept {
+        std::swap(raw_, other.raw_);
+        return *this;
+    }
+
+    ~value() { fscl_tofu_value_erase(&raw_); }
+
+    /**
+     * Takes over a structure returned by fscl_tofu_create, fscl_tofu_create_array
+     * or a loader; the structure itself is freed, its storage is kept.
+     *
+     * @param created The structure to adopt, which must not be used afterwards.
+     * @return The owning value.
+     */
+    static value adopt(ctofu* created) {
+        if (created == nullptr) {
+            throw error(FSCL_TOFU_ERROR_NULL_POINTER);
+        }
+        value result;
+        result.raw_ = *created;
+        created->type = TOFU_NULLPTR_TYPE;
+        created->flags = 0;
+        fscl_tofu_erase(created);
+        return result;
+    }
+
+    /**
+     * Builds an array of scalars from a range.
+     *
+     * @param first Start of the range.
+     * @param last End of the range.
+     * @return A TOFU_ARRAY_TYPE value marked TOFU_FLAG_SCALARS.
+     */
+    template <typename It>
+    static value array(It first, It last) {
+        using S = stored_t<typename std::iterator_traits<It>::value_type>;
+        const std::size_t size = static_cast<std::size_t>(std::distance(first, last));
+        value result;
+        result.raw_.type = TOFU_ARRAY_TYPE;
+        result.raw_.flags = TOFU_FLAG_SCALARS;
+        result.raw_.data.array_type.elements = nullptr;
+        result.raw_.data.array_type.size = 0;
+        if (size == 0) {
+            return result;
+        }
+        ctofu* elements = static_cast<ctofu*>(std::malloc(size * sizeof(ctofu)));
+        if (elements == nullptr) {
+            throw error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        for (std::size_t i = 0; i < size; ++i, ++first) {
+            elements[i].type = traits<S>::type;
+            elements[i].flags = 0;
+            elements[i].data.*traits<S>::member = static_cast<S>(*first);
+        }
+        result.raw_.data.array_type.elements = elements;
+        result.raw_.data.array_type.size = size;
+        return result;
+    }
+
+    template <typename T>
+    static value array(std::initializer_list<T> items) {
+        return array(items.begin(), items.end());
+    }
+
+    /**
+     * Gives up ownership of the structure.
+     *
+     * @return The structure, to be released with fscl_tofu_value_erase.
+     */
+    ctofu release() noexcept {
+        ctofu result = raw_;
+        reset();
+        return result;
+    }
+
+    ctofu* get() noexcept { return &raw_; }
+    const ctofu* get() const noexcept { return &raw_; }
+    ctofu_type type() const noexcept { return raw_.type; }
+
+    /**
+     * Accesses the data as T without checking the type.
+     */
+    template <typename T>
+    T& as() noexcept { return tofu::as<T>(raw_); }
+
+    template <typename T>
+    const T& as() const noexcept { return tofu::as<T>(raw_); }
+
+    /**
+     * @return A pointer to the data as T, or nullptr when the type differs.
+     */
+    template <typename T>
+    T* get_if() noexcept { return raw_.type == traits<T>::type ? &as<T>() : nullptr; }
+
+    template <typename T>
+    const T* get_if() const noexcept { return raw_.type == traits<T>::type ? &as<T>() : nullptr; }
+
+    /**
+     * @return The text of a string value, empty for other types.
+     */
+    std::string_view str() const noexcept {
+        const char* text = fscl_tofu_string_data(&raw_);
+        return text == nullptr ? std::string_view() : std::string_view(text, fscl_tofu_string_length(&raw_));
+    }
+
+    array_view elements() const { return array_view(raw_); }
+
+    template <typename T>
+    span<T> span_of() { return span<T>(raw_); }
+
+    template <typename T>
+    span<const T> span_of() const { return span<const T>(raw_); }
+
+private:
+    void reset() noexcept {
+        raw_ = ctofu{};
+        raw_.type = TOFU_NULLPTR_TYPE;
+    }
+
+    // fscl_tofu_value_copy refuses empty arrays and maps, which own nothing
+    bool empty_container() const noexcept {
+        return (raw_.type == TOFU_ARRAY_TYPE && raw_.data.array_type.size == 0) ||
+               (raw_.type == TOFU_MAP_TYPE && raw_.data.map_type.size == 0);
+    }
+
+    ctofu raw_;
+};
+
+} // namespace fossil::tofu
+
+#endif
@@ -0,0 +1,338 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/account.h"
+#include "xtofu_internal.h"
+#include "xtofu_sync.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FSCL_TOFU_ACCOUNT_TYPES (TOFU_UNKNOWN_TYPE + 1)
+#define FSCL_TOFU_ACCOUNT_MIN_CAPACITY 1024
+
+static const char* const fscl_tofu_account_api_names[FSCL_TOFU_ALLOC_APIS] = {
+    "create", "create_array", "strdup", "value_copy", "other",
+};
+
+static const char* const fscl_tofu_account_type_names[FSCL_TOFU_ACCOUNT_TYPES] = {
+    "int", "uint", "octal", "bitwise", "hex", "fixed", "float", "double", "string",
+    "char", "boolean", "array", "map", "qbit", "nullptr", "invalid", "unknown",
+};
+
+/**
+ * One live block.
+ */
+typedef struct {
+    const void* memory;  ///< The block, NULL for a free slot.
+    size_t bytes;        ///< Size of the block.
+    uint8_t type;        ///< ctofu_type the block belongs to.
+    uint8_t api;         ///< ctofu_alloc_api it is charged to.
+} ctofu_account_entry;
+
+/**
+ * Live blocks by address (open addressing, linear probing) and the counts
+ * they add up to.
+ */
+typedef struct {
+    ctofu_mutex lock;
+    ctofu_account_entry* entries;
+    size_t capacity;
+    size_t count;
+    ctofu_alloc_stats totals;
+    ctofu_alloc_stats types[FSCL_TOFU_ACCOUNT_TYPES];
+    ctofu_alloc_stats apis[FSCL_TOFU_ALLOC_APIS];
+} ctofu_account_table;
+
+atomic_bool fscl_tofu_account_recording = false;
+atomic_bool fscl_tofu_account_watching = false;
+
+static ctofu_account_table fscl_tofu_account_table;
+static ctofu_once fscl_tofu_account_once = FSCL_TOFU_ONCE_INIT;
+static FSCL_TOFU_THREAD_LOCAL unsigned fscl_tofu_account_scope = FSCL_TOFU_ALLOC_APIS;
+
+// =======================
+// LIVE BLOCK TABLE
+// =======================
+
+static size_t fscl_tofu_account_home(const void* memory, size_t capacity) {
+    return (size_t)fscl_tofu_mix64((uint64_t)(uintptr_t)memory) & (capacity - 1);
+}
+
+static size_t fscl_tofu_account_find(const ctofu_account_table* table, const void* memory) {
+    size_t slot = fscl_tofu_account_home(memory, table->capacity);
+    while (table->entries[slot].memory != NULL && table->entries[slot].memory != memory) {
+        slot = (slot + 1) & (table->capacity - 1);
+    }
+    return slot;
+}
+
+static bool fscl_tofu_account_grow(ctofu_account_table* table) {
+    size_t capacity = table->capacity ? table->capacity * 2 : FSCL_TOFU_ACCOUNT_MIN_CAPACITY;
+    ctofu_account_entry* entries = (ctofu_account_entry*)calloc(capacity, sizeof(ctofu_account_entry));
+    if (entries == NULL) {
+        return false;
+    }
+
+    ctofu_account_entry* old = table->entries;
+    size_t old_capacity = table->capacity;
+    table->entries = entries;
+    table->capacity = capacity;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old[i].memory != NULL) {
+            table->entries[fscl_tofu_account_find(table, old[i].memory)] = old[i];
+        }
+    }
+    free(old);
+    return true;
+}
+
+// Removing shifts later entries of the probe run back, so no tombstones are needed
+static void fscl_tofu_account_remove(ctofu_account_table* table, size_t slot) {
+    size_t mask = table->capacity - 1;
+    size_t next = (slot + 1) & mask;
+    while (table->entries[next].memory != NULL) {
+        size_t home = fscl_tofu_account_home(table->entries[next].memory, table->capacity);
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            table->entries[slot] = table->entries[next];
+            slot = next;
+        }
+        next = (next + 1) & mask;
+    }
+    table->entries[slot].memory = NULL;
+    --table->count;
+}
+
+static void fscl_tofu_account_add(ctofu_alloc_stats* stats, size_t bytes) {
+    stats->live_bytes += bytes;
+    ++stats->live_objects;
+    stats->total_bytes += bytes;
+    ++stats->total_objects;
+    if (stats->live_bytes > stats->peak_bytes) {
+        stats->peak_bytes = stats->live_bytes;
+    }
+}
+
+static void fscl_tofu_account_sub(ctofu_alloc_stats* stats, size_t bytes) {
+    stats->live_bytes -= bytes;
+    --stats->live_objects;
+}
+
+static void fscl_tofu_account_release(ctofu_account_table* table, const ctofu_account_entry* entry) {
+    fscl_tofu_account_sub(&table->totals, entry->bytes);
+    fscl_tofu_account_sub(&table->types[entry->type], entry->bytes);
+    fscl_tofu_account_sub(&table->apis[entry->api], entry->bytes);
+}
+
+static void fscl_tofu_account_exit(void) {
+    ctofu_alloc_stats totals;
+    fscl_tofu_account_totals(&totals);
+    if (totals.live_objects > 0) {
+        fprintf(stderr, "tofu: %zu blocks (%zu bytes) still allocated at exit\n", totals.live_objects, totals.live_bytes);
+        fscl_tofu_account_report(stderr);
+    }
+}
+
+static void fscl_tofu_account_start(void) {
+    fscl_tofu_mutex_init(&fscl_tofu_account_table.lock);
+    atexit(fscl_tofu_account_exit);
+}
+
+void fscl_tofu_account_record(void* memory, size_t bytes, ctofu_type type, ctofu_alloc_api api) {
+    ctofu_account_table* table = &fscl_tofu_account_table;
+    unsigned scope = fscl_tofu_account_scope;
+    ctofu_account_entry entry = {
+        .memory = memory,
+        .bytes = bytes,
+        .type = (uint8_t)((unsigned)type < FSCL_TOFU_ACCOUNT_TYPES ? type : TOFU_UNKNOWN_TYPE),
+        .api = (uint8_t)(scope < FSCL_TOFU_ALLOC_APIS ? scope : (unsigned)api),
+    };
+
+    fscl_tofu_mutex_lock(&table->lock);
+    if ((table->count + 1) * 4 > table->capacity * 3 && !fscl_tofu_account_grow(table)) {
+        // No room to track the block, it stays uncounted
+        fscl_tofu_mutex_unlock(&table->lock);
+        return;
+    }
+
+    size_t slot = fscl_tofu_account_find(table, memory);
+    if (table->entries[slot].memory != NULL) {
+        // Freed behind the table's back and handed out again
+        fscl_tofu_account_release(table, &table->entries[slot]);
+    } else {
+        ++table->count;
+    }
+    table->entries[slot] = entry;
+    fscl_tofu_account_add(&table->totals, bytes);
+    fscl_tofu_account_add(&table->types[entry.type], bytes);
+    fscl_tofu_account_add(&table->apis[entry.api], bytes);
+    fscl_tofu_mutex_unlock(&table->lock);
+}
+
+void fscl_tofu_account_forget(const void* memory) {
+    ctofu_account_table* table = &fscl_tofu_account_table;
+    fscl_tofu_mutex_lock(&table->lock);
+    if (table->count > 0) {
+        size_t slot = fscl_tofu_account_find(table, memory);
+        if (table->entries[slot].memory != NULL) {
+            fscl_tofu_account_release(table, &table->entries[slot]);
+            fscl_tofu_account_remove(table, slot);
+        }
+    }
+    fscl_tofu_mutex_unlock(&table->lock);
+}
+
+bool fscl_tofu_account_enter(ctofu_alloc_api api) {
+    if (fscl_tofu_account_scope != FSCL_TOFU_ALLOC_APIS ||
+        !atomic_load_explicit(&fscl_tofu_account_recording, memory_order_relaxed)) {
+        return false;
+    }
+    fscl_tofu_account_scope = api;
+    return true;
+}
+
+void fscl_tofu_account_leave(bool entered) {
+    if (entered) {
+        fscl_tofu_account_scope = FSCL_TOFU_ALLOC_APIS;
+    }
+}
+
+// =======================
+// ACCOUNTING FUNCTIONS
+// =======================
+
+void fscl_tofu_account_enable(bool enabled) {
+    if (enabled) {
+        fscl_tofu_once(&fscl_tofu_account_once, fscl_tofu_account_start);
+        atomic_store_explicit(&fscl_tofu_account_watching, true, memory_order_release);
+    }
+    atomic_store_explicit(&fscl_tofu_account_recording, enabled, memory_order_release);
+}
+
+bool fscl_tofu_account_enabled(void) {
+    return atomic_load_explicit(&fscl_tofu_account_recording, memory_order_relaxed);
+}
+
+// Copies counts under the lock, zeroes when accounting was never on
+static void fscl_tofu_account_read(const ctofu_alloc_stats* source, ctofu_alloc_stats* stats) {
+    if (!atomic_load_explicit(&fscl_tofu_account_watching, memory_order_acquire)) {
+        memset(stats, 0, sizeof(ctofu_alloc_stats));
+        return;
+    }
+    fscl_tofu_mutex_lock(&fscl_tofu_account_table.lock);
+    *stats = *source;
+    fscl_tofu_mutex_unlock(&fscl_tofu_account_table.lock);
+}
+
+ctofu_error fscl_tofu_account_by_type(ctofu_type type, ctofu_alloc_stats* stats) {
+    if (stats == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if ((unsigned)type >= FSCL_TOFU_ACCOUNT_TYPES) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS);
+    }
+    fscl_tofu_account_read(&fscl_tofu_account_table.types[type], stats);
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_account_by_api(ctofu_alloc_api api, ctofu_alloc_stats* stats) {
+    if (stats == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if ((unsigned)api >= FSCL_TOFU_ALLOC_APIS) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS);
+    }
+    fscl_tofu_account_read(&fscl_tofu_account_table.apis[api], stats);
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_account_totals(ctofu_alloc_stats* stats) {
+    if (stats == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    fscl_tofu_account_read(&fscl_tofu_account_table.totals, stats);
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+size_t fscl_tofu_account_report(FILE* stream) {
+    if (!atomic_load_explicit(&fscl_tofu_account_watching, memory_order_acquire)) {
+        return 0;
+    }
+
+    ctofu_account_table* table = &fscl_tofu_account_table;
+    fscl_tofu_mutex_lock(&table->lock);
+    size_t live = table->totals.live_objects;
+    if (stream != NULL) {
+        fprintf(stream, "tofu allocations: %zu live blocks, %zu live bytes, %zu peak bytes, %zu blocks in total\n",
+                live, table->totals.live_bytes, table->totals.peak_bytes, table->totals.total_objects);
+        for (size_t i = 0; i < FSCL_TOFU_ALLOC_APIS; ++i) {
+            const ctofu_alloc_stats* stats = &table->apis[i];
+            if (stats->live_objects > 0) {
+                fprintf(stream, "  %-14s %10zu blocks %12zu bytes\n", fscl_tofu_account_api_names[i],
+                        stats->live_objects, stats->live_bytes);
+            }
+        }
+        for (size_t i = 0; i < FSCL_TOFU_ACCOUNT_TYPES; ++i) {
+            const ctofu_alloc_stats* stats = &table->types[i];
+            if (stats->live_objects > 0) {
+                fprintf(stream, "  %-14s %10zu blocks %12zu bytes\n", fscl_tofu_account_type_names[i],
+                        stats->live_objects, stats->live_bytes);
+            }
+        }
+    }
+    fscl_tofu_mutex_unlock(&table->lock);
+    return live;
+}
+
+// =======================
+// FOOTPRINT FUNCTIONS
+// =======================
+
+// Bytes a value owns beyond its own structure
+static size_t fscl_tofu_footprint_owned(const ctofu* value) {
+    size_t bytes = 0;
+    switch (value->type) {
+        case TOFU_STRING_TYPE:
+            if (value->flags & (TOFU_FLAG_INLINE | TOFU_FLAG_INTERNED) || value->data.string_type == NULL) {
+                return 0;
+            }
+            return fscl_tofu_string_length(value) + 1;
+
+        case TOFU_ARRAY_TYPE:
+            bytes = value->data.array_type.size * sizeof(ctofu);
+            if (!(value->flags & TOFU_FLAG_SCALARS)) {
+                for (size_t i = 0; i < value->data.array_type.size; ++i) {
+                    bytes += fscl_tofu_footprint_owned(&value->data.array_type.elements[i]);
+                }
+            }
+            return bytes;
+
+        case TOFU_MAP_TYPE:
+            bytes = 2 * value->data.map_type.size * sizeof(ctofu);
+            for (size_t i = 0; i < value->data.map_type.size; ++i) {
+                bytes += fscl_tofu_footprint_owned(&value->data.map_type.key[i]);
+                bytes += fscl_tofu_footprint_owned(&value->data.map_type.value[i]);
+            }
+            return bytes;
+
+        default:
+            return 0;
+    }
+}
+
+size_t fscl_tofu_footprint(const ctofu* value) {
+    if (value == NULL) {
+        return 0;
+    }
+    return sizeof(ctofu) + fscl_tofu_footprint_owned(value);
+}
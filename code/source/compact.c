@@ -0,0 +1,582 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/compact.h"
+#include "fossil/intern.h"
+#include "xtofu_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(sizeof(ctofu_compact) == 16, "compact values must stay 16 bytes");
+
+struct ctofu_compact_block {
+    size_t size;                 ///< Number of array elements or map entries.
+    ctofu_compact elements[];    ///< Elements, or keys followed by values for maps.
+};
+
+// Number of slots a block needs for a container of the given size
+static inline size_t fscl_tofu_compact_slots(uint8_t type, size_t size) {
+    return type == TOFU_MAP_TYPE ? size * 2 : size;
+}
+
+static ctofu_compact_block* fscl_tofu_compact_block(size_t slots) {
+    if (slots > (SIZE_MAX - sizeof(ctofu_compact_block)) / sizeof(ctofu_compact)) {
+        return NULL;
+    }
+    return (ctofu_compact_block*)calloc(1, sizeof(ctofu_compact_block) + slots * sizeof(ctofu_compact));
+}
+
+// =======================
+// STRING STORAGE
+// =======================
+
+static ctofu_error fscl_tofu_compact_store(ctofu_compact* value, const char* text, size_t length) {
+    value->type = TOFU_STRING_TYPE;
+    value->length = length > UINT32_MAX ? UINT32_MAX : (uint32_t)length;
+
+    if (length <= FSCL_TOFU_COMPACT_SMALL_STRING) {
+        memcpy(value->data.small_type, text, length);
+        value->flags = TOFU_FLAG_INLINE;
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    value->data.string_type = (char*)malloc(length + 1);
+    if (value->data.string_type == NULL) {
+        return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+    }
+    memcpy(value->data.string_type, text, length);
+    value->data.string_type[length] = '\0';
+    return FSCL_TOFU_ERROR_OK;
+}
+
+const char* fscl_tofu_compact_string(const ctofu_compact* value) {
+    if (value == NULL || value->type != TOFU_STRING_TYPE) {
+        return NULL;
+    }
+    return (value->flags & TOFU_FLAG_INLINE) ? value->data.small_type : value->data.string_type;
+}
+
+size_t fscl_tofu_compact_string_length(const ctofu_compact* value) {
+    if (value == NULL || value->type != TOFU_STRING_TYPE) {
+        return 0;
+    }
+    if (value->length == UINT32_MAX && value->data.string_type != NULL) {
+        return strlen(value->data.string_type);
+    }
+    return value->length;
+}
+
+// =======================
+// CREATE/ERASE FUNCTIONS
+// =======================
+
+ctofu_error fscl_tofu_compact_from(const ctofu* value, ctofu_compact* result) {
+    if (value == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->type = (uint8_t)value->type;
+
+    switch (value->type) {
+        case TOFU_STRING_TYPE: {
+            const char* text = fscl_tofu_string_data(value);
+            if (text == NULL) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+            }
+            size_t length = fscl_tofu_string_length(value);
+            if (value->flags & TOFU_FLAG_INTERNED) {
+                // Interned strings stay shared
+                fscl_tofu_intern_retain(text);
+                result->data.string_type = (char*)text;
+                result->length = length > UINT32_MAX ? UINT32_MAX : (uint32_t)length;
+                result->flags = TOFU_FLAG_INTERNED;
+                return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+            }
+            return fscl_tofu_error(fscl_tofu_compact_store(result, text, length));
+        }
+        case TOFU_ARRAY_TYPE:
+        case TOFU_MAP_TYPE: {
+            bool map = value->type == TOFU_MAP_TYPE;
+            size_t size = map ? value->data.map_type.size : value->data.array_type.size;
+            if (size == 0) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+            }
+
+            ctofu_compact_block* block = fscl_tofu_compact_block(fscl_tofu_compact_slots(result->type, size));
+            if (block == NULL) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+            }
+            // Untouched slots stay zeroed integers, so a partial block erases cleanly
+            block->size = size;
+            result->data.block = block;
+
+            for (size_t i = 0; i < size; ++i) {
+                ctofu_error error;
+                if (map) {
+                    error = fscl_tofu_compact_from(&value->data.map_type.key[i], &block->elements[i]);
+                    if (error == FSCL_TOFU_ERROR_OK) {
+                        error = fscl_tofu_compact_from(&value->data.map_type.value[i], &block->elements[size + i]);
+                    }
+                } else {
+                    error = fscl_tofu_compact_from(&value->data.array_type.elements[i], &block->elements[i]);
+                }
+                if (error != FSCL_TOFU_ERROR_OK) {
+                    fscl_tofu_compact_erase(result);
+                    return error;
+                }
+            }
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        }
+        case TOFU_FLOAT_TYPE:
+            result->data.float_type = value->data.float_type;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        case TOFU_CHAR_TYPE:
+            result->data.char_type = value->data.char_type;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        case TOFU_BOOLEAN_TYPE:
+            result->data.boolean_type = value->data.boolean_type;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        case TOFU_NULLPTR_TYPE:
+            result->data.nullptr_type = value->data.nullptr_type;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        case TOFU_INVALID_TYPE:
+        case TOFU_UNKNOWN_TYPE:
+            return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+        default:
+            // Every remaining type is a full 64-bit word
+            result->data.uint_type = value->data.uint_type;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+}
+
+ctofu_error fscl_tofu_compact_to(const ctofu_compact* value, ctofu* result) {
+    if (value == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->type = (ctofu_type)value->type;
+
+    switch (value->type) {
+        case TOFU_STRING_TYPE: {
+            const char* text = fscl_tofu_compact_string(value);
+            if (text == NULL) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+            }
+            if (value->flags & TOFU_FLAG_INTERNED) {
+                fscl_tofu_intern_retain(text);
+                result->data.string_type = (char*)text;
+                result->flags = TOFU_FLAG_INTERNED;
+                return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+            }
+            return fscl_tofu_string_store(result, text, fscl_tofu_compact_string_length(value));
+        }
+        case TOFU_ARRAY_TYPE:
+        case TOFU_MAP_TYPE: {
+            bool map = value->type == TOFU_MAP_TYPE;
+            size_t size = fscl_tofu_compact_size(value);
+            if (size == 0) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+            }
+
+            ctofu* keys = (ctofu*)calloc(size, sizeof(ctofu));
+            ctofu* values = map ? (ctofu*)calloc(size, sizeof(ctofu)) : NULL;
+            if (keys == NULL || (map && values == NULL)) {
+                free(keys);
+                free(values);
+                return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+            }
+
+            // Arrays only use keys, maps keep their values in the second half of the block
+            const ctofu_compact* source = value->data.block->elements;
+            for (size_t i = 0; i < size; ++i) {
+                ctofu_error error = fscl_tofu_compact_to(&source[i], &keys[i]);
+                if (map && error == FSCL_TOFU_ERROR_OK) {
+                    error = fscl_tofu_compact_to(&source[size + i], &values[i]);
+                    if (error != FSCL_TOFU_ERROR_OK) {
+                        fscl_tofu_value_erase(&keys[i]);
+                    }
+                }
+                if (error != FSCL_TOFU_ERROR_OK) {
+                    for (size_t j = 0; j < i; ++j) {
+                        fscl_tofu_value_erase(&keys[j]);
+                        if (map) {
+                            fscl_tofu_value_erase(&values[j]);
+                        }
+                    }
+                    free(keys);
+                    free(values);
+                    memset(result, 0, sizeof(*result));
+                    return error;
+                }
+            }
+
+            if (map) {
+                result->data.map_type.key = keys;
+                result->data.map_type.value = values;
+                result->data.map_type.size = size;
+            } else {
+                result->data.array_type.elements = keys;
+                result->data.array_type.size = size;
+            }
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        }
+        case TOFU_FLOAT_TYPE:
+            result->data.float_type = value->data.float_type;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        case TOFU_CHAR_TYPE:
+            result->data.char_type = value->data.char_type;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        case TOFU_BOOLEAN_TYPE:
+            result->data.boolean_type = value->data.boolean_type;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        case TOFU_NULLPTR_TYPE:
+            result->data.nullptr_type = value->data.nullptr_type;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        default:
+            result->data.uint_type = value->data.uint_type;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+}
+
+ctofu_error fscl_tofu_compact_array(ctofu_type type, size_t size, ctofu_compact* result) {
+    if (result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->type = TOFU_ARRAY_TYPE;
+    if (size == 0) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    ctofu_compact_block* block = fscl_tofu_compact_block(size);
+    if (block == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    block->size = size;
+    for (size_t i = 0; i < size; ++i) {
+        block->elements[i].type = (uint8_t)type;
+    }
+    result->data.block = block;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+void fscl_tofu_compact_erase(ctofu_compact* value) {
+    if (value == NULL) {
+        return;
+    }
+
+    switch (value->type) {
+        case TOFU_STRING_TYPE:
+            if (value->flags & TOFU_FLAG_INTERNED) {
+                fscl_tofu_intern_release(value->data.string_type);
+            } else if (!(value->flags & TOFU_FLAG_INLINE)) {
+                free(value->data.string_type);
+            }
+            break;
+        case TOFU_ARRAY_TYPE:
+        case TOFU_MAP_TYPE:
+            if (value->data.block != NULL) {
+                size_t slots = fscl_tofu_compact_slots(value->type, value->data.block->size);
+                for (size_t i = 0; i < slots; ++i) {
+                    fscl_tofu_compact_erase(&value->data.block->elements[i]);
+                }
+                free(value->data.block);
+            }
+            break;
+        default:
+            break;
+    }
+
+    memset(value, 0, sizeof(*value));
+    value->type = TOFU_INVALID_TYPE;
+}
+
+// =======================
+// ACCESS FUNCTIONS
+// =======================
+
+ctofu_type fscl_tofu_compact_type(const ctofu_compact* value) {
+    return value != NULL ? (ctofu_type)value->type : TOFU_UNKNOWN_TYPE;
+}
+
+size_t fscl_tofu_compact_size(const ctofu_compact* value) {
+    if (value == NULL || (value->type != TOFU_ARRAY_TYPE && value->type != TOFU_MAP_TYPE) || value->data.block == NULL) {
+        return 0;
+    }
+    return value->data.block->size;
+}
+
+ctofu_compact* fscl_tofu_compact_elements(const ctofu_compact* value) {
+    if (fscl_tofu_compact_size(value) == 0) {
+        return NULL;
+    }
+    return value->data.block->elements;
+}
+
+// =======================
+// ALGORITHM FUNCTIONS
+// =======================
+
+// Checks that value is an array whose elements all share one type, reported through type
+static ctofu_error fscl_tofu_compact_uniform(const ctofu_compact* value, ctofu_type* type) {
+    if (value == NULL) {
+        return FSCL_TOFU_ERROR_NULL_POINTER;
+    }
+    if (value->type != TOFU_ARRAY_TYPE) {
+        return FSCL_TOFU_ERROR_INVALID_OPERATION;
+    }
+
+    size_t size = fscl_tofu_compact_size(value);
+    const ctofu_compact* elements = fscl_tofu_compact_elements(value);
+    *type = size > 0 ? (ctofu_type)elements[0].type : TOFU_NULLPTR_TYPE;
+    for (size_t i = 1; i < size; ++i) {
+        if (elements[i].type != *type) {
+            return FSCL_TOFU_ERROR_INVALID_OPERATION;
+        }
+    }
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static bool fscl_tofu_compact_signed(ctofu_type type) {
+    return type == TOFU_INT_TYPE || type == TOFU_FIXED_TYPE;
+}
+
+static bool fscl_tofu_compact_unsigned(ctofu_type type) {
+    switch (type) {
+        case TOFU_UINT_TYPE:
+        case TOFU_OCTAL_TYPE:
+        case TOFU_BITWISE_TYPE:
+        case TOFU_HEX_TYPE:
+        case TOFU_QBIT_TYPE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static int fscl_tofu_compact_order(const void* left, const void* right) {
+    const ctofu_compact* a = (const ctofu_compact*)left;
+    const ctofu_compact* b = (const ctofu_compact*)right;
+
+    switch (a->type) {
+        case TOFU_INT_TYPE:
+        case TOFU_FIXED_TYPE:
+            return (a->data.int_type > b->data.int_type) - (a->data.int_type < b->data.int_type);
+        case TOFU_DOUBLE_TYPE:
+            return (a->data.double_type > b->data.double_type) - (a->data.double_type < b->data.double_type);
+        case TOFU_FLOAT_TYPE:
+            return (a->data.float_type > b->data.float_type) - (a->data.float_type < b->data.float_type);
+        case TOFU_CHAR_TYPE:
+            return (a->data.char_type > b->data.char_type) - (a->data.char_type < b->data.char_type);
+        case TOFU_BOOLEAN_TYPE:
+            return (int)a->data.boolean_type - (int)b->data.boolean_type;
+        case TOFU_STRING_TYPE: {
+            const char* x = fscl_tofu_compact_string(a);
+            const char* y = fscl_tofu_compact_string(b);
+            if (x == NULL || y == NULL) {
+                return (x != NULL) - (y != NULL);
+            }
+            size_t xl = fscl_tofu_compact_string_length(a);
+            size_t yl = fscl_tofu_compact_string_length(b);
+            int order = memcmp(x, y, xl < yl ? xl : yl);
+            return order != 0 ? order : (xl > yl) - (xl < yl);
+        }
+        default:
+            return (a->data.uint_type > b->data.uint_type) - (a->data.uint_type < b->data.uint_type);
+    }
+}
+
+static bool fscl_tofu_compact_equal(const ctofu_compact* a, const ctofu_compact* b) {
+    if (a->type != b->type) {
+        return false;
+    }
+
+    switch (a->type) {
+        case TOFU_STRING_TYPE:
+            if (a->flags & b->flags & TOFU_FLAG_INTERNED) {
+                return a->data.string_type == b->data.string_type;
+            }
+            return fscl_tofu_compact_order(a, b) == 0;
+        case TOFU_DOUBLE_TYPE:
+            return a->data.double_type == b->data.double_type;
+        case TOFU_FLOAT_TYPE:
+            return a->data.float_type == b->data.float_type;
+        case TOFU_CHAR_TYPE:
+            return a->data.char_type == b->data.char_type;
+        case TOFU_BOOLEAN_TYPE:
+            return a->data.boolean_type == b->data.boolean_type;
+        case TOFU_ARRAY_TYPE:
+        case TOFU_MAP_TYPE:
+            return false;
+        default:
+            return a->data.uint_type == b->data.uint_type;
+    }
+}
+
+ctofu_error fscl_tofu_compact_accumulate(const ctofu_compact* array, ctofu_compact* result) {
+    ctofu_type type;
+    ctofu_error error = fscl_tofu_compact_uniform(array, &type);
+    if (error != FSCL_TOFU_ERROR_OK || result == NULL) {
+        return fscl_tofu_error(result == NULL ? FSCL_TOFU_ERROR_NULL_POINTER : error);
+    }
+
+    size_t size = fscl_tofu_compact_size(array);
+    const ctofu_compact* elements = fscl_tofu_compact_elements(array);
+    if (size == 0) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    memset(result, 0, sizeof(*result));
+
+    if (fscl_tofu_compact_signed(type) || fscl_tofu_compact_unsigned(type)) {
+        // Two's complement makes one wrapping loop serve both signednesses
+        uint64_t sum = 0;
+        for (size_t i = 0; i < size; ++i) {
+            sum += elements[i].data.uint_type;
+        }
+        result->type = fscl_tofu_compact_signed(type) ? TOFU_INT_TYPE : TOFU_UINT_TYPE;
+        result->data.uint_type = sum;
+    } else if (type == TOFU_CHAR_TYPE || type == TOFU_BOOLEAN_TYPE) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < size; ++i) {
+            sum += type == TOFU_CHAR_TYPE ? (unsigned char)elements[i].data.char_type : (uint64_t)elements[i].data.boolean_type;
+        }
+        result->type = TOFU_UINT_TYPE;
+        result->data.uint_type = sum;
+    } else if (type == TOFU_DOUBLE_TYPE || type == TOFU_FLOAT_TYPE) {
+        double sum = 0.0;
+        for (size_t i = 0; i < size; ++i) {
+            sum += type == TOFU_DOUBLE_TYPE ? elements[i].data.double_type : (double)elements[i].data.float_type;
+        }
+        result->type = TOFU_DOUBLE_TYPE;
+        result->data.double_type = sum;
+    } else {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_compact_transform(ctofu_compact* array, int (*transformFunc)(int)) {
+    ctofu_type type;
+    ctofu_error error = fscl_tofu_compact_uniform(array, &type);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return fscl_tofu_error(error);
+    }
+    if (transformFunc == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (fscl_tofu_compact_size(array) > 0 && type != TOFU_INT_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    ctofu_compact* elements = fscl_tofu_compact_elements(array);
+    for (size_t i = 0; i < fscl_tofu_compact_size(array); ++i) {
+        elements[i].data.int_type = transformFunc((int)elements[i].data.int_type);
+    }
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_compact_sort(ctofu_compact* array) {
+    ctofu_type type;
+    ctofu_error error = fscl_tofu_compact_uniform(array, &type);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return fscl_tofu_error(error);
+    }
+
+    size_t size = fscl_tofu_compact_size(array);
+    if (size < 2) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+    if (type == TOFU_ARRAY_TYPE || type == TOFU_MAP_TYPE || type == TOFU_NULLPTR_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    qsort(fscl_tofu_compact_elements(array), size, sizeof(ctofu_compact), fscl_tofu_compact_order);
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_compact_search(const ctofu_compact* array, const ctofu_compact* key, size_t* index) {
+    if (array == NULL || key == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (array->type != TOFU_ARRAY_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    const ctofu_compact* elements = fscl_tofu_compact_elements(array);
+    for (size_t i = 0; i < fscl_tofu_compact_size(array); ++i) {
+        if (fscl_tofu_compact_equal(&elements[i], key)) {
+            if (index != NULL) {
+                *index = i;
+            }
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        }
+    }
+
+    return fscl_tofu_error(FSCL_TOFU_ERROR_TYPE_MISMATCH);  // Key not found
+}
+
+ctofu_error fscl_tofu_compact_filter(ctofu_compact* array, bool (*filterFunc)(const ctofu_data*)) {
+    if (array == NULL || filterFunc == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (array->type != TOFU_ARRAY_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    size_t size = fscl_tofu_compact_size(array);
+    ctofu_compact* elements = fscl_tofu_compact_elements(array);
+    size_t kept = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+        // Present the element the way a ctofu would hold it
+        ctofu_data view;
+        memset(&view, 0, sizeof(view));
+        if (elements[i].type == TOFU_STRING_TYPE) {
+            view.string_type = (char*)fscl_tofu_compact_string(&elements[i]);
+        } else if (elements[i].type != TOFU_ARRAY_TYPE && elements[i].type != TOFU_MAP_TYPE) {
+            memcpy(&view, &elements[i].data, sizeof(elements[i].data));
+        }
+
+        if (filterFunc(&view)) {
+            elements[kept++] = elements[i];
+        } else {
+            fscl_tofu_compact_erase(&elements[i]);
+        }
+    }
+
+    if (size > 0) {
+        array->data.block->size = kept;
+    }
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_compact_reverse(ctofu_compact* array) {
+    if (array == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (array->type != TOFU_ARRAY_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    size_t size = fscl_tofu_compact_size(array);
+    ctofu_compact* elements = fscl_tofu_compact_elements(array);
+    for (size_t i = 0, j = size; i + 1 < j; ++i, --j) {
+        ctofu_compact temp = elements[i];
+        elements[i] = elements[j - 1];
+        elements[j - 1] = temp;
+    }
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
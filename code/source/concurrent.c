@@ -0,0 +1,287 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/concurrent.h"
+#include "xtofu_internal.h"
+#include "xtofu_sync.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FSCL_TOFU_CMAP_SHARD_BITS 6
+#define FSCL_TOFU_CMAP_SHARDS (1u << FSCL_TOFU_CMAP_SHARD_BITS)
+#define FSCL_TOFU_CMAP_BUCKETS 16  // Initial buckets per shard
+
+typedef struct ctofu_cmap_node ctofu_cmap_node;
+
+// Immutable once published, except for next
+struct ctofu_cmap_node {
+    ctofu_retired retired;
+    _Atomic(ctofu_cmap_node*) next;
+    uint64_t hash;
+    ctofu key;
+    ctofu value;
+};
+
+typedef struct {
+    ctofu_retired retired;
+    size_t mask;
+    _Atomic(ctofu_cmap_node*) buckets[];
+} ctofu_cmap_table;
+
+typedef struct {
+    ctofu_mutex lock;                  ///< Serializes the writers of the shard.
+    _Atomic(ctofu_cmap_table*) table;
+    size_t count;                      ///< Entries of the shard, under lock.
+    ctofu_epoch_bin garbage;           ///< Retired nodes and tables, under lock.
+} ctofu_cmap_shard;
+
+struct ctofu_cmap {
+    atomic_size_t size;
+    ctofu_cmap_shard shards[FSCL_TOFU_CMAP_SHARDS];
+};
+
+// =======================
+// NODES AND TABLES
+// =======================
+
+static void fscl_tofu_cmap_node_free(ctofu_cmap_node* node) {
+    fscl_tofu_value_erase(&node->key);
+    fscl_tofu_value_erase(&node->value);
+    free(node);
+}
+
+static void fscl_tofu_cmap_node_reclaim(ctofu_retired* item) {
+    fscl_tofu_cmap_node_free((ctofu_cmap_node*)((char*)item - offsetof(ctofu_cmap_node, retired)));
+}
+
+// A replaced table takes its nodes with it, the new table holds copies
+static void fscl_tofu_cmap_table_free(ctofu_cmap_table* table) {
+    for (size_t i = 0; i <= table->mask; ++i) {
+        ctofu_cmap_node* node = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+        while (node != NULL) {
+            ctofu_cmap_node* next = atomic_load_explicit(&node->next, memory_order_relaxed);
+            fscl_tofu_cmap_node_free(node);
+            node = next;
+        }
+    }
+    free(table);
+}
+
+static void fscl_tofu_cmap_table_reclaim(ctofu_retired* item) {
+    fscl_tofu_cmap_table_free((ctofu_cmap_table*)((char*)item - offsetof(ctofu_cmap_table, retired)));
+}
+
+static ctofu_cmap_table* fscl_tofu_cmap_table_alloc(size_t buckets) {
+    ctofu_cmap_table* table = (ctofu_cmap_table*)calloc(1, sizeof(ctofu_cmap_table) + buckets * sizeof(ctofu_cmap_node*));
+    if (table != NULL) {
+        table->mask = buckets - 1;
+        for (size_t i = 0; i < buckets; ++i) {
+            atomic_init(&table->buckets[i], NULL);
+        }
+    }
+    return table;
+}
+
+static ctofu_cmap_node* fscl_tofu_cmap_node_alloc(uint64_t hash, const ctofu* key, const ctofu* value, bool store) {
+    ctofu_cmap_node* node = (ctofu_cmap_node*)calloc(1, sizeof(ctofu_cmap_node));
+    if (node == NULL) {
+        return NULL;
+    }
+    node->hash = hash;
+    atomic_init(&node->next, NULL);
+
+    ctofu_error error = store ? fscl_tofu_shared_store(key, &node->key) : fscl_tofu_shared_copy(key, &node->key);
+    if (error == FSCL_TOFU_ERROR_OK) {
+        error = store ? fscl_tofu_shared_store(value, &node->value) : fscl_tofu_shared_copy(value, &node->value);
+    }
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_cmap_node_free(node);
+        return NULL;
+    }
+    return node;
+}
+
+static inline ctofu_cmap_shard* fscl_tofu_cmap_shard(ctofu_cmap* map, uint64_t hash) {
+    return &map->shards[hash >> (64 - FSCL_TOFU_CMAP_SHARD_BITS)];
+}
+
+// Doubles the buckets of a shard; readers keep using the old table until it is published
+static void fscl_tofu_cmap_grow(ctofu_cmap_shard* shard) {
+    ctofu_cmap_table* table = atomic_load_explicit(&shard->table, memory_order_relaxed);
+    ctofu_cmap_table* grown = fscl_tofu_cmap_table_alloc((table->mask + 1) * 2);
+    if (grown == NULL) {
+        return;  // Longer chains, still correct
+    }
+
+    for (size_t i = 0; i <= table->mask; ++i) {
+        ctofu_cmap_node* node = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+        for (; node != NULL; node = atomic_load_explicit(&node->next, memory_order_relaxed)) {
+            ctofu_cmap_node* copy = fscl_tofu_cmap_node_alloc(node->hash, &node->key, &node->value, false);
+            if (copy == NULL) {
+                fscl_tofu_cmap_table_free(grown);
+                return;
+            }
+            size_t bucket = copy->hash & grown->mask;
+            atomic_init(&copy->next, atomic_load_explicit(&grown->buckets[bucket], memory_order_relaxed));
+            atomic_init(&grown->buckets[bucket], copy);
+        }
+    }
+
+    atomic_store_explicit(&shard->table, grown, memory_order_release);
+    fscl_tofu_epoch_retire(&shard->garbage, &table->retired, fscl_tofu_cmap_table_reclaim);
+}
+
+// =======================
+// CREATE/ERASE FUNCTIONS
+// =======================
+
+ctofu_cmap* fscl_tofu_cmap_create(void) {
+    ctofu_cmap* map = (ctofu_cmap*)calloc(1, sizeof(ctofu_cmap));
+    if (map == NULL) {
+        return NULL;
+    }
+    atomic_init(&map->size, 0);
+
+    for (size_t i = 0; i < FSCL_TOFU_CMAP_SHARDS; ++i) {
+        ctofu_cmap_table* table = fscl_tofu_cmap_table_alloc(FSCL_TOFU_CMAP_BUCKETS);
+        if (table == NULL) {
+            for (size_t j = 0; j < i; ++j) {
+                fscl_tofu_mutex_erase(&map->shards[j].lock);
+                free(atomic_load_explicit(&map->shards[j].table, memory_order_relaxed));
+            }
+            free(map);
+            return NULL;
+        }
+        fscl_tofu_mutex_init(&map->shards[i].lock);
+        atomic_init(&map->shards[i].table, table);
+    }
+    return map;
+}
+
+void fscl_tofu_cmap_erase(ctofu_cmap* map) {
+    if (map == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < FSCL_TOFU_CMAP_SHARDS; ++i) {
+        ctofu_cmap_shard* shard = &map->shards[i];
+        fscl_tofu_epoch_drain(&shard->garbage);
+        fscl_tofu_cmap_table_free(atomic_load_explicit(&shard->table, memory_order_relaxed));
+        fscl_tofu_mutex_erase(&shard->lock);
+    }
+    free(map);
+}
+
+// =======================
+// ACCESS FUNCTIONS
+// =======================
+
+size_t fscl_tofu_cmap_size(const ctofu_cmap* map) {
+    return map != NULL ? atomic_load_explicit(&map->size, memory_order_relaxed) : 0;
+}
+
+ctofu_error fscl_tofu_cmap_get(ctofu_cmap* map, const ctofu* key, ctofu* value) {
+    if (map == NULL || key == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    uint64_t hash = fscl_tofu_hash(key);
+    ctofu_cmap_shard* shard = fscl_tofu_cmap_shard(map, hash);
+    ctofu_error result = FSCL_TOFU_ERROR_TYPE_MISMATCH;
+
+    fscl_tofu_epoch_enter();
+    ctofu_cmap_table* table = atomic_load_explicit(&shard->table, memory_order_acquire);
+    ctofu_cmap_node* node = atomic_load_explicit(&table->buckets[hash & table->mask], memory_order_acquire);
+    for (; node != NULL; node = atomic_load_explicit(&node->next, memory_order_acquire)) {
+        if (fscl_tofu_key_equal(&node->key, node->hash, key, hash)) {
+            result = value != NULL ? fscl_tofu_shared_copy(&node->value, value) : FSCL_TOFU_ERROR_OK;
+            break;
+        }
+    }
+    fscl_tofu_epoch_exit();
+
+    return fscl_tofu_error(result);
+}
+
+ctofu_error fscl_tofu_cmap_set(ctofu_cmap* map, const ctofu* key, const ctofu* value) {
+    if (map == NULL || key == NULL || value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    uint64_t hash = fscl_tofu_hash(key);
+    ctofu_cmap_node* fresh = fscl_tofu_cmap_node_alloc(hash, key, value, true);
+    if (fresh == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    ctofu_cmap_shard* shard = fscl_tofu_cmap_shard(map, hash);
+    fscl_tofu_mutex_lock(&shard->lock);
+
+    ctofu_cmap_table* table = atomic_load_explicit(&shard->table, memory_order_relaxed);
+    _Atomic(ctofu_cmap_node*)* bucket = &table->buckets[hash & table->mask];
+    _Atomic(ctofu_cmap_node*)* link = bucket;
+    ctofu_cmap_node* node = atomic_load_explicit(link, memory_order_relaxed);
+    while (node != NULL && !fscl_tofu_key_equal(&node->key, node->hash, key, hash)) {
+        link = &node->next;
+        node = atomic_load_explicit(link, memory_order_relaxed);
+    }
+
+    if (node != NULL) {
+        // Swap in the new node; readers already on the old one still reach the rest of the chain
+        atomic_init(&fresh->next, atomic_load_explicit(&node->next, memory_order_relaxed));
+        atomic_store_explicit(link, fresh, memory_order_release);
+        fscl_tofu_epoch_retire(&shard->garbage, &node->retired, fscl_tofu_cmap_node_reclaim);
+    } else {
+        atomic_init(&fresh->next, atomic_load_explicit(bucket, memory_order_relaxed));
+        atomic_store_explicit(bucket, fresh, memory_order_release);
+        atomic_fetch_add_explicit(&map->size, 1, memory_order_relaxed);
+        if (++shard->count > table->mask + 1) {
+            fscl_tofu_cmap_grow(shard);
+        }
+    }
+
+    fscl_tofu_mutex_unlock(&shard->lock);
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_cmap_remove(ctofu_cmap* map, const ctofu* key) {
+    if (map == NULL || key == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    uint64_t hash = fscl_tofu_hash(key);
+    ctofu_cmap_shard* shard = fscl_tofu_cmap_shard(map, hash);
+    fscl_tofu_mutex_lock(&shard->lock);
+
+    ctofu_cmap_table* table = atomic_load_explicit(&shard->table, memory_order_relaxed);
+    _Atomic(ctofu_cmap_node*)* link = &table->buckets[hash & table->mask];
+    ctofu_cmap_node* node = atomic_load_explicit(link, memory_order_relaxed);
+    while (node != NULL && !fscl_tofu_key_equal(&node->key, node->hash, key, hash)) {
+        link = &node->next;
+        node = atomic_load_explicit(link, memory_order_relaxed);
+    }
+
+    if (node == NULL) {
+        fscl_tofu_mutex_unlock(&shard->lock);
+        return fscl_tofu_error(FSCL_TOFU_ERROR_TYPE_MISMATCH);
+    }
+
+    atomic_store_explicit(link, atomic_load_explicit(&node->next, memory_order_relaxed), memory_order_release);
+    fscl_tofu_epoch_retire(&shard->garbage, &node->retired, fscl_tofu_cmap_node_reclaim);
+    --shard->count;
+    atomic_fetch_sub_explicit(&map->size, 1, memory_order_relaxed);
+
+    fscl_tofu_mutex_unlock(&shard->lock);
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
@@ -0,0 +1,824 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/csv.h"
+#include "xtofu_internal.h"
+#include "xtofu_sync.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Below this many bytes per thread a chunk is not worth splitting
+#define FSCL_TOFU_CSV_MIN_SLICE ((size_t)64 << 10)
+#define FSCL_TOFU_CSV_MAX_THREADS 64
+
+typedef struct {
+    ctofu* elements;
+    size_t size;
+    size_t capacity;
+} ctofu_csv_column;
+
+typedef struct {
+    const ctofu_type* schema;
+    size_t count;
+    char delimiter;
+    char quote;
+    size_t threads;
+    bool skip_header;
+    ctofu_csv_column* columns;
+} ctofu_csv_loader;
+
+typedef struct {
+    const ctofu_csv_loader* loader;
+    const char* begin;
+    const char* end;
+    ctofu_csv_column* columns;
+    ctofu_error error;
+} ctofu_csv_slice;
+
+typedef struct {
+    ctofu_csv_slice* slices;
+} ctofu_csv_job;
+
+// =======================
+// SCANNING HELPERS
+// =======================
+
+// Finds the first delimiter or newline, sixteen bytes at a time when SSE2 is available
+static const char* fscl_tofu_csv_scan_field(const char* cursor, const char* end, char delimiter) {
+#ifdef FSCL_TOFU_SSE2
+    const __m128i separator = _mm_set1_epi8(delimiter);
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    while (end - cursor >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)cursor);
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, separator), _mm_cmpeq_epi8(chunk, newline)));
+        if (mask != 0) {
+            return cursor + fscl_tofu_ctz(mask);
+        }
+        cursor += 16;
+    }
+#endif
+
+    while (cursor < end && *cursor != delimiter && *cursor != '\n') {
+        ++cursor;
+    }
+    return cursor;
+}
+
+// Records a record boundary at offset (just past a newline outside quotes)
+static inline void fscl_tofu_csv_resolve(size_t offset, const size_t* targets, size_t* splits, size_t count, size_t* next) {
+    while (*next < count && targets[*next] < offset) {
+        splits[(*next)++] = offset;
+    }
+}
+
+// Walks a block once, tracking whether the cursor is inside quotes, and finds
+// for every target offset the first record boundary after it. Returns the end
+// of the last complete record. Windows of sixteen bytes without a quote are
+// classified at once; only windows holding a quote are walked byte by byte.
+static size_t fscl_tofu_csv_boundaries(const char* data, size_t length, char quote, bool final,
+                                       const size_t* targets, size_t* splits, size_t count) {
+    bool quoted = false;
+    size_t last = 0;
+    size_t next = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        size_t stop = length - i < 16 ? length : i + 16;
+
+#ifdef FSCL_TOFU_SSE2
+        if (length - i >= 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+            unsigned quotes = quote ? (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(quote))) : 0;
+
+            if (quotes == 0) {
+                unsigned newlines = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+                while (!quoted && newlines != 0) {
+                    last = i + fscl_tofu_ctz(newlines) + 1;
+                    fscl_tofu_csv_resolve(last, targets, splits, count, &next);
+                    newlines &= newlines - 1;
+                }
+                i += 16;
+                continue;
+            }
+        }
+#endif
+
+        for (; i < stop; ++i) {
+            if (quote && data[i] == quote) {
+                quoted = !quoted;
+            } else if (data[i] == '\n' && !quoted) {
+                last = i + 1;
+                fscl_tofu_csv_resolve(last, targets, splits, count, &next);
+            }
+        }
+    }
+
+    // The final record of the input does not need a trailing newline
+    if (final) {
+        last = length;
+    }
+    while (next < count) {
+        splits[next++] = last;
+    }
+
+    return last;
+}
+
+// =======================
+// FIELD CONVERSION
+// =======================
+
+#ifdef FSCL_TOFU_LITTLE_ENDIAN
+// Converts eight ASCII digits with a handful of multiplications (SWAR)
+static inline bool fscl_tofu_csv_eight_digits(const char* text, uint64_t* value) {
+    uint64_t chunk;
+    memcpy(&chunk, text, sizeof(chunk));
+
+    if ((((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL)) {
+        return false;
+    }
+
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    *value = chunk;
+    return true;
+}
+#endif
+
+static ctofu_error fscl_tofu_csv_decimal(const char* text, size_t length, uint64_t* result) {
+    uint64_t value = 0;
+    size_t i = 0;
+
+    if (length == 0) {
+        return FSCL_TOFU_ERROR_FORMAT;
+    }
+
+#ifdef FSCL_TOFU_LITTLE_ENDIAN
+    uint64_t chunk;
+    while (length - i >= 8 && value <= (UINT64_MAX - 99999999ULL) / 100000000ULL && fscl_tofu_csv_eight_digits(text + i, &chunk)) {
+        value = value * 100000000ULL + chunk;
+        i += 8;
+    }
+#endif
+
+    for (; i < length; ++i) {
+        unsigned digit = (unsigned)(text[i] - '0');
+        if (digit > 9) {
+            return FSCL_TOFU_ERROR_FORMAT;
+        }
+        if (value > (UINT64_MAX - digit) / 10) {
+            return FSCL_TOFU_ERROR_OVERFLOW_INT;
+        }
+        value = value * 10 + digit;
+    }
+
+    *result = value;
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error fscl_tofu_csv_radix(const char* text, size_t length, unsigned shift, uint64_t* result) {
+    uint64_t value = 0;
+
+    if (length == 0) {
+        return FSCL_TOFU_ERROR_FORMAT;
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[i];
+        unsigned digit;
+
+        if (c >= '0' && c <= '9') {
+            digit = (unsigned)(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = (unsigned)(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            digit = (unsigned)(c - 'A' + 10);
+        } else {
+            return FSCL_TOFU_ERROR_FORMAT;
+        }
+
+        if (digit >= (1u << shift)) {
+            return FSCL_TOFU_ERROR_FORMAT;
+        }
+        if (value >> (64 - shift) != 0) {
+            return FSCL_TOFU_ERROR_OVERFLOW_INT;
+        }
+        value = (value << shift) | digit;
+    }
+
+    *result = value;
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static bool fscl_tofu_csv_prefix(const char* text, size_t length, char lower) {
+    return length >= 2 && text[0] == '0' && (text[1] == lower || text[1] == lower - 'a' + 'A');
+}
+
+static ctofu_error fscl_tofu_csv_signed(const char* text, size_t length, int64_t* result) {
+    bool negative = length > 0 && text[0] == '-';
+    size_t skip = (length > 0 && (text[0] == '-' || text[0] == '+')) ? 1 : 0;
+    uint64_t magnitude;
+
+    ctofu_error error = fscl_tofu_csv_decimal(text + skip, length - skip, &magnitude);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
+    if (negative) {
+        if (magnitude > (uint64_t)INT64_MAX + 1) {
+            return FSCL_TOFU_ERROR_UNDERFLOW_INT;
+        }
+        *result = (int64_t)((uint64_t)0 - magnitude);
+    } else {
+        if (magnitude > (uint64_t)INT64_MAX) {
+            return FSCL_TOFU_ERROR_OVERFLOW_INT;
+        }
+        *result = (int64_t)magnitude;
+    }
+
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error fscl_tofu_csv_real(const char* text, size_t length, double* result) {
+    const char* cursor = text;
+    const char* end = text + length;
+    bool negative = false;
+    bool digits = false;
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+
+    if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+        negative = *cursor == '-';
+        ++cursor;
+    }
+
+    while (cursor < end && *cursor >= '0' && *cursor <= '9' && mantissa < UINT64_MAX / 10) {
+        mantissa = mantissa * 10 + (uint64_t)(*cursor++ - '0');
+        digits = true;
+    }
+    if (cursor < end && *cursor == '.') {
+        ++cursor;
+        while (cursor < end && *cursor >= '0' && *cursor <= '9' && mantissa < UINT64_MAX / 10) {
+            mantissa = mantissa * 10 + (uint64_t)(*cursor++ - '0');
+            --exponent;
+            digits = true;
+        }
+    }
+    if (digits && cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+        const char* mark = cursor++;
+        bool exponent_negative = false;
+        int64_t value = 0;
+
+        if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+            exponent_negative = *cursor++ == '-';
+        }
+        if (cursor == end || *cursor < '0' || *cursor > '9') {
+            cursor = mark;
+        } else {
+            while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+                if (value < 100000) {
+                    value = value * 10 + (*cursor - '0');
+                }
+                ++cursor;
+            }
+            exponent += exponent_negative ? -value : value;
+        }
+    }
+
+    if (digits && cursor == end && fscl_tofu_fast_real(mantissa, exponent, negative, result)) {
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    // Long significands, large exponents, inf and nan take the slow path
+    char small[64];
+    char* copy = length < sizeof(small) ? small : (char*)malloc(length + 1);
+    if (copy == NULL) {
+        return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+    }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    char* parsed = NULL;
+    *result = strtod(copy, &parsed);
+    ctofu_error error = (parsed == copy + length) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_FORMAT;
+
+    if (copy != small) {
+        free(copy);
+    }
+    return error;
+}
+
+static bool fscl_tofu_csv_word(const char* text, size_t length, const char* word) {
+    size_t i = 0;
+    for (; i < length && word[i] != '\0'; ++i) {
+        char c = text[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = (char)(c - 'A' + 'a');
+        }
+        if (c != word[i]) {
+            return false;
+        }
+    }
+    return i == length && word[i] == '\0';
+}
+
+static ctofu_error fscl_tofu_csv_convert(ctofu_type type, const char* text, size_t length, ctofu* value) {
+    uint64_t bits = 0;
+    ctofu_error error = FSCL_TOFU_ERROR_OK;
+
+    memset(value, 0, sizeof(*value));
+    value->type = type;
+
+    // Missing numbers read as zero
+    if (length == 0 && type != TOFU_STRING_TYPE && type != TOFU_BOOLEAN_TYPE) {
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    switch (type) {
+        case TOFU_INT_TYPE:
+            return fscl_tofu_csv_signed(text, length, &value->data.int_type);
+        case TOFU_FIXED_TYPE:
+            return fscl_tofu_csv_signed(text, length, &value->data.fixed_type);
+        case TOFU_UINT_TYPE:
+            return fscl_tofu_csv_decimal(text, length, &value->data.uint_type);
+        case TOFU_HEX_TYPE:
+            if (fscl_tofu_csv_prefix(text, length, 'x')) {
+                text += 2;
+                length -= 2;
+            }
+            return fscl_tofu_csv_radix(text, length, 4, &value->data.hex_type);
+        case TOFU_OCTAL_TYPE:
+            if (fscl_tofu_csv_prefix(text, length, 'o')) {
+                text += 2;
+                length -= 2;
+            }
+            return fscl_tofu_csv_radix(text, length, 3, &value->data.octal_type);
+        case TOFU_BITWISE_TYPE:
+        case TOFU_QBIT_TYPE:
+            if (fscl_tofu_csv_prefix(text, length, 'x')) {
+                error = fscl_tofu_csv_radix(text + 2, length - 2, 4, &bits);
+            } else if (fscl_tofu_csv_prefix(text, length, 'b')) {
+                error = fscl_tofu_csv_radix(text + 2, length - 2, 1, &bits);
+            } else {
+                error = fscl_tofu_csv_radix(text, length, 1, &bits);
+            }
+            if (type == TOFU_QBIT_TYPE) {
+                value->data.qbit_type = bits;
+            } else {
+                value->data.bitwise_type = bits;
+            }
+            return error;
+        case TOFU_DOUBLE_TYPE:
+            return fscl_tofu_csv_real(text, length, &value->data.double_type);
+        case TOFU_FLOAT_TYPE: {
+            double real = 0.0;
+            error = fscl_tofu_csv_real(text, length, &real);
+            value->data.float_type = (float)real;
+            return error;
+        }
+        case TOFU_BOOLEAN_TYPE:
+            if (fscl_tofu_csv_word(text, length, "true") || fscl_tofu_csv_word(text, length, "yes") ||
+                fscl_tofu_csv_word(text, length, "t") || fscl_tofu_csv_word(text, length, "y") ||
+                fscl_tofu_csv_word(text, length, "1")) {
+                value->data.boolean_type = true;
+            } else if (fscl_tofu_csv_word(text, length, "false") || fscl_tofu_csv_word(text, length, "no") ||
+                       fscl_tofu_csv_word(text, length, "f") || fscl_tofu_csv_word(text, length, "n") ||
+                       fscl_tofu_csv_word(text, length, "0") || length == 0) {
+                value->data.boolean_type = false;
+            } else {
+                return FSCL_TOFU_ERROR_FORMAT;
+            }
+            return FSCL_TOFU_ERROR_OK;
+        case TOFU_CHAR_TYPE:
+            value->data.char_type = text[0];
+            return FSCL_TOFU_ERROR_OK;
+        case TOFU_STRING_TYPE:
+            return fscl_tofu_string_store(value, text, length);
+        case TOFU_NULLPTR_TYPE:
+            value->data.nullptr_type = NULL;
+            return FSCL_TOFU_ERROR_OK;
+        default:
+            return FSCL_TOFU_ERROR_INVALID_OPERATION;
+    }
+}
+
+// =======================
+// COLUMN STORAGE
+// =======================
+
+static bool fscl_tofu_csv_reserve(ctofu_csv_column* column, size_t extra) {
+    if (column->size + extra <= column->capacity) {
+        return true;
+    }
+
+    size_t capacity = column->capacity ? column->capacity : 256;
+    while (capacity < column->size + extra) {
+        capacity *= 2;
+    }
+
+    ctofu* elements = (ctofu*)realloc(column->elements, capacity * sizeof(ctofu));
+    if (elements == NULL) {
+        return false;
+    }
+    column->elements = elements;
+    column->capacity = capacity;
+    return true;
+}
+
+static void fscl_tofu_csv_release(ctofu_csv_column* columns, size_t count) {
+    for (size_t c = 0; c < count; ++c) {
+        ctofu array;
+        memset(&array, 0, sizeof(array));
+        array.type = TOFU_ARRAY_TYPE;
+        array.data.array_type.elements = columns[c].elements;
+        array.data.array_type.size = columns[c].size;
+        fscl_tofu_value_erase(&array);
+
+        columns[c].elements = NULL;
+        columns[c].size = 0;
+        columns[c].capacity = 0;
+    }
+}
+
+// =======================
+// RECORD PARSING
+// =======================
+
+// Parses complete records in [begin, end) into the slice's columns
+static void fscl_tofu_csv_parse_slice(ctofu_csv_slice* slice) {
+    const ctofu_csv_loader* loader = slice->loader;
+    const char* cursor = slice->begin;
+    const char* end = slice->end;
+    char* unquoted = NULL;
+    size_t unquoted_capacity = 0;
+
+    slice->error = FSCL_TOFU_ERROR_OK;
+
+    while (cursor < end) {
+        // Blank lines separate nothing
+        if (*cursor == '\n' || (*cursor == '\r' && cursor + 1 < end && cursor[1] == '\n')) {
+            cursor += *cursor == '\r' ? 2 : 1;
+            continue;
+        }
+
+        for (size_t c = 0; c < loader->count; ++c) {
+            const char* field = cursor;
+            size_t length;
+
+            if (loader->quote && cursor < end && *cursor == loader->quote) {
+                // Quoted field: doubled quotes stand for one quote
+                size_t used = 0;
+                ++cursor;
+                for (;;) {
+                    const char* stop = memchr(cursor, loader->quote, (size_t)(end - cursor));
+                    if (stop == NULL) {
+                        slice->error = FSCL_TOFU_ERROR_FORMAT;
+                        goto done;
+                    }
+
+                    size_t piece = (size_t)(stop - cursor) + 1;
+                    if (used + piece > unquoted_capacity) {
+                        size_t capacity = unquoted_capacity ? unquoted_capacity * 2 : 128;
+                        while (capacity < used + piece) {
+                            capacity *= 2;
+                        }
+                        char* grown = (char*)realloc(unquoted, capacity);
+                        if (grown == NULL) {
+                            slice->error = FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+                            goto done;
+                        }
+                        unquoted = grown;
+                        unquoted_capacity = capacity;
+                    }
+
+                    memcpy(unquoted + used, cursor, piece - 1);
+                    used += piece - 1;
+                    cursor = stop + 1;
+
+                    if (cursor < end && *cursor == loader->quote) {
+                        unquoted[used++] = loader->quote;
+                        ++cursor;
+                        continue;
+                    }
+                    break;
+                }
+
+                field = unquoted ? unquoted : "";
+                length = used;
+            } else {
+                cursor = fscl_tofu_csv_scan_field(cursor, end, loader->delimiter);
+                length = (size_t)(cursor - field);
+                if (length > 0 && field[length - 1] == '\r' && (cursor == end || *cursor == '\n')) {
+                    --length;
+                }
+            }
+
+            if (cursor < end && *cursor == '\r' && cursor + 1 < end && cursor[1] == '\n') {
+                ++cursor;
+            }
+
+            // Every field but the last must be followed by a delimiter
+            bool last = c + 1 == loader->count;
+            if (last ? (cursor < end && *cursor != '\n') : (cursor == end || *cursor != loader->delimiter)) {
+                slice->error = FSCL_TOFU_ERROR_FORMAT;
+                goto done;
+            }
+            if (cursor < end) {
+                ++cursor;
+            }
+
+            ctofu_csv_column* column = &slice->columns[c];
+            if (!fscl_tofu_csv_reserve(column, 1)) {
+                slice->error = FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+                goto done;
+            }
+
+            slice->error = fscl_tofu_csv_convert(loader->schema[c], field, length, &column->elements[column->size]);
+            if (slice->error != FSCL_TOFU_ERROR_OK) {
+                goto done;
+            }
+            column->size++;
+        }
+    }
+
+done:
+    free(unquoted);
+}
+
+static void fscl_tofu_csv_parse_task(void* context, size_t task) {
+    ctofu_csv_job* job = (ctofu_csv_job*)context;
+    fscl_tofu_csv_parse_slice(&job->slices[task]);
+}
+
+// Parses the complete records of a block and returns how many bytes were consumed
+static ctofu_error fscl_tofu_csv_process(ctofu_csv_loader* loader, const char* data, size_t length, bool final, size_t* consumed) {
+    size_t offset = 0;
+    *consumed = 0;
+
+    if (loader->skip_header) {
+        size_t target = 0;
+        size_t split = 0;
+        fscl_tofu_csv_boundaries(data, length, loader->quote, final, &target, &split, 1);
+        if (split == 0 && !final) {
+            return FSCL_TOFU_ERROR_OK;  // The header is still incomplete
+        }
+        loader->skip_header = false;
+        offset = split;
+    }
+
+    const char* block = data + offset;
+    size_t size = length - offset;
+
+    size_t slices = loader->threads;
+    if (slices > size / FSCL_TOFU_CSV_MIN_SLICE) {
+        slices = size / FSCL_TOFU_CSV_MIN_SLICE;
+    }
+    if (slices == 0) {
+        slices = 1;
+    }
+
+    size_t targets[FSCL_TOFU_CSV_MAX_THREADS] = {0};
+    size_t splits[FSCL_TOFU_CSV_MAX_THREADS];
+    for (size_t i = 0; i + 1 < slices; ++i) {
+        targets[i] = size / slices * (i + 1);
+    }
+
+    size_t end = fscl_tofu_csv_boundaries(block, size, loader->quote, final, targets, splits, slices - 1);
+    splits[slices - 1] = end;
+    *consumed = offset + end;
+
+    if (end == 0) {
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    if (slices == 1) {
+        // Nothing to merge, parse straight into the result
+        ctofu_csv_slice slice = { loader, block, block + end, loader->columns, FSCL_TOFU_ERROR_OK };
+        fscl_tofu_csv_parse_slice(&slice);
+        return slice.error;
+    }
+
+    ctofu_csv_slice* slice = (ctofu_csv_slice*)calloc(slices, sizeof(ctofu_csv_slice));
+    ctofu_csv_column* storage = (ctofu_csv_column*)calloc(slices * loader->count, sizeof(ctofu_csv_column));
+    if (slice == NULL || storage == NULL) {
+        free(slice);
+        free(storage);
+        return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+    }
+
+    for (size_t i = 0; i < slices; ++i) {
+        slice[i].loader = loader;
+        slice[i].begin = block + (i == 0 ? 0 : splits[i - 1]);
+        slice[i].end = block + splits[i];
+        slice[i].columns = storage + i * loader->count;
+    }
+
+    ctofu_csv_job job = { slice };
+    fscl_tofu_parallel_run(slices, fscl_tofu_csv_parse_task, &job);
+
+    ctofu_error error = FSCL_TOFU_ERROR_OK;
+    for (size_t i = 0; i < slices && error == FSCL_TOFU_ERROR_OK; ++i) {
+        error = slice[i].error;
+    }
+
+    // Append the slices in input order
+    for (size_t c = 0; c < loader->count && error == FSCL_TOFU_ERROR_OK; ++c) {
+        size_t total = 0;
+        for (size_t i = 0; i < slices; ++i) {
+            total += slice[i].columns[c].size;
+        }
+
+        ctofu_csv_column* column = &loader->columns[c];
+        if (!fscl_tofu_csv_reserve(column, total)) {
+            error = FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+            break;
+        }
+
+        for (size_t i = 0; i < slices; ++i) {
+            ctofu_csv_column* part = &slice[i].columns[c];
+            if (part->size > 0) {
+                memcpy(column->elements + column->size, part->elements, part->size * sizeof(ctofu));
+                column->size += part->size;
+            }
+            free(part->elements);
+            part->elements = NULL;
+            part->size = 0;
+            part->capacity = 0;
+        }
+    }
+
+    // Whatever was not moved into the result is released here
+    fscl_tofu_csv_release(storage, slices * loader->count);
+    free(storage);
+    free(slice);
+    return error;
+}
+
+// =======================
+// LOADER FUNCTIONS
+// =======================
+
+ctofu_csv_options fscl_tofu_csv_options(char delimiter) {
+    ctofu_csv_options options;
+    options.delimiter = delimiter;
+    options.quote = '"';
+    options.header = false;
+    options.threads = 1;
+    options.chunk_size = FSCL_TOFU_CSV_CHUNK_SIZE;
+    return options;
+}
+
+static ctofu_error fscl_tofu_csv_begin(ctofu_csv_loader* loader, const ctofu_type* schema, size_t count,
+                                       const ctofu_csv_options* options, ctofu* columns) {
+    ctofu_csv_options defaults = fscl_tofu_csv_options(',');
+    if (options == NULL) {
+        options = &defaults;
+    }
+
+    if (schema == NULL || columns == NULL || count == 0) {
+        return FSCL_TOFU_ERROR_NULL_POINTER;
+    }
+
+    for (size_t c = 0; c < count; ++c) {
+        if (schema[c] == TOFU_ARRAY_TYPE || schema[c] == TOFU_MAP_TYPE ||
+            schema[c] == TOFU_INVALID_TYPE || schema[c] == TOFU_UNKNOWN_TYPE) {
+            return FSCL_TOFU_ERROR_INVALID_OPERATION;
+        }
+    }
+
+    if (options->delimiter == '\n' || options->delimiter == options->quote) {
+        return FSCL_TOFU_ERROR_INVALID_OPERATION;
+    }
+
+    loader->schema = schema;
+    loader->count = count;
+    loader->delimiter = options->delimiter;
+    loader->quote = options->quote;
+    loader->threads = options->threads > 1 ? options->threads : 1;
+    if (loader->threads > FSCL_TOFU_CSV_MAX_THREADS) {
+        loader->threads = FSCL_TOFU_CSV_MAX_THREADS;
+    }
+    loader->skip_header = options->header;
+    loader->columns = (ctofu_csv_column*)calloc(count, sizeof(ctofu_csv_column));
+    return loader->columns ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+}
+
+static ctofu_error fscl_tofu_csv_end(ctofu_csv_loader* loader, ctofu_error error, ctofu* columns) {
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_csv_release(loader->columns, loader->count);
+        free(loader->columns);
+        return fscl_tofu_error(error);
+    }
+
+    for (size_t c = 0; c < loader->count; ++c) {
+        ctofu_csv_column* column = &loader->columns[c];
+
+        // Give back the growth slack
+        if (column->size == 0) {
+            free(column->elements);
+            column->elements = NULL;
+        } else if (column->size < column->capacity) {
+            ctofu* elements = (ctofu*)realloc(column->elements, column->size * sizeof(ctofu));
+            if (elements != NULL) {
+                column->elements = elements;
+            }
+        }
+
+        memset(&columns[c], 0, sizeof(columns[c]));
+        columns[c].type = TOFU_ARRAY_TYPE;
+        columns[c].data.array_type.elements = column->elements;
+        columns[c].data.array_type.size = column->size;
+    }
+
+    free(loader->columns);
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_csv_load_buffer(const char* data, size_t length, const ctofu_type* schema, size_t count,
+                                      const ctofu_csv_options* options, ctofu* columns) {
+    if (data == NULL && length > 0) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    ctofu_csv_loader loader;
+    ctofu_error error = fscl_tofu_csv_begin(&loader, schema, count, options, columns);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return fscl_tofu_error(error);
+    }
+
+    size_t consumed = 0;
+    error = fscl_tofu_csv_process(&loader, data, length, true, &consumed);
+    return fscl_tofu_csv_end(&loader, error, columns);
+}
+
+ctofu_error fscl_tofu_csv_load_file(const char* path, const ctofu_type* schema, size_t count,
+                                    const ctofu_csv_options* options, ctofu* columns) {
+    if (path == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    ctofu_csv_loader loader;
+    ctofu_error error = fscl_tofu_csv_begin(&loader, schema, count, options, columns);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return fscl_tofu_error(error);
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return fscl_tofu_csv_end(&loader, FSCL_TOFU_ERROR_INSECURE_FILE_HANDLING, columns);
+    }
+
+    size_t chunk = (options != NULL && options->chunk_size > 0) ? options->chunk_size : FSCL_TOFU_CSV_CHUNK_SIZE;
+    char* buffer = NULL;
+    size_t capacity = 0;
+    size_t held = 0;
+    bool final = false;
+
+    while (!final && error == FSCL_TOFU_ERROR_OK) {
+        // Grow only when a single record is larger than what is already held
+        if (held + chunk > capacity) {
+            size_t grown_capacity = capacity ? capacity * 2 : chunk * 2;
+            while (grown_capacity < held + chunk) {
+                grown_capacity *= 2;
+            }
+            char* grown = (char*)realloc(buffer, grown_capacity);
+            if (grown == NULL) {
+                error = FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+                break;
+            }
+            buffer = grown;
+            capacity = grown_capacity;
+        }
+
+        held += fread(buffer + held, 1, chunk, file);
+        if (ferror(file)) {
+            error = FSCL_TOFU_ERROR_FILE_CORRUPTION;
+            break;
+        }
+        final = feof(file) != 0;
+
+        size_t consumed = 0;
+        error = fscl_tofu_csv_process(&loader, buffer, held, final, &consumed);
+
+        // Carry the partial record over to the next chunk
+        memmove(buffer, buffer + consumed, held - consumed);
+        held -= consumed;
+    }
+
+    free(buffer);
+    fclose(file);
+    return fscl_tofu_csv_end(&loader, error, columns);
+}
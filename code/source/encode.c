@@ -0,0 +1,1202 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/encode.h"
+#include "fossil/limits.h"
+#include "xtofu_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Flipping the sign bit makes signed keys order like unsigned ones
+#define FSCL_TOFU_SIGN_BIT ((uint64_t)1 << 63)
+
+struct ctofu_encoded {
+    ctofu_type type;           // Type of every element
+    ctofu_encoding encoding;   // How the key sequence is stored
+    size_t size;               // Number of elements
+    uint64_t base;             // Frame of reference, or the first key for delta encodings
+    uint64_t delta;            // Smallest delta, or the first delta for delta of delta
+    unsigned width;            // Bits per packed entry
+    uint64_t* words;           // Packed entries
+    size_t runs;               // Number of runs
+    uint64_t* run_keys;        // Key of every run
+    size_t* run_ends;          // Index one past the end of every run
+    char** dictionary;         // Distinct strings, indexed by key
+    size_t dictionary_size;    // Number of distinct strings
+};
+
+// =======================
+// KEY MAPPING
+// =======================
+
+static bool fscl_tofu_encode_supported(ctofu_type type) {
+    switch (type) {
+        case TOFU_ARRAY_TYPE:
+        case TOFU_MAP_TYPE:
+        case TOFU_INVALID_TYPE:
+        case TOFU_UNKNOWN_TYPE:
+            return false;
+        default:
+            return true;
+    }
+}
+
+static uint64_t fscl_tofu_encode_key(const ctofu* value) {
+    uint64_t key = 0;
+
+    switch (value->type) {
+        case TOFU_INT_TYPE:
+            return (uint64_t)value->data.int_type ^ FSCL_TOFU_SIGN_BIT;
+        case TOFU_FIXED_TYPE:
+            return (uint64_t)value->data.fixed_type ^ FSCL_TOFU_SIGN_BIT;
+        case TOFU_UINT_TYPE:
+            return value->data.uint_type;
+        case TOFU_OCTAL_TYPE:
+            return value->data.octal_type;
+        case TOFU_BITWISE_TYPE:
+            return value->data.bitwise_type;
+        case TOFU_HEX_TYPE:
+            return value->data.hex_type;
+        case TOFU_QBIT_TYPE:
+            return value->data.qbit_type;
+        case TOFU_CHAR_TYPE:
+            return (unsigned char)value->data.char_type;
+        case TOFU_BOOLEAN_TYPE:
+            return value->data.boolean_type ? 1 : 0;
+        case TOFU_DOUBLE_TYPE:
+            memcpy(&key, &value->data.double_type, sizeof(double));
+            return key;
+        case TOFU_FLOAT_TYPE: {
+            uint32_t bits;
+            memcpy(&bits, &value->data.float_type, sizeof(float));
+            return bits;
+        }
+        case TOFU_NULLPTR_TYPE:
+            return (uint64_t)(uintptr_t)value->data.nullptr_type;
+        default:
+            return 0;
+    }
+}
+
+static void fscl_tofu_encode_value(const ctofu_encoded* encoded, uint64_t key, ctofu* value) {
+    memset(value, 0, sizeof(*value));
+    value->type = encoded->type;
+
+    switch (encoded->type) {
+        case TOFU_INT_TYPE:
+            value->data.int_type = (int64_t)(key ^ FSCL_TOFU_SIGN_BIT);
+            break;
+        case TOFU_FIXED_TYPE:
+            value->data.fixed_type = (int64_t)(key ^ FSCL_TOFU_SIGN_BIT);
+            break;
+        case TOFU_UINT_TYPE:
+            value->data.uint_type = key;
+            break;
+        case TOFU_OCTAL_TYPE:
+            value->data.octal_type = key;
+            break;
+        case TOFU_BITWISE_TYPE:
+            value->data.bitwise_type = key;
+            break;
+        case TOFU_HEX_TYPE:
+            value->data.hex_type = key;
+            break;
+        case TOFU_QBIT_TYPE:
+            value->data.qbit_type = key;
+            break;
+        case TOFU_CHAR_TYPE:
+            value->data.char_type = (char)(unsigned char)key;
+            break;
+        case TOFU_BOOLEAN_TYPE:
+            value->data.boolean_type = key != 0;
+            break;
+        case TOFU_DOUBLE_TYPE:
+            memcpy(&value->data.double_type, &key, sizeof(double));
+            break;
+        case TOFU_FLOAT_TYPE: {
+            uint32_t bits = (uint32_t)key;
+            memcpy(&value->data.float_type, &bits, sizeof(float));
+            break;
+        }
+        case TOFU_STRING_TYPE:
+            value->data.string_type = encoded->dictionary[key];
+            break;
+        case TOFU_NULLPTR_TYPE:
+            value->data.nullptr_type = (void*)(uintptr_t)key;
+            break;
+        default:
+            break;
+    }
+}
+
+static inline uint64_t fscl_tofu_zigzag(uint64_t value) {
+    return (value << 1) ^ (uint64_t)((int64_t)value >> 63);
+}
+
+static inline uint64_t fscl_tofu_unzigzag(uint64_t value) {
+    return (value >> 1) ^ ((uint64_t)0 - (value & 1));
+}
+
+// =======================
+// LANE NARROWING
+// =======================
+
+typedef struct {
+    int64_t minimum;
+    uint64_t maximum;
+} ctofu_narrow_range;
+
+static bool fscl_tofu_narrow_supported(ctofu_type type) {
+    switch (type) {
+        case TOFU_INT_TYPE:
+        case TOFU_FIXED_TYPE:
+        case TOFU_UINT_TYPE:
+        case TOFU_OCTAL_TYPE:
+        case TOFU_BITWISE_TYPE:
+        case TOFU_HEX_TYPE:
+        case TOFU_QBIT_TYPE:
+        case TOFU_CHAR_TYPE:
+        case TOFU_BOOLEAN_TYPE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static inline bool fscl_tofu_narrow_signed(ctofu_type type) {
+    return type == TOFU_INT_TYPE || type == TOFU_FIXED_TYPE;
+}
+
+// Picks the narrowest 8/16/32/64-bit range of the element type holding [minimum, maximum]
+static unsigned fscl_tofu_narrow_width(ctofu_type type, uint64_t minimum, uint64_t maximum) {
+    static const ctofu_narrow_range ranges_signed[] = {
+        { TOFU_LIMIT_S8_MIN, TOFU_LIMIT_S8_MAX }, { TOFU_LIMIT_S16_MIN, TOFU_LIMIT_S16_MAX },
+        { TOFU_LIMIT_S32_MIN, TOFU_LIMIT_S32_MAX }, { TOFU_LIMIT_S64_MIN, TOFU_LIMIT_S64_MAX }
+    };
+    static const ctofu_narrow_range ranges_unsigned[] = {
+        { TOFU_LIMIT_U8_MIN, TOFU_LIMIT_U8_MAX }, { TOFU_LIMIT_U16_MIN, TOFU_LIMIT_U16_MAX },
+        { TOFU_LIMIT_U32_MIN, TOFU_LIMIT_U32_MAX }, { TOFU_LIMIT_U64_MIN, TOFU_LIMIT_U64_MAX }
+    };
+    static const ctofu_narrow_range ranges_hex[] = {
+        { TOFU_LIMIT_HEX8_MIN, TOFU_LIMIT_HEX8_MAX }, { TOFU_LIMIT_HEX16_MIN, TOFU_LIMIT_HEX16_MAX },
+        { TOFU_LIMIT_HEX32_MIN, TOFU_LIMIT_HEX32_MAX }, { TOFU_LIMIT_HEX64_MIN, TOFU_LIMIT_HEX64_MAX }
+    };
+    static const ctofu_narrow_range ranges_octal[] = {
+        { TOFU_LIMIT_OCT8_MIN, TOFU_LIMIT_OCT8_MAX }, { TOFU_LIMIT_OCT16_MIN, TOFU_LIMIT_OCT16_MAX },
+        { TOFU_LIMIT_OCT32_MIN, TOFU_LIMIT_OCT32_MAX }, { TOFU_LIMIT_OCT64_MIN, TOFU_LIMIT_OCT64_MAX }
+    };
+    static const ctofu_narrow_range ranges_binary[] = {
+        { TOFU_LIMIT_BIN8_MIN, TOFU_LIMIT_BIN8_MAX }, { TOFU_LIMIT_BIN16_MIN, TOFU_LIMIT_BIN16_MAX },
+        { TOFU_LIMIT_BIN32_MIN, TOFU_LIMIT_BIN32_MAX }, { TOFU_LIMIT_BIN64_MIN, TOFU_LIMIT_BIN64_MAX }
+    };
+    static const ctofu_narrow_range range_byte[] = { { TOFU_LIMIT_BYTE_MIN, TOFU_LIMIT_BYTE_MAX } };
+    static const ctofu_narrow_range range_bool[] = { { TOFU_LIMIT_BOOL_MIN, TOFU_LIMIT_BOOL_MAX } };
+
+    const ctofu_narrow_range* ranges = ranges_unsigned;
+    switch (type) {
+        case TOFU_INT_TYPE:
+        case TOFU_FIXED_TYPE:
+            ranges = ranges_signed;
+            break;
+        case TOFU_HEX_TYPE:
+            ranges = ranges_hex;
+            break;
+        case TOFU_OCTAL_TYPE:
+            ranges = ranges_octal;
+            break;
+        case TOFU_BITWISE_TYPE:
+            ranges = ranges_binary;
+            break;
+        case TOFU_CHAR_TYPE:
+            ranges = range_byte;
+            break;
+        case TOFU_BOOLEAN_TYPE:
+            ranges = range_bool;
+            break;
+        default:
+            break;
+    }
+
+    // Characters and booleans only have a single range, which always fits
+    if (ranges == range_byte || ranges == range_bool) {
+        return 8;
+    }
+
+    for (unsigned i = 0; i < 3; ++i) {
+        bool fits;
+        if (fscl_tofu_narrow_signed(type)) {
+            fits = (int64_t)(minimum ^ FSCL_TOFU_SIGN_BIT) >= ranges[i].minimum &&
+                   (int64_t)(maximum ^ FSCL_TOFU_SIGN_BIT) <= (int64_t)ranges[i].maximum;
+        } else {
+            fits = maximum <= ranges[i].maximum;
+        }
+        if (fits) {
+            return 8u << i;
+        }
+    }
+    return 64;
+}
+
+// Widens a stored lane back to a key
+static inline uint64_t fscl_tofu_narrow_key(const ctofu_encoded* encoded, uint64_t lane) {
+    if (!fscl_tofu_narrow_signed(encoded->type)) {
+        return lane;
+    }
+    if (encoded->width == 64) {
+        return lane ^ FSCL_TOFU_SIGN_BIT;
+    }
+    unsigned shift = 64 - encoded->width;
+    return (uint64_t)((int64_t)(lane << shift) >> shift) ^ FSCL_TOFU_SIGN_BIT;
+}
+
+// =======================
+// BIT PACKING
+// =======================
+
+static inline uint64_t fscl_tofu_unpack(const uint64_t* words, unsigned width, size_t index) {
+    if (width == 0) {
+        return 0;
+    }
+
+    size_t bit = index * width;
+    size_t word = bit >> 6;
+    unsigned shift = (unsigned)(bit & 63);
+    uint64_t value = words[word] >> shift;
+
+    if (shift + width > 64) {
+        value |= words[word + 1] << (64 - shift);
+    }
+    return width == 64 ? value : value & (((uint64_t)1 << width) - 1);
+}
+
+static size_t fscl_tofu_packed_words(size_t count, unsigned width) {
+    return (count * width + 63) / 64;
+}
+
+static bool fscl_tofu_pack(ctofu_encoded* encoded, const uint64_t* values, size_t count) {
+    size_t words = fscl_tofu_packed_words(count, encoded->width);
+    if (words == 0) {
+        return true;
+    }
+
+    encoded->words = (uint64_t*)calloc(words, sizeof(uint64_t));
+    if (encoded->words == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t bit = i * encoded->width;
+        size_t word = bit >> 6;
+        unsigned shift = (unsigned)(bit & 63);
+
+        encoded->words[word] |= values[i] << shift;
+        if (shift + encoded->width > 64) {
+            encoded->words[word + 1] |= values[i] >> (64 - shift);
+        }
+    }
+    return true;
+}
+
+// Sums packed entries, reading byte aligned lanes straight from memory when possible
+static uint64_t fscl_tofu_packed_sum(const uint64_t* words, unsigned width, size_t count) {
+    uint64_t total = 0;
+    size_t i = 0;
+
+#if defined(FSCL_TOFU_SSE2) && defined(FSCL_TOFU_LITTLE_ENDIAN)
+    const char* bytes = (const char*)words;
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = zero;
+
+    if (width == 8) {
+        for (; i + 16 <= count; i += 16) {
+            sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(bytes + i)), zero));
+        }
+    } else if (width == 16) {
+        for (; i + 8 <= count; i += 8) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(bytes + i * 2));
+            __m128i pairs = _mm_add_epi32(_mm_unpacklo_epi16(chunk, zero), _mm_unpackhi_epi16(chunk, zero));
+            sum = _mm_add_epi64(sum, _mm_add_epi64(_mm_unpacklo_epi32(pairs, zero), _mm_unpackhi_epi32(pairs, zero)));
+        }
+    } else if (width == 32) {
+        for (; i + 4 <= count; i += 4) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(bytes + i * 4));
+            sum = _mm_add_epi64(sum, _mm_add_epi64(_mm_unpacklo_epi32(chunk, zero), _mm_unpackhi_epi32(chunk, zero)));
+        }
+    } else if (width == 64) {
+        for (; i + 2 <= count; i += 2) {
+            sum = _mm_add_epi64(sum, _mm_loadu_si128((const __m128i*)(bytes + i * 8)));
+        }
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, sum);
+    total = lanes[0] + lanes[1];
+#endif
+
+    for (; i < count; ++i) {
+        total += fscl_tofu_unpack(words, width, i);
+    }
+    return total;
+}
+
+// Finds the first packed entry equal to target
+static bool fscl_tofu_packed_find(const uint64_t* words, unsigned width, size_t count, uint64_t target, size_t* index) {
+    size_t i = 0;
+
+    if (width == 0) {
+        *index = 0;
+        return target == 0 && count > 0;
+    }
+
+#if defined(FSCL_TOFU_SSE2) && defined(FSCL_TOFU_LITTLE_ENDIAN)
+    const char* bytes = (const char*)words;
+
+    if (width == 8) {
+        const __m128i needle = _mm_set1_epi8((char)target);
+        for (; i + 16 <= count; i += 16) {
+            unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(bytes + i)), needle));
+            if (mask != 0) {
+                *index = i + fscl_tofu_ctz(mask);
+                return true;
+            }
+        }
+    } else if (width == 16) {
+        const __m128i needle = _mm_set1_epi16((short)target);
+        for (; i + 8 <= count; i += 8) {
+            unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(bytes + i * 2)), needle));
+            if (mask != 0) {
+                *index = i + fscl_tofu_ctz(mask) / 2;
+                return true;
+            }
+        }
+    } else if (width == 32) {
+        const __m128i needle = _mm_set1_epi32((int)target);
+        for (; i + 4 <= count; i += 4) {
+            unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(bytes + i * 4)), needle));
+            if (mask != 0) {
+                *index = i + fscl_tofu_ctz(mask) / 4;
+                return true;
+            }
+        }
+    } else if (width == 64) {
+        // SSE2 has no 64-bit compare, so both 32-bit halves must match
+        const __m128i needle = _mm_set_epi32((int)(target >> 32), (int)target, (int)(target >> 32), (int)target);
+        for (; i + 2 <= count; i += 2) {
+            __m128i halves = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(bytes + i * 8)), needle);
+            halves = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+            unsigned mask = (unsigned)_mm_movemask_epi8(halves);
+            if (mask != 0) {
+                *index = i + fscl_tofu_ctz(mask) / 8;
+                return true;
+            }
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        if (fscl_tofu_unpack(words, width, i) == target) {
+            *index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// =======================
+// DICTIONARY BUILDING
+// =======================
+
+static bool fscl_tofu_encode_same(const char* left, const char* right) {
+    if (left == NULL || right == NULL) {
+        return left == right;
+    }
+    return strcmp(left, right) == 0;
+}
+
+// Replaces every string with the index of its first occurrence among the distinct strings
+static ctofu_error fscl_tofu_encode_dictionary(ctofu_encoded* encoded, const ctofu* elements, uint64_t* keys) {
+    size_t capacity = 16;
+    while (capacity < encoded->size * 2) {
+        capacity *= 2;
+    }
+
+    size_t* slots = (size_t*)calloc(capacity, sizeof(size_t));
+    encoded->dictionary = (char**)malloc((encoded->size ? encoded->size : 1) * sizeof(char*));
+    if (slots == NULL || encoded->dictionary == NULL) {
+        free(slots);
+        return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+    }
+
+    for (size_t i = 0; i < encoded->size; ++i) {
+        const char* text = fscl_tofu_string_data(&elements[i]);
+        // Interned elements hand back the hash cached in the pool
+        size_t slot = (size_t)fscl_tofu_hash(&elements[i]) & (capacity - 1);
+
+        // Slots hold code + 1 so that zero marks an empty slot
+        while (slots[slot] != 0 && !fscl_tofu_encode_same(encoded->dictionary[slots[slot] - 1], text)) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+
+        if (slots[slot] == 0) {
+            char* copy = fscl_tofu_strdup(text);
+            if (text != NULL && copy == NULL) {
+                free(slots);
+                return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+            }
+            encoded->dictionary[encoded->dictionary_size++] = copy;
+            slots[slot] = encoded->dictionary_size;
+        }
+        keys[i] = slots[slot] - 1;
+    }
+
+    free(slots);
+    return FSCL_TOFU_ERROR_OK;
+}
+
+// =======================
+// CREATE/ERASE FUNCTIONS
+// =======================
+
+typedef struct {
+    uint64_t minimum;
+    uint64_t maximum;
+    bool sorted;
+    uint64_t delta_minimum;
+    uint64_t delta_maximum;
+    uint64_t second_maximum;
+    size_t runs;
+} ctofu_encode_stats;
+
+static void fscl_tofu_encode_measure(const uint64_t* keys, size_t count, ctofu_encode_stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->minimum = UINT64_MAX;
+    stats->delta_minimum = UINT64_MAX;
+    stats->sorted = true;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (keys[i] < stats->minimum) {
+            stats->minimum = keys[i];
+        }
+        if (keys[i] > stats->maximum) {
+            stats->maximum = keys[i];
+        }
+        if (i == 0 || keys[i] != keys[i - 1]) {
+            stats->runs++;
+        }
+
+        if (i > 0) {
+            uint64_t delta = keys[i] - keys[i - 1];
+            if (keys[i] < keys[i - 1]) {
+                stats->sorted = false;
+            }
+            if (delta < stats->delta_minimum) {
+                stats->delta_minimum = delta;
+            }
+            if (delta > stats->delta_maximum) {
+                stats->delta_maximum = delta;
+            }
+        }
+
+        if (i > 1) {
+            uint64_t second = fscl_tofu_zigzag((keys[i] - keys[i - 1]) - (keys[i - 1] - keys[i - 2]));
+            if (second > stats->second_maximum) {
+                stats->second_maximum = second;
+            }
+        }
+    }
+
+    if (count < 2) {
+        stats->delta_minimum = 0;
+    }
+}
+
+// Estimated payload bytes of every encoding, SIZE_MAX where it does not apply
+static size_t fscl_tofu_encode_cost(const ctofu_encode_stats* stats, size_t count, ctofu_encoding encoding) {
+    switch (encoding) {
+        case TOFU_ENCODING_PACKED:
+        case TOFU_ENCODING_DICTIONARY:
+            return fscl_tofu_packed_words(count, fscl_tofu_bit_width(stats->maximum - stats->minimum)) * sizeof(uint64_t);
+        case TOFU_ENCODING_DELTA:
+            if (!stats->sorted) {
+                return SIZE_MAX;
+            }
+            return fscl_tofu_packed_words(count ? count - 1 : 0, fscl_tofu_bit_width(stats->delta_maximum - stats->delta_minimum)) * sizeof(uint64_t);
+        case TOFU_ENCODING_DELTA_OF_DELTA:
+            return fscl_tofu_packed_words(count > 2 ? count - 2 : 0, fscl_tofu_bit_width(stats->second_maximum)) * sizeof(uint64_t);
+        case TOFU_ENCODING_RUN_LENGTH:
+            return stats->runs * (sizeof(uint64_t) + sizeof(size_t));
+        default:
+            return SIZE_MAX;
+    }
+}
+
+static ctofu_error fscl_tofu_encode_keys(ctofu_encoded* encoded, uint64_t* keys, const ctofu_encode_stats* stats) {
+    size_t count = encoded->size;
+
+    switch (encoded->encoding) {
+        case TOFU_ENCODING_PACKED:
+        case TOFU_ENCODING_DICTIONARY:
+            encoded->base = count ? stats->minimum : 0;
+            encoded->width = fscl_tofu_bit_width(stats->maximum - encoded->base);
+            for (size_t i = 0; i < count; ++i) {
+                keys[i] -= encoded->base;
+            }
+            return fscl_tofu_pack(encoded, keys, count) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+
+        case TOFU_ENCODING_DELTA:
+            encoded->base = count ? keys[0] : 0;
+            encoded->delta = stats->delta_minimum;
+            encoded->width = fscl_tofu_bit_width(stats->delta_maximum - stats->delta_minimum);
+            // Rewrite back to front so every key is still available when its delta is taken
+            for (size_t i = count; i-- > 1;) {
+                keys[i] = keys[i] - keys[i - 1] - encoded->delta;
+            }
+            return fscl_tofu_pack(encoded, keys + (count ? 1 : 0), count ? count - 1 : 0) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+
+        case TOFU_ENCODING_DELTA_OF_DELTA:
+            encoded->base = count ? keys[0] : 0;
+            encoded->delta = count > 1 ? keys[1] - keys[0] : 0;
+            encoded->width = fscl_tofu_bit_width(stats->second_maximum);
+            for (size_t i = count; i-- > 2;) {
+                keys[i] = fscl_tofu_zigzag((keys[i] - keys[i - 1]) - (keys[i - 1] - keys[i - 2]));
+            }
+            return fscl_tofu_pack(encoded, keys + (count > 2 ? 2 : 0), count > 2 ? count - 2 : 0) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+
+        case TOFU_ENCODING_NARROW:
+            // Lanes hold the value itself, two's complement for signed types
+            encoded->width = fscl_tofu_narrow_width(encoded->type, stats->minimum, stats->maximum);
+            if (fscl_tofu_narrow_signed(encoded->type)) {
+                for (size_t i = 0; i < count; ++i) {
+                    keys[i] ^= FSCL_TOFU_SIGN_BIT;
+                    if (encoded->width < 64) {
+                        keys[i] &= ((uint64_t)1 << encoded->width) - 1;
+                    }
+                }
+            }
+            return fscl_tofu_pack(encoded, keys, count) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+
+        case TOFU_ENCODING_RUN_LENGTH:
+            encoded->run_keys = (uint64_t*)malloc((stats->runs ? stats->runs : 1) * sizeof(uint64_t));
+            encoded->run_ends = (size_t*)malloc((stats->runs ? stats->runs : 1) * sizeof(size_t));
+            if (encoded->run_keys == NULL || encoded->run_ends == NULL) {
+                return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (i == 0 || keys[i] != keys[i - 1]) {
+                    encoded->run_keys[encoded->runs++] = keys[i];
+                }
+                encoded->run_ends[encoded->runs - 1] = i + 1;
+            }
+            return FSCL_TOFU_ERROR_OK;
+
+        default:
+            return FSCL_TOFU_ERROR_INVALID_OPERATION;
+    }
+}
+
+ctofu_error fscl_tofu_encode(const ctofu* array, ctofu_encoding encoding, ctofu_encoded** result) {
+    if (array == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    *result = NULL;
+
+    if (array->type != TOFU_ARRAY_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    size_t count = array->data.array_type.size;
+    const ctofu* elements = array->data.array_type.elements;
+
+    if (count > 0 && elements == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    ctofu_type type = count ? elements[0].type : TOFU_UNKNOWN_TYPE;
+    if (count > 0 && !fscl_tofu_encode_supported(type)) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+    for (size_t i = 1; i < count; ++i) {
+        if (elements[i].type != type) {
+            return fscl_tofu_error(FSCL_TOFU_ERROR_TYPE_MISMATCH);
+        }
+    }
+
+    bool strings = type == TOFU_STRING_TYPE;
+    if ((strings && (encoding != TOFU_ENCODING_AUTO && encoding != TOFU_ENCODING_DICTIONARY && encoding != TOFU_ENCODING_RUN_LENGTH)) ||
+        (!strings && encoding == TOFU_ENCODING_DICTIONARY) || encoding > TOFU_ENCODING_NARROW ||
+        (encoding == TOFU_ENCODING_NARROW && count > 0 && !fscl_tofu_narrow_supported(type))) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    ctofu_encoded* encoded = (ctofu_encoded*)calloc(1, sizeof(ctofu_encoded));
+    uint64_t* keys = (uint64_t*)malloc((count ? count : 1) * sizeof(uint64_t));
+    if (encoded == NULL || keys == NULL) {
+        free(encoded);
+        free(keys);
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    encoded->type = type;
+    encoded->size = count;
+
+    ctofu_error error = FSCL_TOFU_ERROR_OK;
+    if (strings) {
+        error = fscl_tofu_encode_dictionary(encoded, elements, keys);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            keys[i] = fscl_tofu_encode_key(&elements[i]);
+        }
+    }
+
+    if (error == FSCL_TOFU_ERROR_OK) {
+        ctofu_encode_stats stats;
+        fscl_tofu_encode_measure(keys, count, &stats);
+
+        if (encoding == TOFU_ENCODING_AUTO) {
+            static const ctofu_encoding numeric[] = {
+                TOFU_ENCODING_PACKED, TOFU_ENCODING_DELTA, TOFU_ENCODING_DELTA_OF_DELTA, TOFU_ENCODING_RUN_LENGTH
+            };
+            static const ctofu_encoding text[] = { TOFU_ENCODING_DICTIONARY, TOFU_ENCODING_RUN_LENGTH };
+            const ctofu_encoding* candidates = strings ? text : numeric;
+            size_t candidate_count = strings ? 2 : 4;
+
+            // Ties go to the earlier candidate, which decodes faster
+            encoding = candidates[0];
+            for (size_t i = 1; i < candidate_count; ++i) {
+                if (fscl_tofu_encode_cost(&stats, count, candidates[i]) < fscl_tofu_encode_cost(&stats, count, encoding)) {
+                    encoding = candidates[i];
+                }
+            }
+        } else if (encoding == TOFU_ENCODING_DELTA && !stats.sorted) {
+            error = FSCL_TOFU_ERROR_INVALID_OPERATION;
+        }
+
+        if (error == FSCL_TOFU_ERROR_OK) {
+            encoded->encoding = encoding;
+            error = fscl_tofu_encode_keys(encoded, keys, &stats);
+        }
+    }
+
+    free(keys);
+
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_encoded_erase(encoded);
+        return fscl_tofu_error(error);
+    }
+
+    *result = encoded;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_narrow(const ctofu* array, ctofu_encoded** result) {
+    return fscl_tofu_encode(array, TOFU_ENCODING_NARROW, result);
+}
+
+ctofu_error fscl_tofu_decode(const ctofu_encoded* encoded, ctofu* array) {
+    if (encoded == NULL || array == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    ctofu* elements = NULL;
+    if (encoded->size > 0) {
+        elements = (ctofu*)malloc(encoded->size * sizeof(ctofu));
+        if (elements == NULL) {
+            return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+    }
+
+    ctofu_encoded_iterator iterator = fscl_tofu_encoded_iterator_start(encoded);
+    for (size_t i = 0; i < encoded->size; ++i) {
+        fscl_tofu_encoded_next(&iterator, &elements[i]);
+        if (encoded->type == TOFU_STRING_TYPE && elements[i].data.string_type != NULL) {
+            // Decoded strings own their text, the dictionary stays with the encoded array
+            const char* text = elements[i].data.string_type;
+            if (fscl_tofu_string_store(&elements[i], text, strlen(text)) != FSCL_TOFU_ERROR_OK) {
+                ctofu partial;
+                memset(&partial, 0, sizeof(partial));
+                partial.type = TOFU_ARRAY_TYPE;
+                partial.data.array_type.elements = elements;
+                partial.data.array_type.size = i;
+                fscl_tofu_value_erase(&partial);
+                return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+            }
+        }
+    }
+
+    memset(array, 0, sizeof(*array));
+    array->type = TOFU_ARRAY_TYPE;
+    array->data.array_type.elements = elements;
+    array->data.array_type.size = encoded->size;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+void fscl_tofu_encoded_erase(ctofu_encoded* encoded) {
+    if (encoded == NULL) {
+        return;
+    }
+
+    // Dictionary strings come from fscl_tofu_strdup, which records them
+    for (size_t i = 0; i < encoded->dictionary_size; ++i) {
+        fscl_tofu_account_free(encoded->dictionary[i]);
+        free(encoded->dictionary[i]);
+    }
+    free(encoded->dictionary);
+    free(encoded->words);
+    free(encoded->run_keys);
+    free(encoded->run_ends);
+    free(encoded);
+}
+
+// =======================
+// ACCESS FUNCTIONS
+// =======================
+
+ctofu_encoding fscl_tofu_encoded_kind(const ctofu_encoded* encoded) {
+    return encoded ? encoded->encoding : TOFU_ENCODING_AUTO;
+}
+
+ctofu_type fscl_tofu_encoded_type(const ctofu_encoded* encoded) {
+    return encoded ? encoded->type : TOFU_INVALID_TYPE;
+}
+
+size_t fscl_tofu_encoded_size(const ctofu_encoded* encoded) {
+    return encoded ? encoded->size : 0;
+}
+
+unsigned fscl_tofu_encoded_width(const ctofu_encoded* encoded) {
+    if (encoded == NULL) {
+        return 0;
+    }
+    return encoded->encoding == TOFU_ENCODING_RUN_LENGTH ? 64 : encoded->width;
+}
+
+size_t fscl_tofu_encoded_bytes(const ctofu_encoded* encoded) {
+    if (encoded == NULL) {
+        return 0;
+    }
+
+    size_t bytes = sizeof(ctofu_encoded);
+    switch (encoded->encoding) {
+        case TOFU_ENCODING_PACKED:
+        case TOFU_ENCODING_DICTIONARY:
+        case TOFU_ENCODING_NARROW:
+            bytes += fscl_tofu_packed_words(encoded->size, encoded->width) * sizeof(uint64_t);
+            break;
+        case TOFU_ENCODING_DELTA:
+            bytes += fscl_tofu_packed_words(encoded->size ? encoded->size - 1 : 0, encoded->width) * sizeof(uint64_t);
+            break;
+        case TOFU_ENCODING_DELTA_OF_DELTA:
+            bytes += fscl_tofu_packed_words(encoded->size > 2 ? encoded->size - 2 : 0, encoded->width) * sizeof(uint64_t);
+            break;
+        case TOFU_ENCODING_RUN_LENGTH:
+            bytes += encoded->runs * (sizeof(uint64_t) + sizeof(size_t));
+            break;
+        default:
+            break;
+    }
+
+    bytes += encoded->dictionary_size * sizeof(char*);
+    for (size_t i = 0; i < encoded->dictionary_size; ++i) {
+        bytes += encoded->dictionary[i] ? strlen(encoded->dictionary[i]) + 1 : 0;
+    }
+    return bytes;
+}
+
+// Index of the run holding an element, by binary search over the run ends
+static size_t fscl_tofu_encoded_run(const ctofu_encoded* encoded, size_t index) {
+    size_t low = 0;
+    size_t high = encoded->runs - 1;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (encoded->run_ends[middle] > index) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+ctofu_error fscl_tofu_encoded_get(const ctofu_encoded* encoded, size_t index, ctofu* value) {
+    if (encoded == NULL || value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    if (index >= encoded->size) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS);
+    }
+
+    switch (encoded->encoding) {
+        case TOFU_ENCODING_PACKED:
+        case TOFU_ENCODING_DICTIONARY:
+            fscl_tofu_encode_value(encoded, encoded->base + fscl_tofu_unpack(encoded->words, encoded->width, index), value);
+            break;
+        case TOFU_ENCODING_NARROW:
+            fscl_tofu_encode_value(encoded, fscl_tofu_narrow_key(encoded, fscl_tofu_unpack(encoded->words, encoded->width, index)), value);
+            break;
+        case TOFU_ENCODING_RUN_LENGTH:
+            fscl_tofu_encode_value(encoded, encoded->run_keys[fscl_tofu_encoded_run(encoded, index)], value);
+            break;
+        default: {
+            // Delta encodings only decode front to back
+            ctofu_encoded_iterator iterator = fscl_tofu_encoded_iterator_start(encoded);
+            for (size_t i = 0; i <= index; ++i) {
+                fscl_tofu_encoded_next(&iterator, value);
+            }
+            break;
+        }
+    }
+
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_encoded_iterator fscl_tofu_encoded_iterator_start(const ctofu_encoded* encoded) {
+    ctofu_encoded_iterator iterator;
+    memset(&iterator, 0, sizeof(iterator));
+    iterator.source = encoded;
+    return iterator;
+}
+
+// Advances the iterator and returns the key of the element it passed
+static uint64_t fscl_tofu_encoded_step(ctofu_encoded_iterator* iterator) {
+    const ctofu_encoded* encoded = iterator->source;
+    size_t index = iterator->index++;
+
+    switch (encoded->encoding) {
+        case TOFU_ENCODING_DELTA:
+            if (index == 0) {
+                iterator->key = encoded->base;
+            } else {
+                iterator->key += encoded->delta + fscl_tofu_unpack(encoded->words, encoded->width, index - 1);
+            }
+            return iterator->key;
+
+        case TOFU_ENCODING_DELTA_OF_DELTA:
+            if (index == 0) {
+                iterator->key = encoded->base;
+                return iterator->key;
+            }
+            if (index == 1) {
+                iterator->delta = encoded->delta;
+            } else {
+                iterator->delta += fscl_tofu_unzigzag(fscl_tofu_unpack(encoded->words, encoded->width, index - 2));
+            }
+            iterator->key += iterator->delta;
+            return iterator->key;
+
+        case TOFU_ENCODING_RUN_LENGTH:
+            while (encoded->run_ends[iterator->run] <= index) {
+                iterator->run++;
+            }
+            return encoded->run_keys[iterator->run];
+
+        case TOFU_ENCODING_NARROW:
+            return fscl_tofu_narrow_key(encoded, fscl_tofu_unpack(encoded->words, encoded->width, index));
+
+        default:
+            return encoded->base + fscl_tofu_unpack(encoded->words, encoded->width, index);
+    }
+}
+
+bool fscl_tofu_encoded_next(ctofu_encoded_iterator* iterator, ctofu* value) {
+    if (iterator == NULL || iterator->source == NULL || value == NULL || iterator->index >= iterator->source->size) {
+        return false;
+    }
+
+    fscl_tofu_encode_value(iterator->source, fscl_tofu_encoded_step(iterator), value);
+    return true;
+}
+
+// =======================
+// ALGORITHM FUNCTIONS
+// =======================
+
+static double fscl_tofu_encoded_real(const ctofu_encoded* encoded, uint64_t key) {
+    ctofu value;
+    fscl_tofu_encode_value(encoded, key, &value);
+    return encoded->type == TOFU_FLOAT_TYPE ? (double)value.data.float_type : value.data.double_type;
+}
+
+ctofu_error fscl_tofu_encoded_accumulate(const ctofu_encoded* encoded, ctofu* result) {
+    if (encoded == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    if (encoded->size == 0) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    if (encoded->type == TOFU_STRING_TYPE || encoded->type == TOFU_NULLPTR_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    memset(result, 0, sizeof(*result));
+
+    if (encoded->type == TOFU_DOUBLE_TYPE || encoded->type == TOFU_FLOAT_TYPE) {
+        double total = 0.0;
+
+        if (encoded->encoding == TOFU_ENCODING_RUN_LENGTH) {
+            for (size_t run = 0, start = 0; run < encoded->runs; start = encoded->run_ends[run++]) {
+                total += fscl_tofu_encoded_real(encoded, encoded->run_keys[run]) * (double)(encoded->run_ends[run] - start);
+            }
+        } else {
+            ctofu_encoded_iterator iterator = fscl_tofu_encoded_iterator_start(encoded);
+            while (iterator.index < encoded->size) {
+                total += fscl_tofu_encoded_real(encoded, fscl_tofu_encoded_step(&iterator));
+            }
+        }
+
+        result->type = TOFU_DOUBLE_TYPE;
+        result->data.double_type = total;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    // Integer keys are summed modulo 2^64 without decoding
+    uint64_t total = 0;
+    switch (encoded->encoding) {
+        case TOFU_ENCODING_PACKED:
+            total = encoded->base * (uint64_t)encoded->size + fscl_tofu_packed_sum(encoded->words, encoded->width, encoded->size);
+            break;
+        case TOFU_ENCODING_NARROW:
+            if (!fscl_tofu_narrow_signed(encoded->type)) {
+                total = fscl_tofu_packed_sum(encoded->words, encoded->width, encoded->size);
+            } else {
+                for (size_t i = 0; i < encoded->size; ++i) {
+                    total += fscl_tofu_narrow_key(encoded, fscl_tofu_unpack(encoded->words, encoded->width, i));
+                }
+            }
+            break;
+        case TOFU_ENCODING_RUN_LENGTH:
+            for (size_t run = 0, start = 0; run < encoded->runs; start = encoded->run_ends[run++]) {
+                total += encoded->run_keys[run] * (uint64_t)(encoded->run_ends[run] - start);
+            }
+            break;
+        default: {
+            ctofu_encoded_iterator iterator = fscl_tofu_encoded_iterator_start(encoded);
+            while (iterator.index < encoded->size) {
+                total += fscl_tofu_encoded_step(&iterator);
+            }
+            break;
+        }
+    }
+
+    if (encoded->type == TOFU_INT_TYPE || encoded->type == TOFU_FIXED_TYPE) {
+        // Every key carries the flipped sign bit once
+        result->type = TOFU_INT_TYPE;
+        result->data.int_type = (int64_t)(total - ((uint64_t)(encoded->size & 1) << 63));
+    } else {
+        result->type = TOFU_UINT_TYPE;
+        result->data.uint_type = total;
+    }
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+// Finds the first element whose key equals target
+static bool fscl_tofu_encoded_find(const ctofu_encoded* encoded, uint64_t target, size_t* index) {
+    switch (encoded->encoding) {
+        case TOFU_ENCODING_PACKED:
+        case TOFU_ENCODING_DICTIONARY:
+            if (target < encoded->base || (encoded->width < 64 && (target - encoded->base) >> encoded->width != 0)) {
+                return false;
+            }
+            return fscl_tofu_packed_find(encoded->words, encoded->width, encoded->size, target - encoded->base, index);
+
+        case TOFU_ENCODING_NARROW:
+            if (encoded->width < 64) {
+                uint64_t lane = target;
+                if (fscl_tofu_narrow_signed(encoded->type)) {
+                    // Out of range keys cannot be stored, in range ones keep their low bits
+                    lane = target ^ FSCL_TOFU_SIGN_BIT;
+                    if (fscl_tofu_narrow_key(encoded, lane & (((uint64_t)1 << encoded->width) - 1)) != target) {
+                        return false;
+                    }
+                    lane &= ((uint64_t)1 << encoded->width) - 1;
+                } else if (target >> encoded->width != 0) {
+                    return false;
+                }
+                return fscl_tofu_packed_find(encoded->words, encoded->width, encoded->size, lane, index);
+            }
+            return fscl_tofu_packed_find(encoded->words, encoded->width, encoded->size,
+                                         fscl_tofu_narrow_signed(encoded->type) ? target ^ FSCL_TOFU_SIGN_BIT : target, index);
+
+        case TOFU_ENCODING_RUN_LENGTH:
+            for (size_t run = 0; run < encoded->runs; ++run) {
+                if (encoded->run_keys[run] == target) {
+                    *index = run == 0 ? 0 : encoded->run_ends[run - 1];
+                    return true;
+                }
+            }
+            return false;
+
+        default: {
+            ctofu_encoded_iterator iterator = fscl_tofu_encoded_iterator_start(encoded);
+            while (iterator.index < encoded->size) {
+                uint64_t key = fscl_tofu_encoded_step(&iterator);
+                if (key == target) {
+                    *index = iterator.index - 1;
+                    return true;
+                }
+                // Delta arrays are sorted, nothing further can match
+                if (encoded->encoding == TOFU_ENCODING_DELTA && key > target) {
+                    return false;
+                }
+            }
+            return false;
+        }
+    }
+}
+
+ctofu_error fscl_tofu_encoded_search(const ctofu_encoded* encoded, const ctofu* key, size_t* index) {
+    if (encoded == NULL || key == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    if (encoded->size > 0 && key->type != encoded->type) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    size_t found = SIZE_MAX;
+    size_t at = 0;
+
+    if (encoded->size == 0) {
+        // Nothing to find
+    } else if (encoded->type == TOFU_STRING_TYPE) {
+        for (size_t code = 0; code < encoded->dictionary_size; ++code) {
+            if (fscl_tofu_encode_same(encoded->dictionary[code], fscl_tofu_string_data(key))) {
+                if (fscl_tofu_encoded_find(encoded, code, &at)) {
+                    found = at;
+                }
+                break;
+            }
+        }
+    } else if ((encoded->type == TOFU_DOUBLE_TYPE && key->data.double_type == 0.0) ||
+               (encoded->type == TOFU_FLOAT_TYPE && key->data.float_type == 0.0f)) {
+        // Positive and negative zero compare equal but have different bits
+        ctofu zero = *key;
+        for (int sign = 0; sign < 2; ++sign) {
+            if (encoded->type == TOFU_DOUBLE_TYPE) {
+                zero.data.double_type = sign ? -0.0 : 0.0;
+            } else {
+                zero.data.float_type = sign ? -0.0f : 0.0f;
+            }
+            if (fscl_tofu_encoded_find(encoded, fscl_tofu_encode_key(&zero), &at) && at < found) {
+                found = at;
+            }
+        }
+    } else if ((encoded->type == TOFU_DOUBLE_TYPE && key->data.double_type != key->data.double_type) ||
+               (encoded->type == TOFU_FLOAT_TYPE && key->data.float_type != key->data.float_type)) {
+        // NaN never compares equal
+    } else if (fscl_tofu_encoded_find(encoded, fscl_tofu_encode_key(key), &at)) {
+        found = at;
+    }
+
+    if (found == SIZE_MAX) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_TYPE_MISMATCH);  // Key not found
+    }
+
+    if (index != NULL) {
+        *index = found;
+    }
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_encoded_filter(const ctofu_encoded* encoded, bool (*filterFunc)(const ctofu_data*), ctofu* result) {
+    if (encoded == NULL || filterFunc == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    ctofu* elements = (ctofu*)malloc((encoded->size ? encoded->size : 1) * sizeof(ctofu));
+    bool* accepted = NULL;
+    if (elements == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    ctofu value;
+    size_t count = 0;
+
+    if (encoded->type == TOFU_STRING_TYPE) {
+        // One call per distinct string
+        accepted = (bool*)malloc((encoded->dictionary_size ? encoded->dictionary_size : 1) * sizeof(bool));
+        if (accepted == NULL) {
+            free(elements);
+            return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        for (size_t code = 0; code < encoded->dictionary_size; ++code) {
+            fscl_tofu_encode_value(encoded, code, &value);
+            accepted[code] = filterFunc(&value.data);
+        }
+    }
+
+    if (encoded->encoding == TOFU_ENCODING_RUN_LENGTH) {
+        // One call per run
+        for (size_t run = 0, start = 0; run < encoded->runs; start = encoded->run_ends[run++]) {
+            fscl_tofu_encode_value(encoded, encoded->run_keys[run], &value);
+            if (accepted ? accepted[encoded->run_keys[run]] : filterFunc(&value.data)) {
+                for (size_t i = start; i < encoded->run_ends[run]; ++i) {
+                    elements[count++] = value;
+                }
+            }
+        }
+    } else {
+        ctofu_encoded_iterator iterator = fscl_tofu_encoded_iterator_start(encoded);
+        while (iterator.index < encoded->size) {
+            uint64_t key = fscl_tofu_encoded_step(&iterator);
+            fscl_tofu_encode_value(encoded, key, &value);
+            if (accepted ? accepted[key] : filterFunc(&value.data)) {
+                elements[count++] = value;
+            }
+        }
+    }
+
+    free(accepted);
+
+    // Strings were borrowed from the dictionary, give the result its own copies
+    ctofu_error error = FSCL_TOFU_ERROR_OK;
+    if (encoded->type == TOFU_STRING_TYPE) {
+        for (size_t i = 0; i < count; ++i) {
+            if (elements[i].data.string_type == NULL) {
+                continue;
+            }
+            const char* text = elements[i].data.string_type;
+            if (fscl_tofu_string_store(&elements[i], text, strlen(text)) != FSCL_TOFU_ERROR_OK) {
+                for (size_t j = 0; j < i; ++j) {
+                    fscl_tofu_value_erase(&elements[j]);
+                }
+                error = FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+                break;
+            }
+        }
+    }
+
+    if (error != FSCL_TOFU_ERROR_OK) {
+        free(elements);
+        return fscl_tofu_error(error);
+    }
+
+    if (count == 0) {
+        free(elements);
+        elements = NULL;
+    } else if (count < encoded->size) {
+        ctofu* shrunk = (ctofu*)realloc(elements, count * sizeof(ctofu));
+        if (shrunk != NULL) {
+            elements = shrunk;
+        }
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->type = TOFU_ARRAY_TYPE;
+    result->data.array_type.elements = elements;
+    result->data.array_type.size = count;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
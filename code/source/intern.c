@@ -0,0 +1,259 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/intern.h"
+#include "xtofu_internal.h"
+#include "xtofu_sync.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =======================
+// POOL STORAGE
+// =======================
+
+#define FSCL_TOFU_INTERN_SHARD_BITS 6
+#define FSCL_TOFU_INTERN_SHARDS (1u << FSCL_TOFU_INTERN_SHARD_BITS)
+#define FSCL_TOFU_INTERN_MIN_BUCKETS 16
+
+typedef struct ctofu_intern_entry {
+    struct ctofu_intern_entry* next;  ///< Next entry of the same bucket.
+    uint64_t hash;                    ///< Cached hash of the text.
+    size_t length;                    ///< Length of the text.
+    atomic_size_t references;         ///< Number of live handles.
+    char text[];                      ///< NUL terminated text, the handle points here.
+} ctofu_intern_entry;
+
+// Every shard owns its own lock and chained table, picked by the top hash bits
+typedef struct {
+    ctofu_mutex lock;
+    ctofu_intern_entry** buckets;
+    size_t capacity;
+    size_t count;
+} ctofu_intern_shard;
+
+static ctofu_intern_shard fscl_tofu_intern_shards[FSCL_TOFU_INTERN_SHARDS];
+static ctofu_once fscl_tofu_intern_ready = FSCL_TOFU_ONCE_INIT;
+static atomic_bool fscl_tofu_intern_active = false;
+
+static void fscl_tofu_intern_setup(void) {
+    for (size_t i = 0; i < FSCL_TOFU_INTERN_SHARDS; ++i) {
+        fscl_tofu_mutex_init(&fscl_tofu_intern_shards[i].lock);
+    }
+}
+
+static inline ctofu_intern_shard* fscl_tofu_intern_shard(uint64_t hash) {
+    fscl_tofu_once(&fscl_tofu_intern_ready, fscl_tofu_intern_setup);
+    return &fscl_tofu_intern_shards[hash >> (64 - FSCL_TOFU_INTERN_SHARD_BITS)];
+}
+
+static inline ctofu_intern_entry* fscl_tofu_intern_entry(const char* handle) {
+    return (ctofu_intern_entry*)(void*)(handle - offsetof(ctofu_intern_entry, text));
+}
+
+// Doubles the bucket array of a locked shard, returns false when out of memory
+static bool fscl_tofu_intern_grow(ctofu_intern_shard* shard) {
+    size_t capacity = shard->capacity ? shard->capacity * 2 : FSCL_TOFU_INTERN_MIN_BUCKETS;
+    ctofu_intern_entry** buckets = (ctofu_intern_entry**)calloc(capacity, sizeof(ctofu_intern_entry*));
+    if (buckets == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < shard->capacity; ++i) {
+        ctofu_intern_entry* entry = shard->buckets[i];
+        while (entry != NULL) {
+            ctofu_intern_entry* next = entry->next;
+            size_t bucket = (size_t)entry->hash & (capacity - 1);
+            entry->next = buckets[bucket];
+            buckets[bucket] = entry;
+            entry = next;
+        }
+    }
+
+    free(shard->buckets);
+    shard->buckets = buckets;
+    shard->capacity = capacity;
+    return true;
+}
+
+// =======================
+// POOL FUNCTIONS
+// =======================
+
+void fscl_tofu_intern_enable(bool enabled) {
+    atomic_store_explicit(&fscl_tofu_intern_active, enabled, memory_order_relaxed);
+}
+
+bool fscl_tofu_intern_enabled(void) {
+    return atomic_load_explicit(&fscl_tofu_intern_active, memory_order_relaxed);
+}
+
+size_t fscl_tofu_intern_count(void) {
+    fscl_tofu_once(&fscl_tofu_intern_ready, fscl_tofu_intern_setup);
+
+    size_t count = 0;
+    for (size_t i = 0; i < FSCL_TOFU_INTERN_SHARDS; ++i) {
+        fscl_tofu_mutex_lock(&fscl_tofu_intern_shards[i].lock);
+        count += fscl_tofu_intern_shards[i].count;
+        fscl_tofu_mutex_unlock(&fscl_tofu_intern_shards[i].lock);
+    }
+    return count;
+}
+
+// =======================
+// HANDLE FUNCTIONS
+// =======================
+
+const char* fscl_tofu_intern_acquire(const char* text, size_t length) {
+    if (text == NULL) {
+        return NULL;
+    }
+
+    uint64_t hash = fscl_tofu_hash_bytes(text, length);
+    ctofu_intern_shard* shard = fscl_tofu_intern_shard(hash);
+
+    fscl_tofu_mutex_lock(&shard->lock);
+
+    if (shard->capacity != 0) {
+        // References only ever rise from zero under the shard lock, so a
+        // string found here cannot be freed before the new reference lands
+        for (ctofu_intern_entry* entry = shard->buckets[(size_t)hash & (shard->capacity - 1)]; entry != NULL; entry = entry->next) {
+            if (entry->hash == hash && entry->length == length && memcmp(entry->text, text, length) == 0) {
+                atomic_fetch_add_explicit(&entry->references, 1, memory_order_relaxed);
+                fscl_tofu_mutex_unlock(&shard->lock);
+                return entry->text;
+            }
+        }
+    }
+
+    if (shard->count >= shard->capacity && !fscl_tofu_intern_grow(shard)) {
+        fscl_tofu_mutex_unlock(&shard->lock);
+        return NULL;
+    }
+
+    ctofu_intern_entry* entry = (ctofu_intern_entry*)malloc(sizeof(ctofu_intern_entry) + length + 1);
+    if (entry == NULL) {
+        fscl_tofu_mutex_unlock(&shard->lock);
+        return NULL;
+    }
+
+    entry->hash = hash;
+    entry->length = length;
+    atomic_init(&entry->references, 1);
+    memcpy(entry->text, text, length);
+    entry->text[length] = '\0';
+
+    size_t bucket = (size_t)hash & (shard->capacity - 1);
+    entry->next = shard->buckets[bucket];
+    shard->buckets[bucket] = entry;
+    ++shard->count;
+
+    fscl_tofu_mutex_unlock(&shard->lock);
+    return entry->text;
+}
+
+void fscl_tofu_intern_retain(const char* handle) {
+    if (handle != NULL) {
+        atomic_fetch_add_explicit(&fscl_tofu_intern_entry(handle)->references, 1, memory_order_relaxed);
+    }
+}
+
+void fscl_tofu_intern_release(const char* handle) {
+    if (handle == NULL) {
+        return;
+    }
+
+    ctofu_intern_entry* entry = fscl_tofu_intern_entry(handle);
+
+    // Dropping a reference that is not the last one needs no lock
+    size_t references = atomic_load_explicit(&entry->references, memory_order_relaxed);
+    while (references > 1) {
+        if (atomic_compare_exchange_weak_explicit(&entry->references, &references, references - 1,
+                                                  memory_order_release, memory_order_relaxed)) {
+            return;
+        }
+    }
+
+    // The last reference may race with a lookup, so settle it under the lock
+    ctofu_intern_shard* shard = fscl_tofu_intern_shard(entry->hash);
+    fscl_tofu_mutex_lock(&shard->lock);
+
+    if (atomic_fetch_sub_explicit(&entry->references, 1, memory_order_acq_rel) == 1) {
+        ctofu_intern_entry** link = &shard->buckets[(size_t)entry->hash & (shard->capacity - 1)];
+        while (*link != entry) {
+            link = &(*link)->next;
+        }
+        *link = entry->next;
+        --shard->count;
+        free(entry);
+    }
+
+    fscl_tofu_mutex_unlock(&shard->lock);
+}
+
+size_t fscl_tofu_intern_length(const char* handle) {
+    return handle != NULL ? fscl_tofu_intern_entry(handle)->length : 0;
+}
+
+uint64_t fscl_tofu_intern_hash(const char* handle) {
+    return handle != NULL ? fscl_tofu_intern_entry(handle)->hash : 0;
+}
+
+// =======================
+// VALUE FUNCTIONS
+// =======================
+
+ctofu_error fscl_tofu_intern_string(ctofu* value, const char* text) {
+    if (value == NULL || text == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    const char* handle = fscl_tofu_intern_acquire(text, strlen(text));
+    if (handle == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    value->type = TOFU_STRING_TYPE;
+    value->flags = TOFU_FLAG_INTERNED;
+    value->data.string_type = (char*)handle;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_intern(ctofu* value) {
+    if (value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (value->type != TOFU_STRING_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_TYPE_MISMATCH);
+    }
+    if (fscl_tofu_string_data(value) == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (value->flags & TOFU_FLAG_INTERNED) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    const char* handle = fscl_tofu_intern_acquire(fscl_tofu_string_data(value), fscl_tofu_string_length(value));
+    if (handle == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    if (value->flags & TOFU_FLAG_SHARED) {
+        fscl_tofu_shared_release(value);
+    } else if (!(value->flags & TOFU_FLAG_INLINE)) {
+        fscl_tofu_slab_free(value->data.string_type);
+    }
+    value->flags = TOFU_FLAG_INTERNED;
+    value->data.string_type = (char*)handle;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
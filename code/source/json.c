@@ -0,0 +1,937 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/json.h"
+#include "xtofu_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef enum {
+    TOFU_JSON_STATE_VALUE,          ///< Expecting any value.
+    TOFU_JSON_STATE_ARRAY_FIRST,    ///< Just after '[', expecting a value or ']'.
+    TOFU_JSON_STATE_OBJECT_FIRST,   ///< Just after '{', expecting a key or '}'.
+    TOFU_JSON_STATE_KEY,            ///< Just after ',' in an object, expecting a key.
+    TOFU_JSON_STATE_COLON,          ///< Expecting ':' after a key.
+    TOFU_JSON_STATE_AFTER_VALUE,    ///< Expecting ',' or the end of the container.
+    TOFU_JSON_STATE_STRING,         ///< Inside a string.
+    TOFU_JSON_STATE_ESCAPE,         ///< Just after a backslash inside a string.
+    TOFU_JSON_STATE_UNICODE,        ///< Inside a \uXXXX escape.
+    TOFU_JSON_STATE_NUMBER,         ///< Inside a number.
+    TOFU_JSON_STATE_LITERAL,        ///< Inside true, false or null.
+    TOFU_JSON_STATE_DONE,           ///< The document is complete.
+    TOFU_JSON_STATE_FAILED          ///< A previous chunk was malformed.
+} ctofu_json_state;
+
+typedef struct {
+    bool object;    ///< True for objects, false for arrays.
+    size_t base;    ///< Index of the first element on the value stack.
+} ctofu_json_frame;
+
+struct ctofu_json_parser {
+    ctofu_json_state state;
+
+    // Open containers
+    ctofu_json_frame* frames;
+    size_t depth;
+    size_t frame_capacity;
+
+    // Scratch stack of finished values waiting for their container to close,
+    // reused across containers so each container is allocated exactly once.
+    ctofu* values;
+    size_t count;
+    size_t value_capacity;
+
+    // Bytes of the string or number currently being read
+    char* token;
+    size_t token_length;
+    size_t token_capacity;
+
+    bool string_is_key;
+    uint32_t unicode;
+    int unicode_digits;
+    uint32_t high_surrogate;
+
+    const char* literal;
+    size_t literal_index;
+    ctofu literal_value;
+
+    ctofu root;
+    bool has_root;   ///< root holds a parsed document not yet handed out.
+};
+
+// =======================
+// SCANNING HELPERS
+// =======================
+
+// Finds the first byte that ends a run of plain string content: a quote,
+// a backslash or a control character. Sixteen bytes are classified at a
+// time when SSE2 is available.
+static const char* fscl_tofu_json_scan_string(const char* cursor, const char* end) {
+#ifdef FSCL_TOFU_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+
+    while (end - cursor >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)cursor);
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+
+        unsigned mask = (unsigned)_mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return cursor + fscl_tofu_ctz(mask);
+        }
+        cursor += 16;
+    }
+#endif
+
+    while (cursor < end) {
+        unsigned char c = (unsigned char)*cursor;
+        if (c == '"' || c == '\\' || c < 0x20) {
+            return cursor;
+        }
+        ++cursor;
+    }
+
+    return end;
+}
+
+static inline bool fscl_tofu_json_is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline bool fscl_tofu_json_is_number_char(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static int fscl_tofu_json_hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// =======================
+// SCRATCH STORAGE
+// =======================
+
+static bool fscl_tofu_json_token_put(ctofu_json_parser* parser, const char* bytes, size_t length) {
+    // Keep room for a NUL so numbers can be handed to strtod in place
+    if (parser->token_length + length + 1 > parser->token_capacity) {
+        size_t capacity = parser->token_capacity ? parser->token_capacity : 64;
+        while (parser->token_length + length + 1 > capacity) {
+            capacity *= 2;
+        }
+
+        char* token = (char*)realloc(parser->token, capacity);
+        if (token == NULL) {
+            return false;
+        }
+        parser->token = token;
+        parser->token_capacity = capacity;
+    }
+
+    memcpy(parser->token + parser->token_length, bytes, length);
+    parser->token_length += length;
+    parser->token[parser->token_length] = '\0';
+    return true;
+}
+
+static bool fscl_tofu_json_token_codepoint(ctofu_json_parser* parser, uint32_t code) {
+    char bytes[4];
+    size_t length;
+
+    if (code < 0x80) {
+        bytes[0] = (char)code;
+        length = 1;
+    } else if (code < 0x800) {
+        bytes[0] = (char)(0xC0 | (code >> 6));
+        bytes[1] = (char)(0x80 | (code & 0x3F));
+        length = 2;
+    } else if (code < 0x10000) {
+        bytes[0] = (char)(0xE0 | (code >> 12));
+        bytes[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        bytes[2] = (char)(0x80 | (code & 0x3F));
+        length = 3;
+    } else {
+        bytes[0] = (char)(0xF0 | (code >> 18));
+        bytes[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+        bytes[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+        bytes[3] = (char)(0x80 | (code & 0x3F));
+        length = 4;
+    }
+
+    return fscl_tofu_json_token_put(parser, bytes, length);
+}
+
+// A high surrogate that is not followed by a low one becomes U+FFFD
+static bool fscl_tofu_json_flush_surrogate(ctofu_json_parser* parser) {
+    if (parser->high_surrogate == 0) {
+        return true;
+    }
+
+    parser->high_surrogate = 0;
+    return fscl_tofu_json_token_codepoint(parser, 0xFFFD);
+}
+
+static bool fscl_tofu_json_push(ctofu_json_parser* parser, const ctofu* value) {
+    if (parser->count == parser->value_capacity) {
+        size_t capacity = parser->value_capacity ? parser->value_capacity * 2 : 64;
+        ctofu* values = (ctofu*)realloc(parser->values, capacity * sizeof(ctofu));
+        if (values == NULL) {
+            return false;
+        }
+        parser->values = values;
+        parser->value_capacity = capacity;
+    }
+
+    parser->values[parser->count++] = *value;
+    return true;
+}
+
+// =======================
+// VALUE CONSTRUCTION
+// =======================
+
+static ctofu_error fscl_tofu_json_fail(ctofu_json_parser* parser, ctofu_error error) {
+    parser->state = TOFU_JSON_STATE_FAILED;
+    return fscl_tofu_error(error);
+}
+
+// Hands a finished value to the enclosing container, or makes it the root
+static ctofu_error fscl_tofu_json_emit(ctofu_json_parser* parser, const ctofu* value) {
+    if (parser->depth == 0) {
+        parser->root = *value;
+        parser->has_root = true;
+        parser->state = TOFU_JSON_STATE_DONE;
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    if (!fscl_tofu_json_push(parser, value)) {
+        ctofu orphan = *value;
+        fscl_tofu_value_erase(&orphan);
+        return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    parser->state = TOFU_JSON_STATE_AFTER_VALUE;
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error fscl_tofu_json_open(ctofu_json_parser* parser, bool object) {
+    if (parser->depth == FSCL_TOFU_JSON_MAX_DEPTH) {
+        return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_BUFFER_OVERFLOW);
+    }
+
+    if (parser->depth == parser->frame_capacity) {
+        size_t capacity = parser->frame_capacity ? parser->frame_capacity * 2 : 16;
+        ctofu_json_frame* frames = (ctofu_json_frame*)realloc(parser->frames, capacity * sizeof(ctofu_json_frame));
+        if (frames == NULL) {
+            return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        parser->frames = frames;
+        parser->frame_capacity = capacity;
+    }
+
+    parser->frames[parser->depth].object = object;
+    parser->frames[parser->depth].base = parser->count;
+    parser->depth++;
+    parser->state = object ? TOFU_JSON_STATE_OBJECT_FIRST : TOFU_JSON_STATE_ARRAY_FIRST;
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error fscl_tofu_json_close(ctofu_json_parser* parser, bool object) {
+    ctofu_json_frame frame = parser->frames[parser->depth - 1];
+    if (frame.object != object) {
+        return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+    }
+
+    size_t count = parser->count - frame.base;
+    const ctofu* items = parser->values + frame.base;
+    ctofu container;
+    memset(&container, 0, sizeof(container));
+
+    if (object) {
+        size_t pairs = count / 2;
+        ctofu* keys = NULL;
+        ctofu* values = NULL;
+
+        if (pairs > 0) {
+            keys = (ctofu*)fscl_tofu_account_alloc(malloc(pairs * sizeof(ctofu)), pairs * sizeof(ctofu),
+                                                   TOFU_MAP_TYPE, FSCL_TOFU_ALLOC_OTHER);
+            values = (ctofu*)fscl_tofu_account_alloc(malloc(pairs * sizeof(ctofu)), pairs * sizeof(ctofu),
+                                                     TOFU_MAP_TYPE, FSCL_TOFU_ALLOC_OTHER);
+            if (keys == NULL || values == NULL) {
+                fscl_tofu_slab_free(keys);
+                fscl_tofu_slab_free(values);
+                return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+            }
+
+            for (size_t i = 0; i < pairs; ++i) {
+                keys[i] = items[2 * i];
+                values[i] = items[2 * i + 1];
+            }
+        }
+
+        container.type = TOFU_MAP_TYPE;
+        container.data.map_type.key = keys;
+        container.data.map_type.value = values;
+        container.data.map_type.size = pairs;
+    } else {
+        ctofu* elements = NULL;
+
+        if (count > 0) {
+            elements = (ctofu*)fscl_tofu_account_alloc(malloc(count * sizeof(ctofu)), count * sizeof(ctofu),
+                                                       TOFU_ARRAY_TYPE, FSCL_TOFU_ALLOC_OTHER);
+            if (elements == NULL) {
+                return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+            }
+            memcpy(elements, items, count * sizeof(ctofu));
+        }
+
+        container.type = TOFU_ARRAY_TYPE;
+        container.data.array_type.elements = elements;
+        container.data.array_type.size = count;
+    }
+
+    // The elements now belong to the container
+    parser->count = frame.base;
+    parser->depth--;
+    return fscl_tofu_json_emit(parser, &container);
+}
+
+static ctofu_error fscl_tofu_json_finish_string(ctofu_json_parser* parser) {
+    if (!fscl_tofu_json_flush_surrogate(parser)) {
+        return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    ctofu value;
+    memset(&value, 0, sizeof(value));
+    if (fscl_tofu_string_store(&value, parser->token_length > 0 ? parser->token : "", parser->token_length) != FSCL_TOFU_ERROR_OK) {
+        return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    parser->token_length = 0;
+
+    if (parser->string_is_key) {
+        if (!fscl_tofu_json_push(parser, &value)) {
+            fscl_tofu_value_erase(&value);
+            return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        parser->state = TOFU_JSON_STATE_COLON;
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    return fscl_tofu_json_emit(parser, &value);
+}
+
+// Converts the pending number token. Integers become INT (or UINT when they
+// only fit unsigned); decimals use an exact fast path when the significand
+// and the power of ten are both exactly representable, and fall back to
+// strtod for everything else.
+static ctofu_error fscl_tofu_json_finish_number(ctofu_json_parser* parser) {
+    const char* cursor = parser->token;
+    const char* end = parser->token + parser->token_length;
+    bool negative = false;
+    bool integral = true;
+    bool overflow = false;
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+
+    if (cursor < end && *cursor == '-') {
+        negative = true;
+        ++cursor;
+    }
+
+    // Integer part: a single zero or a digit sequence without leading zeros
+    if (cursor == end || *cursor < '0' || *cursor > '9') {
+        return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+    }
+    if (*cursor == '0' && cursor + 1 < end && cursor[1] >= '0' && cursor[1] <= '9') {
+        return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+    }
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        unsigned digit = (unsigned)(*cursor - '0');
+        if (mantissa > (UINT64_MAX - digit) / 10) {
+            overflow = true;
+        } else {
+            mantissa = mantissa * 10 + digit;
+        }
+        ++cursor;
+    }
+
+    if (cursor < end && *cursor == '.') {
+        integral = false;
+        ++cursor;
+        if (cursor == end || *cursor < '0' || *cursor > '9') {
+            return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+        }
+        while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+            unsigned digit = (unsigned)(*cursor - '0');
+            if (mantissa > (UINT64_MAX - digit) / 10) {
+                overflow = true;
+            } else {
+                mantissa = mantissa * 10 + digit;
+                --exponent;
+            }
+            ++cursor;
+        }
+    }
+
+    if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+        integral = false;
+        bool exponent_negative = false;
+        int64_t value = 0;
+
+        ++cursor;
+        if (cursor < end && (*cursor == '+' || *cursor == '-')) {
+            exponent_negative = *cursor == '-';
+            ++cursor;
+        }
+        if (cursor == end || *cursor < '0' || *cursor > '9') {
+            return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+        }
+        while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+            if (value < 100000) {
+                value = value * 10 + (*cursor - '0');
+            }
+            ++cursor;
+        }
+        exponent += exponent_negative ? -value : value;
+    }
+
+    if (cursor != end) {
+        return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+    }
+
+    ctofu value;
+    memset(&value, 0, sizeof(value));
+
+    if (integral && !overflow) {
+        if (!negative && mantissa <= (uint64_t)INT64_MAX) {
+            value.type = TOFU_INT_TYPE;
+            value.data.int_type = (int64_t)mantissa;
+        } else if (!negative) {
+            value.type = TOFU_UINT_TYPE;
+            value.data.uint_type = mantissa;
+        } else if (mantissa <= (uint64_t)INT64_MAX + 1) {
+            value.type = TOFU_INT_TYPE;
+            value.data.int_type = (int64_t)((uint64_t)0 - mantissa);
+        } else {
+            value.type = TOFU_DOUBLE_TYPE;
+            value.data.double_type = strtod(parser->token, NULL);
+        }
+    } else if (!overflow && fscl_tofu_fast_real(mantissa, exponent, negative, &value.data.double_type)) {
+        value.type = TOFU_DOUBLE_TYPE;
+    } else {
+        value.type = TOFU_DOUBLE_TYPE;
+        value.data.double_type = strtod(parser->token, NULL);
+    }
+
+    parser->token_length = 0;
+    return fscl_tofu_json_emit(parser, &value);
+}
+
+// =======================
+// READER FUNCTIONS
+// =======================
+
+ctofu_json_parser* fscl_tofu_json_parser_create(void) {
+    ctofu_json_parser* parser = (ctofu_json_parser*)calloc(1, sizeof(ctofu_json_parser));
+    if (parser == NULL) {
+        return NULL;
+    }
+
+    parser->state = TOFU_JSON_STATE_VALUE;
+    return parser;
+}
+
+// Handles a byte seen while waiting for a value (or the end of an empty container)
+static ctofu_error fscl_tofu_json_begin_value(ctofu_json_parser* parser, char c) {
+    switch (c) {
+        case '{':
+            return fscl_tofu_json_open(parser, true);
+        case '[':
+            return fscl_tofu_json_open(parser, false);
+        case '"':
+            parser->string_is_key = false;
+            parser->state = TOFU_JSON_STATE_STRING;
+            return FSCL_TOFU_ERROR_OK;
+        case 't':
+        case 'f':
+        case 'n':
+            memset(&parser->literal_value, 0, sizeof(parser->literal_value));
+            if (c == 'n') {
+                parser->literal = "null";
+                parser->literal_value.type = TOFU_NULLPTR_TYPE;
+                parser->literal_value.data.nullptr_type = NULL;
+            } else {
+                parser->literal = c == 't' ? "true" : "false";
+                parser->literal_value.type = TOFU_BOOLEAN_TYPE;
+                parser->literal_value.data.boolean_type = c == 't';
+            }
+            parser->literal_index = 1;
+            parser->state = TOFU_JSON_STATE_LITERAL;
+            return FSCL_TOFU_ERROR_OK;
+        default:
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                if (!fscl_tofu_json_token_put(parser, &c, 1)) {
+                    return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+                }
+                parser->state = TOFU_JSON_STATE_NUMBER;
+                return FSCL_TOFU_ERROR_OK;
+            }
+            return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+    }
+}
+
+ctofu_error fscl_tofu_json_parser_feed(ctofu_json_parser* parser, const char* chunk, size_t length) {
+    if (parser == NULL || (chunk == NULL && length > 0)) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    if (parser->state == TOFU_JSON_STATE_FAILED) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_FORMAT);
+    }
+
+    const char* cursor = chunk;
+    const char* end = chunk + length;
+    ctofu_error result = FSCL_TOFU_ERROR_OK;
+
+    while (cursor < end && result == FSCL_TOFU_ERROR_OK) {
+        char c = *cursor;
+
+        switch (parser->state) {
+            case TOFU_JSON_STATE_STRING: {
+                const char* stop = fscl_tofu_json_scan_string(cursor, end);
+                if (stop > cursor) {
+                    if (!fscl_tofu_json_flush_surrogate(parser) ||
+                        !fscl_tofu_json_token_put(parser, cursor, (size_t)(stop - cursor))) {
+                        return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+                    }
+                    cursor = stop;
+                    continue;
+                }
+
+                ++cursor;
+                if (c == '"') {
+                    result = fscl_tofu_json_finish_string(parser);
+                } else if (c == '\\') {
+                    parser->state = TOFU_JSON_STATE_ESCAPE;
+                } else {
+                    result = fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+                }
+                continue;
+            }
+
+            case TOFU_JSON_STATE_ESCAPE: {
+                char decoded;
+                ++cursor;
+                parser->state = TOFU_JSON_STATE_STRING;
+
+                switch (c) {
+                    case '"':  decoded = '"';  break;
+                    case '\\': decoded = '\\'; break;
+                    case '/':  decoded = '/';  break;
+                    case 'b':  decoded = '\b'; break;
+                    case 'f':  decoded = '\f'; break;
+                    case 'n':  decoded = '\n'; break;
+                    case 'r':  decoded = '\r'; break;
+                    case 't':  decoded = '\t'; break;
+                    case 'u':
+                        parser->unicode = 0;
+                        parser->unicode_digits = 0;
+                        parser->state = TOFU_JSON_STATE_UNICODE;
+                        continue;
+                    default:
+                        result = fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+                        continue;
+                }
+
+                if (!fscl_tofu_json_flush_surrogate(parser) || !fscl_tofu_json_token_put(parser, &decoded, 1)) {
+                    result = fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+                }
+                continue;
+            }
+
+            case TOFU_JSON_STATE_UNICODE: {
+                int digit = fscl_tofu_json_hex_digit(c);
+                ++cursor;
+                if (digit < 0) {
+                    result = fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+                    continue;
+                }
+
+                parser->unicode = (parser->unicode << 4) | (uint32_t)digit;
+                if (++parser->unicode_digits < 4) {
+                    continue;
+                }
+
+                uint32_t code = parser->unicode;
+                bool stored = true;
+                parser->state = TOFU_JSON_STATE_STRING;
+
+                if (code >= 0xDC00 && code <= 0xDFFF && parser->high_surrogate != 0) {
+                    code = 0x10000 + ((parser->high_surrogate - 0xD800) << 10) + (code - 0xDC00);
+                    parser->high_surrogate = 0;
+                    stored = fscl_tofu_json_token_codepoint(parser, code);
+                } else if (code >= 0xD800 && code <= 0xDBFF) {
+                    stored = fscl_tofu_json_flush_surrogate(parser);
+                    parser->high_surrogate = code;
+                } else {
+                    stored = fscl_tofu_json_flush_surrogate(parser) &&
+                             fscl_tofu_json_token_codepoint(parser, (code >= 0xDC00 && code <= 0xDFFF) ? 0xFFFD : code);
+                }
+
+                if (!stored) {
+                    result = fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+                }
+                continue;
+            }
+
+            case TOFU_JSON_STATE_NUMBER: {
+                const char* stop = cursor;
+                while (stop < end && fscl_tofu_json_is_number_char(*stop)) {
+                    ++stop;
+                }
+
+                if (!fscl_tofu_json_token_put(parser, cursor, (size_t)(stop - cursor))) {
+                    return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+                }
+                cursor = stop;
+
+                // The number only ends once a byte outside of it shows up
+                if (stop < end) {
+                    result = fscl_tofu_json_finish_number(parser);
+                }
+                continue;
+            }
+
+            case TOFU_JSON_STATE_LITERAL:
+                ++cursor;
+                if (c != parser->literal[parser->literal_index]) {
+                    result = fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+                } else if (parser->literal[++parser->literal_index] == '\0') {
+                    result = fscl_tofu_json_emit(parser, &parser->literal_value);
+                }
+                continue;
+
+            default:
+                break;
+        }
+
+        // Structural states: whitespace is insignificant between tokens
+        ++cursor;
+        if (fscl_tofu_json_is_space(c)) {
+            continue;
+        }
+
+        switch (parser->state) {
+            case TOFU_JSON_STATE_VALUE:
+                result = fscl_tofu_json_begin_value(parser, c);
+                break;
+
+            case TOFU_JSON_STATE_ARRAY_FIRST:
+                result = c == ']' ? fscl_tofu_json_close(parser, false) : fscl_tofu_json_begin_value(parser, c);
+                break;
+
+            case TOFU_JSON_STATE_OBJECT_FIRST:
+            case TOFU_JSON_STATE_KEY:
+                if (c == '"') {
+                    parser->string_is_key = true;
+                    parser->state = TOFU_JSON_STATE_STRING;
+                } else if (c == '}' && parser->state == TOFU_JSON_STATE_OBJECT_FIRST) {
+                    result = fscl_tofu_json_close(parser, true);
+                } else {
+                    result = fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+                }
+                break;
+
+            case TOFU_JSON_STATE_COLON:
+                if (c == ':') {
+                    parser->state = TOFU_JSON_STATE_VALUE;
+                } else {
+                    result = fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+                }
+                break;
+
+            case TOFU_JSON_STATE_AFTER_VALUE:
+                if (c == ',') {
+                    parser->state = parser->frames[parser->depth - 1].object ? TOFU_JSON_STATE_KEY : TOFU_JSON_STATE_VALUE;
+                } else if (c == ']') {
+                    result = fscl_tofu_json_close(parser, false);
+                } else if (c == '}') {
+                    result = fscl_tofu_json_close(parser, true);
+                } else {
+                    result = fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+                }
+                break;
+
+            default:
+                // Only whitespace may follow a complete document
+                result = fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+                break;
+        }
+    }
+
+    return result;
+}
+
+ctofu_error fscl_tofu_json_parser_finish(ctofu_json_parser* parser, ctofu* result) {
+    if (parser == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    // A top level number has no closing byte of its own
+    if (parser->state == TOFU_JSON_STATE_NUMBER && parser->depth == 0) {
+        ctofu_error error = fscl_tofu_json_finish_number(parser);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return error;
+        }
+    }
+
+    if (parser->state != TOFU_JSON_STATE_DONE) {
+        return fscl_tofu_json_fail(parser, FSCL_TOFU_ERROR_FORMAT);
+    }
+
+    *result = parser->root;
+    memset(&parser->root, 0, sizeof(parser->root));
+    parser->has_root = false;
+
+    // Ready for the next document
+    parser->state = TOFU_JSON_STATE_VALUE;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+void fscl_tofu_json_parser_erase(ctofu_json_parser* parser) {
+    if (parser == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < parser->count; ++i) {
+        fscl_tofu_value_erase(&parser->values[i]);
+    }
+    // Trailing garbage fails the parser after the root was built
+    if (parser->has_root) {
+        fscl_tofu_value_erase(&parser->root);
+    }
+
+    free(parser->values);
+    free(parser->frames);
+    free(parser->token);
+    free(parser);
+}
+
+ctofu_error fscl_tofu_json_parse(const char* text, size_t length, ctofu* result) {
+    if (text == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    ctofu_json_parser* parser = fscl_tofu_json_parser_create();
+    if (parser == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    ctofu_error error = fscl_tofu_json_parser_feed(parser, text, length);
+    if (error == FSCL_TOFU_ERROR_OK) {
+        error = fscl_tofu_json_parser_finish(parser, result);
+    }
+
+    fscl_tofu_json_parser_erase(parser);
+    return error;
+}
+
+// =======================
+// WRITER FUNCTIONS
+// =======================
+
+static void fscl_tofu_json_write_string(ctofu_writer* writer, const char* text, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    const char* cursor = text;
+    const char* end = text + length;
+
+    fscl_tofu_writer_put(writer, "\"", 1);
+    while (cursor < end) {
+        const char* stop = fscl_tofu_json_scan_string(cursor, end);
+        fscl_tofu_writer_put(writer, cursor, (size_t)(stop - cursor));
+        if (stop == end) {
+            break;
+        }
+
+        unsigned char c = (unsigned char)*stop;
+        switch (c) {
+            case '"':  fscl_tofu_writer_put(writer, "\\\"", 2); break;
+            case '\\': fscl_tofu_writer_put(writer, "\\\\", 2); break;
+            case '\b': fscl_tofu_writer_put(writer, "\\b", 2); break;
+            case '\f': fscl_tofu_writer_put(writer, "\\f", 2); break;
+            case '\n': fscl_tofu_writer_put(writer, "\\n", 2); break;
+            case '\r': fscl_tofu_writer_put(writer, "\\r", 2); break;
+            case '\t': fscl_tofu_writer_put(writer, "\\t", 2); break;
+            default: {
+                char escaped[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                fscl_tofu_writer_put(writer, escaped, sizeof(escaped));
+                break;
+            }
+        }
+        cursor = stop + 1;
+    }
+    fscl_tofu_writer_put(writer, "\"", 1);
+}
+
+static void fscl_tofu_json_write_real(ctofu_writer* writer, double value, int digits) {
+    if (!isfinite(value)) {
+        fscl_tofu_writer_put(writer, "null", 4);
+        return;
+    }
+
+    char text[32];
+    int length = snprintf(text, sizeof(text), "%.*g", digits, value);
+    if (length < 0 || (size_t)length >= sizeof(text)) {
+        writer->failed = true;
+        return;
+    }
+
+    fscl_tofu_writer_put(writer, text, (size_t)length);
+
+    // Keep the value a double when it is read back
+    if (strpbrk(text, ".eE") == NULL) {
+        fscl_tofu_writer_put(writer, ".0", 2);
+    }
+}
+
+static ctofu_error fscl_tofu_json_write_value(ctofu_writer* writer, const ctofu* value) {
+    switch (value->type) {
+        case TOFU_INT_TYPE:
+            fscl_tofu_writer_int(writer, value->data.int_type);
+            break;
+        case TOFU_FIXED_TYPE:
+            fscl_tofu_writer_int(writer, value->data.fixed_type);
+            break;
+        case TOFU_UINT_TYPE:
+            fscl_tofu_writer_uint(writer, value->data.uint_type);
+            break;
+        case TOFU_OCTAL_TYPE:
+            fscl_tofu_writer_uint(writer, value->data.octal_type);
+            break;
+        case TOFU_BITWISE_TYPE:
+            fscl_tofu_writer_uint(writer, value->data.bitwise_type);
+            break;
+        case TOFU_HEX_TYPE:
+            fscl_tofu_writer_uint(writer, value->data.hex_type);
+            break;
+        case TOFU_QBIT_TYPE:
+            fscl_tofu_writer_uint(writer, value->data.qbit_type);
+            break;
+        case TOFU_FLOAT_TYPE:
+            fscl_tofu_json_write_real(writer, value->data.float_type, 9);
+            break;
+        case TOFU_DOUBLE_TYPE:
+            fscl_tofu_json_write_real(writer, value->data.double_type, 17);
+            break;
+        case TOFU_STRING_TYPE:
+            if (fscl_tofu_string_data(value) == NULL) {
+                fscl_tofu_writer_put(writer, "null", 4);
+            } else {
+                fscl_tofu_json_write_string(writer, fscl_tofu_string_data(value), fscl_tofu_string_length(value));
+            }
+            break;
+        case TOFU_CHAR_TYPE:
+            fscl_tofu_json_write_string(writer, &value->data.char_type, 1);
+            break;
+        case TOFU_BOOLEAN_TYPE:
+            if (value->data.boolean_type) {
+                fscl_tofu_writer_put(writer, "true", 4);
+            } else {
+                fscl_tofu_writer_put(writer, "false", 5);
+            }
+            break;
+        case TOFU_NULLPTR_TYPE:
+            fscl_tofu_writer_put(writer, "null", 4);
+            break;
+        case TOFU_ARRAY_TYPE:
+            fscl_tofu_writer_put(writer, "[", 1);
+            for (size_t i = 0; i < value->data.array_type.size; ++i) {
+                if (i > 0) {
+                    fscl_tofu_writer_put(writer, ",", 1);
+                }
+                ctofu_error error = fscl_tofu_json_write_value(writer, &value->data.array_type.elements[i]);
+                if (error != FSCL_TOFU_ERROR_OK) {
+                    return error;
+                }
+            }
+            fscl_tofu_writer_put(writer, "]", 1);
+            break;
+        case TOFU_MAP_TYPE:
+            fscl_tofu_writer_put(writer, "{", 1);
+            for (size_t i = 0; i < value->data.map_type.size; ++i) {
+                const ctofu* key = &value->data.map_type.key[i];
+                if (i > 0) {
+                    fscl_tofu_writer_put(writer, ",", 1);
+                }
+
+                if (fscl_tofu_string_data(key) != NULL) {
+                    fscl_tofu_json_write_string(writer, fscl_tofu_string_data(key), fscl_tofu_string_length(key));
+                } else if (key->type == TOFU_CHAR_TYPE) {
+                    fscl_tofu_json_write_string(writer, &key->data.char_type, 1);
+                } else {
+                    // JSON keys are strings, so other keys are written as their JSON text
+                    size_t length = 0;
+                    char* text = fscl_tofu_json_stringify(key, &length);
+                    if (text == NULL) {
+                        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+                    }
+                    fscl_tofu_json_write_string(writer, text, length);
+                    free(text);
+                }
+
+                fscl_tofu_writer_put(writer, ":", 1);
+                ctofu_error error = fscl_tofu_json_write_value(writer, &value->data.map_type.value[i]);
+                if (error != FSCL_TOFU_ERROR_OK) {
+                    return error;
+                }
+            }
+            fscl_tofu_writer_put(writer, "}", 1);
+            break;
+        default:
+            return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    return FSCL_TOFU_ERROR_OK;
+}
+
+ctofu_error fscl_tofu_json_write(FILE* stream, const ctofu* value) {
+    if (stream == NULL || value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    ctofu_writer writer;
+    fscl_tofu_writer_init(&writer, stream);
+
+    ctofu_error error = fscl_tofu_json_write_value(&writer, value);
+    ctofu_error flushed = fscl_tofu_writer_flush(&writer);
+    return fscl_tofu_error(error != FSCL_TOFU_ERROR_OK ? error : flushed);
+}
+
+char* fscl_tofu_json_stringify(const ctofu* value, size_t* length) {
+    if (value == NULL) {
+        return NULL;
+    }
+
+    ctofu_writer writer;
+    fscl_tofu_writer_init(&writer, NULL);
+
+    if (fscl_tofu_json_write_value(&writer, value) != FSCL_TOFU_ERROR_OK) {
+        free(writer.data);
+        return NULL;
+    }
+
+    return fscl_tofu_writer_release(&writer, length);
+}
@@ -0,0 +1,188 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // syscall() under strict -std modes
+#endif
+#include "fossil/perf.h"
+#include <string.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* const fscl_tofu_perf_names[FSCL_TOFU_PERF_EVENTS] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses",
+};
+
+#if defined(__linux__)
+/**
+ * Fills the perf_event_open type and config of an event.
+ *
+ * @param event The event.
+ * @param attr The attributes to fill.
+ */
+static void fscl_tofu_perf_config(ctofu_perf_event event, struct perf_event_attr* attr) {
+    attr->type = PERF_TYPE_HARDWARE;
+    switch (event) {
+        case FSCL_TOFU_PERF_CYCLES:
+            attr->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case FSCL_TOFU_PERF_INSTRUCTIONS:
+            attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case FSCL_TOFU_PERF_L1D_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case FSCL_TOFU_PERF_LLC_MISSES:
+            attr->config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        default:
+            attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+    }
+}
+#endif
+
+// =======================
+// PERF FUNCTIONS
+// =======================
+ctofu_error fscl_tofu_perf_open(ctofu_perf* perf) {
+    if (perf == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    perf->available = 0;
+    for (size_t i = 0; i < FSCL_TOFU_PERF_EVENTS; ++i) {
+        perf->fds[i] = -1;
+    }
+
+#if defined(__linux__)
+    for (size_t i = 0; i < FSCL_TOFU_PERF_EVENTS; ++i) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        fscl_tofu_perf_config((ctofu_perf_event)i, &attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;  // Allowed without privileges when perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // Containers and seccomp profiles fail this with EACCES, EPERM or ENOSYS
+        long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd >= 0) {
+            perf->fds[i] = (int)fd;
+            perf->available |= UINT32_C(1) << i;
+        }
+    }
+#endif
+
+    return fscl_tofu_error(perf->available != 0 ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_INVALID_OPERATION);
+}
+
+void fscl_tofu_perf_close(ctofu_perf* perf) {
+    if (perf == NULL) {
+        return;
+    }
+
+#if defined(__linux__)
+    for (size_t i = 0; i < FSCL_TOFU_PERF_EVENTS; ++i) {
+        if (perf->fds[i] >= 0) {
+            close(perf->fds[i]);
+        }
+    }
+#endif
+
+    for (size_t i = 0; i < FSCL_TOFU_PERF_EVENTS; ++i) {
+        perf->fds[i] = -1;
+    }
+    perf->available = 0;
+}
+
+ctofu_error fscl_tofu_perf_begin(ctofu_perf* perf) {
+    if (perf == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+#if defined(__linux__)
+    for (size_t i = 0; i < FSCL_TOFU_PERF_EVENTS; ++i) {
+        if (perf->fds[i] >= 0) {
+            ioctl(perf->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(perf->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_perf_end(ctofu_perf* perf, ctofu_perf_sample* sample) {
+    if (perf == NULL || sample == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    memset(sample, 0, sizeof(ctofu_perf_sample));
+
+#if defined(__linux__)
+    for (size_t i = 0; i < FSCL_TOFU_PERF_EVENTS; ++i) {
+        if (perf->fds[i] >= 0) {
+            ioctl(perf->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (size_t i = 0; i < FSCL_TOFU_PERF_EVENTS; ++i) {
+        // value, time enabled, time running
+        uint64_t counts[3];
+        if (perf->fds[i] < 0 || read(perf->fds[i], counts, sizeof(counts)) != (ssize_t)sizeof(counts) ||
+            counts[2] == 0) {
+            continue;
+        }
+        double scale = counts[2] < counts[1] ? (double)counts[1] / (double)counts[2] : 1.0;
+        sample->values[i] = (uint64_t)((double)counts[0] * scale);
+        sample->available |= UINT32_C(1) << i;
+    }
+#endif
+
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_perf_measure(ctofu_perf* perf, void (*region)(void*), void* context, ctofu_perf_sample* sample) {
+    if (perf == NULL || region == NULL || sample == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    ctofu_error error = fscl_tofu_perf_begin(perf);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+    region(context);
+    return fscl_tofu_perf_end(perf, sample);
+}
+
+bool fscl_tofu_perf_has(const ctofu_perf_sample* sample, ctofu_perf_event event) {
+    if (sample == NULL || (unsigned)event >= FSCL_TOFU_PERF_EVENTS) {
+        return false;
+    }
+    return (sample->available & (UINT32_C(1) << event)) != 0;
+}
+
+const char* fscl_tofu_perf_name(ctofu_perf_event event) {
+    if ((unsigned)event >= FSCL_TOFU_PERF_EVENTS) {
+        return "unknown";
+    }
+    return fscl_tofu_perf_names[event];
+}
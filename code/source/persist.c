@@ -0,0 +1,1004 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/persist.h"
+#include "xtofu_internal.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FSCL_TOFU_PERSIST_BITS 5
+#define FSCL_TOFU_PERSIST_WIDTH (1u << FSCL_TOFU_PERSIST_BITS)
+#define FSCL_TOFU_PERSIST_MASK (FSCL_TOFU_PERSIST_WIDTH - 1)
+
+// =======================
+// MAP NODES
+// =======================
+
+typedef struct {
+    uint64_t hash;  ///< fscl_tofu_hash of the key.
+    ctofu key;
+    ctofu value;
+} ctofu_pmap_entry;
+
+typedef struct ctofu_pmap_node ctofu_pmap_node;
+
+struct ctofu_pmap_node {
+    atomic_size_t references;
+    uint32_t datamap;          ///< Slots holding an entry.
+    uint32_t nodemap;          ///< Slots holding a child node.
+    uint32_t entry_count;
+    uint32_t child_count;
+    bool collision;            ///< Entries whose whole hashes are equal, both maps are zero.
+    ctofu_pmap_entry* entries; ///< Entries in slot order, stored right after the node.
+    ctofu_pmap_node** children;
+};
+
+struct ctofu_pmap {
+    atomic_size_t references;
+    size_t size;
+    ctofu_pmap_node* root;     ///< NULL for the empty map.
+};
+
+static ctofu_pmap_node* fscl_tofu_pmap_node_alloc(uint32_t entries, uint32_t children) {
+    size_t bytes = sizeof(ctofu_pmap_node) + entries * sizeof(ctofu_pmap_entry) + children * sizeof(ctofu_pmap_node*);
+    ctofu_pmap_node* node = (ctofu_pmap_node*)calloc(1, bytes);
+    if (node == NULL) {
+        return NULL;
+    }
+    atomic_init(&node->references, 1);
+    node->entry_count = entries;
+    node->child_count = children;
+    node->entries = (ctofu_pmap_entry*)(node + 1);
+    node->children = (ctofu_pmap_node**)(node->entries + entries);
+    return node;
+}
+
+static ctofu_pmap_node* fscl_tofu_pmap_node_retain(ctofu_pmap_node* node) {
+    if (node != NULL) {
+        atomic_fetch_add_explicit(&node->references, 1, memory_order_relaxed);
+    }
+    return node;
+}
+
+static void fscl_tofu_pmap_node_release(ctofu_pmap_node* node) {
+    if (node == NULL || atomic_fetch_sub_explicit(&node->references, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    for (uint32_t i = 0; i < node->entry_count; ++i) {
+        fscl_tofu_value_erase(&node->entries[i].key);
+        fscl_tofu_value_erase(&node->entries[i].value);
+    }
+    for (uint32_t i = 0; i < node->child_count; ++i) {
+        fscl_tofu_pmap_node_release(node->children[i]);
+    }
+    free(node);
+}
+
+static ctofu_error fscl_tofu_pmap_entry_copy(const ctofu_pmap_entry* source, ctofu_pmap_entry* dest) {
+    dest->hash = source->hash;
+    ctofu_error error = fscl_tofu_shared_copy(&source->key, &dest->key);
+    if (error == FSCL_TOFU_ERROR_OK) {
+        error = fscl_tofu_shared_copy(&source->value, &dest->value);
+    }
+    return error;
+}
+
+static inline bool fscl_tofu_pmap_entry_matches(const ctofu_pmap_entry* entry, uint64_t hash, const ctofu* key) {
+    return fscl_tofu_key_equal(&entry->key, entry->hash, key, hash);
+}
+
+static inline uint32_t fscl_tofu_pmap_bit(uint64_t hash, unsigned shift) {
+    return 1u << ((hash >> shift) & FSCL_TOFU_PERSIST_MASK);
+}
+
+static inline uint32_t fscl_tofu_pmap_index(uint32_t map, uint32_t bit) {
+    return fscl_tofu_popcount(map & (bit - 1));
+}
+
+/**
+ * Builds a copy of a node with one entry and one child slot changed.
+ *
+ * @param node The node to copy.
+ * @param datamap The entry slots of the copy.
+ * @param nodemap The child slots of the copy.
+ * @param skip_entry Index of a source entry to leave out, or UINT32_MAX.
+ * @param entry Entry to insert at insert_entry, or NULL.
+ * @param insert_entry Index of the inserted entry in the copy.
+ * @param skip_child Index of a source child to leave out, or UINT32_MAX.
+ * @param child Child to insert at insert_child, or NULL; the copy takes this reference.
+ * @param insert_child Index of the inserted child in the copy.
+ * @param result Receives the copy.
+ * @return Error code indicating the success or failure of the operation.
+ */
+static ctofu_error fscl_tofu_pmap_node_edit(const ctofu_pmap_node* node, uint32_t datamap, uint32_t nodemap,
+                                           uint32_t skip_entry, const ctofu_pmap_entry* entry, uint32_t insert_entry,
+                                           uint32_t skip_child, ctofu_pmap_node* child, uint32_t insert_child,
+                                           ctofu_pmap_node** result) {
+    uint32_t entries = node->entry_count - (skip_entry != UINT32_MAX) + (entry != NULL);
+    uint32_t children = node->child_count - (skip_child != UINT32_MAX) + (child != NULL);
+    ctofu_pmap_node* copy = fscl_tofu_pmap_node_alloc(entries, children);
+    if (copy == NULL) {
+        fscl_tofu_pmap_node_release(child);
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    copy->datamap = datamap;
+    copy->nodemap = nodemap;
+    copy->collision = node->collision;
+
+    ctofu_error error = FSCL_TOFU_ERROR_OK;
+    uint32_t target = 0;
+    for (uint32_t i = 0; i <= node->entry_count && error == FSCL_TOFU_ERROR_OK; ++i) {
+        if (entry != NULL && target == insert_entry) {
+            error = fscl_tofu_pmap_entry_copy(entry, &copy->entries[target++]);
+            entry = NULL;
+        }
+        if (i < node->entry_count && i != skip_entry && error == FSCL_TOFU_ERROR_OK) {
+            error = fscl_tofu_pmap_entry_copy(&node->entries[i], &copy->entries[target++]);
+        }
+    }
+
+    target = 0;
+    for (uint32_t i = 0; i <= node->child_count; ++i) {
+        if (child != NULL && target == insert_child) {
+            copy->children[target++] = child;
+            child = NULL;
+        }
+        if (i < node->child_count && i != skip_child) {
+            copy->children[target++] = fscl_tofu_pmap_node_retain(node->children[i]);
+        }
+    }
+
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_pmap_node_release(copy);
+        return error;
+    }
+    *result = copy;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+// Builds the smallest subtree holding two entries whose slots collide at shift
+static ctofu_error fscl_tofu_pmap_node_merge(const ctofu_pmap_entry* first, const ctofu_pmap_entry* second,
+                                            unsigned shift, ctofu_pmap_node** result) {
+    if (first->hash == second->hash || shift >= 64) {
+        ctofu_pmap_node* node = fscl_tofu_pmap_node_alloc(2, 0);
+        if (node == NULL) {
+            return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        node->collision = true;
+        ctofu_error error = fscl_tofu_pmap_entry_copy(first, &node->entries[0]);
+        if (error == FSCL_TOFU_ERROR_OK) {
+            error = fscl_tofu_pmap_entry_copy(second, &node->entries[1]);
+        }
+        if (error != FSCL_TOFU_ERROR_OK) {
+            fscl_tofu_pmap_node_release(node);
+            return error;
+        }
+        *result = node;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    uint32_t first_bit = fscl_tofu_pmap_bit(first->hash, shift);
+    uint32_t second_bit = fscl_tofu_pmap_bit(second->hash, shift);
+
+    if (first_bit == second_bit) {
+        ctofu_pmap_node* child = NULL;
+        ctofu_error error = fscl_tofu_pmap_node_merge(first, second, shift + FSCL_TOFU_PERSIST_BITS, &child);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return error;
+        }
+        ctofu_pmap_node* node = fscl_tofu_pmap_node_alloc(0, 1);
+        if (node == NULL) {
+            fscl_tofu_pmap_node_release(child);
+            return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        node->nodemap = first_bit;
+        node->children[0] = child;
+        *result = node;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    ctofu_pmap_node* node = fscl_tofu_pmap_node_alloc(2, 0);
+    if (node == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    node->datamap = first_bit | second_bit;
+    bool ordered = first_bit < second_bit;
+    ctofu_error error = fscl_tofu_pmap_entry_copy(ordered ? first : second, &node->entries[0]);
+    if (error == FSCL_TOFU_ERROR_OK) {
+        error = fscl_tofu_pmap_entry_copy(ordered ? second : first, &node->entries[1]);
+    }
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_pmap_node_release(node);
+        return error;
+    }
+    *result = node;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+static ctofu_error fscl_tofu_pmap_node_set(const ctofu_pmap_node* node, unsigned shift, const ctofu_pmap_entry* entry,
+                                          bool* added, ctofu_pmap_node** result) {
+    if (node->collision && node->entries[0].hash != entry->hash) {
+        // Another hash reached the collision: push the collision one level down and retry
+        ctofu_pmap_node* parent = fscl_tofu_pmap_node_alloc(0, 1);
+        if (parent == NULL) {
+            return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        parent->nodemap = fscl_tofu_pmap_bit(node->entries[0].hash, shift);
+        parent->children[0] = fscl_tofu_pmap_node_retain((ctofu_pmap_node*)node);
+        ctofu_error error = fscl_tofu_pmap_node_set(parent, shift, entry, added, result);
+        fscl_tofu_pmap_node_release(parent);
+        return error;
+    }
+
+    if (node->collision) {
+        for (uint32_t i = 0; i < node->entry_count; ++i) {
+            if (fscl_tofu_pmap_entry_matches(&node->entries[i], entry->hash, &entry->key)) {
+                return fscl_tofu_pmap_node_edit(node, 0, 0, i, entry, i, UINT32_MAX, NULL, 0, result);
+            }
+        }
+        *added = true;
+        return fscl_tofu_pmap_node_edit(node, 0, 0, UINT32_MAX, entry, node->entry_count, UINT32_MAX, NULL, 0, result);
+    }
+
+    uint32_t bit = fscl_tofu_pmap_bit(entry->hash, shift);
+
+    if (node->datamap & bit) {
+        uint32_t index = fscl_tofu_pmap_index(node->datamap, bit);
+        const ctofu_pmap_entry* existing = &node->entries[index];
+        if (fscl_tofu_pmap_entry_matches(existing, entry->hash, &entry->key)) {
+            return fscl_tofu_pmap_node_edit(node, node->datamap, node->nodemap, index, entry, index,
+                                            UINT32_MAX, NULL, 0, result);
+        }
+
+        // Two keys in one slot move down into a new child
+        ctofu_pmap_node* child = NULL;
+        ctofu_error error = fscl_tofu_pmap_node_merge(existing, entry, shift + FSCL_TOFU_PERSIST_BITS, &child);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return error;
+        }
+        *added = true;
+        return fscl_tofu_pmap_node_edit(node, node->datamap ^ bit, node->nodemap | bit, index, NULL, 0,
+                                        UINT32_MAX, child, fscl_tofu_pmap_index(node->nodemap, bit), result);
+    }
+
+    if (node->nodemap & bit) {
+        uint32_t index = fscl_tofu_pmap_index(node->nodemap, bit);
+        ctofu_pmap_node* child = NULL;
+        ctofu_error error = fscl_tofu_pmap_node_set(node->children[index], shift + FSCL_TOFU_PERSIST_BITS, entry, added, &child);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return error;
+        }
+        return fscl_tofu_pmap_node_edit(node, node->datamap, node->nodemap, UINT32_MAX, NULL, 0,
+                                        index, child, index, result);
+    }
+
+    *added = true;
+    return fscl_tofu_pmap_node_edit(node, node->datamap | bit, node->nodemap, UINT32_MAX, entry,
+                                    fscl_tofu_pmap_index(node->datamap, bit), UINT32_MAX, NULL, 0, result);
+}
+
+// Sets *result to NULL when the key is not present
+static ctofu_error fscl_tofu_pmap_node_remove(const ctofu_pmap_node* node, unsigned shift, uint64_t hash,
+                                             const ctofu* key, ctofu_pmap_node** result) {
+    *result = NULL;
+
+    if (node->collision) {
+        for (uint32_t i = 0; i < node->entry_count; ++i) {
+            if (fscl_tofu_pmap_entry_matches(&node->entries[i], hash, key)) {
+                return fscl_tofu_pmap_node_edit(node, 0, 0, i, NULL, 0, UINT32_MAX, NULL, 0, result);
+            }
+        }
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    uint32_t bit = fscl_tofu_pmap_bit(hash, shift);
+
+    if (node->datamap & bit) {
+        uint32_t index = fscl_tofu_pmap_index(node->datamap, bit);
+        if (!fscl_tofu_pmap_entry_matches(&node->entries[index], hash, key)) {
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        }
+        return fscl_tofu_pmap_node_edit(node, node->datamap ^ bit, node->nodemap, index, NULL, 0,
+                                        UINT32_MAX, NULL, 0, result);
+    }
+
+    if (node->nodemap & bit) {
+        uint32_t index = fscl_tofu_pmap_index(node->nodemap, bit);
+        ctofu_pmap_node* child = NULL;
+        ctofu_error error = fscl_tofu_pmap_node_remove(node->children[index], shift + FSCL_TOFU_PERSIST_BITS, hash, key, &child);
+        if (error != FSCL_TOFU_ERROR_OK || child == NULL) {
+            return error;
+        }
+
+        // A child left with a single entry is folded back into this node
+        if (child->child_count == 0 && child->entry_count == 1) {
+            error = fscl_tofu_pmap_node_edit(node, node->datamap | bit, node->nodemap ^ bit, UINT32_MAX, &child->entries[0],
+                                             fscl_tofu_pmap_index(node->datamap, bit), index, NULL, 0, result);
+            fscl_tofu_pmap_node_release(child);
+            return error;
+        }
+        return fscl_tofu_pmap_node_edit(node, node->datamap, node->nodemap, UINT32_MAX, NULL, 0,
+                                        index, child, index, result);
+    }
+
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+static ctofu_error fscl_tofu_pmap_node_export(const ctofu_pmap_node* node, ctofu* result, size_t* count) {
+    for (uint32_t i = 0; i < node->entry_count; ++i) {
+        ctofu_error error = fscl_tofu_shared_copy(&node->entries[i].key, &result->data.map_type.key[*count]);
+        if (error == FSCL_TOFU_ERROR_OK) {
+            error = fscl_tofu_shared_copy(&node->entries[i].value, &result->data.map_type.value[*count]);
+        }
+        ++*count;
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return error;
+        }
+    }
+    for (uint32_t i = 0; i < node->child_count; ++i) {
+        ctofu_error error = fscl_tofu_pmap_node_export(node->children[i], result, count);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return error;
+        }
+    }
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+// =======================
+// PERSISTENT MAP FUNCTIONS
+// =======================
+
+static ctofu_error fscl_tofu_pmap_wrap(ctofu_pmap_node* root, size_t size, ctofu_pmap** result) {
+    ctofu_pmap* map = (ctofu_pmap*)malloc(sizeof(ctofu_pmap));
+    if (map == NULL) {
+        fscl_tofu_pmap_node_release(root);
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    atomic_init(&map->references, 1);
+    map->size = size;
+    map->root = root;
+    *result = map;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_pmap* fscl_tofu_pmap_create(void) {
+    ctofu_pmap* map = NULL;
+    fscl_tofu_pmap_wrap(NULL, 0, &map);
+    return map;
+}
+
+ctofu_pmap* fscl_tofu_pmap_retain(ctofu_pmap* map) {
+    if (map != NULL) {
+        atomic_fetch_add_explicit(&map->references, 1, memory_order_relaxed);
+    }
+    return map;
+}
+
+void fscl_tofu_pmap_release(ctofu_pmap* map) {
+    if (map == NULL || atomic_fetch_sub_explicit(&map->references, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    fscl_tofu_pmap_node_release(map->root);
+    free(map);
+}
+
+size_t fscl_tofu_pmap_size(const ctofu_pmap* map) {
+    return map != NULL ? map->size : 0;
+}
+
+const ctofu* fscl_tofu_pmap_get(const ctofu_pmap* map, const ctofu* key) {
+    if (map == NULL || key == NULL || map->root == NULL) {
+        return NULL;
+    }
+
+    uint64_t hash = fscl_tofu_hash(key);
+    const ctofu_pmap_node* node = map->root;
+    for (unsigned shift = 0;; shift += FSCL_TOFU_PERSIST_BITS) {
+        if (node->collision) {
+            for (uint32_t i = 0; i < node->entry_count; ++i) {
+                if (fscl_tofu_pmap_entry_matches(&node->entries[i], hash, key)) {
+                    return &node->entries[i].value;
+                }
+            }
+            return NULL;
+        }
+
+        uint32_t bit = fscl_tofu_pmap_bit(hash, shift);
+        if (node->datamap & bit) {
+            const ctofu_pmap_entry* entry = &node->entries[fscl_tofu_pmap_index(node->datamap, bit)];
+            return fscl_tofu_pmap_entry_matches(entry, hash, key) ? &entry->value : NULL;
+        }
+        if (!(node->nodemap & bit)) {
+            return NULL;
+        }
+        node = node->children[fscl_tofu_pmap_index(node->nodemap, bit)];
+    }
+}
+
+ctofu_error fscl_tofu_pmap_set(const ctofu_pmap* map, const ctofu* key, const ctofu* value, ctofu_pmap** result) {
+    if (map == NULL || key == NULL || value == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    ctofu_pmap_entry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.hash = fscl_tofu_hash(key);
+    ctofu_error error = fscl_tofu_shared_store(key, &entry.key);
+    if (error == FSCL_TOFU_ERROR_OK) {
+        error = fscl_tofu_shared_store(value, &entry.value);
+    }
+
+    ctofu_pmap_node* root = NULL;
+    bool added = false;
+    if (error == FSCL_TOFU_ERROR_OK && map->root == NULL) {
+        root = fscl_tofu_pmap_node_alloc(1, 0);
+        if (root == NULL) {
+            error = fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        } else {
+            root->datamap = fscl_tofu_pmap_bit(entry.hash, 0);
+            root->entries[0] = entry;
+            memset(&entry, 0, sizeof(entry));
+            added = true;
+        }
+    } else if (error == FSCL_TOFU_ERROR_OK) {
+        error = fscl_tofu_pmap_node_set(map->root, 0, &entry, &added, &root);
+    }
+
+    fscl_tofu_value_erase(&entry.key);
+    fscl_tofu_value_erase(&entry.value);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+    return fscl_tofu_pmap_wrap(root, map->size + (added ? 1 : 0), result);
+}
+
+ctofu_error fscl_tofu_pmap_remove(const ctofu_pmap* map, const ctofu* key, ctofu_pmap** result) {
+    if (map == NULL || key == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    ctofu_pmap_node* root = NULL;
+    if (map->root != NULL) {
+        ctofu_error error = fscl_tofu_pmap_node_remove(map->root, 0, fscl_tofu_hash(key), key, &root);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return error;
+        }
+    }
+
+    if (root == NULL) {
+        *result = fscl_tofu_pmap_retain((ctofu_pmap*)map);
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+    if (root->entry_count == 0 && root->child_count == 0) {
+        fscl_tofu_pmap_node_release(root);
+        root = NULL;
+    }
+    return fscl_tofu_pmap_wrap(root, map->size - 1, result);
+}
+
+ctofu_error fscl_tofu_pmap_from(const ctofu* map, ctofu_pmap** result) {
+    if (map == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (map->type != TOFU_MAP_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_TYPE_MISMATCH);
+    }
+
+    ctofu_pmap* current = fscl_tofu_pmap_create();
+    if (current == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    for (size_t i = 0; i < map->data.map_type.size; ++i) {
+        ctofu_pmap* next = NULL;
+        ctofu_error error = fscl_tofu_pmap_set(current, &map->data.map_type.key[i], &map->data.map_type.value[i], &next);
+        fscl_tofu_pmap_release(current);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return error;
+        }
+        current = next;
+    }
+
+    *result = current;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_pmap_to(const ctofu_pmap* map, ctofu* result) {
+    if (map == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    memset(result, 0, sizeof(ctofu));
+    result->type = TOFU_MAP_TYPE;
+    if (map->size == 0) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    result->data.map_type.key = (ctofu*)calloc(map->size, sizeof(ctofu));
+    result->data.map_type.value = (ctofu*)calloc(map->size, sizeof(ctofu));
+    result->data.map_type.size = map->size;
+    if (result->data.map_type.key == NULL || result->data.map_type.value == NULL) {
+        free(result->data.map_type.key);
+        free(result->data.map_type.value);
+        memset(result, 0, sizeof(ctofu));
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    size_t count = 0;
+    ctofu_error error = fscl_tofu_pmap_node_export(map->root, result, &count);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_value_erase(result);
+        memset(result, 0, sizeof(ctofu));
+    }
+    return error;
+}
+
+// =======================
+// VECTOR NODES
+// =======================
+
+typedef struct ctofu_pvec_node ctofu_pvec_node;
+
+// Leaves store their items, branches their children, right after the node
+struct ctofu_pvec_node {
+    atomic_size_t references;
+    uint32_t count;
+    bool leaf;
+};
+
+struct ctofu_pvec {
+    atomic_size_t references;
+    size_t size;
+    unsigned shift;            ///< Bits consumed above the leaves of the tree.
+    ctofu_pvec_node* root;     ///< NULL while every element fits in the tail.
+    ctofu_pvec_node* tail;     ///< Last leaf, kept out of the tree; NULL when empty.
+};
+
+static inline ctofu* fscl_tofu_pvec_items(const ctofu_pvec_node* node) {
+    return (ctofu*)(node + 1);
+}
+
+static inline ctofu_pvec_node** fscl_tofu_pvec_children(const ctofu_pvec_node* node) {
+    return (ctofu_pvec_node**)(node + 1);
+}
+
+static ctofu_pvec_node* fscl_tofu_pvec_node_alloc(bool leaf, uint32_t count) {
+    size_t slot = leaf ? sizeof(ctofu) : sizeof(ctofu_pvec_node*);
+    ctofu_pvec_node* node = (ctofu_pvec_node*)calloc(1, sizeof(ctofu_pvec_node) + count * slot);
+    if (node == NULL) {
+        return NULL;
+    }
+    atomic_init(&node->references, 1);
+    node->count = count;
+    node->leaf = leaf;
+    return node;
+}
+
+static ctofu_pvec_node* fscl_tofu_pvec_node_retain(ctofu_pvec_node* node) {
+    if (node != NULL) {
+        atomic_fetch_add_explicit(&node->references, 1, memory_order_relaxed);
+    }
+    return node;
+}
+
+static void fscl_tofu_pvec_node_release(ctofu_pvec_node* node) {
+    if (node == NULL || atomic_fetch_sub_explicit(&node->references, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    for (uint32_t i = 0; i < node->count; ++i) {
+        if (node->leaf) {
+            fscl_tofu_value_erase(&fscl_tofu_pvec_items(node)[i]);
+        } else {
+            fscl_tofu_pvec_node_release(fscl_tofu_pvec_children(node)[i]);
+        }
+    }
+    free(node);
+}
+
+// Copies the first min(count, node->count) slots of a node into a node of count slots
+static ctofu_error fscl_tofu_pvec_node_copy(const ctofu_pvec_node* node, bool leaf, uint32_t count, ctofu_pvec_node** result) {
+    ctofu_pvec_node* copy = fscl_tofu_pvec_node_alloc(leaf, count);
+    if (copy == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    uint32_t used = node == NULL ? 0 : (node->count < count ? node->count : count);
+    for (uint32_t i = 0; i < used; ++i) {
+        if (leaf) {
+            ctofu_error error = fscl_tofu_shared_copy(&fscl_tofu_pvec_items(node)[i], &fscl_tofu_pvec_items(copy)[i]);
+            if (error != FSCL_TOFU_ERROR_OK) {
+                fscl_tofu_pvec_node_release(copy);
+                return error;
+            }
+        } else {
+            fscl_tofu_pvec_children(copy)[i] = fscl_tofu_pvec_node_retain(fscl_tofu_pvec_children(node)[i]);
+        }
+    }
+
+    *result = copy;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+static inline size_t fscl_tofu_pvec_tail_offset(size_t size) {
+    return size < FSCL_TOFU_PERSIST_WIDTH ? 0 : ((size - 1) >> FSCL_TOFU_PERSIST_BITS) << FSCL_TOFU_PERSIST_BITS;
+}
+
+static const ctofu_pvec_node* fscl_tofu_pvec_leaf(const ctofu_pvec* vector, size_t index) {
+    if (index >= fscl_tofu_pvec_tail_offset(vector->size)) {
+        return vector->tail;
+    }
+    const ctofu_pvec_node* node = vector->root;
+    for (unsigned level = vector->shift; level > 0; level -= FSCL_TOFU_PERSIST_BITS) {
+        node = fscl_tofu_pvec_children(node)[(index >> level) & FSCL_TOFU_PERSIST_MASK];
+    }
+    return node;
+}
+
+static ctofu_error fscl_tofu_pvec_node_assign(const ctofu_pvec_node* node, unsigned level, size_t index,
+                                             const ctofu* value, ctofu_pvec_node** result) {
+    ctofu_pvec_node* copy = NULL;
+    ctofu_error error = fscl_tofu_pvec_node_copy(node, node->leaf, node->count, &copy);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
+    size_t slot = (index >> level) & FSCL_TOFU_PERSIST_MASK;
+    if (level == 0) {
+        ctofu* item = &fscl_tofu_pvec_items(copy)[slot];
+        fscl_tofu_value_erase(item);
+        error = fscl_tofu_shared_copy(value, item);
+    } else {
+        ctofu_pvec_node* child = NULL;
+        error = fscl_tofu_pvec_node_assign(fscl_tofu_pvec_children(node)[slot], level - FSCL_TOFU_PERSIST_BITS, index, value, &child);
+        if (error == FSCL_TOFU_ERROR_OK) {
+            fscl_tofu_pvec_node_release(fscl_tofu_pvec_children(copy)[slot]);
+            fscl_tofu_pvec_children(copy)[slot] = child;
+        }
+    }
+
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_pvec_node_release(copy);
+        return error;
+    }
+    *result = copy;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+// Wraps a leaf in single child branches up to level
+static ctofu_error fscl_tofu_pvec_node_path(unsigned level, ctofu_pvec_node* leaf, ctofu_pvec_node** result) {
+    if (level == 0) {
+        *result = fscl_tofu_pvec_node_retain(leaf);
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    ctofu_pvec_node* child = NULL;
+    ctofu_error error = fscl_tofu_pvec_node_path(level - FSCL_TOFU_PERSIST_BITS, leaf, &child);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+    ctofu_pvec_node* node = fscl_tofu_pvec_node_alloc(false, 1);
+    if (node == NULL) {
+        fscl_tofu_pvec_node_release(child);
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    fscl_tofu_pvec_children(node)[0] = child;
+    *result = node;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+// Adds the full tail of a vector of size elements as the rightmost leaf below node
+static ctofu_error fscl_tofu_pvec_node_push(const ctofu_pvec_node* node, unsigned level, size_t size,
+                                           ctofu_pvec_node* tail, ctofu_pvec_node** result) {
+    uint32_t slot = (uint32_t)(((size - 1) >> level) & FSCL_TOFU_PERSIST_MASK);
+    ctofu_pvec_node* copy = NULL;
+    ctofu_error error = fscl_tofu_pvec_node_copy(node, false, slot + 1, &copy);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
+    ctofu_pvec_node* child = NULL;
+    if (level == FSCL_TOFU_PERSIST_BITS) {
+        child = fscl_tofu_pvec_node_retain(tail);
+    } else if (node != NULL && slot < node->count) {
+        error = fscl_tofu_pvec_node_push(fscl_tofu_pvec_children(node)[slot], level - FSCL_TOFU_PERSIST_BITS, size, tail, &child);
+    } else {
+        error = fscl_tofu_pvec_node_path(level - FSCL_TOFU_PERSIST_BITS, tail, &child);
+    }
+
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_pvec_node_release(copy);
+        return error;
+    }
+    fscl_tofu_pvec_node_release(fscl_tofu_pvec_children(copy)[slot]);
+    fscl_tofu_pvec_children(copy)[slot] = child;
+    *result = copy;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+// Drops the rightmost leaf below node of a vector of size elements, *result is NULL when nothing is left
+static ctofu_error fscl_tofu_pvec_node_pop(const ctofu_pvec_node* node, unsigned level, size_t size, ctofu_pvec_node** result) {
+    uint32_t slot = (uint32_t)(((size - 2) >> level) & FSCL_TOFU_PERSIST_MASK);
+    *result = NULL;
+
+    if (level > FSCL_TOFU_PERSIST_BITS) {
+        ctofu_pvec_node* child = NULL;
+        ctofu_error error = fscl_tofu_pvec_node_pop(fscl_tofu_pvec_children(node)[slot], level - FSCL_TOFU_PERSIST_BITS, size, &child);
+        if (error != FSCL_TOFU_ERROR_OK || (child == NULL && slot == 0)) {
+            return error;
+        }
+
+        ctofu_pvec_node* copy = NULL;
+        error = fscl_tofu_pvec_node_copy(node, false, child != NULL ? slot + 1 : slot, &copy);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            fscl_tofu_pvec_node_release(child);
+            return error;
+        }
+        if (child != NULL) {
+            fscl_tofu_pvec_node_release(fscl_tofu_pvec_children(copy)[slot]);
+            fscl_tofu_pvec_children(copy)[slot] = child;
+        }
+        *result = copy;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    if (slot == 0) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+    return fscl_tofu_pvec_node_copy(node, false, slot, result);
+}
+
+static void fscl_tofu_pvec_node_export(const ctofu_pvec_node* node, ctofu* elements, size_t* count, ctofu_error* error) {
+    for (uint32_t i = 0; i < node->count && *error == FSCL_TOFU_ERROR_OK; ++i) {
+        if (node->leaf) {
+            *error = fscl_tofu_shared_copy(&fscl_tofu_pvec_items(node)[i], &elements[(*count)++]);
+        } else {
+            fscl_tofu_pvec_node_export(fscl_tofu_pvec_children(node)[i], elements, count, error);
+        }
+    }
+}
+
+// =======================
+// PERSISTENT VECTOR FUNCTIONS
+// =======================
+
+static ctofu_error fscl_tofu_pvec_wrap(ctofu_pvec_node* root, ctofu_pvec_node* tail, unsigned shift, size_t size,
+                                      ctofu_pvec** result) {
+    ctofu_pvec* vector = (ctofu_pvec*)malloc(sizeof(ctofu_pvec));
+    if (vector == NULL) {
+        fscl_tofu_pvec_node_release(root);
+        fscl_tofu_pvec_node_release(tail);
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    atomic_init(&vector->references, 1);
+    vector->size = size;
+    vector->shift = shift;
+    vector->root = root;
+    vector->tail = tail;
+    *result = vector;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_pvec* fscl_tofu_pvec_create(void) {
+    ctofu_pvec* vector = NULL;
+    fscl_tofu_pvec_wrap(NULL, NULL, FSCL_TOFU_PERSIST_BITS, 0, &vector);
+    return vector;
+}
+
+ctofu_pvec* fscl_tofu_pvec_retain(ctofu_pvec* vector) {
+    if (vector != NULL) {
+        atomic_fetch_add_explicit(&vector->references, 1, memory_order_relaxed);
+    }
+    return vector;
+}
+
+void fscl_tofu_pvec_release(ctofu_pvec* vector) {
+    if (vector == NULL || atomic_fetch_sub_explicit(&vector->references, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    fscl_tofu_pvec_node_release(vector->root);
+    fscl_tofu_pvec_node_release(vector->tail);
+    free(vector);
+}
+
+size_t fscl_tofu_pvec_size(const ctofu_pvec* vector) {
+    return vector != NULL ? vector->size : 0;
+}
+
+const ctofu* fscl_tofu_pvec_get(const ctofu_pvec* vector, size_t index) {
+    if (vector == NULL || index >= vector->size) {
+        return NULL;
+    }
+    return &fscl_tofu_pvec_items(fscl_tofu_pvec_leaf(vector, index))[index & FSCL_TOFU_PERSIST_MASK];
+}
+
+ctofu_error fscl_tofu_pvec_set(const ctofu_pvec* vector, size_t index, const ctofu* value, ctofu_pvec** result) {
+    if (vector == NULL || value == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (index >= vector->size) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS);
+    }
+
+    ctofu stored;
+    ctofu_error error = fscl_tofu_shared_store(value, &stored);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_value_erase(&stored);
+        return error;
+    }
+
+    ctofu_pvec_node* root = NULL;
+    ctofu_pvec_node* tail = NULL;
+    if (index >= fscl_tofu_pvec_tail_offset(vector->size)) {
+        error = fscl_tofu_pvec_node_assign(vector->tail, 0, index, &stored, &tail);
+        root = fscl_tofu_pvec_node_retain(vector->root);
+    } else {
+        error = fscl_tofu_pvec_node_assign(vector->root, vector->shift, index, &stored, &root);
+        tail = fscl_tofu_pvec_node_retain(vector->tail);
+    }
+    fscl_tofu_value_erase(&stored);
+
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_pvec_node_release(root);
+        fscl_tofu_pvec_node_release(tail);
+        return error;
+    }
+    return fscl_tofu_pvec_wrap(root, tail, vector->shift, vector->size, result);
+}
+
+ctofu_error fscl_tofu_pvec_push(const ctofu_pvec* vector, const ctofu* value, ctofu_pvec** result) {
+    if (vector == NULL || value == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    size_t size = vector->size;
+    size_t in_tail = size - fscl_tofu_pvec_tail_offset(size);
+    ctofu_pvec_node* root = NULL;
+    ctofu_pvec_node* tail = NULL;
+    unsigned shift = vector->shift;
+    ctofu_error error = FSCL_TOFU_ERROR_OK;
+
+    if (size == 0 || in_tail < FSCL_TOFU_PERSIST_WIDTH) {
+        // Room left in the tail
+        error = fscl_tofu_pvec_node_copy(vector->tail, true, (uint32_t)in_tail + 1, &tail);
+        root = fscl_tofu_pvec_node_retain(vector->root);
+    } else {
+        // The full tail moves into the tree, growing a level when the root is full
+        if ((size >> FSCL_TOFU_PERSIST_BITS) > ((size_t)1 << shift)) {
+            root = fscl_tofu_pvec_node_alloc(false, 2);
+            if (root == NULL) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+            }
+            fscl_tofu_pvec_children(root)[0] = fscl_tofu_pvec_node_retain(vector->root);
+            error = fscl_tofu_pvec_node_path(shift, vector->tail, &fscl_tofu_pvec_children(root)[1]);
+            shift += FSCL_TOFU_PERSIST_BITS;
+        } else {
+            error = fscl_tofu_pvec_node_push(vector->root, shift, size, vector->tail, &root);
+        }
+        if (error == FSCL_TOFU_ERROR_OK) {
+            tail = fscl_tofu_pvec_node_alloc(true, 1);
+            if (tail == NULL) {
+                error = fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+            }
+        }
+    }
+
+    if (error == FSCL_TOFU_ERROR_OK) {
+        error = fscl_tofu_shared_store(value, &fscl_tofu_pvec_items(tail)[tail->count - 1]);
+    }
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_pvec_node_release(root);
+        fscl_tofu_pvec_node_release(tail);
+        return error;
+    }
+    return fscl_tofu_pvec_wrap(root, tail, shift, size + 1, result);
+}
+
+ctofu_error fscl_tofu_pvec_pop(const ctofu_pvec* vector, ctofu_pvec** result) {
+    if (vector == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (vector->size == 0) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS);
+    }
+
+    size_t size = vector->size;
+    if (size == 1) {
+        return fscl_tofu_pvec_wrap(NULL, NULL, FSCL_TOFU_PERSIST_BITS, 0, result);
+    }
+
+    ctofu_pvec_node* root = NULL;
+    ctofu_pvec_node* tail = NULL;
+    unsigned shift = vector->shift;
+    ctofu_error error = FSCL_TOFU_ERROR_OK;
+
+    if (size - fscl_tofu_pvec_tail_offset(size) > 1) {
+        error = fscl_tofu_pvec_node_copy(vector->tail, true, vector->tail->count - 1, &tail);
+        root = fscl_tofu_pvec_node_retain(vector->root);
+    } else {
+        // The rightmost leaf of the tree becomes the tail
+        tail = fscl_tofu_pvec_node_retain((ctofu_pvec_node*)fscl_tofu_pvec_leaf(vector, size - 2));
+        error = fscl_tofu_pvec_node_pop(vector->root, shift, size, &root);
+        if (error == FSCL_TOFU_ERROR_OK && root != NULL && shift > FSCL_TOFU_PERSIST_BITS && root->count == 1) {
+            ctofu_pvec_node* child = fscl_tofu_pvec_node_retain(fscl_tofu_pvec_children(root)[0]);
+            fscl_tofu_pvec_node_release(root);
+            root = child;
+            shift -= FSCL_TOFU_PERSIST_BITS;
+        }
+        if (root == NULL) {
+            shift = FSCL_TOFU_PERSIST_BITS;
+        }
+    }
+
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_pvec_node_release(root);
+        fscl_tofu_pvec_node_release(tail);
+        return error;
+    }
+    return fscl_tofu_pvec_wrap(root, tail, shift, size - 1, result);
+}
+
+ctofu_error fscl_tofu_pvec_from(const ctofu* array, ctofu_pvec** result) {
+    if (array == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (array->type != TOFU_ARRAY_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_TYPE_MISMATCH);
+    }
+
+    ctofu_pvec* current = fscl_tofu_pvec_create();
+    if (current == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    for (size_t i = 0; i < array->data.array_type.size; ++i) {
+        ctofu_pvec* next = NULL;
+        ctofu_error error = fscl_tofu_pvec_push(current, &array->data.array_type.elements[i], &next);
+        fscl_tofu_pvec_release(current);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return error;
+        }
+        current = next;
+    }
+
+    *result = current;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_pvec_to(const ctofu_pvec* vector, ctofu* result) {
+    if (vector == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    memset(result, 0, sizeof(ctofu));
+    result->type = TOFU_ARRAY_TYPE;
+    if (vector->size == 0) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    ctofu* elements = (ctofu*)calloc(vector->size, sizeof(ctofu));
+    if (elements == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    result->data.array_type.elements = elements;
+    result->data.array_type.size = vector->size;
+
+    size_t count = 0;
+    ctofu_error error = FSCL_TOFU_ERROR_OK;
+    if (vector->root != NULL) {
+        fscl_tofu_pvec_node_export(vector->root, elements, &count, &error);
+    }
+    fscl_tofu_pvec_node_export(vector->tail, elements, &count, &error);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_value_erase(result);
+        memset(result, 0, sizeof(ctofu));
+    }
+    return error;
+}
@@ -0,0 +1,52 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/probe.h"
+#include "xtofu_internal.h"
+#include <stdatomic.h>
+
+_Atomic(ctofu_probe_hook) fscl_tofu_probe_hook = NULL;
+static _Atomic(void*) fscl_tofu_probe_context = NULL;
+
+// =======================
+// PROBE FUNCTIONS
+// =======================
+
+void fscl_tofu_probe_fire(const ctofu_probe_site* site, bool exit, ctofu_error error) {
+    ctofu_probe_hook hook = atomic_load_explicit(&fscl_tofu_probe_hook, memory_order_acquire);
+    if (hook == NULL) {
+        return;
+    }
+
+    ctofu_probe_event event = {
+        .op = site->op,
+        .type = site->type,
+        .elements = site->elements,
+        .exit = exit,
+        .error = error,
+    };
+    hook(&event, atomic_load_explicit(&fscl_tofu_probe_context, memory_order_relaxed));
+}
+
+void fscl_tofu_probe_set(ctofu_probe_hook hook, void* context) {
+    // The context is published first so that a new hook never sees an older one
+    atomic_store_explicit(&fscl_tofu_probe_context, context, memory_order_relaxed);
+    atomic_store_explicit(&fscl_tofu_probe_hook, hook, memory_order_release);
+}
+
+bool fscl_tofu_probe_usdt(void) {
+#ifdef FSCL_TOFU_USDT
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,1323 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/query.h"
+#include "xtofu_internal.h"
+#include "xtofu_sync.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Below this many elements per thread a run is not worth splitting
+#define FSCL_TOFU_QUERY_MIN_SLICE ((size_t)16 << 10)
+#define FSCL_TOFU_QUERY_MAX_THREADS 64
+
+typedef enum {
+    FSCL_TOFU_QUERY_FILTER_STAGE,
+    FSCL_TOFU_QUERY_WHERE_STAGE,
+    FSCL_TOFU_QUERY_MAP_STAGE,
+    FSCL_TOFU_QUERY_APPLY_STAGE,
+    FSCL_TOFU_QUERY_SKIP_STAGE,
+    FSCL_TOFU_QUERY_TAKE_STAGE
+} ctofu_query_stage_kind;
+
+typedef struct {
+    ctofu_query_stage_kind kind;
+    int op;                           ///< ctofu_query_compare or ctofu_query_arith.
+    ctofu operand;                    ///< Numeric operand of where and apply.
+    ctofu_query_predicate predicate;
+    ctofu_query_function function;
+    void* context;
+    size_t count;                     ///< Elements to skip or take.
+} ctofu_query_stage;
+
+struct ctofu_query {
+    const ctofu* array;
+    size_t threads;
+    size_t count;
+    bool ordered;  ///< Has skip or take stages, which need the elements in order.
+    ctofu_query_stage stages[FSCL_TOFU_QUERY_MAX_STAGES];
+};
+
+// One numeric value of any of the built-in types
+typedef union {
+    int64_t i;
+    uint64_t u;
+    double d;
+    float f;
+} ctofu_query_lane;
+
+// The data of a batch laid out flat, one array per type
+typedef union {
+    int64_t i[FSCL_TOFU_QUERY_BATCH];
+    uint64_t u[FSCL_TOFU_QUERY_BATCH];
+    double d[FSCL_TOFU_QUERY_BATCH];
+    float f[FSCL_TOFU_QUERY_BATCH];
+} ctofu_query_lanes;
+
+typedef struct {
+    ctofu_query_lane value;  ///< Running result, in double precision for float sums.
+    ctofu_type type;         ///< Type of the reduced elements.
+    size_t count;            ///< Number of reduced elements.
+} ctofu_query_total;
+
+typedef struct {
+    ctofu key;
+    uint64_t hash;
+    ctofu_query_total total;
+} ctofu_query_group;
+
+typedef struct {
+    ctofu_query_group* entries;  ///< Groups in order of first appearance.
+    size_t count;
+    size_t capacity;
+    size_t* slots;               ///< Entry index + 1, 0 for a free slot.
+    size_t mask;
+} ctofu_query_groups;
+
+typedef enum {
+    FSCL_TOFU_QUERY_REDUCE_SINK,
+    FSCL_TOFU_QUERY_FOLD_SINK,
+    FSCL_TOFU_QUERY_COLLECT_SINK,
+    FSCL_TOFU_QUERY_GROUP_SINK
+} ctofu_query_sink_kind;
+
+typedef struct {
+    ctofu_query_sink_kind kind;
+    ctofu_query_reduction reduction;
+    ctofu (*fold)(const ctofu*, const ctofu*);
+    ctofu_query_function key;
+    void* context;
+    ctofu* output;  ///< Collected elements, each slice writes from its first index on.
+} ctofu_query_sink;
+
+typedef struct {
+    const ctofu_query* query;
+    const ctofu_query_sink* sink;
+    size_t begin;
+    size_t end;
+    ctofu_error error;
+    bool done;                                       ///< A take stage is satisfied.
+    size_t remaining[FSCL_TOFU_QUERY_MAX_STAGES];    ///< Left to skip or take per stage.
+    ctofu_query_total total;
+    bool folded;
+    ctofu fold;
+    size_t written;
+    ctofu_query_groups groups;
+} ctofu_query_slice;
+
+typedef struct {
+    ctofu_query_slice* slices;
+} ctofu_query_job;
+
+typedef struct {
+    const ctofu* source;   ///< Elements of the batch in the array.
+    size_t offset;         ///< Index of the first of them.
+    size_t count;
+    ctofu_type type;       ///< Type of every live element, TOFU_UNKNOWN_TYPE when they differ.
+    bool copied;           ///< items hold the elements, source is stale.
+    bool lanes;            ///< lane holds the data of the live elements.
+    uint8_t keep[FSCL_TOFU_QUERY_BATCH];
+    bool owned[FSCL_TOFU_QUERY_BATCH];
+    ctofu_query_lanes lane;
+    ctofu items[FSCL_TOFU_QUERY_BATCH];
+} ctofu_query_batch;
+
+static inline bool fscl_tofu_query_numeric(ctofu_type type) {
+    return type == TOFU_INT_TYPE || type == TOFU_UINT_TYPE || type == TOFU_DOUBLE_TYPE || type == TOFU_FLOAT_TYPE;
+}
+
+// Converts a numeric operand to the type of the elements it is used with
+static ctofu_query_lane fscl_tofu_query_convert(const ctofu* operand, ctofu_type type) {
+    ctofu_query_lane lane;
+    lane.u = 0;
+
+#define FSCL_TOFU_QUERY_CAST(source)                                      \
+    switch (type) {                                                       \
+        case TOFU_INT_TYPE: lane.i = (int64_t)(source); break;            \
+        case TOFU_UINT_TYPE: lane.u = (uint64_t)(source); break;          \
+        case TOFU_DOUBLE_TYPE: lane.d = (double)(source); break;          \
+        default: lane.f = (float)(source); break;                         \
+    }
+
+    switch (operand->type) {
+        case TOFU_INT_TYPE: FSCL_TOFU_QUERY_CAST(operand->data.int_type) break;
+        case TOFU_UINT_TYPE: FSCL_TOFU_QUERY_CAST(operand->data.uint_type) break;
+        case TOFU_DOUBLE_TYPE: FSCL_TOFU_QUERY_CAST(operand->data.double_type) break;
+        default: FSCL_TOFU_QUERY_CAST(operand->data.float_type) break;
+    }
+
+#undef FSCL_TOFU_QUERY_CAST
+    return lane;
+}
+
+// Copies the data of a numeric element to slot index of lanes
+static void fscl_tofu_query_lane_load(ctofu_query_lanes* lanes, size_t index, const ctofu* value) {
+    switch (value->type) {
+        case TOFU_INT_TYPE: lanes->i[index] = value->data.int_type; break;
+        case TOFU_UINT_TYPE: lanes->u[index] = value->data.uint_type; break;
+        case TOFU_DOUBLE_TYPE: lanes->d[index] = value->data.double_type; break;
+        default: lanes->f[index] = value->data.float_type; break;
+    }
+}
+
+// Copies slot index of lanes back to a numeric element of the same type
+static void fscl_tofu_query_lane_store(const ctofu_query_lanes* lanes, size_t index, ctofu* value) {
+    switch (value->type) {
+        case TOFU_INT_TYPE: value->data.int_type = lanes->i[index]; break;
+        case TOFU_UINT_TYPE: value->data.uint_type = lanes->u[index]; break;
+        case TOFU_DOUBLE_TYPE: value->data.double_type = lanes->d[index]; break;
+        default: value->data.float_type = lanes->f[index]; break;
+    }
+}
+
+// =======================
+// KERNELS
+// =======================
+
+// The kernels run over every lane of a batch, live or not, so each is one
+// branch-free loop; dropped lanes are masked out by keep.
+
+static void fscl_tofu_query_where_lanes(ctofu_type type, ctofu_query_compare compare, ctofu_query_lane bound,
+                                        const ctofu_query_lanes* lane, uint8_t* keep, size_t count) {
+#define FSCL_TOFU_QUERY_COMPARE_LOOP(field, OP)                               \
+    for (size_t i = 0; i < count; ++i) {                                      \
+        keep[i] &= (uint8_t)(lane->field[i] OP bound.field);                  \
+    }                                                                         \
+    break;
+
+#define FSCL_TOFU_QUERY_COMPARE(field)                                                      \
+    switch (compare) {                                                                      \
+        case FSCL_TOFU_QUERY_LESS: FSCL_TOFU_QUERY_COMPARE_LOOP(field, <)                   \
+        case FSCL_TOFU_QUERY_LESS_EQUAL: FSCL_TOFU_QUERY_COMPARE_LOOP(field, <=)            \
+        case FSCL_TOFU_QUERY_EQUAL: FSCL_TOFU_QUERY_COMPARE_LOOP(field, ==)                 \
+        case FSCL_TOFU_QUERY_NOT_EQUAL: FSCL_TOFU_QUERY_COMPARE_LOOP(field, !=)             \
+        case FSCL_TOFU_QUERY_GREATER_EQUAL: FSCL_TOFU_QUERY_COMPARE_LOOP(field, >=)         \
+        case FSCL_TOFU_QUERY_GREATER: FSCL_TOFU_QUERY_COMPARE_LOOP(field, >)                \
+    }                                                                                       \
+    break;
+
+    switch (type) {
+        case TOFU_INT_TYPE: FSCL_TOFU_QUERY_COMPARE(i)
+        case TOFU_UINT_TYPE: FSCL_TOFU_QUERY_COMPARE(u)
+        case TOFU_DOUBLE_TYPE: FSCL_TOFU_QUERY_COMPARE(d)
+        default: FSCL_TOFU_QUERY_COMPARE(f)
+    }
+
+#undef FSCL_TOFU_QUERY_COMPARE
+#undef FSCL_TOFU_QUERY_COMPARE_LOOP
+}
+
+static void fscl_tofu_query_apply_lanes(ctofu_type type, ctofu_query_arith arith, ctofu_query_lane operand,
+                                        ctofu_query_lanes* lane, size_t count) {
+#define FSCL_TOFU_QUERY_ARITH_LOOP(expression)  \
+    for (size_t i = 0; i < count; ++i) {        \
+        expression;                             \
+    }                                           \
+    break;
+
+// Integers are combined as unsigned so overflow wraps around
+#define FSCL_TOFU_QUERY_ARITH(field, T, W)                                                                 \
+    switch (arith) {                                                                                       \
+        case FSCL_TOFU_QUERY_ADD:                                                                          \
+            FSCL_TOFU_QUERY_ARITH_LOOP(lane->field[i] = (T)((W)lane->field[i] + (W)operand.field))         \
+        case FSCL_TOFU_QUERY_SUBTRACT:                                                                     \
+            FSCL_TOFU_QUERY_ARITH_LOOP(lane->field[i] = (T)((W)lane->field[i] - (W)operand.field))         \
+        case FSCL_TOFU_QUERY_MULTIPLY:                                                                     \
+            FSCL_TOFU_QUERY_ARITH_LOOP(lane->field[i] = (T)((W)lane->field[i] * (W)operand.field))         \
+    }                                                                                                      \
+    break;
+
+    switch (type) {
+        case TOFU_INT_TYPE: FSCL_TOFU_QUERY_ARITH(i, int64_t, uint64_t)
+        case TOFU_UINT_TYPE: FSCL_TOFU_QUERY_ARITH(u, uint64_t, uint64_t)
+        case TOFU_DOUBLE_TYPE: FSCL_TOFU_QUERY_ARITH(d, double, double)
+        default: FSCL_TOFU_QUERY_ARITH(f, float, float)
+    }
+
+#undef FSCL_TOFU_QUERY_ARITH
+#undef FSCL_TOFU_QUERY_ARITH_LOOP
+}
+
+static ctofu_query_lane fscl_tofu_query_identity(ctofu_query_reduction reduction, ctofu_type type) {
+    ctofu_query_lane lane;
+    lane.u = 0;
+    if (reduction == FSCL_TOFU_QUERY_SUM) {
+        return lane;  // float sums run in double precision, 0 is all zero bits either way
+    }
+
+    bool least = reduction == FSCL_TOFU_QUERY_MIN;
+    switch (type) {
+        case TOFU_INT_TYPE: lane.i = least ? INT64_MAX : INT64_MIN; break;
+        case TOFU_UINT_TYPE: lane.u = least ? UINT64_MAX : 0; break;
+        case TOFU_DOUBLE_TYPE: lane.d = least ? INFINITY : -INFINITY; break;
+        default: lane.f = least ? INFINITY : -INFINITY; break;
+    }
+    return lane;
+}
+
+// Folds the live lanes into value, which already holds a running result
+static void fscl_tofu_query_reduce_lanes(ctofu_query_reduction reduction, ctofu_type type, const ctofu_query_lanes* lane,
+                                         const uint8_t* keep, size_t count, ctofu_query_lane* value) {
+    if (reduction == FSCL_TOFU_QUERY_SUM) {
+        if (type == TOFU_INT_TYPE || type == TOFU_UINT_TYPE) {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < count; ++i) {
+                sum += lane->u[i] & (0 - (uint64_t)keep[i]);
+            }
+            value->u += sum;
+            return;
+        }
+
+        // Four partial sums keep the additions independent
+        double sums[4] = {0.0, 0.0, 0.0, 0.0};
+        size_t i = 0;
+        if (type == TOFU_DOUBLE_TYPE) {
+            for (; i + 4 <= count; i += 4) {
+                for (size_t k = 0; k < 4; ++k) {
+                    sums[k] += keep[i + k] ? lane->d[i + k] : 0.0;
+                }
+            }
+            for (; i < count; ++i) {
+                sums[0] += keep[i] ? lane->d[i] : 0.0;
+            }
+        } else {
+            for (; i + 4 <= count; i += 4) {
+                for (size_t k = 0; k < 4; ++k) {
+                    sums[k] += keep[i + k] ? (double)lane->f[i + k] : 0.0;
+                }
+            }
+            for (; i < count; ++i) {
+                sums[0] += keep[i] ? (double)lane->f[i] : 0.0;
+            }
+        }
+        value->d += (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        return;
+    }
+
+#define FSCL_TOFU_QUERY_BEST(T, field, OP)                              \
+    {                                                                   \
+        T best = value->field;                                          \
+        for (size_t i = 0; i < count; ++i) {                            \
+            T candidate = lane->field[i];                               \
+            bool better = (keep[i] != 0) & (candidate OP best);         \
+            best = better ? candidate : best;                           \
+        }                                                               \
+        value->field = best;                                            \
+    }                                                                   \
+    break;
+
+    if (reduction == FSCL_TOFU_QUERY_MIN) {
+        switch (type) {
+            case TOFU_INT_TYPE: FSCL_TOFU_QUERY_BEST(int64_t, i, <)
+            case TOFU_UINT_TYPE: FSCL_TOFU_QUERY_BEST(uint64_t, u, <)
+            case TOFU_DOUBLE_TYPE: FSCL_TOFU_QUERY_BEST(double, d, <)
+            default: FSCL_TOFU_QUERY_BEST(float, f, <)
+        }
+    } else {
+        switch (type) {
+            case TOFU_INT_TYPE: FSCL_TOFU_QUERY_BEST(int64_t, i, >)
+            case TOFU_UINT_TYPE: FSCL_TOFU_QUERY_BEST(uint64_t, u, >)
+            case TOFU_DOUBLE_TYPE: FSCL_TOFU_QUERY_BEST(double, d, >)
+            default: FSCL_TOFU_QUERY_BEST(float, f, >)
+        }
+    }
+
+#undef FSCL_TOFU_QUERY_BEST
+}
+
+// =======================
+// TOTAL HELPERS
+// =======================
+
+static ctofu_error fscl_tofu_query_accumulate(ctofu_query_reduction reduction, ctofu_type type, const ctofu_query_lanes* lane,
+                                              const uint8_t* keep, size_t count, ctofu_query_total* total) {
+    size_t live = 0;
+    for (size_t i = 0; i < count; ++i) {
+        live += keep[i];
+    }
+    if (live == 0 || reduction == FSCL_TOFU_QUERY_COUNT) {
+        total->count += live;
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    if (total->count == 0) {
+        total->type = type;
+        total->value = fscl_tofu_query_identity(reduction, type);
+    } else if (total->type != type) {
+        return FSCL_TOFU_ERROR_TYPE_MISMATCH;
+    }
+    total->count += live;
+    fscl_tofu_query_reduce_lanes(reduction, type, lane, keep, count, &total->value);
+    return FSCL_TOFU_ERROR_OK;
+}
+
+// Adds the total of a later part of the array to into
+static ctofu_error fscl_tofu_query_combine(ctofu_query_reduction reduction, ctofu_query_total* into, const ctofu_query_total* from) {
+    if (from->count == 0) {
+        return FSCL_TOFU_ERROR_OK;
+    }
+    if (into->count == 0 || reduction == FSCL_TOFU_QUERY_COUNT) {
+        size_t count = into->count + from->count;
+        if (into->count == 0) {
+            *into = *from;
+        }
+        into->count = count;
+        return FSCL_TOFU_ERROR_OK;
+    }
+    if (into->type != from->type) {
+        return FSCL_TOFU_ERROR_TYPE_MISMATCH;
+    }
+
+    into->count += from->count;
+    if (reduction == FSCL_TOFU_QUERY_SUM) {
+        if (from->type == TOFU_INT_TYPE || from->type == TOFU_UINT_TYPE) {
+            into->value.u += from->value.u;
+        } else {
+            into->value.d += from->value.d;
+        }
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    bool least = reduction == FSCL_TOFU_QUERY_MIN;
+#define FSCL_TOFU_QUERY_PICK(field)                                                                         \
+    if (least ? from->value.field < into->value.field : from->value.field > into->value.field) {           \
+        into->value.field = from->value.field;                                                             \
+    }                                                                                                       \
+    break;
+
+    switch (from->type) {
+        case TOFU_INT_TYPE: FSCL_TOFU_QUERY_PICK(i)
+        case TOFU_UINT_TYPE: FSCL_TOFU_QUERY_PICK(u)
+        case TOFU_DOUBLE_TYPE: FSCL_TOFU_QUERY_PICK(d)
+        default: FSCL_TOFU_QUERY_PICK(f)
+    }
+
+#undef FSCL_TOFU_QUERY_PICK
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error fscl_tofu_query_total_value(ctofu_query_reduction reduction, const ctofu_query_total* total, ctofu* result) {
+    memset(result, 0, sizeof(ctofu));
+    if (reduction == FSCL_TOFU_QUERY_COUNT) {
+        result->type = TOFU_UINT_TYPE;
+        result->data.uint_type = total->count;
+        return FSCL_TOFU_ERROR_OK;
+    }
+    if (total->count == 0) {
+        result->type = TOFU_NULLPTR_TYPE;
+        return FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS;
+    }
+
+    result->type = total->type;
+    switch (total->type) {
+        case TOFU_INT_TYPE: result->data.int_type = total->value.i; break;
+        case TOFU_UINT_TYPE: result->data.uint_type = total->value.u; break;
+        case TOFU_DOUBLE_TYPE: result->data.double_type = total->value.d; break;
+        default:
+            if (reduction == FSCL_TOFU_QUERY_SUM) {
+                result->type = TOFU_DOUBLE_TYPE;
+                result->data.double_type = total->value.d;
+            } else {
+                result->data.float_type = total->value.f;
+            }
+            break;
+    }
+    return FSCL_TOFU_ERROR_OK;
+}
+
+// Reduces one element of any numeric type into a total
+static ctofu_error fscl_tofu_query_accumulate_one(ctofu_query_reduction reduction, const ctofu* value, ctofu_query_total* total) {
+    static const uint8_t live = 1;
+    if (reduction == FSCL_TOFU_QUERY_COUNT) {
+        total->count++;
+        return FSCL_TOFU_ERROR_OK;
+    }
+    if (!fscl_tofu_query_numeric(value->type)) {
+        return FSCL_TOFU_ERROR_TYPE_MISMATCH;
+    }
+    ctofu_query_lanes one;
+    fscl_tofu_query_lane_load(&one, 0, value);
+    return fscl_tofu_query_accumulate(reduction, value->type, &one, &live, 1, total);
+}
+
+// =======================
+// BATCH HELPERS
+// =======================
+
+static void fscl_tofu_query_load(ctofu_query_batch* batch, const ctofu* source, size_t offset, size_t count) {
+    batch->source = source;
+    batch->offset = offset;
+    batch->count = count;
+    batch->copied = false;
+    batch->lanes = false;
+    memset(batch->keep, 1, count);
+
+    ctofu_type type = source[0].type;
+    for (size_t i = 1; i < count; ++i) {
+        type = source[i].type == type ? type : TOFU_UNKNOWN_TYPE;
+    }
+    batch->type = type;
+}
+
+// Erases the values stages created and nobody took
+static void fscl_tofu_query_unload(ctofu_query_batch* batch) {
+    if (!batch->copied) {
+        return;
+    }
+    for (size_t i = 0; i < batch->count; ++i) {
+        if (batch->owned[i]) {
+            fscl_tofu_value_erase(&batch->items[i]);
+        }
+    }
+}
+
+// Makes items hold the elements, so stages can replace them
+static void fscl_tofu_query_copy(ctofu_query_batch* batch) {
+    if (!batch->copied) {
+        memcpy(batch->items, batch->source, batch->count * sizeof(ctofu));
+        memset(batch->owned, 0, batch->count);
+        batch->copied = true;
+    }
+}
+
+// Loads the data of the batch into lane when every live element has the same numeric type
+static bool fscl_tofu_query_gather(ctofu_query_batch* batch) {
+    if (batch->lanes) {
+        return true;
+    }
+
+    const ctofu* values = batch->copied ? batch->items : batch->source;
+    if (batch->type == TOFU_UNKNOWN_TYPE) {
+        // Filters may have dropped the odd ones out
+        ctofu_type type = TOFU_INVALID_TYPE;
+        for (size_t i = 0; i < batch->count; ++i) {
+            if (batch->keep[i]) {
+                type = type == TOFU_INVALID_TYPE || type == values[i].type ? values[i].type : TOFU_UNKNOWN_TYPE;
+            }
+        }
+        batch->type = type;
+    }
+    if (!fscl_tofu_query_numeric(batch->type)) {
+        return false;
+    }
+
+    ctofu_query_lanes* lane = &batch->lane;
+    switch (batch->type) {
+        case TOFU_INT_TYPE:
+            for (size_t i = 0; i < batch->count; ++i) {
+                lane->i[i] = values[i].data.int_type;
+            }
+            break;
+        case TOFU_UINT_TYPE:
+            for (size_t i = 0; i < batch->count; ++i) {
+                lane->u[i] = values[i].data.uint_type;
+            }
+            break;
+        case TOFU_DOUBLE_TYPE:
+            for (size_t i = 0; i < batch->count; ++i) {
+                lane->d[i] = values[i].data.double_type;
+            }
+            break;
+        default:
+            for (size_t i = 0; i < batch->count; ++i) {
+                lane->f[i] = values[i].data.float_type;
+            }
+            break;
+    }
+    batch->lanes = true;
+    return true;
+}
+
+// Returns the current elements of the batch, storing lane back first if needed
+static const ctofu* fscl_tofu_query_view(ctofu_query_batch* batch) {
+    if (batch->lanes) {
+        fscl_tofu_query_copy(batch);
+        for (size_t i = 0; i < batch->count; ++i) {
+            if (batch->keep[i]) {
+                batch->items[i].type = batch->type;
+                batch->items[i].flags = 0;
+                fscl_tofu_query_lane_store(&batch->lane, i, &batch->items[i]);
+            }
+        }
+        batch->lanes = false;
+    }
+    return batch->copied ? batch->items : batch->source;
+}
+
+// Copies a value out of the batch, or moves it when a stage created it
+static ctofu_error fscl_tofu_query_export(ctofu_query_batch* batch, const ctofu* values, size_t index, ctofu* dest) {
+    const ctofu* value = &values[index];
+    if (batch->copied && batch->owned[index]) {
+        *dest = batch->items[index];
+        batch->owned[index] = false;
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    switch (value->type) {
+        case TOFU_STRING_TYPE:
+            return fscl_tofu_value_copy(value, dest);
+        case TOFU_ARRAY_TYPE:
+        case TOFU_MAP_TYPE:
+            if (value->data.array_type.size != 0) {
+                return fscl_tofu_value_copy(value, dest);
+            }
+            // Empty containers own nothing, which fscl_tofu_value_copy refuses
+            memset(dest, 0, sizeof(ctofu));
+            dest->type = value->type;
+            return FSCL_TOFU_ERROR_OK;
+        default:
+            *dest = *value;
+            dest->flags = 0;
+            return FSCL_TOFU_ERROR_OK;
+    }
+}
+
+// Callbacks often build scalars without setting flags
+static void fscl_tofu_query_settle(ctofu* value) {
+    if (value->type != TOFU_STRING_TYPE && value->type != TOFU_ARRAY_TYPE && value->type != TOFU_MAP_TYPE) {
+        value->flags = 0;
+    }
+}
+
+// =======================
+// STAGES
+// =======================
+
+static ctofu_error fscl_tofu_query_where_stage(const ctofu_query_stage* stage, ctofu_query_batch* batch) {
+    ctofu_query_compare compare = (ctofu_query_compare)stage->op;
+    if (fscl_tofu_query_gather(batch)) {
+        ctofu_query_lane bound = fscl_tofu_query_convert(&stage->operand, batch->type);
+        fscl_tofu_query_where_lanes(batch->type, compare, bound, &batch->lane, batch->keep, batch->count);
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    // Mixed types, one element at a time
+    ctofu_query_lanes one;
+    const ctofu* values = fscl_tofu_query_view(batch);
+    for (size_t i = 0; i < batch->count; ++i) {
+        if (!batch->keep[i]) {
+            continue;
+        }
+        if (!fscl_tofu_query_numeric(values[i].type)) {
+            return FSCL_TOFU_ERROR_ELEMENT(FSCL_TOFU_ERROR_TYPE_MISMATCH, batch->offset + i, values[i].type);
+        }
+        fscl_tofu_query_lane_load(&one, 0, &values[i]);
+        ctofu_query_lane bound = fscl_tofu_query_convert(&stage->operand, values[i].type);
+        fscl_tofu_query_where_lanes(values[i].type, compare, bound, &one, &batch->keep[i], 1);
+    }
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error fscl_tofu_query_apply_stage(const ctofu_query_stage* stage, ctofu_query_batch* batch) {
+    ctofu_query_arith arith = (ctofu_query_arith)stage->op;
+    if (fscl_tofu_query_gather(batch)) {
+        ctofu_query_lane operand = fscl_tofu_query_convert(&stage->operand, batch->type);
+        fscl_tofu_query_apply_lanes(batch->type, arith, operand, &batch->lane, batch->count);
+        return FSCL_TOFU_ERROR_OK;
+    }
+
+    // Mixed types, one element at a time
+    ctofu_query_lanes one;
+    fscl_tofu_query_view(batch);
+    fscl_tofu_query_copy(batch);
+    for (size_t i = 0; i < batch->count; ++i) {
+        ctofu* value = &batch->items[i];
+        if (!batch->keep[i]) {
+            continue;
+        }
+        if (!fscl_tofu_query_numeric(value->type)) {
+            return FSCL_TOFU_ERROR_ELEMENT(FSCL_TOFU_ERROR_TYPE_MISMATCH, batch->offset + i, value->type);
+        }
+        fscl_tofu_query_lane_load(&one, 0, value);
+        fscl_tofu_query_apply_lanes(value->type, arith, fscl_tofu_query_convert(&stage->operand, value->type), &one, 1);
+        fscl_tofu_query_lane_store(&one, 0, value);
+    }
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error fscl_tofu_query_map_stage(const ctofu_query_stage* stage, ctofu_query_batch* batch) {
+    const ctofu* values = fscl_tofu_query_view(batch);
+    bool fresh = !batch->copied;
+    fscl_tofu_query_copy(batch);
+
+    ctofu_type type = TOFU_INVALID_TYPE;
+    for (size_t i = 0; i < batch->count; ++i) {
+        if (!batch->keep[i]) {
+            continue;
+        }
+
+        ctofu result;
+        memset(&result, 0, sizeof(result));
+        ctofu_error error = stage->function(&values[i], &result, stage->context);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return error;
+        }
+        fscl_tofu_query_settle(&result);
+
+        // values may be items, so the element is erased only after the call
+        if (!fresh && batch->owned[i]) {
+            fscl_tofu_value_erase(&batch->items[i]);
+        }
+        batch->items[i] = result;
+        batch->owned[i] = true;
+        type = type == TOFU_INVALID_TYPE || type == result.type ? result.type : TOFU_UNKNOWN_TYPE;
+    }
+
+    batch->type = type == TOFU_INVALID_TYPE ? TOFU_UNKNOWN_TYPE : type;
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error fscl_tofu_query_stage(ctofu_query_slice* slice, size_t index, ctofu_query_batch* batch) {
+    const ctofu_query_stage* stage = &slice->query->stages[index];
+    switch (stage->kind) {
+        case FSCL_TOFU_QUERY_FILTER_STAGE: {
+            const ctofu* values = fscl_tofu_query_view(batch);
+            for (size_t i = 0; i < batch->count; ++i) {
+                if (batch->keep[i] && !stage->predicate(&values[i], stage->context)) {
+                    batch->keep[i] = 0;
+                }
+            }
+            return FSCL_TOFU_ERROR_OK;
+        }
+        case FSCL_TOFU_QUERY_WHERE_STAGE:
+            return fscl_tofu_query_where_stage(stage, batch);
+        case FSCL_TOFU_QUERY_MAP_STAGE:
+            return fscl_tofu_query_map_stage(stage, batch);
+        case FSCL_TOFU_QUERY_APPLY_STAGE:
+            return fscl_tofu_query_apply_stage(stage, batch);
+        case FSCL_TOFU_QUERY_SKIP_STAGE:
+        case FSCL_TOFU_QUERY_TAKE_STAGE: {
+            bool take = stage->kind == FSCL_TOFU_QUERY_TAKE_STAGE;
+            size_t* remaining = &slice->remaining[index];
+            for (size_t i = 0; i < batch->count; ++i) {
+                if (!batch->keep[i]) {
+                    continue;
+                }
+                if (*remaining == 0) {
+                    if (!take) {
+                        break;  // Everything from here on passes
+                    }
+                    batch->keep[i] = 0;
+                } else {
+                    --*remaining;
+                    batch->keep[i] = take;
+                }
+            }
+            if (take && *remaining == 0) {
+                slice->done = true;
+            }
+            return FSCL_TOFU_ERROR_OK;
+        }
+    }
+    return FSCL_TOFU_ERROR_INVALID_OPERATION;
+}
+
+// =======================
+// SINKS
+// =======================
+
+static ctofu_query_group* fscl_tofu_query_group_find(const ctofu_query_groups* groups, const ctofu* key, uint64_t hash) {
+    if (groups->slots == NULL) {
+        return NULL;
+    }
+    for (size_t slot = hash & groups->mask; groups->slots[slot] != 0; slot = (slot + 1) & groups->mask) {
+        ctofu_query_group* group = &groups->entries[groups->slots[slot] - 1];
+        if (fscl_tofu_key_equal(&group->key, group->hash, key, hash)) {
+            return group;
+        }
+    }
+    return NULL;
+}
+
+// Adds a group taking over key, NULL if out of memory (key is then left alone)
+static ctofu_query_group* fscl_tofu_query_group_add(ctofu_query_groups* groups, const ctofu* key, uint64_t hash) {
+    if (groups->count == groups->capacity) {
+        size_t capacity = groups->capacity == 0 ? 16 : groups->capacity * 2;
+        ctofu_query_group* entries = (ctofu_query_group*)realloc(groups->entries, capacity * sizeof(ctofu_query_group));
+        if (entries == NULL) {
+            return NULL;
+        }
+        groups->entries = entries;
+        groups->capacity = capacity;
+    }
+
+    // Keep the table at most half full
+    if (groups->slots == NULL || 2 * (groups->count + 1) > groups->mask + 1) {
+        size_t size = groups->slots == NULL ? 32 : 2 * (groups->mask + 1);
+        size_t* slots = (size_t*)calloc(size, sizeof(size_t));
+        if (slots == NULL) {
+            return NULL;
+        }
+        for (size_t i = 0; i < groups->count; ++i) {
+            size_t slot = groups->entries[i].hash & (size - 1);
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & (size - 1);
+            }
+            slots[slot] = i + 1;
+        }
+        free(groups->slots);
+        groups->slots = slots;
+        groups->mask = size - 1;
+    }
+
+    size_t slot = hash & groups->mask;
+    while (groups->slots[slot] != 0) {
+        slot = (slot + 1) & groups->mask;
+    }
+    groups->slots[slot] = groups->count + 1;
+
+    ctofu_query_group* group = &groups->entries[groups->count++];
+    group->key = *key;
+    group->hash = hash;
+    memset(&group->total, 0, sizeof(group->total));
+    return group;
+}
+
+static void fscl_tofu_query_groups_erase(ctofu_query_groups* groups) {
+    for (size_t i = 0; i < groups->count; ++i) {
+        fscl_tofu_value_erase(&groups->entries[i].key);
+    }
+    free(groups->entries);
+    free(groups->slots);
+    memset(groups, 0, sizeof(ctofu_query_groups));
+}
+
+static ctofu_error fscl_tofu_query_group_sink(ctofu_query_slice* slice, ctofu_query_batch* batch) {
+    const ctofu_query_sink* sink = slice->sink;
+    const ctofu* values = fscl_tofu_query_view(batch);
+
+    for (size_t i = 0; i < batch->count; ++i) {
+        if (!batch->keep[i]) {
+            continue;
+        }
+
+        ctofu key;
+        ctofu_error error;
+        if (sink->key == NULL) {
+            key = values[i];
+        } else {
+            memset(&key, 0, sizeof(key));
+            error = sink->key(&values[i], &key, sink->context);
+            if (error != FSCL_TOFU_ERROR_OK) {
+                return error;
+            }
+            fscl_tofu_query_settle(&key);
+        }
+
+        uint64_t hash = fscl_tofu_hash(&key);
+        ctofu_query_group* group = fscl_tofu_query_group_find(&slice->groups, &key, hash);
+        if (group != NULL) {
+            if (sink->key != NULL) {
+                fscl_tofu_value_erase(&key);
+            }
+        } else {
+            ctofu stored = key;
+            if (sink->key == NULL) {
+                error = fscl_tofu_query_export(batch, values, i, &stored);
+                if (error != FSCL_TOFU_ERROR_OK) {
+                    return error;
+                }
+            }
+            group = fscl_tofu_query_group_add(&slice->groups, &stored, hash);
+            if (group == NULL) {
+                fscl_tofu_value_erase(&stored);
+                return FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+            }
+        }
+
+        // A key moved out of the batch still leaves its data readable there
+        error = fscl_tofu_query_accumulate_one(sink->reduction, &values[i], &group->total);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return FSCL_TOFU_ERROR_ELEMENT(error, batch->offset + i, values[i].type);
+        }
+    }
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error fscl_tofu_query_sink_batch(ctofu_query_slice* slice, ctofu_query_batch* batch) {
+    const ctofu_query_sink* sink = slice->sink;
+    switch (sink->kind) {
+        case FSCL_TOFU_QUERY_REDUCE_SINK: {
+            if (sink->reduction == FSCL_TOFU_QUERY_COUNT || fscl_tofu_query_gather(batch)) {
+                ctofu_error error = fscl_tofu_query_accumulate(sink->reduction, batch->type, &batch->lane, batch->keep,
+                                                               batch->count, &slice->total);
+                return error == FSCL_TOFU_ERROR_OK ? error : FSCL_TOFU_ERROR_ELEMENT(error, batch->offset, batch->type);
+            }
+            const ctofu* values = fscl_tofu_query_view(batch);
+            for (size_t i = 0; i < batch->count; ++i) {
+                if (batch->keep[i]) {
+                    ctofu_error error = fscl_tofu_query_accumulate_one(sink->reduction, &values[i], &slice->total);
+                    if (error != FSCL_TOFU_ERROR_OK) {
+                        return FSCL_TOFU_ERROR_ELEMENT(error, batch->offset + i, values[i].type);
+                    }
+                }
+            }
+            return FSCL_TOFU_ERROR_OK;
+        }
+        case FSCL_TOFU_QUERY_FOLD_SINK: {
+            const ctofu* values = fscl_tofu_query_view(batch);
+            for (size_t i = 0; i < batch->count; ++i) {
+                if (!batch->keep[i]) {
+                    continue;
+                }
+                if (!slice->folded) {
+                    ctofu_error error = fscl_tofu_query_export(batch, values, i, &slice->fold);
+                    if (error != FSCL_TOFU_ERROR_OK) {
+                        return error;
+                    }
+                    slice->folded = true;
+                    continue;
+                }
+                ctofu next = sink->fold(&slice->fold, &values[i]);
+                fscl_tofu_query_settle(&next);
+                fscl_tofu_value_erase(&slice->fold);
+                slice->fold = next;
+            }
+            return FSCL_TOFU_ERROR_OK;
+        }
+        case FSCL_TOFU_QUERY_COLLECT_SINK: {
+            const ctofu* values = fscl_tofu_query_view(batch);
+            ctofu* output = sink->output + slice->begin;
+            for (size_t i = 0; i < batch->count; ++i) {
+                if (!batch->keep[i]) {
+                    continue;
+                }
+                ctofu_error error = fscl_tofu_query_export(batch, values, i, &output[slice->written]);
+                if (error != FSCL_TOFU_ERROR_OK) {
+                    return error;
+                }
+                slice->written++;
+            }
+            return FSCL_TOFU_ERROR_OK;
+        }
+        case FSCL_TOFU_QUERY_GROUP_SINK:
+            return fscl_tofu_query_group_sink(slice, batch);
+    }
+    return FSCL_TOFU_ERROR_INVALID_OPERATION;
+}
+
+// =======================
+// RUN HELPERS
+// =======================
+
+static void fscl_tofu_query_run_slice(ctofu_query_slice* slice) {
+    const ctofu_query* query = slice->query;
+    const ctofu* elements = query->array->data.array_type.elements;
+
+    // About 11 KiB, on the stack of the thread running the slice
+    ctofu_query_batch batch;
+    for (size_t start = slice->begin; start < slice->end && !slice->done; start += FSCL_TOFU_QUERY_BATCH) {
+        size_t count = slice->end - start < FSCL_TOFU_QUERY_BATCH ? slice->end - start : FSCL_TOFU_QUERY_BATCH;
+        fscl_tofu_query_load(&batch, elements + start, start, count);
+
+        ctofu_error error = FSCL_TOFU_ERROR_OK;
+        for (size_t s = 0; s < query->count && error == FSCL_TOFU_ERROR_OK; ++s) {
+            error = fscl_tofu_query_stage(slice, s, &batch);
+        }
+        if (error == FSCL_TOFU_ERROR_OK) {
+            error = fscl_tofu_query_sink_batch(slice, &batch);
+        }
+        fscl_tofu_query_unload(&batch);
+
+        if (error != FSCL_TOFU_ERROR_OK) {
+            slice->error = error;
+            return;
+        }
+    }
+}
+
+static void fscl_tofu_query_run_task(void* context, size_t task) {
+    ctofu_query_job* job = (ctofu_query_job*)context;
+    fscl_tofu_query_run_slice(&job->slices[task]);
+}
+
+// Splits the array into slices and runs them. The slices are local when
+// there is only one, else allocated and freed with fscl_tofu_query_finish.
+static ctofu_query_slice* fscl_tofu_query_start(const ctofu_query* query, const ctofu_query_sink* sink,
+                                                ctofu_query_slice* local, size_t* count) {
+    size_t size = query->array->data.array_type.size;
+    size_t slices = query->ordered ? 1 : query->threads;
+    if (slices > size / FSCL_TOFU_QUERY_MIN_SLICE) {
+        slices = size / FSCL_TOFU_QUERY_MIN_SLICE;
+    }
+
+    ctofu_query_slice* slice = slices > 1 ? (ctofu_query_slice*)calloc(slices, sizeof(ctofu_query_slice)) : NULL;
+    if (slice == NULL) {
+        // One slice, also when out of memory for more
+        slices = 1;
+        slice = local;
+        memset(local, 0, sizeof(ctofu_query_slice));
+    }
+
+    for (size_t i = 0; i < slices; ++i) {
+        slice[i].query = query;
+        slice[i].sink = sink;
+        slice[i].begin = size / slices * i;
+        slice[i].end = i + 1 == slices ? size : size / slices * (i + 1);
+        slice[i].error = FSCL_TOFU_ERROR_OK;
+        for (size_t s = 0; s < query->count; ++s) {
+            slice[i].remaining[s] = query->stages[s].count;
+        }
+    }
+
+    if (slices == 1) {
+        fscl_tofu_query_run_slice(slice);
+    } else {
+        ctofu_query_job job = { slice };
+        fscl_tofu_parallel_run(slices, fscl_tofu_query_run_task, &job);
+    }
+
+    *count = slices;
+    return slice;
+}
+
+// Returns the first error in array order
+static ctofu_error fscl_tofu_query_failure(const ctofu_query_slice* slice, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (slice[i].error != FSCL_TOFU_ERROR_OK) {
+            return slice[i].error;
+        }
+    }
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static void fscl_tofu_query_finish(ctofu_query_slice* slice, const ctofu_query_slice* local) {
+    if (slice != local) {
+        free(slice);
+    }
+}
+
+static ctofu_error fscl_tofu_query_stage_add(ctofu_query* query, const ctofu_query_stage* stage) {
+    if (query == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (query->count == FSCL_TOFU_QUERY_MAX_STAGES) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+    query->stages[query->count++] = *stage;
+    query->ordered = query->ordered || stage->kind == FSCL_TOFU_QUERY_SKIP_STAGE ||
+                     stage->kind == FSCL_TOFU_QUERY_TAKE_STAGE;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+static ctofu_error fscl_tofu_query_operand_add(ctofu_query* query, ctofu_query_stage_kind kind, int op, const ctofu* operand) {
+    if (operand == NULL || !fscl_tofu_query_numeric(operand->type)) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+    ctofu_query_stage stage;
+    memset(&stage, 0, sizeof(stage));
+    stage.kind = kind;
+    stage.op = op;
+    stage.operand = *operand;
+    stage.operand.flags = 0;
+    return fscl_tofu_query_stage_add(query, &stage);
+}
+
+// =======================
+// CREATE/ERASE FUNCTIONS
+// =======================
+
+ctofu_query* fscl_tofu_query_create(const ctofu* array) {
+    if (array == NULL || array->type != TOFU_ARRAY_TYPE) {
+        return NULL;
+    }
+    ctofu_query* query = (ctofu_query*)calloc(1, sizeof(ctofu_query));
+    if (query == NULL) {
+        return NULL;
+    }
+    query->array = array;
+    query->threads = 1;
+    return query;
+}
+
+void fscl_tofu_query_erase(ctofu_query* query) {
+    free(query);
+}
+
+void fscl_tofu_query_threads(ctofu_query* query, size_t threads) {
+    if (query != NULL) {
+        query->threads = threads == 0 ? 1 : threads > FSCL_TOFU_QUERY_MAX_THREADS ? FSCL_TOFU_QUERY_MAX_THREADS : threads;
+    }
+}
+
+// =======================
+// STAGE FUNCTIONS
+// =======================
+
+ctofu_error fscl_tofu_query_filter(ctofu_query* query, ctofu_query_predicate predicate, void* context) {
+    if (predicate == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+    ctofu_query_stage stage;
+    memset(&stage, 0, sizeof(stage));
+    stage.kind = FSCL_TOFU_QUERY_FILTER_STAGE;
+    stage.predicate = predicate;
+    stage.context = context;
+    return fscl_tofu_query_stage_add(query, &stage);
+}
+
+ctofu_error fscl_tofu_query_where(ctofu_query* query, ctofu_query_compare compare, const ctofu* operand) {
+    if ((unsigned)compare > FSCL_TOFU_QUERY_GREATER) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+    return fscl_tofu_query_operand_add(query, FSCL_TOFU_QUERY_WHERE_STAGE, (int)compare, operand);
+}
+
+ctofu_error fscl_tofu_query_map(ctofu_query* query, ctofu_query_function function, void* context) {
+    if (function == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+    ctofu_query_stage stage;
+    memset(&stage, 0, sizeof(stage));
+    stage.kind = FSCL_TOFU_QUERY_MAP_STAGE;
+    stage.function = function;
+    stage.context = context;
+    return fscl_tofu_query_stage_add(query, &stage);
+}
+
+ctofu_error fscl_tofu_query_apply(ctofu_query* query, ctofu_query_arith arith, const ctofu* operand) {
+    if ((unsigned)arith > FSCL_TOFU_QUERY_MULTIPLY) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+    return fscl_tofu_query_operand_add(query, FSCL_TOFU_QUERY_APPLY_STAGE, (int)arith, operand);
+}
+
+ctofu_error fscl_tofu_query_skip(ctofu_query* query, size_t count) {
+    ctofu_query_stage stage;
+    memset(&stage, 0, sizeof(stage));
+    stage.kind = FSCL_TOFU_QUERY_SKIP_STAGE;
+    stage.count = count;
+    return fscl_tofu_query_stage_add(query, &stage);
+}
+
+ctofu_error fscl_tofu_query_take(ctofu_query* query, size_t count) {
+    ctofu_query_stage stage;
+    memset(&stage, 0, sizeof(stage));
+    stage.kind = FSCL_TOFU_QUERY_TAKE_STAGE;
+    stage.count = count;
+    return fscl_tofu_query_stage_add(query, &stage);
+}
+
+// =======================
+// RUN FUNCTIONS
+// =======================
+
+ctofu_error fscl_tofu_query_reduce(ctofu_query* query, ctofu_query_reduction reduction, ctofu* result) {
+    if (query == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if ((unsigned)reduction > FSCL_TOFU_QUERY_MAX) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    ctofu_query_sink sink = { FSCL_TOFU_QUERY_REDUCE_SINK, reduction, NULL, NULL, NULL, NULL };
+    ctofu_query_slice local;
+    size_t count;
+    ctofu_query_slice* slice = fscl_tofu_query_start(query, &sink, &local, &count);
+
+    ctofu_query_total total = slice[0].total;
+    ctofu_error error = fscl_tofu_query_failure(slice, count);
+    for (size_t i = 1; i < count && error == FSCL_TOFU_ERROR_OK; ++i) {
+        error = fscl_tofu_query_combine(reduction, &total, &slice[i].total);
+    }
+
+    fscl_tofu_query_finish(slice, &local);
+    if (error == FSCL_TOFU_ERROR_OK) {
+        error = fscl_tofu_query_total_value(reduction, &total, result);
+    }
+    return fscl_tofu_error(error);
+}
+
+ctofu_error fscl_tofu_query_fold(ctofu_query* query, ctofu (*function)(const ctofu*, const ctofu*), ctofu* result) {
+    if (query == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (function == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    ctofu_query_sink sink = { FSCL_TOFU_QUERY_FOLD_SINK, FSCL_TOFU_QUERY_COUNT, function, NULL, NULL, NULL };
+    ctofu_query_slice local;
+    size_t count;
+    ctofu_query_slice* slice = fscl_tofu_query_start(query, &sink, &local, &count);
+
+    // Partial results are folded together in array order
+    ctofu_error error = fscl_tofu_query_failure(slice, count);
+    bool folded = false;
+    ctofu fold;
+    memset(&fold, 0, sizeof(fold));
+    for (size_t i = 0; i < count; ++i) {
+        if (!slice[i].folded) {
+            continue;
+        }
+        if (error != FSCL_TOFU_ERROR_OK) {
+            fscl_tofu_value_erase(&slice[i].fold);
+            continue;
+        }
+        if (!folded) {
+            fold = slice[i].fold;
+            folded = true;
+            continue;
+        }
+        ctofu next = function(&fold, &slice[i].fold);
+        fscl_tofu_query_settle(&next);
+        fscl_tofu_value_erase(&fold);
+        fscl_tofu_value_erase(&slice[i].fold);
+        fold = next;
+    }
+
+    fscl_tofu_query_finish(slice, &local);
+    if (error == FSCL_TOFU_ERROR_OK && !folded) {
+        error = FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS;
+    }
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_value_erase(&fold);
+        return fscl_tofu_error(error);
+    }
+    *result = fold;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_query_collect(ctofu_query* query, ctofu* result) {
+    if (query == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    // Nothing comes out of a query that did not go in, or past a take stage
+    size_t capacity = query->array->data.array_type.size;
+    for (size_t s = 0; s < query->count; ++s) {
+        if (query->stages[s].kind == FSCL_TOFU_QUERY_TAKE_STAGE && query->stages[s].count < capacity) {
+            capacity = query->stages[s].count;
+        }
+    }
+
+    ctofu* output = NULL;
+    if (capacity > 0) {
+        output = (ctofu*)fscl_tofu_account_alloc(malloc(capacity * sizeof(ctofu)), capacity * sizeof(ctofu),
+                                                 TOFU_ARRAY_TYPE, FSCL_TOFU_ALLOC_OTHER);
+        if (output == NULL) {
+            return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+    }
+
+    ctofu_query_sink sink = { FSCL_TOFU_QUERY_COLLECT_SINK, FSCL_TOFU_QUERY_COUNT, NULL, NULL, NULL, output };
+    ctofu_query_slice local;
+    size_t count;
+    ctofu_query_slice* slice = fscl_tofu_query_start(query, &sink, &local, &count);
+
+    // Close the gaps the slices left between their parts
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (size != slice[i].begin) {
+            memmove(output + size, output + slice[i].begin, slice[i].written * sizeof(ctofu));
+        }
+        size += slice[i].written;
+    }
+
+    ctofu_error error = fscl_tofu_query_failure(slice, count);
+    fscl_tofu_query_finish(slice, &local);
+    if (error != FSCL_TOFU_ERROR_OK || size == 0) {
+        for (size_t i = 0; i < size; ++i) {
+            fscl_tofu_value_erase(&output[i]);
+        }
+        fscl_tofu_slab_free(output);
+        output = NULL;
+        if (error != FSCL_TOFU_ERROR_OK) {
+            return fscl_tofu_error(error);
+        }
+    } else if (size < capacity) {
+        // Records go before realloc frees the block, a failed realloc keeps the larger one
+        fscl_tofu_account_free(output);
+        ctofu* trimmed = (ctofu*)realloc(output, size * sizeof(ctofu));
+        output = trimmed != NULL ? trimmed : output;
+        fscl_tofu_account_alloc(output, size * sizeof(ctofu), TOFU_ARRAY_TYPE, FSCL_TOFU_ALLOC_OTHER);
+    }
+
+    memset(result, 0, sizeof(ctofu));
+    result->type = TOFU_ARRAY_TYPE;
+    result->data.array_type.elements = output;
+    result->data.array_type.size = size;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_query_group(ctofu_query* query, ctofu_query_function key, void* context,
+                                  ctofu_query_reduction reduction, ctofu* result) {
+    if (query == NULL || result == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if ((unsigned)reduction > FSCL_TOFU_QUERY_MAX) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    ctofu_query_sink sink = { FSCL_TOFU_QUERY_GROUP_SINK, reduction, NULL, key, context, NULL };
+    ctofu_query_slice local;
+    size_t count;
+    ctofu_query_slice* slice = fscl_tofu_query_start(query, &sink, &local, &count);
+
+    // Later slices are merged into the first, keeping the order of first appearance
+    ctofu_error error = fscl_tofu_query_failure(slice, count);
+    ctofu_query_groups* groups = &slice[0].groups;
+    for (size_t i = 1; i < count && error == FSCL_TOFU_ERROR_OK; ++i) {
+        ctofu_query_groups* part = &slice[i].groups;
+        for (size_t g = 0; g < part->count && error == FSCL_TOFU_ERROR_OK; ++g) {
+            ctofu_query_group* entry = &part->entries[g];
+            ctofu_query_group* group = fscl_tofu_query_group_find(groups, &entry->key, entry->hash);
+            if (group == NULL) {
+                group = fscl_tofu_query_group_add(groups, &entry->key, entry->hash);
+                if (group == NULL) {
+                    error = FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+                    break;
+                }
+                memset(&entry->key, 0, sizeof(ctofu));
+            }
+            error = fscl_tofu_query_combine(reduction, &group->total, &entry->total);
+        }
+    }
+
+    size_t size = groups->count;
+    ctofu* keys = NULL;
+    ctofu* values = NULL;
+    if (error == FSCL_TOFU_ERROR_OK && size > 0) {
+        keys = (ctofu*)fscl_tofu_account_alloc(malloc(size * sizeof(ctofu)), size * sizeof(ctofu),
+                                               TOFU_MAP_TYPE, FSCL_TOFU_ALLOC_OTHER);
+        values = (ctofu*)fscl_tofu_account_alloc(malloc(size * sizeof(ctofu)), size * sizeof(ctofu),
+                                                 TOFU_MAP_TYPE, FSCL_TOFU_ALLOC_OTHER);
+        if (keys == NULL || values == NULL) {
+            error = FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+        }
+    }
+    if (error == FSCL_TOFU_ERROR_OK) {
+        for (size_t g = 0; g < size; ++g) {
+            keys[g] = groups->entries[g].key;
+            memset(&groups->entries[g].key, 0, sizeof(ctofu));
+            fscl_tofu_query_total_value(reduction, &groups->entries[g].total, &values[g]);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        fscl_tofu_query_groups_erase(&slice[i].groups);
+    }
+    fscl_tofu_query_finish(slice, &local);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_slab_free(keys);
+        fscl_tofu_slab_free(values);
+        return fscl_tofu_error(error);
+    }
+
+    memset(result, 0, sizeof(ctofu));
+    result->type = TOFU_MAP_TYPE;
+    result->data.map_type.key = keys;
+    result->data.map_type.value = values;
+    result->data.map_type.size = size;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
@@ -0,0 +1,336 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/queue.h"
+#include "xtofu_sync.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FSCL_TOFU_CACHE_LINE 64
+
+typedef struct {
+    atomic_size_t sequence;  ///< MPMC turn of the slot, unused by SPSC queues.
+    ctofu value;
+} ctofu_queue_cell;
+
+struct ctofu_queue {
+    ctofu_queue_kind kind;
+    size_t mask;
+    ctofu_queue_cell* cells;
+    atomic_bool closed;
+    char consumer_padding[FSCL_TOFU_CACHE_LINE];
+
+    // Consumer side
+    atomic_size_t head;              ///< Next position to pop.
+    size_t cached_tail;              ///< SPSC consumer's last view of tail.
+    char producer_padding[FSCL_TOFU_CACHE_LINE];
+
+    // Producer side
+    atomic_size_t tail;              ///< Next position to push.
+    size_t cached_head;              ///< SPSC producer's last view of head.
+    char wait_padding[FSCL_TOFU_CACHE_LINE];
+
+    // Sleepers, only touched when somebody waits
+    _Atomic uint32_t pushed;         ///< Bumped to wake consumers.
+    _Atomic uint32_t popped;         ///< Bumped to wake producers.
+    atomic_uint consumers_waiting;
+    atomic_uint producers_waiting;
+};
+
+// =======================
+// RING OPERATIONS
+// =======================
+
+static size_t fscl_tofu_queue_spsc_push(ctofu_queue* queue, ctofu* values, size_t count) {
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    size_t capacity = queue->mask + 1;
+    size_t room = capacity - (tail - queue->cached_head);
+    if (room < count) {
+        queue->cached_head = atomic_load_explicit(&queue->head, memory_order_acquire);
+        room = capacity - (tail - queue->cached_head);
+    }
+
+    size_t moved = count < room ? count : room;
+    for (size_t i = 0; i < moved; ++i) {
+        queue->cells[(tail + i) & queue->mask].value = values[i];
+        memset(&values[i], 0, sizeof(ctofu));
+    }
+    if (moved > 0) {
+        atomic_store_explicit(&queue->tail, tail + moved, memory_order_release);
+    }
+    return moved;
+}
+
+static size_t fscl_tofu_queue_spsc_pop(ctofu_queue* queue, ctofu* values, size_t count) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    size_t available = queue->cached_tail - head;
+    if (available < count) {
+        queue->cached_tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+        available = queue->cached_tail - head;
+    }
+
+    size_t taken = count < available ? count : available;
+    for (size_t i = 0; i < taken; ++i) {
+        values[i] = queue->cells[(head + i) & queue->mask].value;
+    }
+    if (taken > 0) {
+        atomic_store_explicit(&queue->head, head + taken, memory_order_release);
+    }
+    return taken;
+}
+
+static bool fscl_tofu_queue_mpmc_push(ctofu_queue* queue, ctofu* value) {
+    size_t position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    for (;;) {
+        ctofu_queue_cell* cell = &queue->cells[position & queue->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->value = *value;
+                memset(value, 0, sizeof(ctofu));
+                atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;  // The slot still holds the value of the previous lap
+        } else {
+            position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+}
+
+static bool fscl_tofu_queue_mpmc_pop(ctofu_queue* queue, ctofu* value) {
+    size_t position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    for (;;) {
+        ctofu_queue_cell* cell = &queue->cells[position & queue->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *value = cell->value;
+                atomic_store_explicit(&cell->sequence, position + queue->mask + 1, memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        }
+    }
+}
+
+// Wakes the other side, if anybody sleeps there, after values moved
+static void fscl_tofu_queue_notify(_Atomic uint32_t* word, atomic_uint* waiting, size_t moved) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(waiting, memory_order_relaxed) > 0) {
+        atomic_fetch_add_explicit(word, 1, memory_order_seq_cst);
+        fscl_tofu_wake(word, moved > 1);
+    }
+}
+
+static size_t fscl_tofu_queue_give(ctofu_queue* queue, ctofu* values, size_t count) {
+    size_t moved = 0;
+    if (queue->kind == FSCL_TOFU_QUEUE_SPSC) {
+        moved = fscl_tofu_queue_spsc_push(queue, values, count);
+    } else {
+        while (moved < count && fscl_tofu_queue_mpmc_push(queue, &values[moved])) {
+            ++moved;
+        }
+    }
+    if (moved > 0) {
+        fscl_tofu_queue_notify(&queue->pushed, &queue->consumers_waiting, moved);
+    }
+    return moved;
+}
+
+static size_t fscl_tofu_queue_take(ctofu_queue* queue, ctofu* values, size_t count) {
+    size_t taken = 0;
+    if (queue->kind == FSCL_TOFU_QUEUE_SPSC) {
+        taken = fscl_tofu_queue_spsc_pop(queue, values, count);
+    } else {
+        while (taken < count && fscl_tofu_queue_mpmc_pop(queue, &values[taken])) {
+            ++taken;
+        }
+    }
+    if (taken > 0) {
+        fscl_tofu_queue_notify(&queue->popped, &queue->producers_waiting, taken);
+    }
+    return taken;
+}
+
+// =======================
+// CREATE/ERASE FUNCTIONS
+// =======================
+
+ctofu_queue* fscl_tofu_queue_create(ctofu_queue_kind kind, size_t capacity) {
+    if (capacity == 0 || capacity > SIZE_MAX / 2 / sizeof(ctofu_queue_cell)) {
+        return NULL;
+    }
+
+    size_t slots = 1;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+
+    ctofu_queue* queue = (ctofu_queue*)calloc(1, sizeof(ctofu_queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->cells = (ctofu_queue_cell*)calloc(slots, sizeof(ctofu_queue_cell));
+    if (queue->cells == NULL) {
+        free(queue);
+        return NULL;
+    }
+
+    queue->kind = kind;
+    queue->mask = slots - 1;
+    for (size_t i = 0; i < slots; ++i) {
+        atomic_init(&queue->cells[i].sequence, i);
+    }
+    atomic_init(&queue->closed, false);
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->pushed, 0);
+    atomic_init(&queue->popped, 0);
+    atomic_init(&queue->consumers_waiting, 0);
+    atomic_init(&queue->producers_waiting, 0);
+    return queue;
+}
+
+void fscl_tofu_queue_erase(ctofu_queue* queue) {
+    if (queue == NULL) {
+        return;
+    }
+
+    ctofu value;
+    while (fscl_tofu_queue_take(queue, &value, 1) == 1) {
+        fscl_tofu_value_erase(&value);
+    }
+    free(queue->cells);
+    free(queue);
+}
+
+void fscl_tofu_queue_close(ctofu_queue* queue) {
+    if (queue == NULL) {
+        return;
+    }
+
+    atomic_store_explicit(&queue->closed, true, memory_order_seq_cst);
+    atomic_fetch_add_explicit(&queue->pushed, 1, memory_order_seq_cst);
+    atomic_fetch_add_explicit(&queue->popped, 1, memory_order_seq_cst);
+    fscl_tofu_wake(&queue->pushed, true);
+    fscl_tofu_wake(&queue->popped, true);
+}
+
+size_t fscl_tofu_queue_size(const ctofu_queue* queue) {
+    if (queue == NULL) {
+        return 0;
+    }
+    size_t head = atomic_load_explicit(&((ctofu_queue*)queue)->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&((ctofu_queue*)queue)->tail, memory_order_acquire);
+    return tail > head ? tail - head : 0;
+}
+
+size_t fscl_tofu_queue_capacity(const ctofu_queue* queue) {
+    return queue != NULL ? queue->mask + 1 : 0;
+}
+
+// =======================
+// PUSH/POP FUNCTIONS
+// =======================
+
+size_t fscl_tofu_queue_push_batch(ctofu_queue* queue, ctofu* values, size_t count, bool block) {
+    if (queue == NULL || values == NULL || atomic_load_explicit(&queue->closed, memory_order_acquire)) {
+        return 0;
+    }
+
+    size_t moved = fscl_tofu_queue_give(queue, values, count);
+    while (moved < count && block) {
+        atomic_fetch_add_explicit(&queue->producers_waiting, 1, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+        uint32_t seen = atomic_load_explicit(&queue->popped, memory_order_seq_cst);
+        bool closed = atomic_load_explicit(&queue->closed, memory_order_seq_cst);
+        if (!closed) {
+            size_t more = fscl_tofu_queue_give(queue, values + moved, count - moved);
+            if (more == 0) {
+                fscl_tofu_wait(&queue->popped, seen);
+            }
+            moved += more;
+        }
+        atomic_fetch_sub_explicit(&queue->producers_waiting, 1, memory_order_relaxed);
+        if (closed) {
+            break;
+        }
+    }
+    return moved;
+}
+
+size_t fscl_tofu_queue_pop_batch(ctofu_queue* queue, ctofu* values, size_t count, bool block) {
+    if (queue == NULL || values == NULL || count == 0) {
+        return 0;
+    }
+
+    size_t taken = fscl_tofu_queue_take(queue, values, count);
+    while (taken == 0 && block) {
+        atomic_fetch_add_explicit(&queue->consumers_waiting, 1, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+        uint32_t seen = atomic_load_explicit(&queue->pushed, memory_order_seq_cst);
+        bool closed = atomic_load_explicit(&queue->closed, memory_order_seq_cst);
+        taken = fscl_tofu_queue_take(queue, values, count);
+        if (taken == 0 && !closed) {
+            fscl_tofu_wait(&queue->pushed, seen);
+        }
+        atomic_fetch_sub_explicit(&queue->consumers_waiting, 1, memory_order_relaxed);
+        if (closed) {
+            break;
+        }
+    }
+    return taken;
+}
+
+ctofu_error fscl_tofu_queue_try_push(ctofu_queue* queue, ctofu* value) {
+    if (queue == NULL || value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (atomic_load_explicit(&queue->closed, memory_order_acquire)) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+    return fscl_tofu_error(fscl_tofu_queue_give(queue, value, 1) == 1 ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_BUFFER_OVERFLOW);
+}
+
+ctofu_error fscl_tofu_queue_push(ctofu_queue* queue, ctofu* value) {
+    if (queue == NULL || value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    return fscl_tofu_error(fscl_tofu_queue_push_batch(queue, value, 1, true) == 1 ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_INVALID_OPERATION);
+}
+
+ctofu_error fscl_tofu_queue_try_pop(ctofu_queue* queue, ctofu* value) {
+    if (queue == NULL || value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    return fscl_tofu_error(fscl_tofu_queue_take(queue, value, 1) == 1 ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_BUFFER_UNDERFLOW);
+}
+
+ctofu_error fscl_tofu_queue_pop(ctofu_queue* queue, ctofu* value) {
+    if (queue == NULL || value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    return fscl_tofu_error(fscl_tofu_queue_pop_batch(queue, value, 1, true) == 1 ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_BUFFER_UNDERFLOW);
+}
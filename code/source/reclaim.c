@@ -0,0 +1,147 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/reclaim.h"
+#include "fossil/queue.h"
+#include "xtofu_sync.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Values the reclaimer takes off the queue per wake up
+#define FSCL_TOFU_RECLAIM_BATCH 32
+
+static ctofu_once fscl_tofu_reclaim_ready = FSCL_TOFU_ONCE_INIT;
+static ctofu_mutex fscl_tofu_reclaim_lock;
+static ctofu_thread fscl_tofu_reclaim_thread;
+static _Atomic(ctofu_queue*) fscl_tofu_reclaim_queue = NULL;
+static atomic_size_t fscl_tofu_reclaim_count = 0;   ///< Values handed over and not erased yet.
+static _Atomic uint32_t fscl_tofu_reclaim_idle = 0;  ///< Bumped whenever the count drops to zero.
+
+static void fscl_tofu_reclaim_setup(void) {
+    fscl_tofu_mutex_init(&fscl_tofu_reclaim_lock);
+}
+
+// Accounts for erased values and wakes drainers once nothing is left
+static void fscl_tofu_reclaim_done(size_t count) {
+    if (atomic_fetch_sub_explicit(&fscl_tofu_reclaim_count, count, memory_order_seq_cst) == count) {
+        atomic_fetch_add_explicit(&fscl_tofu_reclaim_idle, 1, memory_order_seq_cst);
+        fscl_tofu_wake(&fscl_tofu_reclaim_idle, true);
+    }
+}
+
+static void fscl_tofu_reclaim_run(void* argument) {
+    ctofu_queue* queue = (ctofu_queue*)argument;
+    ctofu batch[FSCL_TOFU_RECLAIM_BATCH];
+
+    // Ends once the queue is closed and empty
+    size_t count;
+    while ((count = fscl_tofu_queue_pop_batch(queue, batch, FSCL_TOFU_RECLAIM_BATCH, true)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            fscl_tofu_value_erase(&batch[i]);
+        }
+        fscl_tofu_reclaim_done(count);
+    }
+}
+
+// =======================
+// RECLAIMER FUNCTIONS
+// =======================
+
+ctofu_error fscl_tofu_reclaim_start(size_t capacity) {
+    fscl_tofu_once(&fscl_tofu_reclaim_ready, fscl_tofu_reclaim_setup);
+    fscl_tofu_mutex_lock(&fscl_tofu_reclaim_lock);
+
+    ctofu_error error = FSCL_TOFU_ERROR_OK;
+    if (atomic_load_explicit(&fscl_tofu_reclaim_queue, memory_order_relaxed) == NULL) {
+        ctofu_queue* queue = fscl_tofu_queue_create(FSCL_TOFU_QUEUE_MPMC, capacity);
+        if (queue == NULL) {
+            error = FSCL_TOFU_ERROR_MEMORY_CORRUPTION;
+        } else if (!fscl_tofu_thread_start(&fscl_tofu_reclaim_thread, fscl_tofu_reclaim_run, queue)) {
+            fscl_tofu_queue_erase(queue);
+            error = FSCL_TOFU_ERROR_INVALID_OPERATION;
+        } else {
+            atomic_store_explicit(&fscl_tofu_reclaim_queue, queue, memory_order_release);
+        }
+    }
+
+    fscl_tofu_mutex_unlock(&fscl_tofu_reclaim_lock);
+    return fscl_tofu_error(error);
+}
+
+void fscl_tofu_reclaim_drain(void) {
+    while (atomic_load_explicit(&fscl_tofu_reclaim_count, memory_order_seq_cst) > 0) {
+        uint32_t seen = atomic_load_explicit(&fscl_tofu_reclaim_idle, memory_order_seq_cst);
+        if (atomic_load_explicit(&fscl_tofu_reclaim_count, memory_order_seq_cst) == 0) {
+            break;
+        }
+        fscl_tofu_wait(&fscl_tofu_reclaim_idle, seen);
+    }
+}
+
+void fscl_tofu_reclaim_stop(void) {
+    fscl_tofu_once(&fscl_tofu_reclaim_ready, fscl_tofu_reclaim_setup);
+    fscl_tofu_mutex_lock(&fscl_tofu_reclaim_lock);
+
+    ctofu_queue* queue = atomic_load_explicit(&fscl_tofu_reclaim_queue, memory_order_relaxed);
+    if (queue != NULL) {
+        // Closing lets the reclaimer empty the queue before it returns
+        fscl_tofu_queue_close(queue);
+        fscl_tofu_thread_join(fscl_tofu_reclaim_thread);
+        atomic_store_explicit(&fscl_tofu_reclaim_queue, NULL, memory_order_release);
+        fscl_tofu_queue_erase(queue);
+    }
+
+    fscl_tofu_mutex_unlock(&fscl_tofu_reclaim_lock);
+}
+
+size_t fscl_tofu_reclaim_pending(void) {
+    return atomic_load_explicit(&fscl_tofu_reclaim_count, memory_order_relaxed);
+}
+
+// =======================
+// ERASE FUNCTIONS
+// =======================
+
+ctofu_error fscl_tofu_erase_async(ctofu* value, bool block) {
+    if (value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    bool owns = (value->type == TOFU_STRING_TYPE && !(value->flags & TOFU_FLAG_INLINE)) ||
+                value->type == TOFU_ARRAY_TYPE || value->type == TOFU_MAP_TYPE;
+    if (!owns) {
+        memset(value, 0, sizeof(ctofu));
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    ctofu_queue* queue = atomic_load_explicit(&fscl_tofu_reclaim_queue, memory_order_acquire);
+    if (queue == NULL) {
+        if (fscl_tofu_reclaim_start(FSCL_TOFU_RECLAIM_CAPACITY) != FSCL_TOFU_ERROR_OK) {
+            fscl_tofu_value_erase(value);
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        }
+        queue = atomic_load_explicit(&fscl_tofu_reclaim_queue, memory_order_acquire);
+    }
+
+    // Counted before the push, so a drain never misses a value in flight
+    atomic_fetch_add_explicit(&fscl_tofu_reclaim_count, 1, memory_order_seq_cst);
+    ctofu_error error = block ? fscl_tofu_queue_push(queue, value) : fscl_tofu_queue_try_push(queue, value);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_reclaim_done(1);
+        if (error == FSCL_TOFU_ERROR_BUFFER_OVERFLOW) {
+            return fscl_tofu_error(error);
+        }
+        fscl_tofu_value_erase(value);
+    }
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
@@ -0,0 +1,297 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/shared.h"
+#include "xtofu_internal.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =======================
+// SHARED BLOCKS
+// =======================
+
+// Placed in front of the elements, keys and values, or text of a shared value
+typedef struct {
+    atomic_size_t references;
+    size_t reserved;  ///< Keeps the payload 16 byte aligned.
+} ctofu_shared_header;
+
+static void* fscl_tofu_shared_payload(const ctofu* value) {
+    switch (value->type) {
+        case TOFU_ARRAY_TYPE:
+            return value->data.array_type.elements;
+        case TOFU_MAP_TYPE:
+            return value->data.map_type.key;
+        default:
+            return value->data.string_type;
+    }
+}
+
+static inline ctofu_shared_header* fscl_tofu_shared_header(const ctofu* value) {
+    return (ctofu_shared_header*)fscl_tofu_shared_payload(value) - 1;
+}
+
+static ctofu_shared_header* fscl_tofu_shared_block(size_t bytes, ctofu_type type) {
+    if (bytes > SIZE_MAX - sizeof(ctofu_shared_header)) {
+        return NULL;
+    }
+    FSCL_TOFU_TRACE_BYTES(sizeof(ctofu_shared_header) + bytes);
+    ctofu_shared_header* header = (ctofu_shared_header*)fscl_tofu_account_alloc(
+        malloc(sizeof(ctofu_shared_header) + bytes), sizeof(ctofu_shared_header) + bytes, type, FSCL_TOFU_ALLOC_OTHER);
+    if (header != NULL) {
+        atomic_init(&header->references, 1);
+        header->reserved = 0;
+    }
+    return header;
+}
+
+// Number of ctofu slots behind the header: maps keep keys, then values
+static inline size_t fscl_tofu_shared_slots(const ctofu* value) {
+    return value->type == TOFU_MAP_TYPE ? value->data.map_type.size * 2 : value->data.array_type.size;
+}
+
+static void fscl_tofu_shared_attach(ctofu* value, ctofu_shared_header* header) {
+    ctofu* slots = (ctofu*)(header + 1);
+    if (value->type == TOFU_ARRAY_TYPE) {
+        value->data.array_type.elements = slots;
+    } else {
+        value->data.map_type.key = slots;
+        value->data.map_type.value = slots + value->data.map_type.size;
+    }
+    value->flags |= TOFU_FLAG_SHARED;
+}
+
+void fscl_tofu_shared_retain(const ctofu* value) {
+    atomic_fetch_add_explicit(&fscl_tofu_shared_header(value)->references, 1, memory_order_relaxed);
+}
+
+void* fscl_tofu_shared_drop(const ctofu* value) {
+    ctofu_shared_header* header = fscl_tofu_shared_header(value);
+    if (atomic_fetch_sub_explicit(&header->references, 1, memory_order_acq_rel) == 1) {
+        return header;
+    }
+    return NULL;
+}
+
+void fscl_tofu_shared_release(ctofu* value) {
+    ctofu_shared_header* header = (ctofu_shared_header*)fscl_tofu_shared_drop(value);
+    if (header != NULL) {
+        if ((value->type == TOFU_ARRAY_TYPE && !(value->flags & TOFU_FLAG_SCALARS)) || value->type == TOFU_MAP_TYPE) {
+            ctofu* slots = (ctofu*)(header + 1);
+            for (size_t i = 0; i < fscl_tofu_shared_slots(value); ++i) {
+                fscl_tofu_value_erase(&slots[i]);
+            }
+        }
+        fscl_tofu_slab_free(header);
+    }
+    value->flags &= ~(uint32_t)TOFU_FLAG_SHARED;
+}
+
+// =======================
+// SHARING FUNCTIONS
+// =======================
+
+ctofu_error fscl_tofu_share(ctofu* value) {
+    if (value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (value->flags & TOFU_FLAG_SHARED) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    switch (value->type) {
+        case TOFU_STRING_TYPE: {
+            if (value->data.string_type == NULL || (value->flags & (TOFU_FLAG_INLINE | TOFU_FLAG_INTERNED))) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+            }
+            size_t length = fscl_tofu_string_length(value);
+            ctofu_shared_header* header = fscl_tofu_shared_block(length + 1, TOFU_STRING_TYPE);
+            if (header == NULL) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+            }
+            char* text = (char*)(header + 1);
+            memcpy(text, value->data.string_type, length + 1);
+            fscl_tofu_slab_free(value->data.string_type);
+            value->data.sized_type.text = text;
+            value->data.sized_type.length = length;
+            value->flags = TOFU_FLAG_SIZED | TOFU_FLAG_SHARED;
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        }
+        case TOFU_ARRAY_TYPE:
+        case TOFU_MAP_TYPE: {
+            size_t slots = fscl_tofu_shared_slots(value);
+            if (slots == 0 || fscl_tofu_shared_payload(value) == NULL) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+            }
+
+            // Share the nested values first so that clones only retain them
+            size_t size = value->type == TOFU_MAP_TYPE ? value->data.map_type.size : slots;
+            for (size_t i = 0; i < size; ++i) {
+                ctofu_error error = value->type == TOFU_MAP_TYPE
+                    ? fscl_tofu_share(&value->data.map_type.key[i])
+                    : fscl_tofu_share(&value->data.array_type.elements[i]);
+                if (error == FSCL_TOFU_ERROR_OK && value->type == TOFU_MAP_TYPE) {
+                    error = fscl_tofu_share(&value->data.map_type.value[i]);
+                }
+                if (error != FSCL_TOFU_ERROR_OK) {
+                    return error;
+                }
+            }
+
+            if (slots > SIZE_MAX / sizeof(ctofu)) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+            }
+            ctofu_shared_header* header = fscl_tofu_shared_block(slots * sizeof(ctofu), value->type);
+            if (header == NULL) {
+                return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+            }
+
+            ctofu* target = (ctofu*)(header + 1);
+            if (value->type == TOFU_MAP_TYPE) {
+                memcpy(target, value->data.map_type.key, size * sizeof(ctofu));
+                memcpy(target + size, value->data.map_type.value, size * sizeof(ctofu));
+                fscl_tofu_slab_free(value->data.map_type.key);
+                fscl_tofu_slab_free(value->data.map_type.value);
+            } else {
+                memcpy(target, value->data.array_type.elements, size * sizeof(ctofu));
+                fscl_tofu_slab_free(value->data.array_type.elements);
+            }
+            fscl_tofu_shared_attach(value, header);
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+        }
+        default:
+            return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+}
+
+ctofu_error fscl_tofu_unique(ctofu* value) {
+    if (value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (!(value->flags & TOFU_FLAG_SHARED) ||
+        atomic_load_explicit(&fscl_tofu_shared_header(value)->references, memory_order_acquire) == 1) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    if (value->type == TOFU_STRING_TYPE) {
+        size_t length = value->data.sized_type.length;
+        ctofu_shared_header* header = fscl_tofu_shared_block(length + 1, TOFU_STRING_TYPE);
+        if (header == NULL) {
+            return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        memcpy(header + 1, value->data.string_type, length + 1);
+        fscl_tofu_shared_release(value);
+        value->data.sized_type.text = (char*)(header + 1);
+        value->flags |= TOFU_FLAG_SHARED;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    size_t slots = fscl_tofu_shared_slots(value);
+    ctofu_shared_header* header = fscl_tofu_shared_block(slots * sizeof(ctofu), value->type);
+    if (header == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+
+    // Copying a shared element is a retain, so the clone is shallow
+    const ctofu* source = (const ctofu*)fscl_tofu_shared_payload(value);
+    ctofu* target = (ctofu*)(header + 1);
+    for (size_t i = 0; i < slots; ++i) {
+        memset(&target[i], 0, sizeof(ctofu));
+        ctofu_error error = fscl_tofu_value_copy(&source[i], &target[i]);
+        if (error != FSCL_TOFU_ERROR_OK) {
+            for (size_t j = 0; j < i; ++j) {
+                fscl_tofu_value_erase(&target[j]);
+            }
+            fscl_tofu_slab_free(header);
+            return error;
+        }
+    }
+
+    fscl_tofu_shared_release(value);
+    fscl_tofu_shared_attach(value, header);
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_shared_copy(const ctofu* source, ctofu* dest) {
+    bool empty = (source->type == TOFU_ARRAY_TYPE && source->data.array_type.size == 0) ||
+                 (source->type == TOFU_MAP_TYPE && source->data.map_type.size == 0);
+    if (empty) {
+        memset(dest, 0, sizeof(ctofu));
+        dest->type = source->type;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    ctofu_error error = fscl_tofu_value_copy(source, dest);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        memset(dest, 0, sizeof(ctofu));
+    }
+    return error;
+}
+
+ctofu_error fscl_tofu_shared_store(const ctofu* source, ctofu* dest) {
+    ctofu_error error = fscl_tofu_shared_copy(source, dest);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+    return fscl_tofu_share(dest);
+}
+
+ctofu_error fscl_tofu_shared_detach(ctofu* value) {
+    ctofu_error error = fscl_tofu_unique(value);
+    if (error != FSCL_TOFU_ERROR_OK || !(value->flags & TOFU_FLAG_SHARED)) {
+        return error;
+    }
+
+    // The block has no other owner, so its slots can simply change hands
+    ctofu_shared_header* header = fscl_tofu_shared_header(value);
+    ctofu* slots = (ctofu*)(header + 1);
+    if (value->type == TOFU_ARRAY_TYPE) {
+        size_t size = value->data.array_type.size;
+        ctofu* elements = (ctofu*)fscl_tofu_account_alloc(malloc(size * sizeof(ctofu)), size * sizeof(ctofu),
+                                                          TOFU_ARRAY_TYPE, FSCL_TOFU_ALLOC_OTHER);
+        if (elements == NULL && size > 0) {
+            return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        if (size > 0) {
+            memcpy(elements, slots, size * sizeof(ctofu));
+        }
+        value->data.array_type.elements = elements;
+    } else {
+        size_t size = value->data.map_type.size;
+        ctofu* keys = (ctofu*)fscl_tofu_account_alloc(malloc(size * sizeof(ctofu)), size * sizeof(ctofu),
+                                                      TOFU_MAP_TYPE, FSCL_TOFU_ALLOC_OTHER);
+        ctofu* values = (ctofu*)fscl_tofu_account_alloc(malloc(size * sizeof(ctofu)), size * sizeof(ctofu),
+                                                        TOFU_MAP_TYPE, FSCL_TOFU_ALLOC_OTHER);
+        if ((keys == NULL || values == NULL) && size > 0) {
+            fscl_tofu_slab_free(keys);
+            fscl_tofu_slab_free(values);
+            return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        if (size > 0) {
+            memcpy(keys, slots, size * sizeof(ctofu));
+            memcpy(values, slots + size, size * sizeof(ctofu));
+        }
+        value->data.map_type.key = keys;
+        value->data.map_type.value = values;
+    }
+    fscl_tofu_slab_free(header);
+    value->flags &= ~(uint32_t)TOFU_FLAG_SHARED;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+size_t fscl_tofu_references(const ctofu* value) {
+    if (value == NULL || !(value->flags & TOFU_FLAG_SHARED)) {
+        return 1;
+    }
+    return atomic_load_explicit(&fscl_tofu_shared_header(value)->references, memory_order_relaxed);
+}
@@ -0,0 +1,312 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/slab.h"
+#include "xtofu_internal.h"
+#include "xtofu_sync.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+// =======================
+// SLAB STORAGE
+// =======================
+
+#define FSCL_TOFU_SLAB_SHIFT 16
+#define FSCL_TOFU_SLAB_SIZE ((size_t)1 << FSCL_TOFU_SLAB_SHIFT)
+#define FSCL_TOFU_SLAB_HEADER 64    // Blocks start this far into a slab
+#define FSCL_TOFU_SLAB_SMALLEST 32  // Block sizes double up to FSCL_TOFU_SLAB_LARGEST
+#define FSCL_TOFU_SLAB_CLASSES 4
+#define FSCL_TOFU_SLAB_BATCH 32     // Blocks moved between a thread and the depot at once
+#define FSCL_TOFU_SLAB_MAP_BITS 16  // Slab numbers are looked up in two 16 bit steps
+
+typedef struct ctofu_slab_block {
+    struct ctofu_slab_block* next;   ///< Next free block of the same list.
+    struct ctofu_slab_block* batch;  ///< Next batch, only used in the depot.
+} ctofu_slab_block;
+
+typedef struct ctofu_slab {
+    struct ctofu_slab* next;  ///< Keeps every slab reachable.
+    unsigned size_class;      ///< Blocks are FSCL_TOFU_SLAB_SMALLEST << size_class bytes.
+} ctofu_slab;
+
+typedef struct {
+    ctofu_slab_block* head;
+    size_t count;
+} ctofu_slab_list;
+
+typedef struct {
+    ctofu_mutex lock;
+    ctofu_slab_block* batches;  ///< Batches of FSCL_TOFU_SLAB_BATCH blocks given back by threads.
+    ctofu_slab_block* loose;    ///< Blocks of exited threads, until they make up a batch.
+    size_t loose_count;
+    char* carve;                ///< Unused part of the newest slab.
+    char* carve_end;
+} ctofu_slab_depot;
+
+_Static_assert(sizeof(ctofu_slab) <= FSCL_TOFU_SLAB_HEADER, "slab header too large");
+_Static_assert(FSCL_TOFU_SLAB_SMALLEST << (FSCL_TOFU_SLAB_CLASSES - 1) == FSCL_TOFU_SLAB_LARGEST, "slab classes");
+
+static FSCL_TOFU_THREAD_LOCAL ctofu_slab_list fscl_tofu_slab_cache[FSCL_TOFU_SLAB_CLASSES];
+static FSCL_TOFU_THREAD_LOCAL bool fscl_tofu_slab_cached = false;  ///< The exit key is set for this thread.
+static ctofu_slab_depot fscl_tofu_slab_depots[FSCL_TOFU_SLAB_CLASSES];
+static ctofu_once fscl_tofu_slab_ready = FSCL_TOFU_ONCE_INIT;
+static ctofu_mutex fscl_tofu_slab_lock;  ///< Guards new slabs and the slab map.
+static ctofu_thread_key fscl_tofu_slab_key;
+static bool fscl_tofu_slab_keyed = false;
+static atomic_bool fscl_tofu_slab_active = false;
+static atomic_size_t fscl_tofu_slab_total = 0;
+static ctofu_slab* fscl_tofu_slab_all = NULL;
+
+// Two level bitmap of slab numbers, so that any pointer can be checked
+static _Atomic(_Atomic uintptr_t*) fscl_tofu_slab_map = NULL;
+
+// Runs at thread exit: the blocks cached by the thread go back to the depots
+static void FSCL_TOFU_THREAD_EXIT fscl_tofu_slab_release(void* value) {
+    ctofu_slab_list* cache = (ctofu_slab_list*)value;
+    for (size_t i = 0; i < FSCL_TOFU_SLAB_CLASSES; ++i) {
+        ctofu_slab_depot* depot = &fscl_tofu_slab_depots[i];
+        ctofu_slab_list* list = &cache[i];
+        fscl_tofu_mutex_lock(&depot->lock);
+        while (list->head != NULL) {
+            ctofu_slab_block* block = list->head;
+            list->head = block->next;
+            block->next = depot->loose;
+            depot->loose = block;
+            if (++depot->loose_count == FSCL_TOFU_SLAB_BATCH) {
+                depot->loose->batch = depot->batches;
+                depot->batches = depot->loose;
+                depot->loose = NULL;
+                depot->loose_count = 0;
+            }
+        }
+        list->count = 0;
+        fscl_tofu_mutex_unlock(&depot->lock);
+    }
+    // Another exit handler may still free blocks into the cache
+    fscl_tofu_slab_cached = false;
+}
+
+static void fscl_tofu_slab_setup(void) {
+    fscl_tofu_mutex_init(&fscl_tofu_slab_lock);
+    for (size_t i = 0; i < FSCL_TOFU_SLAB_CLASSES; ++i) {
+        fscl_tofu_mutex_init(&fscl_tofu_slab_depots[i].lock);
+    }
+    fscl_tofu_slab_keyed = fscl_tofu_thread_key_create(&fscl_tofu_slab_key, fscl_tofu_slab_release);
+}
+
+// Makes sure the blocks this thread caches are handed back when it exits
+static void fscl_tofu_slab_adopt(void) {
+    if (fscl_tofu_slab_keyed) {
+        fscl_tofu_thread_key_set(fscl_tofu_slab_key, fscl_tofu_slab_cache);
+    }
+    fscl_tofu_slab_cached = true;
+}
+
+static void* fscl_tofu_slab_memory(void) {
+#if defined(_WIN32)
+    return _aligned_malloc(FSCL_TOFU_SLAB_SIZE, FSCL_TOFU_SLAB_SIZE);
+#else
+    return aligned_alloc(FSCL_TOFU_SLAB_SIZE, FSCL_TOFU_SLAB_SIZE);
+#endif
+}
+
+static void fscl_tofu_slab_memory_free(void* memory) {
+#if defined(_WIN32)
+    _aligned_free(memory);
+#else
+    free(memory);
+#endif
+}
+
+// Finds the slab a block belongs to, or NULL when it came from malloc
+static inline ctofu_slab* fscl_tofu_slab_find(const void* block) {
+    uint64_t number = (uint64_t)(uintptr_t)block >> FSCL_TOFU_SLAB_SHIFT;
+    if (number >> (2 * FSCL_TOFU_SLAB_MAP_BITS)) {
+        return NULL;
+    }
+    _Atomic uintptr_t* map = atomic_load_explicit(&fscl_tofu_slab_map, memory_order_acquire);
+    if (map == NULL) {
+        return NULL;
+    }
+    uintptr_t leaf = atomic_load_explicit(&map[number >> FSCL_TOFU_SLAB_MAP_BITS], memory_order_acquire);
+    if (leaf == 0) {
+        return NULL;
+    }
+    size_t low = (size_t)(number & ((UINT64_C(1) << FSCL_TOFU_SLAB_MAP_BITS) - 1));
+    uint64_t bits = atomic_load_explicit(&((_Atomic uint64_t*)leaf)[low / 64], memory_order_relaxed);
+    if (!((bits >> (low % 64)) & 1)) {
+        return NULL;
+    }
+    return (ctofu_slab*)(uintptr_t)(number << FSCL_TOFU_SLAB_SHIFT);
+}
+
+// Allocates and registers a slab, the caller holds the depot lock of size_class
+static ctofu_slab* fscl_tofu_slab_grow(unsigned size_class) {
+    void* memory = fscl_tofu_slab_memory();
+    if (memory == NULL) {
+        return NULL;
+    }
+    uint64_t number = (uint64_t)(uintptr_t)memory >> FSCL_TOFU_SLAB_SHIFT;
+    if (number >> (2 * FSCL_TOFU_SLAB_MAP_BITS)) {
+        // Beyond what the map covers, malloc serves this size instead
+        fscl_tofu_slab_memory_free(memory);
+        return NULL;
+    }
+
+    fscl_tofu_mutex_lock(&fscl_tofu_slab_lock);
+    _Atomic uintptr_t* map = atomic_load_explicit(&fscl_tofu_slab_map, memory_order_relaxed);
+    if (map == NULL) {
+        map = (_Atomic uintptr_t*)calloc((size_t)1 << FSCL_TOFU_SLAB_MAP_BITS, sizeof(uintptr_t));
+        if (map != NULL) {
+            atomic_store_explicit(&fscl_tofu_slab_map, map, memory_order_release);
+        }
+    }
+    _Atomic uint64_t* leaf = NULL;
+    if (map != NULL) {
+        leaf = (_Atomic uint64_t*)atomic_load_explicit(&map[number >> FSCL_TOFU_SLAB_MAP_BITS], memory_order_relaxed);
+        if (leaf == NULL) {
+            leaf = (_Atomic uint64_t*)calloc(((size_t)1 << FSCL_TOFU_SLAB_MAP_BITS) / 64, sizeof(uint64_t));
+            if (leaf != NULL) {
+                atomic_store_explicit(&map[number >> FSCL_TOFU_SLAB_MAP_BITS], (uintptr_t)leaf, memory_order_release);
+            }
+        }
+    }
+    if (leaf == NULL) {
+        fscl_tofu_mutex_unlock(&fscl_tofu_slab_lock);
+        fscl_tofu_slab_memory_free(memory);
+        return NULL;
+    }
+
+    ctofu_slab* slab = (ctofu_slab*)memory;
+    slab->size_class = size_class;
+    slab->next = fscl_tofu_slab_all;
+    fscl_tofu_slab_all = slab;
+    size_t low = (size_t)(number & ((UINT64_C(1) << FSCL_TOFU_SLAB_MAP_BITS) - 1));
+    atomic_fetch_or_explicit(&leaf[low / 64], UINT64_C(1) << (low % 64), memory_order_release);
+    atomic_fetch_add_explicit(&fscl_tofu_slab_total, 1, memory_order_relaxed);
+    fscl_tofu_mutex_unlock(&fscl_tofu_slab_lock);
+    return slab;
+}
+
+// Fills an empty thread list with a batch from the depot or a fresh slab
+static bool fscl_tofu_slab_refill(unsigned size_class, ctofu_slab_list* list) {
+    fscl_tofu_once(&fscl_tofu_slab_ready, fscl_tofu_slab_setup);
+    if (!fscl_tofu_slab_cached) {
+        fscl_tofu_slab_adopt();
+    }
+    ctofu_slab_depot* depot = &fscl_tofu_slab_depots[size_class];
+    size_t size = (size_t)FSCL_TOFU_SLAB_SMALLEST << size_class;
+
+    fscl_tofu_mutex_lock(&depot->lock);
+    if (depot->batches != NULL) {
+        list->head = depot->batches;
+        list->count = FSCL_TOFU_SLAB_BATCH;
+        depot->batches = depot->batches->batch;
+    } else {
+        if ((size_t)(depot->carve_end - depot->carve) < size) {
+            ctofu_slab* slab = fscl_tofu_slab_grow(size_class);
+            if (slab == NULL) {
+                fscl_tofu_mutex_unlock(&depot->lock);
+                return false;
+            }
+            depot->carve = (char*)slab + FSCL_TOFU_SLAB_HEADER;
+            depot->carve_end = (char*)slab + FSCL_TOFU_SLAB_SIZE;
+        }
+        while (list->count < FSCL_TOFU_SLAB_BATCH && (size_t)(depot->carve_end - depot->carve) >= size) {
+            ctofu_slab_block* block = (ctofu_slab_block*)(void*)depot->carve;
+            depot->carve += size;
+            block->next = list->head;
+            list->head = block;
+            ++list->count;
+        }
+    }
+    fscl_tofu_mutex_unlock(&depot->lock);
+    return true;
+}
+
+// =======================
+// SLAB FUNCTIONS
+// =======================
+
+void fscl_tofu_slab_enable(bool enabled) {
+    atomic_store_explicit(&fscl_tofu_slab_active, enabled, memory_order_relaxed);
+}
+
+bool fscl_tofu_slab_enabled(void) {
+    return atomic_load_explicit(&fscl_tofu_slab_active, memory_order_relaxed);
+}
+
+size_t fscl_tofu_slab_count(void) {
+    return atomic_load_explicit(&fscl_tofu_slab_total, memory_order_relaxed);
+}
+
+void* fscl_tofu_slab_alloc(size_t bytes) {
+    FSCL_TOFU_TRACE_BYTES(bytes);
+    if (bytes == 0 || bytes > FSCL_TOFU_SLAB_LARGEST || !atomic_load_explicit(&fscl_tofu_slab_active, memory_order_relaxed)) {
+        return malloc(bytes);
+    }
+
+    unsigned size_class = bytes <= FSCL_TOFU_SLAB_SMALLEST ? 0 : fscl_tofu_bit_width(bytes - 1) - 5;
+    ctofu_slab_list* list = &fscl_tofu_slab_cache[size_class];
+    if (list->head == NULL && !fscl_tofu_slab_refill(size_class, list)) {
+        return malloc(bytes);
+    }
+
+    ctofu_slab_block* block = list->head;
+    list->head = block->next;
+    --list->count;
+    return block;
+}
+
+void fscl_tofu_slab_free(void* memory) {
+    if (memory == NULL) {
+        return;
+    }
+    fscl_tofu_account_free(memory);
+    ctofu_slab* slab = fscl_tofu_slab_find(memory);
+    if (slab == NULL) {
+        free(memory);
+        return;
+    }
+
+    // Slabs exist, so the setup and its exit key are done
+    if (!fscl_tofu_slab_cached) {
+        fscl_tofu_slab_adopt();
+    }
+    ctofu_slab_list* list = &fscl_tofu_slab_cache[slab->size_class];
+    ctofu_slab_block* block = (ctofu_slab_block*)memory;
+    block->next = list->head;
+    list->head = block;
+    if (++list->count < 2 * FSCL_TOFU_SLAB_BATCH) {
+        return;
+    }
+
+    // Keep the most recently freed half, the colder half goes to the depot
+    ctofu_slab_block* last = list->head;
+    for (size_t i = 1; i < FSCL_TOFU_SLAB_BATCH; ++i) {
+        last = last->next;
+    }
+    ctofu_slab_block* batch = last->next;
+    last->next = NULL;
+    list->count = FSCL_TOFU_SLAB_BATCH;
+
+    ctofu_slab_depot* depot = &fscl_tofu_slab_depots[slab->size_class];
+    fscl_tofu_mutex_lock(&depot->lock);
+    batch->batch = depot->batches;
+    depot->batches = batch;
+    fscl_tofu_mutex_unlock(&depot->lock);
+}
@@ -0,0 +1,441 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // syscall() under strict -std modes
+#endif
+#include "xtofu_sync.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#if !defined(_WIN32)
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+#pragma comment(lib, "synchronization.lib")
+#endif
+
+typedef struct {
+    void (*function)(void*);
+    void* argument;
+} ctofu_thread_start;
+
+// =======================
+// THREAD FUNCTIONS
+// =======================
+
+#if defined(_WIN32)
+static DWORD WINAPI fscl_tofu_thread_entry(LPVOID parameter) {
+#else
+static void* fscl_tofu_thread_entry(void* parameter) {
+#endif
+    ctofu_thread_start start = *(ctofu_thread_start*)parameter;
+    free(parameter);
+    start.function(start.argument);
+    return 0;
+}
+
+bool fscl_tofu_thread_start(ctofu_thread* thread, void (*function)(void*), void* argument) {
+    ctofu_thread_start* start = (ctofu_thread_start*)malloc(sizeof(ctofu_thread_start));
+    if (start == NULL) {
+        return false;
+    }
+
+    start->function = function;
+    start->argument = argument;
+
+#if defined(_WIN32)
+    *thread = CreateThread(NULL, 0, fscl_tofu_thread_entry, start, 0, NULL);
+    if (*thread == NULL) {
+        free(start);
+        return false;
+    }
+#else
+    if (pthread_create(thread, NULL, fscl_tofu_thread_entry, start) != 0) {
+        free(start);
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+void fscl_tofu_thread_join(ctofu_thread thread) {
+#if defined(_WIN32)
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+size_t fscl_tofu_cpu_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#endif
+}
+
+typedef struct {
+    void (*function)(void* context, size_t task);
+    void* context;
+    size_t task;
+} ctofu_parallel_task;
+
+static void fscl_tofu_parallel_entry(void* argument) {
+    ctofu_parallel_task* task = (ctofu_parallel_task*)argument;
+    task->function(task->context, task->task);
+}
+
+void fscl_tofu_parallel_run(size_t tasks, void (*function)(void* context, size_t task), void* context) {
+    if (tasks == 0) {
+        return;
+    }
+
+    ctofu_thread* threads = NULL;
+    ctofu_parallel_task* args = NULL;
+    bool* started = NULL;
+
+    if (tasks > 1) {
+        threads = (ctofu_thread*)malloc((tasks - 1) * sizeof(ctofu_thread));
+        args = (ctofu_parallel_task*)malloc((tasks - 1) * sizeof(ctofu_parallel_task));
+        started = (bool*)calloc(tasks - 1, sizeof(bool));
+    }
+
+    for (size_t i = 0; i + 1 < tasks; ++i) {
+        if (threads != NULL && args != NULL && started != NULL) {
+            args[i].function = function;
+            args[i].context = context;
+            args[i].task = i;
+            started[i] = fscl_tofu_thread_start(&threads[i], fscl_tofu_parallel_entry, &args[i]);
+        }
+
+        // No thread for this task, run it here instead
+        if (started == NULL || !started[i]) {
+            function(context, i);
+        }
+    }
+
+    function(context, tasks - 1);
+
+    for (size_t i = 0; i + 1 < tasks; ++i) {
+        if (started != NULL && started[i]) {
+            fscl_tofu_thread_join(threads[i]);
+        }
+    }
+
+    free(threads);
+    free(args);
+    free(started);
+}
+
+bool fscl_tofu_thread_key_create(ctofu_thread_key* key, void (FSCL_TOFU_THREAD_EXIT* destructor)(void*)) {
+#if defined(_WIN32)
+    *key = FlsAlloc(destructor);
+    return *key != FLS_OUT_OF_INDEXES;
+#else
+    return pthread_key_create(key, destructor) == 0;
+#endif
+}
+
+void fscl_tofu_thread_key_set(ctofu_thread_key key, void* value) {
+#if defined(_WIN32)
+    FlsSetValue(key, value);
+#else
+    pthread_setspecific(key, value);
+#endif
+}
+
+// =======================
+// PER-THREAD RECORDS
+// =======================
+
+// One key serves every list: its value chains the records a thread holds
+static FSCL_TOFU_THREAD_LOCAL ctofu_thread_record* fscl_tofu_thread_held = NULL;
+static ctofu_once fscl_tofu_thread_records_once = FSCL_TOFU_ONCE_INIT;
+static ctofu_thread_key fscl_tofu_thread_records_key;
+static bool fscl_tofu_thread_records_keyed = false;
+
+// Runs at thread exit: the records are idle by now, so they only change hands
+static void FSCL_TOFU_THREAD_EXIT fscl_tofu_thread_records_release(void* value) {
+    ctofu_thread_record* record = (ctofu_thread_record*)value;
+    while (record != NULL) {
+        ctofu_thread_record* held = record->held;
+        if (record->list->release != NULL) {
+            record->list->release(record);
+        }
+        *record->self = NULL;
+        atomic_store_explicit(&record->owned, false, memory_order_release);
+        record = held;
+    }
+    fscl_tofu_thread_held = NULL;
+}
+
+static void fscl_tofu_thread_records_start(void) {
+    fscl_tofu_thread_records_keyed =
+        fscl_tofu_thread_key_create(&fscl_tofu_thread_records_key, fscl_tofu_thread_records_release);
+}
+
+ctofu_thread_record* fscl_tofu_thread_record_claim(ctofu_thread_records* list, ctofu_thread_record** self) {
+    // Take over the record of a thread that exited
+    ctofu_thread_record* record = atomic_load_explicit(&list->head, memory_order_acquire);
+    for (; record != NULL; record = record->next) {
+        bool owned = false;
+        if (!atomic_load_explicit(&record->owned, memory_order_relaxed) &&
+            atomic_compare_exchange_strong_explicit(&record->owned, &owned, true,
+                                                    memory_order_acquire, memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    if (record == NULL) {
+        record = (ctofu_thread_record*)calloc(1, list->size);
+        if (record == NULL) {
+            return NULL;
+        }
+        atomic_init(&record->owned, true);
+        record->list = list;
+        if (list->init != NULL) {
+            list->init(record);
+        }
+
+        // Push onto the list, readers only ever walk it
+        ctofu_thread_record* head = atomic_load_explicit(&list->head, memory_order_relaxed);
+        do {
+            record->next = head;
+        } while (!atomic_compare_exchange_weak_explicit(&list->head, &head, record,
+                                                        memory_order_release, memory_order_relaxed));
+    }
+
+    fscl_tofu_once(&fscl_tofu_thread_records_once, fscl_tofu_thread_records_start);
+    record->self = self;
+    record->held = fscl_tofu_thread_held;
+    fscl_tofu_thread_held = record;
+    if (fscl_tofu_thread_records_keyed) {
+        fscl_tofu_thread_key_set(fscl_tofu_thread_records_key, record);
+    }
+    *self = record;
+    return record;
+}
+
+// =======================
+// LOCK FUNCTIONS
+// =======================
+
+void fscl_tofu_mutex_init(ctofu_mutex* mutex) {
+#if defined(_WIN32)
+    InitializeSRWLock(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void fscl_tofu_mutex_erase(ctofu_mutex* mutex) {
+#if defined(_WIN32)
+    (void)mutex;  // Slim reader/writer locks hold no resources
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+void fscl_tofu_mutex_lock(ctofu_mutex* mutex) {
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+void fscl_tofu_mutex_unlock(ctofu_mutex* mutex) {
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+#if defined(_WIN32)
+static BOOL CALLBACK fscl_tofu_once_entry(PINIT_ONCE once, PVOID parameter, PVOID* context) {
+    (void)once;
+    (void)context;
+    ((void (*)(void))parameter)();
+    return TRUE;
+}
+#endif
+
+void fscl_tofu_once(ctofu_once* once, void (*function)(void)) {
+#if defined(_WIN32)
+    InitOnceExecuteOnce(once, fscl_tofu_once_entry, (PVOID)function, NULL);
+#else
+    pthread_once(once, function);
+#endif
+}
+
+// =======================
+// WAIT FUNCTIONS
+// =======================
+
+void fscl_tofu_wait(_Atomic uint32_t* word, uint32_t expected) {
+#if defined(__linux__)
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#elif defined(_WIN32)
+    WaitOnAddress((volatile VOID*)word, &expected, sizeof(expected), INFINITE);
+#else
+    if (atomic_load_explicit(word, memory_order_acquire) == expected) {
+        sched_yield();
+    }
+#endif
+}
+
+void fscl_tofu_wake(_Atomic uint32_t* word, bool all) {
+#if defined(__linux__)
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE_PRIVATE, all ? INT32_MAX : 1, NULL, NULL, 0);
+#elif defined(_WIN32)
+    if (all) {
+        WakeByAddressAll((PVOID)word);
+    } else {
+        WakeByAddressSingle((PVOID)word);
+    }
+#else
+    (void)word;
+    (void)all;
+#endif
+}
+
+// =======================
+// EPOCH RECLAMATION
+// =======================
+
+// Retire this many objects between two attempts to advance the epoch
+#define FSCL_TOFU_EPOCH_BATCH 64
+
+// One per thread inside the library, see ctofu_thread_record
+typedef struct {
+    ctofu_thread_record link;  ///< Handover link, first so a record is its link.
+    _Atomic uint64_t state;    ///< Observed epoch shifted left once, low bit set while active.
+    size_t depth;              ///< Nesting depth, only touched by the owner.
+} ctofu_epoch_record;
+
+// Runs at thread exit: a thread that died inside a section must not hold the epoch back
+static void fscl_tofu_epoch_release(ctofu_thread_record* link) {
+    ctofu_epoch_record* record = (ctofu_epoch_record*)link;
+    record->depth = 0;
+    atomic_store_explicit(&record->state, 0, memory_order_relaxed);
+}
+
+static _Atomic uint64_t fscl_tofu_epoch_global = 2;
+static ctofu_thread_records fscl_tofu_epoch_records =
+    FSCL_TOFU_THREAD_RECORDS_INIT(ctofu_epoch_record, NULL, fscl_tofu_epoch_release);
+static FSCL_TOFU_THREAD_LOCAL ctofu_thread_record* fscl_tofu_epoch_self = NULL;
+
+static ctofu_epoch_record* fscl_tofu_epoch_record(void) {
+    ctofu_thread_record* record = fscl_tofu_epoch_self;
+    if (record == NULL) {
+        record = fscl_tofu_thread_record_claim(&fscl_tofu_epoch_records, &fscl_tofu_epoch_self);
+        if (record == NULL) {
+            abort();  // Readers cannot run unprotected
+        }
+    }
+    return (ctofu_epoch_record*)record;
+}
+
+void fscl_tofu_epoch_enter(void) {
+    ctofu_epoch_record* record = fscl_tofu_epoch_record();
+    if (record->depth++ == 0) {
+        uint64_t epoch = atomic_load_explicit(&fscl_tofu_epoch_global, memory_order_relaxed);
+        atomic_store_explicit(&record->state, (epoch << 1) | 1, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+}
+
+void fscl_tofu_epoch_exit(void) {
+    ctofu_epoch_record* record = (ctofu_epoch_record*)fscl_tofu_epoch_self;
+    if (--record->depth == 0) {
+        atomic_store_explicit(&record->state, 0, memory_order_release);
+    }
+}
+
+// Moves the global epoch forward when every active reader has seen the current one
+static uint64_t fscl_tofu_epoch_advance(void) {
+    atomic_thread_fence(memory_order_seq_cst);
+    uint64_t epoch = atomic_load_explicit(&fscl_tofu_epoch_global, memory_order_acquire);
+
+    ctofu_thread_record* link = atomic_load_explicit(&fscl_tofu_epoch_records.head, memory_order_acquire);
+    for (; link != NULL; link = link->next) {
+        uint64_t state = atomic_load_explicit(&((ctofu_epoch_record*)link)->state, memory_order_acquire);
+        if ((state & 1) && (state >> 1) != epoch) {
+            return epoch;
+        }
+    }
+
+    if (atomic_compare_exchange_strong_explicit(&fscl_tofu_epoch_global, &epoch, epoch + 1,
+                                                memory_order_acq_rel, memory_order_acquire)) {
+        return epoch + 1;
+    }
+    return epoch;
+}
+
+void fscl_tofu_epoch_collect(ctofu_epoch_bin* bin) {
+    uint64_t epoch = fscl_tofu_epoch_advance();
+
+    // The list runs from newest to oldest, so everything after the first safe object is safe too
+    ctofu_retired** link = &bin->head;
+    while (*link != NULL && (*link)->epoch + 2 > epoch) {
+        link = &(*link)->next;
+    }
+
+    ctofu_retired* item = *link;
+    *link = NULL;
+    while (item != NULL) {
+        ctofu_retired* next = item->next;
+        item->reclaim(item);
+        --bin->count;
+        item = next;
+    }
+}
+
+void fscl_tofu_epoch_retire(ctofu_epoch_bin* bin, ctofu_retired* item, void (*reclaim)(ctofu_retired* item)) {
+    // Orders the caller's unlink before the epoch read, pairing with the fence in
+    // fscl_tofu_epoch_enter: otherwise the item could be tagged one epoch early
+    // and freed under a reader that entered the next epoch
+    atomic_thread_fence(memory_order_seq_cst);
+    item->epoch = atomic_load_explicit(&fscl_tofu_epoch_global, memory_order_acquire);
+    item->reclaim = reclaim;
+    item->next = bin->head;
+    bin->head = item;
+
+    if (++bin->count % FSCL_TOFU_EPOCH_BATCH == 0) {
+        fscl_tofu_epoch_collect(bin);
+    }
+}
+
+void fscl_tofu_epoch_drain(ctofu_epoch_bin* bin) {
+    ctofu_retired* item = bin->head;
+    while (item != NULL) {
+        ctofu_retired* next = item->next;
+        item->reclaim(item);
+        item = next;
+    }
+    bin->head = NULL;
+    bin->count = 0;
+}
@@ -0,0 +1,330 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L  // clock_gettime() under strict -std modes
+#endif
+#include "fossil/telemetry.h"
+#include "xtofu_internal.h"
+#include "xtofu_sync.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char* const fscl_tofu_telemetry_names[FSCL_TOFU_TELEMETRY_OPS] = {
+    "create", "create_array", "erase", "accumulate", "transform", "filter", "sort",
+    "search", "reverse", "reduce", "shuffle", "partition", "value_copy", "out",
+};
+
+#ifdef FSCL_TOFU_TELEMETRY
+
+// Latencies of 2^41 ns (about 36 minutes) and more share the last bucket
+#define FSCL_TOFU_TELEMETRY_LIMIT_BITS 41
+#define FSCL_TOFU_TELEMETRY_BUCKETS ((FSCL_TOFU_TELEMETRY_LIMIT_BITS - 3) * 8 + 8)
+
+/**
+ * Counters of one operation in one shard.
+ */
+typedef struct {
+    _Atomic uint64_t calls;
+    _Atomic uint64_t elements;
+    _Atomic uint64_t bytes;
+    _Atomic uint64_t total_ns;
+    _Atomic uint64_t min_ns;
+    _Atomic uint64_t max_ns;
+    _Atomic uint64_t buckets[FSCL_TOFU_TELEMETRY_BUCKETS];
+} ctofu_telemetry_counters;
+
+/**
+ * Counters written by one thread at a time. When its thread exits a shard
+ * keeps its counts for the next thread that records (see ctofu_thread_record).
+ */
+typedef struct {
+    ctofu_thread_record link;  ///< Handover link, first so a shard is its link.
+    ctofu_telemetry_counters ops[FSCL_TOFU_TELEMETRY_OPS];
+} ctofu_telemetry_shard;
+
+static void fscl_tofu_telemetry_init(ctofu_thread_record* link);
+
+static ctofu_thread_records fscl_tofu_telemetry_shards =
+    FSCL_TOFU_THREAD_RECORDS_INIT(ctofu_telemetry_shard, fscl_tofu_telemetry_init, NULL);
+static FSCL_TOFU_THREAD_LOCAL ctofu_thread_record* fscl_tofu_telemetry_self = NULL;
+static FSCL_TOFU_THREAD_LOCAL uint64_t fscl_tofu_telemetry_allocated = 0;
+
+static uint64_t fscl_tofu_telemetry_now(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * UINT64_C(1000000000) + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/**
+ * Finds the histogram bucket of a latency: exact below 16 ns, then 8
+ * buckets per power of two.
+ *
+ * @param ns The latency.
+ * @return The bucket index.
+ */
+static size_t fscl_tofu_telemetry_bucket(uint64_t ns) {
+    if (ns < 16) {
+        return (size_t)ns;
+    }
+    if (ns >> FSCL_TOFU_TELEMETRY_LIMIT_BITS) {
+        ns = (UINT64_C(1) << FSCL_TOFU_TELEMETRY_LIMIT_BITS) - 1;
+    }
+    unsigned width = fscl_tofu_bit_width(ns);
+    return (size_t)(width - 3) * 8 + (size_t)((ns >> (width - 4)) - 8);
+}
+
+/**
+ * Gives the largest latency that falls into a bucket.
+ *
+ * @param bucket The bucket index.
+ * @return The upper bound of the bucket, in nanoseconds.
+ */
+static uint64_t fscl_tofu_telemetry_bucket_high(size_t bucket) {
+    if (bucket < 16) {
+        return bucket;
+    }
+    unsigned width = (unsigned)(bucket / 8) + 3;
+    uint64_t top = bucket % 8 + 8;
+    return ((top + 1) << (width - 4)) - 1;
+}
+
+/**
+ * Adds to a counter only the calling thread writes, without a locked instruction.
+ *
+ * @param counter The counter.
+ * @param amount The amount to add.
+ */
+static inline void fscl_tofu_telemetry_add(_Atomic uint64_t* counter, uint64_t amount) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+static void fscl_tofu_telemetry_clear(ctofu_telemetry_shard* shard) {
+    for (size_t op = 0; op < FSCL_TOFU_TELEMETRY_OPS; ++op) {
+        ctofu_telemetry_counters* counters = &shard->ops[op];
+        atomic_store_explicit(&counters->calls, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters->elements, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters->bytes, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters->total_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters->min_ns, UINT64_MAX, memory_order_relaxed);
+        atomic_store_explicit(&counters->max_ns, 0, memory_order_relaxed);
+        for (size_t bucket = 0; bucket < FSCL_TOFU_TELEMETRY_BUCKETS; ++bucket) {
+            atomic_store_explicit(&counters->buckets[bucket], 0, memory_order_relaxed);
+        }
+    }
+}
+
+// New shards start empty, with no minimum seen yet
+static void fscl_tofu_telemetry_init(ctofu_thread_record* link) {
+    fscl_tofu_telemetry_clear((ctofu_telemetry_shard*)link);
+}
+
+static ctofu_telemetry_shard* fscl_tofu_telemetry_shard(void) {
+    ctofu_thread_record* shard = fscl_tofu_telemetry_self;
+    if (shard == NULL) {
+        shard = fscl_tofu_thread_record_claim(&fscl_tofu_telemetry_shards, &fscl_tofu_telemetry_self);
+    }
+    return (ctofu_telemetry_shard*)shard;
+}
+
+// =======================
+// RECORDING FUNCTIONS
+// =======================
+ctofu_trace fscl_tofu_trace_begin(size_t elements) {
+    ctofu_trace trace;
+    trace.bytes = fscl_tofu_telemetry_allocated;
+    trace.elements = elements;
+    trace.start = fscl_tofu_telemetry_now();
+    return trace;
+}
+
+void fscl_tofu_trace_end(ctofu_telemetry_op op, const ctofu_trace* trace) {
+    uint64_t ns = fscl_tofu_telemetry_now() - trace->start;
+    ctofu_telemetry_shard* shard = fscl_tofu_telemetry_shard();
+    if (shard == NULL) {
+        return;
+    }
+
+    ctofu_telemetry_counters* counters = &shard->ops[op];
+    fscl_tofu_telemetry_add(&counters->calls, 1);
+    fscl_tofu_telemetry_add(&counters->elements, trace->elements);
+    fscl_tofu_telemetry_add(&counters->bytes, fscl_tofu_telemetry_allocated - trace->bytes);
+    fscl_tofu_telemetry_add(&counters->total_ns, ns);
+    fscl_tofu_telemetry_add(&counters->buckets[fscl_tofu_telemetry_bucket(ns)], 1);
+    if (ns < atomic_load_explicit(&counters->min_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&counters->min_ns, ns, memory_order_relaxed);
+    }
+    if (ns > atomic_load_explicit(&counters->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&counters->max_ns, ns, memory_order_relaxed);
+    }
+}
+
+void fscl_tofu_trace_bytes(size_t bytes) {
+    fscl_tofu_telemetry_allocated += bytes;
+}
+
+#endif
+
+// =======================
+// TELEMETRY FUNCTIONS
+// =======================
+bool fscl_tofu_telemetry_enabled(void) {
+#ifdef FSCL_TOFU_TELEMETRY
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* fscl_tofu_telemetry_name(ctofu_telemetry_op op) {
+    if ((unsigned)op >= FSCL_TOFU_TELEMETRY_OPS) {
+        return "unknown";
+    }
+    return fscl_tofu_telemetry_names[op];
+}
+
+ctofu_error fscl_tofu_telemetry_read(ctofu_telemetry_op op, ctofu_telemetry_stats* stats) {
+    if (stats == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    memset(stats, 0, sizeof(ctofu_telemetry_stats));
+    if ((unsigned)op >= FSCL_TOFU_TELEMETRY_OPS) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS);
+    }
+
+#ifdef FSCL_TOFU_TELEMETRY
+    uint64_t merged[FSCL_TOFU_TELEMETRY_BUCKETS] = {0};
+    uint64_t min_ns = UINT64_MAX;
+
+    ctofu_thread_record* link = atomic_load_explicit(&fscl_tofu_telemetry_shards.head, memory_order_acquire);
+    for (; link != NULL; link = link->next) {
+        ctofu_telemetry_counters* counters = &((ctofu_telemetry_shard*)link)->ops[op];
+        stats->calls += atomic_load_explicit(&counters->calls, memory_order_relaxed);
+        stats->elements += atomic_load_explicit(&counters->elements, memory_order_relaxed);
+        stats->bytes += atomic_load_explicit(&counters->bytes, memory_order_relaxed);
+        stats->total_ns += atomic_load_explicit(&counters->total_ns, memory_order_relaxed);
+        uint64_t shard_min = atomic_load_explicit(&counters->min_ns, memory_order_relaxed);
+        uint64_t shard_max = atomic_load_explicit(&counters->max_ns, memory_order_relaxed);
+        min_ns = shard_min < min_ns ? shard_min : min_ns;
+        stats->max_ns = shard_max > stats->max_ns ? shard_max : stats->max_ns;
+        for (size_t bucket = 0; bucket < FSCL_TOFU_TELEMETRY_BUCKETS; ++bucket) {
+            merged[bucket] += atomic_load_explicit(&counters->buckets[bucket], memory_order_relaxed);
+        }
+    }
+    stats->min_ns = min_ns == UINT64_MAX ? 0 : min_ns;
+
+    // Percentiles report the upper bound of their bucket, kept within the observed range
+    uint64_t count = 0;
+    for (size_t bucket = 0; bucket < FSCL_TOFU_TELEMETRY_BUCKETS; ++bucket) {
+        count += merged[bucket];
+    }
+    const uint64_t permille[4] = {500, 900, 990, 999};
+    uint64_t* targets[4] = {&stats->p50_ns, &stats->p90_ns, &stats->p99_ns, &stats->p999_ns};
+    for (size_t i = 0; i < 4 && count > 0; ++i) {
+        uint64_t rank = (count * permille[i] + 999) / 1000;
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < FSCL_TOFU_TELEMETRY_BUCKETS; ++bucket) {
+            seen += merged[bucket];
+            if (seen >= rank) {
+                uint64_t high = fscl_tofu_telemetry_bucket_high(bucket);
+                high = high > stats->max_ns ? stats->max_ns : high;
+                *targets[i] = high < stats->min_ns ? stats->min_ns : high;
+                break;
+            }
+        }
+    }
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+#else
+    return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+#endif
+}
+
+/**
+ * Adds a string key and uint value to a map.
+ *
+ * @param map The map.
+ * @param name The key.
+ * @param value The value to move into the map.
+ * @return Error code indicating the success or failure of the operation.
+ */
+static ctofu_error fscl_tofu_telemetry_entry(ctofu* map, const char* name, ctofu* value) {
+    ctofu key;
+    memset(&key, 0, sizeof(key));
+    ctofu_error error = fscl_tofu_string_set(&key, name, strlen(name));
+    if (error == FSCL_TOFU_ERROR_OK) {
+        error = fscl_tofu_map_move_entry(map, &key, value);
+    }
+    fscl_tofu_value_erase(&key);
+    fscl_tofu_value_erase(value);
+    return error;
+}
+
+ctofu_error fscl_tofu_telemetry_snapshot(ctofu* snapshot) {
+    if (snapshot == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    memset(snapshot, 0, sizeof(ctofu));
+    if (!fscl_tofu_telemetry_enabled()) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+    snapshot->type = TOFU_MAP_TYPE;
+
+    for (size_t op = 0; op < FSCL_TOFU_TELEMETRY_OPS; ++op) {
+        ctofu_telemetry_stats stats;
+        ctofu_error error = fscl_tofu_telemetry_read((ctofu_telemetry_op)op, &stats);
+
+        const char* const fields[10] = {"calls", "elements", "bytes", "total_ns", "min_ns",
+                                        "max_ns", "p50_ns", "p90_ns", "p99_ns", "p999_ns"};
+        const uint64_t values[10] = {stats.calls, stats.elements, stats.bytes, stats.total_ns, stats.min_ns,
+                                     stats.max_ns, stats.p50_ns, stats.p90_ns, stats.p99_ns, stats.p999_ns};
+        ctofu entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.type = TOFU_MAP_TYPE;
+        for (size_t i = 0; i < 10 && error == FSCL_TOFU_ERROR_OK; ++i) {
+            ctofu value;
+            memset(&value, 0, sizeof(value));
+            value.type = TOFU_UINT_TYPE;
+            value.data.uint_type = values[i];
+            error = fscl_tofu_telemetry_entry(&entry, fields[i], &value);
+        }
+        if (error == FSCL_TOFU_ERROR_OK) {
+            error = fscl_tofu_telemetry_entry(snapshot, fscl_tofu_telemetry_names[op], &entry);
+        }
+        if (error != FSCL_TOFU_ERROR_OK) {
+            fscl_tofu_value_erase(&entry);
+            fscl_tofu_value_erase(snapshot);
+            return error;
+        }
+    }
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+void fscl_tofu_telemetry_reset(void) {
+#ifdef FSCL_TOFU_TELEMETRY
+    ctofu_thread_record* link = atomic_load_explicit(&fscl_tofu_telemetry_shards.head, memory_order_acquire);
+    for (; link != NULL; link = link->next) {
+        fscl_tofu_telemetry_clear((ctofu_telemetry_shard*)link);
+    }
+#endif
+}
@@ -11,22 +11,29 @@ Description:
 ==============================================================================
 */
 #include "fossil/xtofu.h"
+#include "fossil/intern.h"
+#include "fossil/shared.h"
+#include "xtofu_internal.h"
+#include "xtofu_sync.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 
 // =======================
 // CREATE/ERASE FUNCTIONS
 // =======================
-ctofu* fscl_tofu_create(ctofu_type type, ctofu_data* value) {
-    ctofu* result = (ctofu*)malloc(sizeof(ctofu));
+static ctofu* fscl_tofu_create_untraced(ctofu_type type, ctofu_data* value) {
+    ctofu* result = (ctofu*)fscl_tofu_account_alloc(fscl_tofu_slab_alloc(sizeof(ctofu)), sizeof(ctofu), type,
+                                                    FSCL_TOFU_ALLOC_CREATE);
     if (result == NULL) {
         // Handle memory allocation failure
         return NULL;
     }
 
     result->type = type;
+    result->flags = 0;
 
     switch (type) {
         case TOFU_INT_TYPE:
@@ -68,52 +75,62 @@ ctofu* fscl_tofu_create(ctofu_type type, ctofu_data* value) {
             result->data.qbit_type = value->qbit_type;
             break;
         case TOFU_STRING_TYPE:
-            result->data.string_type = fscl_tofu_strdup(value->string_type);
-            if (result->data.string_type == NULL) {
+            if (value->string_type == NULL ||
+                fscl_tofu_string_store(result, value->string_type, strlen(value->string_type)) != FSCL_TOFU_ERROR_OK) {
                 // Handle memory allocation failure
-                free(result);
+                fscl_tofu_slab_free(result);
                 return NULL;
             }
             break;
         default:
             // Handle other cases if needed
-            free(result);
+            fscl_tofu_slab_free(result);
             return NULL;
     }
 
     return result;
 }
 
+ctofu* fscl_tofu_create(ctofu_type type, ctofu_data* value) {
+    FSCL_TOFU_TRACE_BEGIN(trace, 1);
+    bool charged = fscl_tofu_account_enter(FSCL_TOFU_ALLOC_CREATE);
+    ctofu* result = fscl_tofu_create_untraced(type, value);
+    fscl_tofu_account_leave(charged);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_CREATE, trace);
+    return result;
+}
+
 bool fscl_tofu_is_homogeneous(ctofu_type type, size_t size, ctofu_data* elements) {
     for (size_t i = 0; i < size; ++i) {
-        if (elements[i].array_type.elements->type != type) {
+        if (elements->array_type.elements[i].type != type) {
             return false;
         }
     }
     return true;
 }
 
-ctofu* fscl_tofu_create_array(ctofu_type type, size_t size, ...) {
-    ctofu* tofu_array = (ctofu*)malloc(sizeof(ctofu));
+static ctofu* fscl_tofu_create_array_untraced(ctofu_type type, size_t size, va_list args) {
+    ctofu* tofu_array = (ctofu*)fscl_tofu_account_alloc(fscl_tofu_slab_alloc(sizeof(ctofu)), sizeof(ctofu),
+                                                        TOFU_ARRAY_TYPE, FSCL_TOFU_ALLOC_CREATE_ARRAY);
     if (tofu_array == NULL) {
         // Handle memory allocation failure
         return NULL;
     }
 
     tofu_array->type = TOFU_ARRAY_TYPE;
+    tofu_array->flags = type == TOFU_STRING_TYPE ? 0 : TOFU_FLAG_SCALARS;
     tofu_array->data.array_type.size = size;
-    tofu_array->data.array_type.elements = (ctofu*)malloc(size * sizeof(ctofu));
+    tofu_array->data.array_type.elements = (ctofu*)fscl_tofu_account_alloc(
+        fscl_tofu_slab_alloc(size * sizeof(ctofu)), size * sizeof(ctofu), TOFU_ARRAY_TYPE, FSCL_TOFU_ALLOC_CREATE_ARRAY);
     if (tofu_array->data.array_type.elements == NULL) {
         // Handle memory allocation failure
-        free(tofu_array);
+        fscl_tofu_slab_free(tofu_array);
         return NULL;
     }
 
-    va_list args;
-    va_start(args, size);
-
     for (size_t i = 0; i < size; ++i) {
         tofu_array->data.array_type.elements[i].type = type;
+        tofu_array->data.array_type.elements[i].flags = 0;
 
         switch (type) {
             case TOFU_INT_TYPE:
@@ -140,9 +157,18 @@ ctofu* fscl_tofu_create_array(ctofu_type type, size_t size, ...) {
             case TOFU_DOUBLE_TYPE:
                 tofu_array->data.array_type.elements[i].data.double_type = va_arg(args, double);
                 break;
-            case TOFU_STRING_TYPE:
-                tofu_array->data.array_type.elements[i].data.string_type = va_arg(args, char*);
+            case TOFU_STRING_TYPE: {
+                // The caller keeps its string, the element owns a copy
+                const char* text = va_arg(args, char*);
+                tofu_array->data.array_type.elements[i].data.string_type = NULL;
+                if (text != NULL &&
+                    fscl_tofu_string_store(&tofu_array->data.array_type.elements[i], text, strlen(text)) != FSCL_TOFU_ERROR_OK) {
+                    tofu_array->data.array_type.size = i;
+                    fscl_tofu_erase(tofu_array);
+                    return NULL;
+                }
                 break;
+            }
             case TOFU_CHAR_TYPE:
                 tofu_array->data.array_type.elements[i].data.char_type = va_arg(args, int);
                 break;
@@ -158,53 +184,71 @@ ctofu* fscl_tofu_create_array(ctofu_type type, size_t size, ...) {
             case TOFU_MAP_TYPE:
             case TOFU_ARRAY_TYPE:
                 // Nested array or map not supported in this function
-                free(tofu_array->data.array_type.elements);
-                free(tofu_array);
-                va_end(args);
+                tofu_array->data.array_type.size = i;
+                fscl_tofu_erase_array(tofu_array);
+                fscl_tofu_slab_free(tofu_array);
                 return NULL;
         }
     }
 
-    va_end(args);
-
     // Perform type checking to ensure homogeneity
     if (!fscl_tofu_is_homogeneous(type, size, &tofu_array->data)) {
         // Handle mixed types, free allocated memory and return NULL
-        free(tofu_array->data.array_type.elements);
-        free(tofu_array);
+        fscl_tofu_erase_array(tofu_array);
+        fscl_tofu_slab_free(tofu_array);
         return NULL;
     }
 
     return tofu_array;
 }
 
+ctofu* fscl_tofu_create_array(ctofu_type type, size_t size, ...) {
+    FSCL_TOFU_TRACE_BEGIN(trace, size);
+    va_list args;
+    va_start(args, size);
+    bool charged = fscl_tofu_account_enter(FSCL_TOFU_ALLOC_CREATE_ARRAY);
+    ctofu* result = fscl_tofu_create_array_untraced(type, size, args);
+    fscl_tofu_account_leave(charged);
+    va_end(args);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_CREATE_ARRAY, trace);
+    return result;
+}
+
 ctofu_error fscl_tofu_erase_array(ctofu* array) {
     if (!array || array->type != TOFU_ARRAY_TYPE) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS); // Not an array
     }
 
-    free(array->data.array_type.elements);
-    array->data.array_type.elements = NULL;
-    array->data.array_type.size = 0;
+    fscl_tofu_value_erase(array);
     array->type = TOFU_INVALID_TYPE;
 
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
-ctofu_error fscl_tofu_erase(ctofu* value) {
+static ctofu_error fscl_tofu_erase_untraced(ctofu* value) {
     if (!value) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
 
-    free(value);
+    fscl_tofu_value_erase(value);
+    fscl_tofu_slab_free(value);
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
+ctofu_error fscl_tofu_erase(ctofu* value) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(value));
+    ctofu_probe_site probe = fscl_tofu_probe_entry(FSCL_TOFU_TELEMETRY_ERASE, value);
+    ctofu_error error = fscl_tofu_erase_untraced(value);
+    fscl_tofu_probe_exit(&probe, error);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_ERASE, trace);
+    return error;
+}
+
 
 // =======================
 // CLASSIC ALGORITHM FUNCTIONS
 // =======================
-ctofu_error fscl_tofu_accumulate(ctofu* objects) {
+static ctofu_error fscl_tofu_accumulate_untraced(ctofu* objects) {
     if (objects == NULL) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
@@ -228,7 +272,7 @@ ctofu_error fscl_tofu_accumulate(ctofu* objects) {
 
     for (size_t i = 0; i < size; ++i) {
         if (objects->data.array_type.elements[i].type != TOFU_INT_TYPE) {
-            return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+            return FSCL_TOFU_ERROR_ELEMENT(FSCL_TOFU_ERROR_INVALID_OPERATION, i, objects->data.array_type.elements[i].type);
         }
 
         ctofu_data currentData = fscl_tofu_value_getter(&objects->data.array_type.elements[i]);
@@ -246,13 +290,22 @@ ctofu_error fscl_tofu_accumulate(ctofu* objects) {
 
     // Erase the existing array and set the result object as its only element
     fscl_tofu_erase_array(objects);
+    objects->type = TOFU_ARRAY_TYPE;
+    objects->flags = TOFU_FLAG_SCALARS;
     objects->data.array_type.size = 1;
     objects->data.array_type.elements = resultObject;
 
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
-ctofu_error fscl_tofu_transform(ctofu* objects, int (*transformFunc)(int)) {
+ctofu_error fscl_tofu_accumulate(ctofu* objects) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(objects));
+    ctofu_error error = fscl_tofu_accumulate_untraced(objects);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_ACCUMULATE, trace);
+    return error;
+}
+
+static ctofu_error fscl_tofu_transform_untraced(ctofu* objects, int (*transformFunc)(int)) {
     if (!fscl_tofu_not_cnullptr(objects)) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
@@ -271,9 +324,14 @@ ctofu_error fscl_tofu_transform(ctofu* objects, int (*transformFunc)(int)) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
 
+    ctofu_error error = fscl_tofu_unique(objects);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
     for (size_t i = 0; i < size; ++i) {
         if (objects->data.array_type.elements[i].type != TOFU_INT_TYPE) {
-            return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+            return FSCL_TOFU_ERROR_ELEMENT(FSCL_TOFU_ERROR_INVALID_OPERATION, i, objects->data.array_type.elements[i].type);
         }
 
         // Get the current ctofu element
@@ -289,7 +347,14 @@ ctofu_error fscl_tofu_transform(ctofu* objects, int (*transformFunc)(int)) {
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
-ctofu_error fscl_tofu_sort(ctofu* objects) {
+ctofu_error fscl_tofu_transform(ctofu* objects, int (*transformFunc)(int)) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(objects));
+    ctofu_error error = fscl_tofu_transform_untraced(objects, transformFunc);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_TRANSFORM, trace);
+    return error;
+}
+
+static ctofu_error fscl_tofu_sort_untraced(ctofu* objects) {
     if (!fscl_tofu_not_cnullptr(objects)) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
@@ -301,10 +366,15 @@ ctofu_error fscl_tofu_sort(ctofu* objects) {
     // Ensure that array elements have compatible types for sorting
     for (size_t i = 0; i < objects->data.array_type.size; ++i) {
         if (fscl_tofu_type_getter(&objects->data.array_type.elements[i]) != TOFU_INT_TYPE) {
-            return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+            return FSCL_TOFU_ERROR_ELEMENT(FSCL_TOFU_ERROR_INVALID_OPERATION, i, objects->data.array_type.elements[i].type);
         }
     }
 
+    ctofu_error error = fscl_tofu_unique(objects);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
     // Implement a simple bubble sort algorithm
     for (size_t i = 0; i < objects->data.array_type.size - 1; ++i) {
         for (size_t j = 0; j < objects->data.array_type.size - i - 1; ++j) {
@@ -323,7 +393,16 @@ ctofu_error fscl_tofu_sort(ctofu* objects) {
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
-ctofu_error fscl_tofu_search(ctofu* objects, ctofu* key) {
+ctofu_error fscl_tofu_sort(ctofu* objects) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(objects));
+    ctofu_probe_site probe = fscl_tofu_probe_entry(FSCL_TOFU_TELEMETRY_SORT, objects);
+    ctofu_error error = fscl_tofu_sort_untraced(objects);
+    fscl_tofu_probe_exit(&probe, error);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_SORT, trace);
+    return error;
+}
+
+static ctofu_error fscl_tofu_search_untraced(ctofu* objects, ctofu* key) {
     if (!fscl_tofu_not_cnullptr(objects) || !fscl_tofu_not_cnullptr(key)) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
@@ -337,7 +416,7 @@ ctofu_error fscl_tofu_search(ctofu* objects, ctofu* key) {
     // Ensure that array elements have compatible types for searching
     for (size_t i = 0; i < objects->data.array_type.size; ++i) {
         if (fscl_tofu_type_getter(&objects->data.array_type.elements[i]) != keyType) {
-            return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+            return FSCL_TOFU_ERROR_ELEMENT(FSCL_TOFU_ERROR_INVALID_OPERATION, i, objects->data.array_type.elements[i].type);
         }
     }
 
@@ -351,8 +430,17 @@ ctofu_error fscl_tofu_search(ctofu* objects, ctofu* key) {
     return fscl_tofu_error(FSCL_TOFU_ERROR_TYPE_MISMATCH);  // Key not found
 }
 
-ctofu_error fscl_tofu_filter(ctofu* objects, bool (*filterFunc)(const ctofu_data*)) {
-    if (!fscl_tofu_not_cnullptr(objects)) {
+ctofu_error fscl_tofu_search(ctofu* objects, ctofu* key) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(objects));
+    ctofu_probe_site probe = fscl_tofu_probe_entry(FSCL_TOFU_TELEMETRY_SEARCH, objects);
+    ctofu_error error = fscl_tofu_search_untraced(objects, key);
+    fscl_tofu_probe_exit(&probe, error);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_SEARCH, trace);
+    return error;
+}
+
+static ctofu_error fscl_tofu_filter_untraced(ctofu* objects, bool (*filterFunc)(const ctofu_data*)) {
+    if (!fscl_tofu_not_cnullptr(objects) || filterFunc == NULL) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
 
@@ -360,29 +448,41 @@ ctofu_error fscl_tofu_filter(ctofu* objects, bool (*filterFunc)(const ctofu_data
         return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
     }
 
-    // Declare an array of ctofu_data to store the filtered elements
-    ctofu_data filteredArray[objects->data.array_type.size];
-    size_t filteredSize = 0;
+    ctofu_error error = fscl_tofu_unique(objects);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
 
-    // Filter elements based on the provided function
+    // Kept elements slide forward by moving, only rejected ones are erased
+    ctofu* elements = objects->data.array_type.elements;
+    size_t kept = 0;
     for (size_t i = 0; i < objects->data.array_type.size; ++i) {
-        if (filterFunc(&objects->data.array_type.elements[i].data)) {
-            // Copy the entire ctofu_data element into the filteredArray
-            filteredArray[filteredSize] = objects->data.array_type.elements[i].data;
-            ++filteredSize;
+        if (filterFunc(&elements[i].data)) {
+            if (kept != i) {
+                elements[kept] = elements[i];
+                memset(&elements[i], 0, sizeof(ctofu));
+            }
+            ++kept;
+        } else {
+            fscl_tofu_value_erase(&elements[i]);
+            memset(&elements[i], 0, sizeof(ctofu));
         }
     }
-
-    // Clear existing data and store the filtered result
-    fscl_tofu_erase(objects);
-    // Create a new TOFU array and set its data
-    objects = fscl_tofu_create(TOFU_ARRAY_TYPE, filteredArray);
-    objects->data.array_type.size = filteredSize;
+    objects->data.array_type.size = kept;
 
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
-ctofu_error fscl_tofu_reverse(ctofu* objects) {
+ctofu_error fscl_tofu_filter(ctofu* objects, bool (*filterFunc)(const ctofu_data*)) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(objects));
+    ctofu_probe_site probe = fscl_tofu_probe_entry(FSCL_TOFU_TELEMETRY_FILTER, objects);
+    ctofu_error error = fscl_tofu_filter_untraced(objects, filterFunc);
+    fscl_tofu_probe_exit(&probe, error);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_FILTER, trace);
+    return error;
+}
+
+static ctofu_error fscl_tofu_reverse_untraced(ctofu* objects) {
     if (!fscl_tofu_not_cnullptr(objects)) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
@@ -391,15 +491,20 @@ ctofu_error fscl_tofu_reverse(ctofu* objects) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_UNKNOWN);
     }
 
+    ctofu_error error = fscl_tofu_unique(objects);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
     // Reverse the array elements
     size_t i = 0;
     size_t j = objects->data.array_type.size - 1;
 
     while (i < j) {
-        // Swap elements at positions i and j
-        ctofu_data temp = objects->data.array_type.elements[i].data;
-        objects->data.array_type.elements[i].data = objects->data.array_type.elements[j].data;
-        objects->data.array_type.elements[j].data = temp;
+        // Swap whole elements, a string's storage flags move with its data
+        ctofu temp = objects->data.array_type.elements[i];
+        objects->data.array_type.elements[i] = objects->data.array_type.elements[j];
+        objects->data.array_type.elements[j] = temp;
 
         ++i;
         --j;
@@ -408,6 +513,13 @@ ctofu_error fscl_tofu_reverse(ctofu* objects) {
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
+ctofu_error fscl_tofu_reverse(ctofu* objects) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(objects));
+    ctofu_error error = fscl_tofu_reverse_untraced(objects);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_REVERSE, trace);
+    return error;
+}
+
 ctofu_error fscl_tofu_swap(ctofu* right, ctofu* left) {
     if (!right || !left) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
@@ -447,8 +559,17 @@ ctofu_error fscl_tofu_compare(ctofu* right, ctofu* left) {
             return (right->data.float_type == left->data.float_type) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_INVALID_OPERATION;
         case TOFU_DOUBLE_TYPE:
             return (right->data.double_type == left->data.double_type) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_INVALID_OPERATION;
-        case TOFU_STRING_TYPE:
-            return (strcmp(right->data.string_type, left->data.string_type) == 0) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_INVALID_OPERATION;
+        case TOFU_STRING_TYPE: {
+            if (right->flags & left->flags & TOFU_FLAG_INTERNED) {
+                // Interned strings are equal exactly when their handles are
+                return (right->data.string_type == left->data.string_type) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_INVALID_OPERATION;
+            }
+            size_t length = fscl_tofu_string_length(right);
+            if (length != fscl_tofu_string_length(left)) {
+                return FSCL_TOFU_ERROR_INVALID_OPERATION;
+            }
+            return (memcmp(fscl_tofu_string_data(right), fscl_tofu_string_data(left), length) == 0) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_INVALID_OPERATION;
+        }
         case TOFU_CHAR_TYPE:
             return (right->data.char_type == left->data.char_type) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_INVALID_OPERATION;
         case TOFU_BOOLEAN_TYPE:
@@ -460,14 +581,14 @@ ctofu_error fscl_tofu_compare(ctofu* right, ctofu* left) {
             // Handle array type
             // You might want to implement specific logic for comparing array elements
             // For simplicity, I'll return TOFU_UNKNOWN_TYPE indicating unsupported comparison
-            printf("Unsupported type (array) for value comparison\n");
+            FSCL_TOFU_LOG(FSCL_TOFU_ERROR_UNKNOWN, TOFU_ARRAY_TYPE, "Unsupported type (array) for value comparison");
             return fscl_tofu_error(FSCL_TOFU_ERROR_UNKNOWN);
 
         case TOFU_MAP_TYPE:
             // Handle map type
             // You might want to implement specific logic for comparing map elements
             // For simplicity, I'll return TOFU_UNKNOWN_TYPE indicating unsupported comparison
-            printf("Unsupported type (map) for value comparison\n");
+            FSCL_TOFU_LOG(FSCL_TOFU_ERROR_UNKNOWN, TOFU_MAP_TYPE, "Unsupported type (map) for value comparison");
             return fscl_tofu_error(FSCL_TOFU_ERROR_UNKNOWN);
         case TOFU_QBIT_TYPE:
             return (right->data.qbit_type == left->data.qbit_type) ? FSCL_TOFU_ERROR_OK : FSCL_TOFU_ERROR_INVALID_OPERATION;
@@ -478,7 +599,7 @@ ctofu_error fscl_tofu_compare(ctofu* right, ctofu* left) {
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
-ctofu_error fscl_tofu_reduce(ctofu* objects, ctofu (*reduceFunc)(const ctofu*, const ctofu*)) {
+static ctofu_error fscl_tofu_reduce_untraced(ctofu* objects, ctofu (*reduceFunc)(const ctofu*, const ctofu*)) {
     if (!fscl_tofu_not_cnullptr(objects)) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
@@ -491,10 +612,22 @@ ctofu_error fscl_tofu_reduce(ctofu* objects, ctofu (*reduceFunc)(const ctofu*, c
         return fscl_tofu_error(FSCL_TOFU_ERROR_OK);  // No reduction needed for less than two elements
     }
 
-    // Apply the reduce function iteratively
+    ctofu_error error = fscl_tofu_unique(objects);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
+    // Apply the reduce function iteratively, the running result lives in the first slot
+    ctofu* elements = objects->data.array_type.elements;
     for (size_t i = 1; i < objects->data.array_type.size; ++i) {
-        ctofu reducedValue = reduceFunc(&objects->data.array_type.elements[i - 1], &objects->data.array_type.elements[i]);
-        fscl_tofu_value_setter(&reducedValue, &objects->data.array_type.elements[i]);
+        ctofu reducedValue = reduceFunc(&elements[0], &elements[i]);
+        if (reducedValue.type != TOFU_STRING_TYPE && reducedValue.type != TOFU_ARRAY_TYPE &&
+            reducedValue.type != TOFU_MAP_TYPE) {
+            reducedValue.flags = 0;  // Callbacks often build scalars without setting flags
+        }
+        fscl_tofu_value_erase(&elements[i]);
+        memset(&elements[i], 0, sizeof(ctofu));
+        fscl_tofu_value_move(&reducedValue, &elements[0]);
     }
 
     // Update the size after reduction
@@ -503,7 +636,16 @@ ctofu_error fscl_tofu_reduce(ctofu* objects, ctofu (*reduceFunc)(const ctofu*, c
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
-ctofu_error fscl_tofu_shuffle(ctofu* objects) {
+ctofu_error fscl_tofu_reduce(ctofu* objects, ctofu (*reduceFunc)(const ctofu*, const ctofu*)) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(objects));
+    ctofu_probe_site probe = fscl_tofu_probe_entry(FSCL_TOFU_TELEMETRY_REDUCE, objects);
+    ctofu_error error = fscl_tofu_reduce_untraced(objects, reduceFunc);
+    fscl_tofu_probe_exit(&probe, error);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_REDUCE, trace);
+    return error;
+}
+
+static ctofu_error fscl_tofu_shuffle_untraced(ctofu* objects) {
     if (!fscl_tofu_not_cnullptr(objects)) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
@@ -512,26 +654,43 @@ ctofu_error fscl_tofu_shuffle(ctofu* objects) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_UNKNOWN);
     }
 
+    ctofu_error error = fscl_tofu_unique(objects);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
     size_t size = objects->data.array_type.size;
 
     // Use Fisher-Yates shuffle algorithm to randomize the array elements
     for (size_t i = size - 1; i > 0; --i) {
         size_t j = rand() % (i + 1);
 
-        // Swap elements at positions i and j
-        ctofu_data temp = objects->data.array_type.elements[i].data;
-        objects->data.array_type.elements[i].data = objects->data.array_type.elements[j].data;
-        objects->data.array_type.elements[j].data = temp;
+        // Swap whole elements, a string's storage flags move with its data
+        ctofu temp = objects->data.array_type.elements[i];
+        objects->data.array_type.elements[i] = objects->data.array_type.elements[j];
+        objects->data.array_type.elements[j] = temp;
     }
 
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
+ctofu_error fscl_tofu_shuffle(ctofu* objects) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(objects));
+    ctofu_error error = fscl_tofu_shuffle_untraced(objects);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_SHUFFLE, trace);
+    return error;
+}
+
 ctofu_error fscl_tofu_for_each(ctofu* objects, void (*forEachFunc)(ctofu*)) {
     if (objects == NULL || forEachFunc == NULL) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
     }
 
+    ctofu_error error = fscl_tofu_unique(objects);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
     size_t size = objects->data.array_type.size;
     for (size_t i = 0; i < size; ++i) {
         forEachFunc(&objects->data.array_type.elements[i]);
@@ -540,11 +699,41 @@ ctofu_error fscl_tofu_for_each(ctofu* objects, void (*forEachFunc)(ctofu*)) {
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
-ctofu_error fscl_tofu_partition(ctofu* objects, bool (*partitionFunc)(const ctofu*), ctofu* partitionedResults[2]) {
+static ctofu* fscl_tofu_partition_array(size_t size) {
+    FSCL_TOFU_TRACE_BYTES(sizeof(ctofu) + size * sizeof(ctofu));
+    ctofu* array = (ctofu*)fscl_tofu_account_alloc(calloc(1, sizeof(ctofu)), sizeof(ctofu), TOFU_ARRAY_TYPE,
+                                                   FSCL_TOFU_ALLOC_OTHER);
+    if (array == NULL) {
+        return NULL;
+    }
+    array->type = TOFU_ARRAY_TYPE;
+    if (size > 0) {
+        array->data.array_type.elements = (ctofu*)fscl_tofu_account_alloc(
+            malloc(size * sizeof(ctofu)), size * sizeof(ctofu), TOFU_ARRAY_TYPE, FSCL_TOFU_ALLOC_OTHER);
+        if (array->data.array_type.elements == NULL) {
+            fscl_tofu_account_free(array);
+            free(array);
+            return NULL;
+        }
+    }
+    array->data.array_type.size = size;
+    return array;
+}
+
+static ctofu_error fscl_tofu_partition_untraced(ctofu* objects, bool (*partitionFunc)(const ctofu*), ctofu* partitionedResults[2]) {
     if (objects == NULL || partitionFunc == NULL || partitionedResults == NULL) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
     }
 
+    if (objects->type != TOFU_ARRAY_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    ctofu_error error = fscl_tofu_unique(objects);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
     size_t size = objects->data.array_type.size;
     size_t partition1Count = 0;
     
@@ -556,115 +745,325 @@ ctofu_error fscl_tofu_partition(ctofu* objects, bool (*partitionFunc)(const ctof
     }
 
     // Allocate memory for partitioned results
-    partitionedResults[0] = fscl_tofu_create_array(objects->type, partition1Count);
-    partitionedResults[1] = fscl_tofu_create_array(objects->type, size - partition1Count);
+    partitionedResults[0] = fscl_tofu_partition_array(partition1Count);
+    partitionedResults[1] = fscl_tofu_partition_array(size - partition1Count);
 
     if (partitionedResults[0] == NULL || partitionedResults[1] == NULL) {
         // Handle memory allocation failure
-        return fscl_tofu_error(FSCL_TOFU_ERROR_BUFFER_OVERFLOW);
+        for (size_t i = 0; i < 2; ++i) {
+            if (partitionedResults[i] != NULL) {
+                fscl_tofu_slab_free(partitionedResults[i]->data.array_type.elements);
+                fscl_tofu_slab_free(partitionedResults[i]);
+                partitionedResults[i] = NULL;
+            }
+        }
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
     }
 
     size_t indexPartition1 = 0;
     size_t indexPartition2 = 0;
 
-    // Partition the elements based on the predicate
+    // Move the elements into their partitions, nothing is duplicated
     for (size_t i = 0; i < size; ++i) {
         ctofu* currentElement = &objects->data.array_type.elements[i];
-        if (partitionFunc(currentElement)) {
-            fscl_tofu_value_setter(currentElement, &partitionedResults[0]->data.array_type.elements[indexPartition1++]);
+        bool first = partitionFunc(currentElement);
+        if ((first && indexPartition1 < partition1Count) || indexPartition2 == size - partition1Count) {
+            partitionedResults[0]->data.array_type.elements[indexPartition1++] = *currentElement;
         } else {
-            fscl_tofu_value_setter(currentElement, &partitionedResults[1]->data.array_type.elements[indexPartition2++]);
+            partitionedResults[1]->data.array_type.elements[indexPartition2++] = *currentElement;
         }
+        memset(currentElement, 0, sizeof(ctofu));
     }
+    partitionedResults[0]->data.array_type.size = indexPartition1;
+    partitionedResults[1]->data.array_type.size = indexPartition2;
+
+    // The source keeps only zeroed slots, so dropping its storage frees nothing else
+    if (objects->flags & TOFU_FLAG_SHARED) {
+        fscl_tofu_shared_release(objects);
+    } else {
+        fscl_tofu_slab_free(objects->data.array_type.elements);
+    }
+    objects->data.array_type.elements = NULL;
+    objects->data.array_type.size = 0;
 
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
+ctofu_error fscl_tofu_partition(ctofu* objects, bool (*partitionFunc)(const ctofu*), ctofu* partitionedResults[2]) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(objects));
+    ctofu_error error = fscl_tofu_partition_untraced(objects, partitionFunc, partitionedResults);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_PARTITION, trace);
+    return error;
+}
+
 // =======================
 // UTILITY FUNCTIONS
 // =======================
 
-void fscl_tofu_out(const ctofu value) {
-    switch (value.type) {
+void fscl_tofu_writer_init(ctofu_writer* writer, FILE* stream) {
+    writer->stream = stream;
+    writer->data = NULL;
+    writer->length = 0;
+    writer->capacity = 0;
+    writer->failed = false;
+}
+
+void fscl_tofu_writer_put(ctofu_writer* writer, const char* text, size_t length) {
+    if (writer->failed || length == 0) {
+        return;
+    }
+
+    if (writer->stream != NULL) {
+        if (writer->length + length > sizeof(writer->buffer)) {
+            fscl_tofu_writer_flush(writer);
+        }
+
+        if (length > sizeof(writer->buffer)) {
+            // Too large to stage, hand it straight to the stream
+            if (fwrite(text, 1, length, writer->stream) != length) {
+                writer->failed = true;
+            }
+            return;
+        }
+
+        memcpy(writer->buffer + writer->length, text, length);
+        writer->length += length;
+        return;
+    }
+
+    // Keep room for the NUL terminator added on release
+    if (writer->length + length + 1 > writer->capacity) {
+        size_t capacity = writer->capacity ? writer->capacity : 256;
+        while (writer->length + length + 1 > capacity) {
+            capacity *= 2;
+        }
+
+        char* data = (char*)realloc(writer->data, capacity);
+        if (data == NULL) {
+            writer->failed = true;
+            return;
+        }
+        writer->data = data;
+        writer->capacity = capacity;
+    }
+
+    memcpy(writer->data + writer->length, text, length);
+    writer->length += length;
+}
+
+void fscl_tofu_writer_format(ctofu_writer* writer, const char* format, ...) {
+    char text[128];
+    va_list args;
+
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    if (length < 0) {
+        writer->failed = true;
+        return;
+    }
+
+    if ((size_t)length < sizeof(text)) {
+        fscl_tofu_writer_put(writer, text, (size_t)length);
+        return;
+    }
+
+    // Rare long output, format again into a buffer of the exact size
+    char* large = (char*)malloc((size_t)length + 1);
+    if (large == NULL) {
+        writer->failed = true;
+        return;
+    }
+
+    va_start(args, format);
+    vsnprintf(large, (size_t)length + 1, format, args);
+    va_end(args);
+
+    fscl_tofu_writer_put(writer, large, (size_t)length);
+    free(large);
+}
+
+void fscl_tofu_writer_uint(ctofu_writer* writer, uint64_t value) {
+    char digits[20];
+    size_t index = sizeof(digits);
+
+    do {
+        digits[--index] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    fscl_tofu_writer_put(writer, digits + index, sizeof(digits) - index);
+}
+
+void fscl_tofu_writer_int(ctofu_writer* writer, int64_t value) {
+    if (value < 0) {
+        fscl_tofu_writer_put(writer, "-", 1);
+        // Negate in unsigned space so INT64_MIN does not overflow
+        fscl_tofu_writer_uint(writer, (uint64_t)0 - (uint64_t)value);
+        return;
+    }
+
+    fscl_tofu_writer_uint(writer, (uint64_t)value);
+}
+
+void fscl_tofu_writer_value(ctofu_writer* writer, const ctofu* value) {
+    switch (value->type) {
         case TOFU_INT_TYPE:
-            printf("%lld", (long long)value.data.int_type);
+            fscl_tofu_writer_int(writer, value->data.int_type);
             break;
         case TOFU_UINT_TYPE:
-            printf("%ld", (unsigned long)value.data.uint_type);
+            fscl_tofu_writer_uint(writer, value->data.uint_type);
             break;
         case TOFU_OCTAL_TYPE:
-            printf("0%llo", (unsigned long long)value.data.octal_type);
+            fscl_tofu_writer_format(writer, "0%llo", (unsigned long long)value->data.octal_type);
             break;
         case TOFU_BITWISE_TYPE:
-            printf("0x%llx", (unsigned long long)value.data.bitwise_type);
+            fscl_tofu_writer_format(writer, "0x%llx", (unsigned long long)value->data.bitwise_type);
             break;
         case TOFU_HEX_TYPE:
-            printf("0x%llx", (unsigned long long)value.data.hex_type);
+            fscl_tofu_writer_format(writer, "0x%llx", (unsigned long long)value->data.hex_type);
             break;
         case TOFU_FIXED_TYPE:
-            printf("%lld.%lld", (long long)value.data.fixed_type, (long long)(value.data.fixed_type - (long long)value.data.fixed_type) * 100);
+            fscl_tofu_writer_format(writer, "%lld.%lld", (long long)value->data.fixed_type, (long long)(value->data.fixed_type - (long long)value->data.fixed_type) * 100);
             break;
         case TOFU_FLOAT_TYPE:
-            printf("%f", value.data.float_type);
+            fscl_tofu_writer_format(writer, "%f", value->data.float_type);
             break;
         case TOFU_DOUBLE_TYPE:
-            printf("%f", value.data.double_type);
+            fscl_tofu_writer_format(writer, "%f", value->data.double_type);
             break;
         case TOFU_STRING_TYPE:
-            printf("%s", value.data.string_type);
+            if (fscl_tofu_string_data(value) != NULL) {
+                fscl_tofu_writer_put(writer, fscl_tofu_string_data(value), fscl_tofu_string_length(value));
+            }
             break;
         case TOFU_CHAR_TYPE:
-            printf("%c", value.data.char_type);
+            fscl_tofu_writer_put(writer, &value->data.char_type, 1);
             break;
         case TOFU_BOOLEAN_TYPE:
-            printf("%s", value.data.boolean_type ? "true" : "false");
+            if (value->data.boolean_type) {
+                fscl_tofu_writer_put(writer, "true", 4);
+            } else {
+                fscl_tofu_writer_put(writer, "false", 5);
+            }
             break;
         case TOFU_NULLPTR_TYPE:
-            printf("cnullptr");
+            fscl_tofu_writer_put(writer, "cnullptr", 8);
             break;
-        case TOFU_QBIT_TYPE:
+        case TOFU_QBIT_TYPE: {
             // Assuming that qbit_type is an unsigned integer type
-            printf("0b");
-            for (int i = sizeof(value.data.qbit_type) * 8 - 1; i >= 0; --i) {
-                printf("%llu", (long long unsigned int)((value.data.qbit_type >> i) & 1));
+            char bits[2 + sizeof(value->data.qbit_type) * 8];
+            size_t index = 0;
+            bits[index++] = '0';
+            bits[index++] = 'b';
+            for (int i = sizeof(value->data.qbit_type) * 8 - 1; i >= 0; --i) {
+                bits[index++] = (char)('0' + ((value->data.qbit_type >> i) & 1));
             }
+            fscl_tofu_writer_put(writer, bits, index);
             break;
+        }
         case TOFU_ARRAY_TYPE:
-            printf("[ ");
-            for (size_t i = 0; i < value.data.array_type.size; ++i) {
-                fscl_tofu_out(value.data.array_type.elements[i]);
-                if (i < value.data.array_type.size - 1) {
-                    printf(", ");
+            fscl_tofu_writer_put(writer, "[ ", 2);
+            for (size_t i = 0; i < value->data.array_type.size; ++i) {
+                fscl_tofu_writer_value(writer, &value->data.array_type.elements[i]);
+                if (i < value->data.array_type.size - 1) {
+                    fscl_tofu_writer_put(writer, ", ", 2);
                 }
             }
-            printf(" ]");
+            fscl_tofu_writer_put(writer, " ]", 2);
             break;
         case TOFU_MAP_TYPE:
-            printf("< ");
-            for (size_t i = 0; i < value.data.map_type.size; ++i) {
-                fscl_tofu_out(value.data.map_type.key[i]);
-                printf(": ");
-                fscl_tofu_out(value.data.map_type.value[i]);
-                if (i < value.data.map_type.size - 1) {
-                    printf(", ");
+            fscl_tofu_writer_put(writer, "< ", 2);
+            for (size_t i = 0; i < value->data.map_type.size; ++i) {
+                fscl_tofu_writer_value(writer, &value->data.map_type.key[i]);
+                fscl_tofu_writer_put(writer, ": ", 2);
+                fscl_tofu_writer_value(writer, &value->data.map_type.value[i]);
+                if (i < value->data.map_type.size - 1) {
+                    fscl_tofu_writer_put(writer, ", ", 2);
                 }
             }
-            printf(" >");
+            fscl_tofu_writer_put(writer, " >", 2);
             break;
         case TOFU_INVALID_TYPE:
         case TOFU_UNKNOWN_TYPE:
-            printf("[Invalid or Unknown Type]");
+            fscl_tofu_writer_put(writer, "[Invalid or Unknown Type]", 25);
             break;
     }
 }
 
+ctofu_error fscl_tofu_writer_flush(ctofu_writer* writer) {
+    if (writer->stream != NULL && writer->length > 0) {
+        if (!writer->failed && fwrite(writer->buffer, 1, writer->length, writer->stream) != writer->length) {
+            writer->failed = true;
+        }
+        writer->length = 0;
+    }
+
+    return writer->failed ? FSCL_TOFU_ERROR_BUFFER_OVERFLOW_FILE : FSCL_TOFU_ERROR_OK;
+}
+
+char* fscl_tofu_writer_release(ctofu_writer* writer, size_t* length) {
+    if (writer->failed) {
+        free(writer->data);
+        writer->data = NULL;
+        return NULL;
+    }
+
+    // Appends always leave room for the terminator, only an empty writer needs a buffer
+    if (writer->data == NULL) {
+        writer->data = (char*)malloc(1);
+        if (writer->data == NULL) {
+            return NULL;
+        }
+    }
+
+    writer->data[writer->length] = '\0';
+    if (length != NULL) {
+        *length = writer->length;
+    }
+
+    char* data = writer->data;
+    writer->data = NULL;
+    writer->length = 0;
+    writer->capacity = 0;
+    return data;
+}
+
+void fscl_tofu_out(const ctofu value) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(&value));
+    ctofu_writer writer;
+    fscl_tofu_writer_init(&writer, stdout);
+    fscl_tofu_writer_value(&writer, &value);
+    fscl_tofu_writer_flush(&writer);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_OUT, trace);
+}
+
+bool fscl_tofu_fast_real(uint64_t mantissa, int64_t exponent, bool negative, double* result) {
+    // Powers of ten that are exactly representable as doubles
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    if (mantissa > ((uint64_t)1 << 53) || exponent < -22 || exponent > 22) {
+        return false;
+    }
+
+    double value = (double)mantissa;
+    value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+    *result = negative ? -value : value;
+    return true;
+}
+
 char* fscl_tofu_strdup(const char* source) {
     if (source == NULL) {
         return NULL;
     }
 
     size_t length = strlen(source) + 1;  // +1 for the null terminator
-    char* destination = (char*)malloc(length);
+    FSCL_TOFU_TRACE_BYTES(length);
+    char* destination = (char*)fscl_tofu_account_alloc(malloc(length), length, TOFU_STRING_TYPE, FSCL_TOFU_ALLOC_STRDUP);
 
     if (destination != NULL) {
         memcpy(destination, source, length);
@@ -673,17 +1072,170 @@ char* fscl_tofu_strdup(const char* source) {
     return destination;
 }
 
-ctofu_error fscl_tofu_error(ctofu_error error) {
-    fscl_tofu_error_message(error);
-    return error;
+uint64_t fscl_tofu_hash_bytes(const void* data, size_t length) {
+    const uint64_t multiplier = UINT64_C(0xc6a4a7935bd1e995);
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = UINT64_C(0x9e3779b97f4a7c15) ^ (length * multiplier);
+
+    while (length >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, bytes, sizeof(chunk));
+        chunk *= multiplier;
+        chunk ^= chunk >> 47;
+        hash = (hash ^ (chunk * multiplier)) * multiplier;
+        bytes += 8;
+        length -= 8;
+    }
+
+    uint64_t tail = 0;
+    for (size_t i = 0; i < length; ++i) {
+        tail |= (uint64_t)bytes[i] << (8 * i);
+    }
+    return fscl_tofu_mix64(hash ^ tail);
 }
 
-ctofu_error fscl_tofu_value_copy(const ctofu* source, ctofu* dest) {
+uint64_t fscl_tofu_hash(const ctofu* value) {
+    if (value == NULL) {
+        return 0;
+    }
+
+    switch (value->type) {
+        case TOFU_INT_TYPE:
+        case TOFU_FIXED_TYPE:
+            return fscl_tofu_mix64((uint64_t)value->data.int_type);
+        case TOFU_UINT_TYPE:
+        case TOFU_OCTAL_TYPE:
+        case TOFU_BITWISE_TYPE:
+        case TOFU_HEX_TYPE:
+        case TOFU_QBIT_TYPE:
+            return fscl_tofu_mix64(value->data.uint_type);
+        case TOFU_FLOAT_TYPE: {
+            // -0.0 compares equal to 0.0, so both must hash alike
+            double real = value->data.float_type == 0.0f ? 0.0 : (double)value->data.float_type;
+            uint64_t bits;
+            memcpy(&bits, &real, sizeof(bits));
+            return fscl_tofu_mix64(bits);
+        }
+        case TOFU_DOUBLE_TYPE: {
+            double real = value->data.double_type == 0.0 ? 0.0 : value->data.double_type;
+            uint64_t bits;
+            memcpy(&bits, &real, sizeof(bits));
+            return fscl_tofu_mix64(bits);
+        }
+        case TOFU_STRING_TYPE:
+            if (fscl_tofu_string_data(value) == NULL) {
+                return 0;
+            }
+            if (value->flags & TOFU_FLAG_INTERNED) {
+                return fscl_tofu_intern_hash(value->data.string_type);
+            }
+            return fscl_tofu_hash_bytes(fscl_tofu_string_data(value), fscl_tofu_string_length(value));
+        case TOFU_CHAR_TYPE:
+            return fscl_tofu_mix64((uint64_t)(unsigned char)value->data.char_type);
+        case TOFU_BOOLEAN_TYPE:
+            return fscl_tofu_mix64(value->data.boolean_type ? 1 : 0);
+        case TOFU_ARRAY_TYPE: {
+            uint64_t hash = fscl_tofu_mix64(value->data.array_type.size);
+            for (size_t i = 0; i < value->data.array_type.size; ++i) {
+                hash = fscl_tofu_mix64(hash ^ fscl_tofu_hash(&value->data.array_type.elements[i])) + UINT64_C(0x9e3779b97f4a7c15);
+            }
+            return hash;
+        }
+        case TOFU_MAP_TYPE: {
+            // Entries are summed so the hash does not depend on their order
+            uint64_t hash = fscl_tofu_mix64(value->data.map_type.size);
+            for (size_t i = 0; i < value->data.map_type.size; ++i) {
+                uint64_t key = fscl_tofu_hash(&value->data.map_type.key[i]);
+                hash += fscl_tofu_mix64(key ^ (fscl_tofu_hash(&value->data.map_type.value[i]) * UINT64_C(0xc6a4a7935bd1e995)));
+            }
+            return hash;
+        }
+        default:
+            return 0;
+    }
+}
+
+static ctofu_error fscl_tofu_string_copy(const ctofu* source, ctofu* dest) {
+    if (source->flags & TOFU_FLAG_INLINE) {
+        // Inline strings carry their text with them
+        dest->data.small_type = source->data.small_type;
+        dest->flags = TOFU_FLAG_INLINE;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    if (source->data.string_type == NULL) {
+        dest->data.string_type = NULL;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    if (source->flags & TOFU_FLAG_INTERNED) {
+        // Pooled strings are shared, copying one only takes another reference
+        fscl_tofu_intern_retain(source->data.string_type);
+        dest->data.string_type = source->data.string_type;
+        dest->flags = TOFU_FLAG_INTERNED;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    return fscl_tofu_string_store(dest, source->data.string_type, fscl_tofu_string_length(source));
+}
+
+// =======================
+// ERROR FUNCTIONS
+// =======================
+
+static FSCL_TOFU_THREAD_LOCAL ctofu_error_context fscl_tofu_error_last = {
+    FSCL_TOFU_ERROR_OK, NULL, SIZE_MAX, TOFU_INVALID_TYPE,
+};
+static _Atomic(ctofu_log_sink) fscl_tofu_log_sink = NULL;
+static _Atomic(void*) fscl_tofu_log_user = NULL;
+
+void fscl_tofu_error_raise(ctofu_error error, const char* function, size_t index, ctofu_type type) {
+    fscl_tofu_error_last.code = error;
+    fscl_tofu_error_last.function = function;
+    fscl_tofu_error_last.index = index;
+    fscl_tofu_error_last.type = type;
+}
+
+void fscl_tofu_error_log(ctofu_error error, const char* function, ctofu_type type, const char* message) {
+    fscl_tofu_error_raise(error, function, SIZE_MAX, type);
+    ctofu_log_sink sink = atomic_load_explicit(&fscl_tofu_log_sink, memory_order_acquire);
+    if (sink != NULL) {
+        sink(&fscl_tofu_error_last, message, atomic_load_explicit(&fscl_tofu_log_user, memory_order_relaxed));
+    }
+}
+
+// Parenthesized so the fast-path macro of xtofu_internal.h does not apply
+ctofu_error (fscl_tofu_error)(ctofu_error error) {
+    return fscl_tofu_error_at(error, NULL, SIZE_MAX, TOFU_INVALID_TYPE);
+}
+
+const ctofu_error_context* fscl_tofu_last_error(void) {
+    return &fscl_tofu_error_last;
+}
+
+void fscl_tofu_clear_error(void) {
+    fscl_tofu_error_raise(FSCL_TOFU_ERROR_OK, NULL, SIZE_MAX, TOFU_INVALID_TYPE);
+}
+
+void fscl_tofu_set_log_sink(ctofu_log_sink sink, void* user) {
+    atomic_store_explicit(&fscl_tofu_log_user, user, memory_order_relaxed);
+    atomic_store_explicit(&fscl_tofu_log_sink, sink, memory_order_release);
+}
+
+static ctofu_error fscl_tofu_value_copy_untraced(const ctofu* source, ctofu* dest) {
     if (source == NULL || dest == NULL) {
         return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
     }
 
+    if (source->flags & TOFU_FLAG_SHARED) {
+        // Shared storage is copied by taking another reference
+        fscl_tofu_shared_retain(source);
+        *dest = *source;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
     dest->type = source->type;
+    dest->flags = 0;
 
     switch (source->type) {
         case TOFU_INT_TYPE:
@@ -719,8 +1271,7 @@ ctofu_error fscl_tofu_value_copy(const ctofu* source, ctofu* dest) {
             break;
 
         case TOFU_STRING_TYPE:
-            dest->data.string_type = fscl_tofu_strdup(source->data.string_type);
-            break;
+            return fscl_tofu_string_copy(source, dest);
 
         case TOFU_CHAR_TYPE:
             dest->data.char_type = source->data.char_type;
@@ -734,7 +1285,10 @@ ctofu_error fscl_tofu_value_copy(const ctofu* source, ctofu* dest) {
             // Implement array copying logic here
             if (source->data.array_type.size > 0 && source->data.array_type.elements != NULL) {
                 dest->data.array_type.size = source->data.array_type.size;
-                dest->data.array_type.elements = malloc(dest->data.array_type.size * sizeof(ctofu));
+                FSCL_TOFU_TRACE_BYTES(dest->data.array_type.size * sizeof(ctofu));
+                dest->data.array_type.elements = fscl_tofu_account_alloc(
+                    malloc(dest->data.array_type.size * sizeof(ctofu)), dest->data.array_type.size * sizeof(ctofu),
+                    TOFU_ARRAY_TYPE, FSCL_TOFU_ALLOC_VALUE_COPY);
                 
                 if (dest->data.array_type.elements == NULL) {
                     return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION); // Handle memory allocation failure
@@ -742,14 +1296,14 @@ ctofu_error fscl_tofu_value_copy(const ctofu* source, ctofu* dest) {
 
                 // Copy each element
                 for (size_t i = 0; i < dest->data.array_type.size; ++i) {
-                    ctofu_error copyResult = fscl_tofu_value_copy(&source->data.array_type.elements[i], &dest->data.array_type.elements[i]);
+                    ctofu_error copyResult = fscl_tofu_value_copy_untraced(&source->data.array_type.elements[i], &dest->data.array_type.elements[i]);
                     if (copyResult != FSCL_TOFU_ERROR_OK) {
                         // Handle copy error
                         // Clean up allocated memory
                         for (size_t j = 0; j < i; ++j) {
-                            free(dest->data.array_type.elements[j].data.string_type);
+                            fscl_tofu_value_erase(&dest->data.array_type.elements[j]);
                         }
-                        free(dest->data.array_type.elements);
+                        fscl_tofu_slab_free(dest->data.array_type.elements);
                         return copyResult;
                     }
                 }
@@ -761,41 +1315,48 @@ ctofu_error fscl_tofu_value_copy(const ctofu* source, ctofu* dest) {
             dest->data.map_type.size = source->data.map_type.size;
 
             // Allocate memory for keys and values
-            dest->data.map_type.key = (ctofu*)malloc(sizeof(ctofu) * dest->data.map_type.size);
-            dest->data.map_type.value = (ctofu*)malloc(sizeof(ctofu) * dest->data.map_type.size);
+            FSCL_TOFU_TRACE_BYTES(2 * sizeof(ctofu) * dest->data.map_type.size);
+            dest->data.map_type.key = (ctofu*)fscl_tofu_account_alloc(
+                malloc(sizeof(ctofu) * dest->data.map_type.size), sizeof(ctofu) * dest->data.map_type.size,
+                TOFU_MAP_TYPE, FSCL_TOFU_ALLOC_VALUE_COPY);
+            dest->data.map_type.value = (ctofu*)fscl_tofu_account_alloc(
+                malloc(sizeof(ctofu) * dest->data.map_type.size), sizeof(ctofu) * dest->data.map_type.size,
+                TOFU_MAP_TYPE, FSCL_TOFU_ALLOC_VALUE_COPY);
 
             if (dest->data.map_type.key == NULL || dest->data.map_type.value == NULL) {
                 // Handle memory allocation failure
-                free(dest->data.map_type.key);
-                free(dest->data.map_type.value);
+                fscl_tofu_slab_free(dest->data.map_type.key);
+                fscl_tofu_slab_free(dest->data.map_type.value);
                 return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
             }
 
             // Copy keys and values
             for (size_t i = 0; i < dest->data.map_type.size; ++i) {
-                ctofu_error copyResult = fscl_tofu_value_copy(&source->data.map_type.key[i], &dest->data.map_type.key[i]);
+                ctofu_error copyResult = fscl_tofu_value_copy_untraced(&source->data.map_type.key[i], &dest->data.map_type.key[i]);
                 if (copyResult != FSCL_TOFU_ERROR_OK) {
                     // Handle copy error
                     // Clean up allocated memory
                     for (size_t j = 0; j < i; ++j) {
-                        free(dest->data.map_type.key[j].data.string_type);
-                        free(dest->data.map_type.value[j].data.string_type);
+                        fscl_tofu_value_erase(&dest->data.map_type.key[j]);
+                        fscl_tofu_value_erase(&dest->data.map_type.value[j]);
                     }
-                    free(dest->data.map_type.key);
-                    free(dest->data.map_type.value);
+                    fscl_tofu_slab_free(dest->data.map_type.key);
+                    fscl_tofu_slab_free(dest->data.map_type.value);
                     return copyResult;
                 }
 
-                copyResult = fscl_tofu_value_copy(&source->data.map_type.value[i], &dest->data.map_type.value[i]);
+                copyResult = fscl_tofu_value_copy_untraced(&source->data.map_type.value[i], &dest->data.map_type.value[i]);
                 if (copyResult != FSCL_TOFU_ERROR_OK) {
                     // Handle copy error
                     // Clean up allocated memory
+                    for (size_t j = 0; j < i; ++j) {
+                        fscl_tofu_value_erase(&dest->data.map_type.value[j]);
+                    }
                     for (size_t j = 0; j <= i; ++j) {
-                        free(dest->data.map_type.key[j].data.string_type);
-                        free(dest->data.map_type.value[j].data.string_type);
+                        fscl_tofu_value_erase(&dest->data.map_type.key[j]);
                     }
-                    free(dest->data.map_type.key);
-                    free(dest->data.map_type.value);
+                    fscl_tofu_slab_free(dest->data.map_type.key);
+                    fscl_tofu_slab_free(dest->data.map_type.value);
                     return copyResult;
                 }
             }
@@ -811,28 +1372,115 @@ ctofu_error fscl_tofu_value_copy(const ctofu* source, ctofu* dest) {
 
         default:
             // Handle unsupported types
-            printf("Unsupported type for value copy\n");
+            FSCL_TOFU_LOG(FSCL_TOFU_ERROR_UNKNOWN, source->type, "Unsupported type for value copy");
             return fscl_tofu_error(FSCL_TOFU_ERROR_UNKNOWN);
     }
 
     return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
 }
 
-void fscl_tofu_value_erase(ctofu* value) {
-    if (value == NULL) {
+ctofu_error fscl_tofu_value_copy(const ctofu* source, ctofu* dest) {
+    FSCL_TOFU_TRACE_BEGIN(trace, fscl_tofu_trace_size(source));
+    ctofu_probe_site probe = fscl_tofu_probe_entry(FSCL_TOFU_TELEMETRY_VALUE_COPY, source);
+    bool charged = fscl_tofu_account_enter(FSCL_TOFU_ALLOC_VALUE_COPY);
+    ctofu_error error = fscl_tofu_value_copy_untraced(source, dest);
+    fscl_tofu_account_leave(charged);
+    fscl_tofu_probe_exit(&probe, error);
+    FSCL_TOFU_TRACE_END(FSCL_TOFU_TELEMETRY_VALUE_COPY, trace);
+    return error;
+}
+
+// Frames of the erase walk live on the C stack until nesting gets this deep
+#define FSCL_TOFU_ERASE_FRAMES 32
+
+typedef struct {
+    ctofu* slots;   ///< Values still to erase.
+    size_t count;   ///< Number of slots.
+    size_t index;   ///< Next slot to erase.
+    void* storage;  ///< Buffer freed once every slot is erased.
+} ctofu_erase_frame;
+
+typedef struct {
+    ctofu_erase_frame* frames;
+    size_t depth;
+    size_t capacity;
+    ctofu_erase_frame local[FSCL_TOFU_ERASE_FRAMES];
+} ctofu_erase_stack;
+
+static void fscl_tofu_erase_push(ctofu_erase_stack* stack, ctofu* slots, size_t count, void* storage) {
+    if (count == 0) {
+        fscl_tofu_slab_free(storage);
+        return;
+    }
+
+    if (stack->depth == stack->capacity) {
+        size_t capacity = stack->capacity * 2;
+        ctofu_erase_frame* frames = stack->frames == stack->local
+                                        ? (ctofu_erase_frame*)malloc(capacity * sizeof(ctofu_erase_frame))
+                                        : (ctofu_erase_frame*)realloc(stack->frames, capacity * sizeof(ctofu_erase_frame));
+        if (frames == NULL) {
+            // Out of memory for frames, this one buffer is erased by recursion
+            for (size_t i = 0; i < count; ++i) {
+                fscl_tofu_value_erase(&slots[i]);
+            }
+            fscl_tofu_slab_free(storage);
+            return;
+        }
+        if (stack->frames == stack->local) {
+            memcpy(frames, stack->local, sizeof(stack->local));
+        }
+        stack->frames = frames;
+        stack->capacity = capacity;
+    }
+
+    ctofu_erase_frame* frame = &stack->frames[stack->depth++];
+    frame->slots = slots;
+    frame->count = count;
+    frame->index = 0;
+    frame->storage = storage;
+}
+
+// Releases what one value owns directly, its elements are queued on the stack
+static void fscl_tofu_erase_storage(ctofu_erase_stack* stack, ctofu* value) {
+    bool scalars = (value->flags & TOFU_FLAG_SCALARS) != 0;
+
+    if (value->flags & TOFU_FLAG_SHARED) {
+        void* block = fscl_tofu_shared_drop(value);
+        if (block == NULL) {
+            return;
+        }
+        if (value->type == TOFU_ARRAY_TYPE && !scalars) {
+            fscl_tofu_erase_push(stack, value->data.array_type.elements, value->data.array_type.size, block);
+        } else if (value->type == TOFU_MAP_TYPE) {
+            // Shared maps keep keys and then values in the one block
+            fscl_tofu_erase_push(stack, value->data.map_type.key, value->data.map_type.size * 2, block);
+        } else {
+            fscl_tofu_slab_free(block);
+        }
         return;
     }
 
     switch (value->type) {
         case TOFU_STRING_TYPE:
-            free(value->data.string_type);
+            if (value->flags & TOFU_FLAG_INTERNED) {
+                fscl_tofu_intern_release(value->data.string_type);
+            } else if (!(value->flags & TOFU_FLAG_INLINE)) {
+                fscl_tofu_slab_free(value->data.string_type);
+            }
             break;
 
         case TOFU_ARRAY_TYPE:
-            for (size_t i = 0; i < value->data.array_type.size; ++i) {
-                fscl_tofu_value_erase(&value->data.array_type.elements[i]);
+            if (scalars) {
+                fscl_tofu_slab_free(value->data.array_type.elements);
+            } else {
+                fscl_tofu_erase_push(stack, value->data.array_type.elements, value->data.array_type.size,
+                                     value->data.array_type.elements);
             }
-            free(value->data.array_type.elements);
+            break;
+
+        case TOFU_MAP_TYPE:
+            fscl_tofu_erase_push(stack, value->data.map_type.value, value->data.map_type.size, value->data.map_type.value);
+            fscl_tofu_erase_push(stack, value->data.map_type.key, value->data.map_type.size, value->data.map_type.key);
             break;
 
         default:
@@ -841,12 +1489,57 @@ void fscl_tofu_value_erase(ctofu* value) {
     }
 }
 
+void fscl_tofu_value_erase(ctofu* value) {
+    if (value == NULL) {
+        return;
+    }
+
+    ctofu_erase_stack stack;
+    stack.frames = stack.local;
+    stack.depth = 0;
+    stack.capacity = FSCL_TOFU_ERASE_FRAMES;
+
+    fscl_tofu_erase_storage(&stack, value);
+    while (stack.depth > 0) {
+        ctofu_erase_frame* frame = &stack.frames[stack.depth - 1];
+        if (frame->index == frame->count) {
+            fscl_tofu_slab_free(frame->storage);
+            --stack.depth;
+            continue;
+        }
+        // Pushing may move the frames, so frame is not used past this call
+        fscl_tofu_erase_storage(&stack, &frame->slots[frame->index++]);
+    }
+
+    if (stack.frames != stack.local) {
+        free(stack.frames);
+    }
+    memset(value, 0, sizeof(ctofu));
+}
+
 void fscl_tofu_value_setter(const ctofu* source, ctofu* dest) {
     if (source == NULL || dest == NULL) {
         return;
     }
 
+    // Arrays are only assigned over arrays of the same size and element type
+    if (source->type == TOFU_ARRAY_TYPE &&
+        (dest->type != TOFU_ARRAY_TYPE || source->data.array_type.size != dest->data.array_type.size ||
+         (source->data.array_type.size > 0 &&
+          source->data.array_type.elements[0].type != dest->data.array_type.elements[0].type))) {
+        FSCL_TOFU_LOG(FSCL_TOFU_ERROR_TYPE_MISMATCH, TOFU_ARRAY_TYPE, "Incompatible array types for value setter");
+        return;
+    }
+
+    // The old storage is replaced, so a shared block is released rather than copied first
+    if (dest->flags & TOFU_FLAG_SHARED) {
+        fscl_tofu_shared_release(dest);
+    } else if (source->type == TOFU_ARRAY_TYPE) {
+        fscl_tofu_value_erase(dest);
+    }
+
     dest->type = source->type;
+    dest->flags = 0;
 
     switch (source->type) {
         case TOFU_INT_TYPE:
@@ -882,7 +1575,7 @@ void fscl_tofu_value_setter(const ctofu* source, ctofu* dest) {
             break;
 
         case TOFU_STRING_TYPE:
-            dest->data.string_type = fscl_tofu_strdup(source->data.string_type);
+            fscl_tofu_string_copy(source, dest);
             break;
 
         case TOFU_CHAR_TYPE:
@@ -894,26 +1587,16 @@ void fscl_tofu_value_setter(const ctofu* source, ctofu* dest) {
             break;
 
         case TOFU_ARRAY_TYPE:
-            // Check if both arrays have the same type
-            if (source->data.array_type.size != dest->data.array_type.size ||
-                source->data.array_type.elements[0].type != dest->data.array_type.elements[0].type) {
-                printf("Incompatible array types for value setter\n");
-                break;  // or return an error code
-            }
-        
             // Set array B to array A
             dest->data.array_type.size = source->data.array_type.size;
         
-            // Cleanup existing array elements in B
-            for (size_t i = 0; i < dest->data.array_type.size; ++i) {
-                fscl_tofu_value_erase(&dest->data.array_type.elements[i]);
-            }
-        
-            // Allocate memory for new array elements in B
-            dest->data.array_type.elements = (ctofu*)malloc(dest->data.array_type.size * sizeof(ctofu));
+            // Allocate memory for new array elements in B, zeroed so each element starts as a plain value
+            dest->data.array_type.elements = (ctofu*)fscl_tofu_account_alloc(
+                calloc(dest->data.array_type.size ? dest->data.array_type.size : 1, sizeof(ctofu)),
+                dest->data.array_type.size * sizeof(ctofu), TOFU_ARRAY_TYPE, FSCL_TOFU_ALLOC_OTHER);
             if (dest->data.array_type.elements == NULL) {
                 // Handle memory allocation failure
-                printf("Memory allocation failed for array elements\n");
+                FSCL_TOFU_LOG(FSCL_TOFU_ERROR_MEMORY_CORRUPTION, TOFU_ARRAY_TYPE, "Memory allocation failed for array elements");
                 break;  // or return an error code
             }
         
@@ -934,7 +1617,7 @@ void fscl_tofu_value_setter(const ctofu* source, ctofu* dest) {
                 // Handle memory allocation failure
                 free(dest->data.map_type.key);
                 free(dest->data.map_type.value);
-                printf("Memory allocation failed for map keys or values\n");
+                FSCL_TOFU_LOG(FSCL_TOFU_ERROR_MEMORY_CORRUPTION, TOFU_MAP_TYPE, "Memory allocation failed for map keys or values");
                 break;
             }
 
@@ -955,7 +1638,7 @@ void fscl_tofu_value_setter(const ctofu* source, ctofu* dest) {
 
         default:
             // Handle unsupported types
-            printf("Unsupported type for value setter\n");
+            FSCL_TOFU_LOG(FSCL_TOFU_ERROR_UNKNOWN, source->type, "Unsupported type for value setter");
     }
 }
 
@@ -1002,7 +1685,8 @@ ctofu_data fscl_tofu_value_getter(ctofu* current) {
             break;
 
         case TOFU_STRING_TYPE:
-            result.string_type = current->data.string_type;
+            // Inline text stays in current, hand out a pointer to it
+            result.string_type = (char*)fscl_tofu_string_data(current);
             break;
 
         case TOFU_CHAR_TYPE:
@@ -1023,21 +1707,21 @@ ctofu_data fscl_tofu_value_getter(ctofu* current) {
 
         case TOFU_ARRAY_TYPE:
             // Handle array type
-            printf("Unsupported type (array) for value getter\n");
+            FSCL_TOFU_LOG(FSCL_TOFU_ERROR_INVALID_OPERATION, TOFU_ARRAY_TYPE, "Unsupported type (array) for value getter");
             // You might want to set a default value or handle this case differently
             result.int_type = 0;
             break;
 
         case TOFU_MAP_TYPE:
             // Handle map type
-            printf("Unsupported type (map) for value getter\n");
+            FSCL_TOFU_LOG(FSCL_TOFU_ERROR_INVALID_OPERATION, TOFU_MAP_TYPE, "Unsupported type (map) for value getter");
             // You might want to set a default value or handle this case differently
             result.int_type = 0;
             break;
 
         default:
             // Handle unsupported types
-            printf("Unsupported type for value getter\n");
+            FSCL_TOFU_LOG(FSCL_TOFU_ERROR_INVALID_OPERATION, current->type, "Unsupported type for value getter");
             // You might want to set a default value or handle this case differently
             result.int_type = 0;
     }
@@ -1062,6 +1746,199 @@ bool fscl_tofu_its_cnullptr(const ctofu* value) {
     return value == NULL;
 }
 
+// =======================
+// MOVE FUNCTIONS
+// =======================
+
+ctofu_error fscl_tofu_value_move(ctofu* source, ctofu* dest) {
+    if (source == NULL || dest == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    if (source != dest) {
+        fscl_tofu_value_erase(dest);
+        *dest = *source;
+        memset(source, 0, sizeof(ctofu));
+    }
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_array_move_in(ctofu* array, size_t index, ctofu* value) {
+    if (array == NULL || value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (array->type != TOFU_ARRAY_TYPE || index >= array->data.array_type.size) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS);
+    }
+
+    ctofu_error error = fscl_tofu_unique(array);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+    if (value->type == TOFU_STRING_TYPE || value->type == TOFU_ARRAY_TYPE || value->type == TOFU_MAP_TYPE) {
+        array->flags &= ~(uint32_t)TOFU_FLAG_SCALARS;
+    }
+    return fscl_tofu_value_move(value, &array->data.array_type.elements[index]);
+}
+
+ctofu_error fscl_tofu_array_take(ctofu* array, size_t index, ctofu* value) {
+    if (array == NULL || value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (array->type != TOFU_ARRAY_TYPE || index >= array->data.array_type.size) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS);
+    }
+
+    ctofu_error error = fscl_tofu_unique(array);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+    *value = array->data.array_type.elements[index];
+    memset(&array->data.array_type.elements[index], 0, sizeof(ctofu));
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_map_move_entry(ctofu* map, ctofu* key, ctofu* value) {
+    if (map == NULL || key == NULL || value == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+    if (map->type != TOFU_MAP_TYPE) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_INVALID_OPERATION);
+    }
+
+    size_t size = map->data.map_type.size;
+    for (size_t i = 0; i < size; ++i) {
+        ctofu* probe = &map->data.map_type.key[i];
+        if (probe->type == key->type && fscl_tofu_compare(probe, key) == FSCL_TOFU_ERROR_OK) {
+            ctofu_error error = fscl_tofu_unique(map);
+            if (error != FSCL_TOFU_ERROR_OK) {
+                return error;
+            }
+            fscl_tofu_value_erase(key);
+            memset(key, 0, sizeof(ctofu));
+            return fscl_tofu_value_move(value, &map->data.map_type.value[i]);
+        }
+    }
+
+    // Growing needs storage that realloc may move, which shared blocks are not
+    ctofu_error error = fscl_tofu_shared_detach(map);
+    if (error != FSCL_TOFU_ERROR_OK) {
+        return error;
+    }
+
+    // Records go before realloc frees the block, a failed realloc leaves it uncounted
+    fscl_tofu_account_free(map->data.map_type.key);
+    ctofu* keys = (ctofu*)realloc(map->data.map_type.key, (size + 1) * sizeof(ctofu));
+    if (keys == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    map->data.map_type.key = fscl_tofu_account_alloc(keys, (size + 1) * sizeof(ctofu), TOFU_MAP_TYPE, FSCL_TOFU_ALLOC_OTHER);
+    fscl_tofu_account_free(map->data.map_type.value);
+    ctofu* values = (ctofu*)realloc(map->data.map_type.value, (size + 1) * sizeof(ctofu));
+    if (values == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    map->data.map_type.value = fscl_tofu_account_alloc(values, (size + 1) * sizeof(ctofu), TOFU_MAP_TYPE, FSCL_TOFU_ALLOC_OTHER);
+
+    keys[size] = *key;
+    values[size] = *value;
+    memset(key, 0, sizeof(ctofu));
+    memset(value, 0, sizeof(ctofu));
+    map->data.map_type.size = size + 1;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+// =======================
+// STRING FUNCTIONS
+// =======================
+
+static atomic_bool fscl_tofu_inline_active = false;
+
+void fscl_tofu_inline_strings_enable(bool enabled) {
+    atomic_store_explicit(&fscl_tofu_inline_active, enabled, memory_order_relaxed);
+}
+
+bool fscl_tofu_inline_strings_enabled(void) {
+    return atomic_load_explicit(&fscl_tofu_inline_active, memory_order_relaxed);
+}
+
+static void fscl_tofu_string_inline(ctofu* value, const char* text, size_t length) {
+    memset(&value->data, 0, sizeof(value->data));
+    memcpy(value->data.small_type.text, text, length);
+    value->data.small_type.length = (uint8_t)length;
+    value->flags = TOFU_FLAG_INLINE;
+}
+
+ctofu_error fscl_tofu_string_store(ctofu* value, const char* text, size_t length) {
+    value->type = TOFU_STRING_TYPE;
+    value->flags = 0;
+    value->data.string_type = NULL;
+
+    if (length <= FSCL_TOFU_SMALL_STRING && fscl_tofu_inline_strings_enabled()) {
+        fscl_tofu_string_inline(value, text, length);
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    if (fscl_tofu_intern_enabled()) {
+        const char* handle = fscl_tofu_intern_acquire(text, length);
+        if (handle == NULL) {
+            return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+        }
+        value->flags = TOFU_FLAG_INTERNED;
+        value->data.string_type = (char*)handle;
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+
+    FSCL_TOFU_TRACE_BYTES(length + 1);
+    char* copy = (char*)fscl_tofu_account_alloc(malloc(length + 1), length + 1, TOFU_STRING_TYPE, FSCL_TOFU_ALLOC_OTHER);
+    if (copy == NULL) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_MEMORY_CORRUPTION);
+    }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    value->flags = TOFU_FLAG_SIZED;
+    value->data.sized_type.text = copy;
+    value->data.sized_type.length = length;
+    return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+}
+
+ctofu_error fscl_tofu_string_set(ctofu* value, const char* text, size_t length) {
+    if (value == NULL || (text == NULL && length > 0)) {
+        return fscl_tofu_error(FSCL_TOFU_ERROR_NULL_POINTER);
+    }
+
+    if (length <= FSCL_TOFU_SMALL_STRING) {
+        value->type = TOFU_STRING_TYPE;
+        fscl_tofu_string_inline(value, length > 0 ? text : "", length);
+        return fscl_tofu_error(FSCL_TOFU_ERROR_OK);
+    }
+    return fscl_tofu_string_store(value, text, length);
+}
+
+const char* fscl_tofu_string_data(const ctofu* value) {
+    if (value == NULL || value->type != TOFU_STRING_TYPE) {
+        return NULL;
+    }
+    return (value->flags & TOFU_FLAG_INLINE) ? value->data.small_type.text : value->data.string_type;
+}
+
+size_t fscl_tofu_string_length(const ctofu* value) {
+    if (value == NULL || value->type != TOFU_STRING_TYPE) {
+        return 0;
+    }
+    if (value->flags & TOFU_FLAG_INLINE) {
+        return value->data.small_type.length;
+    }
+    if (value->flags & TOFU_FLAG_SIZED) {
+        return value->data.sized_type.length;
+    }
+    if (value->flags & TOFU_FLAG_INTERNED) {
+        return fscl_tofu_intern_length(value->data.string_type);
+    }
+    return value->data.string_type != NULL ? strlen(value->data.string_type) : 0;
+}
+
 // =======================
 // ITERATOR FUNCTIONS
 // =======================
@@ -0,0 +1,582 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_INTERNAL_H
+#define FSCL_XTOFU_INTERNAL_H
+
+/**
+ * @file xtofu_internal.h
+ *
+ * @brief Private helpers shared between the ToFu translation units.
+ *
+ * Nothing in this header is part of the public API; it is only included by
+ * the sources under code/source.
+ */
+
+#include "fossil/xtofu.h"
+#include "fossil/account.h"
+#include "fossil/probe.h"
+#include <stdatomic.h>
+#include <stdio.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FSCL_TOFU_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_WIN32)
+#define FSCL_TOFU_LITTLE_ENDIAN 1
+#endif
+
+// =======================
+// BIT HELPERS
+// =======================
+
+/**
+ * Counts the trailing zero bits of a non-zero mask.
+ *
+ * @param mask The mask, must not be zero.
+ * @return The index of the lowest set bit.
+ */
+static inline unsigned fscl_tofu_ctz(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+/**
+ * Counts the bits needed to store a value.
+ *
+ * @param value The value.
+ * @return The position of the highest set bit plus one, or 0 for 0.
+ */
+static inline unsigned fscl_tofu_bit_width(uint64_t value) {
+    if (value == 0) {
+        return 0;
+    }
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (unsigned)index + 1;
+#else
+    return 64 - (unsigned)__builtin_clzll(value);
+#endif
+}
+
+/**
+ * Counts the set bits of a mask.
+ *
+ * @param mask The mask.
+ * @return The number of set bits.
+ */
+static inline unsigned fscl_tofu_popcount(uint32_t mask) {
+#if defined(_MSC_VER)
+    return (unsigned)__popcnt(mask);
+#else
+    return (unsigned)__builtin_popcount(mask);
+#endif
+}
+
+// =======================
+// ERROR HELPERS
+// =======================
+
+/**
+ * Records a failure as the last error of the calling thread.
+ *
+ * @param error The error, not FSCL_TOFU_ERROR_OK.
+ * @param function The function raising it.
+ * @param index The element at fault, SIZE_MAX for none.
+ * @param type The type at fault, TOFU_INVALID_TYPE for none.
+ */
+void fscl_tofu_error_raise(ctofu_error error, const char* function, size_t index, ctofu_type type);
+
+/**
+ * Records a failure and hands a diagnostic to the log sink, if one is set.
+ *
+ * @param error The error.
+ * @param function The function raising it.
+ * @param type The type at fault, TOFU_INVALID_TYPE for none.
+ * @param message The diagnostic.
+ */
+void fscl_tofu_error_log(ctofu_error error, const char* function, ctofu_type type, const char* message);
+
+/**
+ * Passes an error code through, recording it only when it is a failure.
+ *
+ * @param error The error code.
+ * @param function The function raising it.
+ * @param index The element at fault, SIZE_MAX for none.
+ * @param type The type at fault, TOFU_INVALID_TYPE for none.
+ * @return error.
+ */
+static inline ctofu_error fscl_tofu_error_at(ctofu_error error, const char* function, size_t index, ctofu_type type) {
+    if (error != FSCL_TOFU_ERROR_OK) {
+        fscl_tofu_error_raise(error, function, index, type);
+    }
+    return error;
+}
+
+// Inside the library a successful return folds away to the bare code
+#define fscl_tofu_error(error) fscl_tofu_error_at((error), __func__, SIZE_MAX, TOFU_INVALID_TYPE)
+#define FSCL_TOFU_ERROR_ELEMENT(error, index, type) fscl_tofu_error_at((error), __func__, (index), (type))
+#define FSCL_TOFU_LOG(error, type, message) fscl_tofu_error_log((error), __func__, (type), (message))
+
+// =======================
+// HASH HELPERS
+// =======================
+
+/**
+ * Scrambles the bits of a 64-bit value (MurmurHash3 finalizer).
+ *
+ * @param value The value to mix.
+ * @return The mixed value.
+ */
+static inline uint64_t fscl_tofu_mix64(uint64_t value) {
+    value ^= value >> 33;
+    value *= UINT64_C(0xff51afd7ed558ccd);
+    value ^= value >> 33;
+    value *= UINT64_C(0xc4ceb9fe1a85ec53);
+    value ^= value >> 33;
+    return value;
+}
+
+/**
+ * Hashes a run of bytes eight at a time.
+ *
+ * @param data The bytes to hash.
+ * @param length The number of bytes.
+ * @return The 64-bit hash.
+ */
+uint64_t fscl_tofu_hash_bytes(const void* data, size_t length);
+
+/**
+ * Tells whether a stored key equals a probe, for the hashed containers.
+ *
+ * @param key The stored key.
+ * @param key_hash The fscl_tofu_hash of the stored key.
+ * @param probe The key looked up.
+ * @param probe_hash The fscl_tofu_hash of the probe.
+ * @return true if the keys are equal.
+ */
+static inline bool fscl_tofu_key_equal(const ctofu* key, uint64_t key_hash, const ctofu* probe, uint64_t probe_hash) {
+    return key_hash == probe_hash && key->type == probe->type &&
+           fscl_tofu_compare((ctofu*)key, (ctofu*)probe) == FSCL_TOFU_ERROR_OK;
+}
+
+// =======================
+// STORAGE HELPERS
+// =======================
+
+/**
+ * Stores a copy of text as a TOFU_STRING_TYPE value: inline when inline
+ * strings are enabled and it fits, else interned when the intern pool is
+ * enabled, else duplicated on the heap together with its length.
+ *
+ * @param value Receives the string value.
+ * @param text The text, which need not be NUL terminated.
+ * @param length The number of bytes of text.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_string_store(ctofu* value, const char* text, size_t length);
+
+/**
+ * Allocates a ctofu structure or element buffer, from the thread's slab
+ * cache when the slab allocator is on and the size fits, else with malloc.
+ *
+ * @param bytes The number of bytes.
+ * @return The uninitialized memory, or NULL if out of memory.
+ */
+void* fscl_tofu_slab_alloc(size_t bytes);
+
+/**
+ * Frees memory from fscl_tofu_slab_alloc, or any memory from malloc.
+ *
+ * @param memory The memory, may be NULL.
+ */
+void fscl_tofu_slab_free(void* memory);
+
+/**
+ * Takes another reference to the storage of a TOFU_FLAG_SHARED value.
+ *
+ * @param value The shared value.
+ */
+void fscl_tofu_shared_retain(const ctofu* value);
+
+/**
+ * Drops the reference a TOFU_FLAG_SHARED value holds, erasing the shared
+ * storage when it was the last one.
+ *
+ * @param value The shared value.
+ */
+void fscl_tofu_shared_release(ctofu* value);
+
+/**
+ * Drops the reference a TOFU_FLAG_SHARED value holds without erasing
+ * anything, for callers that walk the shared slots themselves.
+ *
+ * @param value The shared value.
+ * @return The block to erase and free when this was the last reference, else NULL.
+ *         The slots of an array or map start right after the block header,
+ *         at the payload pointer the value already holds.
+ */
+void* fscl_tofu_shared_drop(const ctofu* value);
+
+/**
+ * Copies a value held by a container; a shared value is only retained.
+ *
+ * Unlike fscl_tofu_value_copy, empty arrays and maps copy fine, and dest is
+ * left zeroed (a valid, empty value) when the copy fails.
+ *
+ * @param source The value to copy.
+ * @param dest Receives the copy.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_shared_copy(const ctofu* source, ctofu* dest);
+
+/**
+ * Copies a value handed to a container and moves the copy into shared
+ * storage, so that the container can copy it again by reference.
+ *
+ * @param source The value to store.
+ * @param dest Receives the shared copy.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_shared_store(const ctofu* source, ctofu* dest);
+
+/**
+ * Turns a shared array or map back into storage of its own, which can be
+ * resized with realloc. Plain values are left untouched.
+ *
+ * @param value The array or map.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_shared_detach(ctofu* value);
+
+// =======================
+// TELEMETRY
+// =======================
+
+#ifdef FSCL_TOFU_TELEMETRY
+#include "fossil/telemetry.h"
+
+/**
+ * Start of a recorded call.
+ */
+typedef struct {
+    uint64_t start;      ///< Clock reading in nanoseconds.
+    uint64_t bytes;      ///< Bytes the thread had allocated so far.
+    size_t elements;     ///< Elements handed to the call.
+} ctofu_trace;
+
+/**
+ * Starts recording a call.
+ *
+ * @param elements The number of elements handed to the call.
+ * @return The start of the call.
+ */
+ctofu_trace fscl_tofu_trace_begin(size_t elements);
+
+/**
+ * Records a finished call in the thread's shard.
+ *
+ * @param op The operation.
+ * @param trace The start of the call.
+ */
+void fscl_tofu_trace_end(ctofu_telemetry_op op, const ctofu_trace* trace);
+
+/**
+ * Adds to the bytes the calling thread has allocated.
+ *
+ * @param bytes The number of bytes.
+ */
+void fscl_tofu_trace_bytes(size_t bytes);
+
+#define FSCL_TOFU_TRACE_BEGIN(trace, elements) ctofu_trace trace = fscl_tofu_trace_begin(elements)
+#define FSCL_TOFU_TRACE_END(op, trace) fscl_tofu_trace_end(op, &trace)
+#define FSCL_TOFU_TRACE_BYTES(bytes) fscl_tofu_trace_bytes(bytes)
+#else
+#define FSCL_TOFU_TRACE_BEGIN(trace, elements) ((void)0)
+#define FSCL_TOFU_TRACE_END(op, trace) ((void)0)
+#define FSCL_TOFU_TRACE_BYTES(bytes) ((void)0)
+#endif
+
+/**
+ * Counts the elements a call works on, for telemetry.
+ *
+ * @param value The value handed to the call, may be NULL.
+ * @return The size of an array or map, else 1.
+ */
+static inline size_t fscl_tofu_trace_size(const ctofu* value) {
+    if (value == NULL) {
+        return 0;
+    }
+    if (value->type == TOFU_ARRAY_TYPE) {
+        return value->data.array_type.size;
+    }
+    if (value->type == TOFU_MAP_TYPE) {
+        return value->data.map_type.size;
+    }
+    return 1;
+}
+
+// =======================
+// PROBES
+// =======================
+
+#if defined(__has_include) && !defined(FSCL_TOFU_NO_USDT)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define FSCL_TOFU_USDT 1
+#endif
+#endif
+
+extern _Atomic(ctofu_probe_hook) fscl_tofu_probe_hook;
+
+/**
+ * What an operation was handed, kept from entry to exit.
+ */
+typedef struct {
+    ctofu_telemetry_op op;
+    ctofu_type type;
+    size_t elements;
+} ctofu_probe_site;
+
+/**
+ * Passes an event to the probe hook.
+ *
+ * @param site The operation and its value.
+ * @param exit Whether the operation is leaving.
+ * @param error Result of the operation.
+ */
+void fscl_tofu_probe_fire(const ctofu_probe_site* site, bool exit, ctofu_error error);
+
+/**
+ * Fires the entry probes of an operation.
+ *
+ * @param op The operation.
+ * @param value The value handed to it, may be NULL.
+ * @return The site to pass to fscl_tofu_probe_exit.
+ */
+static inline ctofu_probe_site fscl_tofu_probe_entry(ctofu_telemetry_op op, const ctofu* value) {
+    ctofu_probe_site site = {op, TOFU_INVALID_TYPE, fscl_tofu_trace_size(value)};
+    if (value != NULL) {
+        site.type = value->type == TOFU_ARRAY_TYPE && value->data.array_type.size > 0
+                        ? value->data.array_type.elements[0].type
+                        : value->type;
+    }
+#ifdef FSCL_TOFU_USDT
+    DTRACE_PROBE3(fscl_tofu, op__entry, (int)site.op, (int)site.type, site.elements);
+#endif
+    if (atomic_load_explicit(&fscl_tofu_probe_hook, memory_order_acquire) != NULL) {
+        fscl_tofu_probe_fire(&site, false, FSCL_TOFU_ERROR_OK);
+    }
+    return site;
+}
+
+/**
+ * Fires the exit probes of an operation.
+ *
+ * @param site The result of fscl_tofu_probe_entry.
+ * @param error Result of the operation.
+ */
+static inline void fscl_tofu_probe_exit(const ctofu_probe_site* site, ctofu_error error) {
+#ifdef FSCL_TOFU_USDT
+    DTRACE_PROBE4(fscl_tofu, op__return, (int)site->op, (int)site->type, site->elements, (int)error);
+#endif
+    if (atomic_load_explicit(&fscl_tofu_probe_hook, memory_order_acquire) != NULL) {
+        fscl_tofu_probe_fire(site, true, error);
+    }
+}
+
+// =======================
+// ACCOUNTING
+// =======================
+
+extern atomic_bool fscl_tofu_account_recording;  ///< Accounting is on.
+extern atomic_bool fscl_tofu_account_watching;   ///< Accounting was ever on, so frees are looked up.
+
+/**
+ * Records a block allocated for a value.
+ *
+ * @param memory The block.
+ * @param bytes The size of the block.
+ * @param type The type of the value the block belongs to.
+ * @param api The call to charge when no public call is in progress.
+ */
+void fscl_tofu_account_record(void* memory, size_t bytes, ctofu_type type, ctofu_alloc_api api);
+
+/**
+ * Releases the record of a block, if it has one.
+ *
+ * @param memory The block.
+ */
+void fscl_tofu_account_forget(const void* memory);
+
+/**
+ * Charges the allocations of the calling thread to a public call, unless an
+ * outer call already is.
+ *
+ * @param api The call.
+ * @return true if the call became the charged one, to be passed to fscl_tofu_account_leave.
+ */
+bool fscl_tofu_account_enter(ctofu_alloc_api api);
+
+/**
+ * Ends a call started with fscl_tofu_account_enter.
+ *
+ * @param entered The result of fscl_tofu_account_enter.
+ */
+void fscl_tofu_account_leave(bool entered);
+
+/**
+ * Records a block when accounting is on.
+ *
+ * @param memory The block, may be NULL.
+ * @param bytes The size of the block.
+ * @param type The type of the value the block belongs to.
+ * @param api The call to charge when no public call is in progress.
+ * @return memory.
+ */
+static inline void* fscl_tofu_account_alloc(void* memory, size_t bytes, ctofu_type type, ctofu_alloc_api api) {
+    if (memory != NULL && atomic_load_explicit(&fscl_tofu_account_recording, memory_order_acquire)) {
+        fscl_tofu_account_record(memory, bytes, type, api);
+    }
+    return memory;
+}
+
+/**
+ * Releases the record of a block about to be freed.
+ *
+ * @param memory The block, may be NULL.
+ */
+static inline void fscl_tofu_account_free(const void* memory) {
+    if (memory != NULL && atomic_load_explicit(&fscl_tofu_account_watching, memory_order_acquire)) {
+        fscl_tofu_account_forget(memory);
+    }
+}
+
+// =======================
+// OUTPUT WRITER
+// =======================
+
+/**
+ * Buffered text sink used by fscl_tofu_out and the JSON writer.
+ *
+ * A writer either drains into a stdio stream whenever its fixed buffer fills,
+ * or (when stream is NULL) grows a heap buffer that the caller takes ownership
+ * of with fscl_tofu_writer_release.
+ */
+typedef struct {
+    FILE* stream;          ///< Destination stream, or NULL for a memory writer.
+    char* data;            ///< Heap buffer used by memory writers.
+    size_t length;         ///< Number of pending bytes.
+    size_t capacity;       ///< Capacity of the heap buffer.
+    bool failed;           ///< Set once an allocation or write has failed.
+    char buffer[1024];     ///< Staging buffer used by stream writers.
+} ctofu_writer;
+
+/**
+ * Prepares a writer that drains into the given stream, or into memory when stream is NULL.
+ *
+ * @param writer The writer to initialize.
+ * @param stream The destination stream, or NULL for a memory writer.
+ */
+void fscl_tofu_writer_init(ctofu_writer* writer, FILE* stream);
+
+/**
+ * Appends raw bytes to the writer.
+ *
+ * @param writer The writer.
+ * @param text The bytes to append.
+ * @param length The number of bytes to append.
+ */
+void fscl_tofu_writer_put(ctofu_writer* writer, const char* text, size_t length);
+
+/**
+ * Appends a formatted string to the writer.
+ *
+ * @param writer The writer.
+ * @param format The printf style format string.
+ */
+void fscl_tofu_writer_format(ctofu_writer* writer, const char* format, ...);
+
+/**
+ * Appends the decimal representation of a signed integer.
+ *
+ * @param writer The writer.
+ * @param value The value to write.
+ */
+void fscl_tofu_writer_int(ctofu_writer* writer, int64_t value);
+
+/**
+ * Appends the decimal representation of an unsigned integer.
+ *
+ * @param writer The writer.
+ * @param value The value to write.
+ */
+void fscl_tofu_writer_uint(ctofu_writer* writer, uint64_t value);
+
+/**
+ * Appends a value using the fscl_tofu_out text format.
+ *
+ * @param writer The writer.
+ * @param value The value to write.
+ */
+void fscl_tofu_writer_value(ctofu_writer* writer, const ctofu* value);
+
+/**
+ * Drains any pending bytes of a stream writer into its stream.
+ *
+ * @param writer The writer.
+ * @return Error code indicating the success or failure of the operation.
+ */
+ctofu_error fscl_tofu_writer_flush(ctofu_writer* writer);
+
+/**
+ * Hands the NUL terminated buffer of a memory writer to the caller.
+ *
+ * @param writer The writer.
+ * @param length Optional output for the number of bytes written.
+ * @return The buffer, to be released with free(), or NULL on failure.
+ */
+char* fscl_tofu_writer_release(ctofu_writer* writer, size_t* length);
+
+// =======================
+// NUMBER PARSING
+// =======================
+
+/**
+ * Converts a decimal significand and power of ten to a double without strtod.
+ *
+ * Only succeeds when both the significand (at most 2^53) and the power of
+ * ten (|exponent| <= 22) are exactly representable, which makes the single
+ * multiplication or division correctly rounded. Callers fall back to strtod
+ * when it returns false.
+ *
+ * @param mantissa The decimal significand.
+ * @param exponent The power of ten applied to the significand.
+ * @param negative Whether the value is negative.
+ * @param result Receives the converted value.
+ * @return true if the value was converted exactly, false otherwise.
+ */
+bool fscl_tofu_fast_real(uint64_t mantissa, int64_t exponent, bool negative, double* result);
+
+#endif
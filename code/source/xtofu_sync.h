@@ -0,0 +1,293 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_SYNC_H
+#define FSCL_XTOFU_SYNC_H
+
+/**
+ * @file xtofu_sync.h
+ *
+ * @brief Private portable threading layer shared by the ToFu sources.
+ *
+ * Wraps POSIX threads and the Win32 thread API behind one small interface so
+ * the rest of the library never includes platform headers directly.
+ */
+
+#include "fossil/xtofu.h"
+#include <stdatomic.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef HANDLE ctofu_thread;
+typedef SRWLOCK ctofu_mutex;
+typedef INIT_ONCE ctofu_once;
+typedef DWORD ctofu_thread_key;
+#define FSCL_TOFU_ONCE_INIT INIT_ONCE_STATIC_INIT
+#define FSCL_TOFU_THREAD_EXIT WINAPI
+#else
+#include <pthread.h>
+typedef pthread_t ctofu_thread;
+typedef pthread_mutex_t ctofu_mutex;
+typedef pthread_once_t ctofu_once;
+typedef pthread_key_t ctofu_thread_key;
+#define FSCL_TOFU_ONCE_INIT PTHREAD_ONCE_INIT
+#define FSCL_TOFU_THREAD_EXIT
+#endif
+
+#if defined(_MSC_VER)
+#define FSCL_TOFU_THREAD_LOCAL __declspec(thread)
+#else
+#define FSCL_TOFU_THREAD_LOCAL _Thread_local
+#endif
+
+// =======================
+// THREAD FUNCTIONS
+// =======================
+
+/**
+ * Starts a new thread running function(argument).
+ *
+ * @param thread Receives the handle of the new thread.
+ * @param function The function to run.
+ * @param argument The argument handed to the function.
+ * @return true if the thread was started, false otherwise.
+ */
+bool fscl_tofu_thread_start(ctofu_thread* thread, void (*function)(void*), void* argument);
+
+/**
+ * Waits for a thread started with fscl_tofu_thread_start to finish.
+ *
+ * @param thread The thread to join.
+ */
+void fscl_tofu_thread_join(ctofu_thread thread);
+
+/**
+ * Retrieves the number of processors available to the process.
+ *
+ * @return The number of online processors, at least 1.
+ */
+size_t fscl_tofu_cpu_count(void);
+
+/**
+ * Runs function(context, task) for every task in [0, tasks) on separate threads.
+ *
+ * The last task runs on the calling thread. If a thread cannot be started its
+ * task also runs on the calling thread, so every task always runs exactly once.
+ *
+ * @param tasks The number of tasks.
+ * @param function The task function.
+ * @param context The context handed to every task.
+ */
+void fscl_tofu_parallel_run(size_t tasks, void (*function)(void* context, size_t task), void* context);
+
+/**
+ * Creates a key whose destructor runs when a thread that set a value for it
+ * exits, so per-thread state can be handed back instead of leaking.
+ *
+ * The destructor is declared with FSCL_TOFU_THREAD_EXIT and receives the
+ * value the exiting thread set. It does not run for the main thread when the
+ * process exits.
+ *
+ * @param key Receives the key.
+ * @param destructor The function to run at thread exit.
+ * @return true if the key was created, false otherwise.
+ */
+bool fscl_tofu_thread_key_create(ctofu_thread_key* key, void (FSCL_TOFU_THREAD_EXIT* destructor)(void*));
+
+/**
+ * Sets the value the calling thread hands to the destructor of a key.
+ *
+ * @param key A key from fscl_tofu_thread_key_create.
+ * @param value The value, NULL to run no destructor for this thread.
+ */
+void fscl_tofu_thread_key_set(ctofu_thread_key key, void* value);
+
+// =======================
+// PER-THREAD RECORDS
+// =======================
+
+/**
+ * Link placed first in a per-thread record that outlives its thread.
+ *
+ * Each thread claims one record of a list the first time it needs one. When
+ * the thread exits the record is handed back and the next thread to claim
+ * takes it over, so a list only grows with the number of threads alive at
+ * once. Records are never freed, so readers may walk a list at any time.
+ */
+typedef struct ctofu_thread_record {
+    struct ctofu_thread_record* next;     ///< Next record of the list, immutable once published.
+    atomic_bool owned;                    ///< A live thread holds the record.
+    struct ctofu_thread_records* list;    ///< The list the record belongs to.
+    struct ctofu_thread_record** self;    ///< The owner's thread-local pointer to the record.
+    struct ctofu_thread_record* held;     ///< Next record held by the same thread.
+} ctofu_thread_record;
+
+/**
+ * List of per-thread records of one kind.
+ */
+typedef struct ctofu_thread_records {
+    _Atomic(ctofu_thread_record*) head;                 ///< Most recently created record.
+    size_t size;                                        ///< Size of a record, link included.
+    void (*init)(ctofu_thread_record* record);          ///< Prepares a zeroed new record, may be NULL.
+    void (*release)(ctofu_thread_record* record);       ///< Runs at thread exit before the handover, may be NULL.
+} ctofu_thread_records;
+
+/**
+ * Static initializer of a list whose records are of the given type.
+ */
+#define FSCL_TOFU_THREAD_RECORDS_INIT(type, init, release) {NULL, sizeof(type), init, release}
+
+/**
+ * Gives the calling thread a record of a list, taking over the record of a
+ * thread that exited when one is free.
+ *
+ * The record is stored in *self, which must be a thread-local variable of the
+ * caller. It is reset to NULL when the record is handed back at thread exit.
+ *
+ * @param list The list.
+ * @param self The caller's thread-local pointer to its record.
+ * @return The record, or NULL if a new one could not be allocated.
+ */
+ctofu_thread_record* fscl_tofu_thread_record_claim(ctofu_thread_records* list, ctofu_thread_record** self);
+
+// =======================
+// LOCK FUNCTIONS
+// =======================
+
+/**
+ * Prepares a mutex for use.
+ *
+ * @param mutex The mutex to initialize.
+ */
+void fscl_tofu_mutex_init(ctofu_mutex* mutex);
+
+/**
+ * Releases the resources held by a mutex.
+ *
+ * @param mutex The mutex, which must not be locked.
+ */
+void fscl_tofu_mutex_erase(ctofu_mutex* mutex);
+
+/**
+ * Acquires a mutex, waiting until it is available.
+ *
+ * @param mutex The mutex to lock.
+ */
+void fscl_tofu_mutex_lock(ctofu_mutex* mutex);
+
+/**
+ * Releases a mutex acquired with fscl_tofu_mutex_lock.
+ *
+ * @param mutex The mutex to unlock.
+ */
+void fscl_tofu_mutex_unlock(ctofu_mutex* mutex);
+
+/**
+ * Runs function exactly once for the given flag, even when called from several threads.
+ *
+ * @param once The flag, statically initialized with FSCL_TOFU_ONCE_INIT.
+ * @param function The function to run.
+ */
+void fscl_tofu_once(ctofu_once* once, void (*function)(void));
+
+// =======================
+// WAIT FUNCTIONS
+// =======================
+
+/**
+ * Sleeps while a word still holds an expected value (a futex wait).
+ *
+ * May return early or spuriously, so callers re-check their condition in a
+ * loop. Uses futex on Linux and WaitOnAddress on Windows; elsewhere it only
+ * yields the processor.
+ *
+ * @param word The word to watch.
+ * @param expected The value that keeps the caller asleep.
+ */
+void fscl_tofu_wait(_Atomic uint32_t* word, uint32_t expected);
+
+/**
+ * Wakes threads sleeping in fscl_tofu_wait on a word.
+ *
+ * @param word The watched word, changed by the caller beforehand.
+ * @param all Wake every waiter instead of one.
+ */
+void fscl_tofu_wake(_Atomic uint32_t* word, bool all);
+
+// =======================
+// EPOCH RECLAMATION
+// =======================
+
+/**
+ * Link embedded in objects that wait for reclamation.
+ *
+ * Lock-free readers may still hold pointers to an object that a writer has
+ * unlinked, so the writer retires it instead of freeing it. A retired object
+ * is reclaimed once the global epoch has moved two steps past the epoch it
+ * was retired in, which guarantees that every reader that could have seen
+ * it has left its critical section.
+ */
+typedef struct ctofu_retired {
+    struct ctofu_retired* next;                  ///< Next, older, retired object.
+    uint64_t epoch;                              ///< Global epoch when it was retired.
+    void (*reclaim)(struct ctofu_retired* item); ///< Frees the object.
+} ctofu_retired;
+
+/**
+ * List of retired objects owned by one writer (for example, guarded by its lock).
+ */
+typedef struct {
+    ctofu_retired* head;  ///< Most recently retired object.
+    size_t count;         ///< Number of objects in the list.
+} ctofu_epoch_bin;
+
+/**
+ * Enters a read-side critical section; pointers loaded inside stay valid until
+ * the matching fscl_tofu_epoch_exit. Sections may nest.
+ */
+void fscl_tofu_epoch_enter(void);
+
+/**
+ * Leaves a read-side critical section.
+ */
+void fscl_tofu_epoch_exit(void);
+
+/**
+ * Retires an object that is no longer reachable by new readers.
+ *
+ * Every so often this also tries to advance the global epoch and reclaims the
+ * objects of the bin that no reader can see any more.
+ *
+ * @param bin The bin owned by the caller.
+ * @param item The link embedded in the object.
+ * @param reclaim The function that frees the object.
+ */
+void fscl_tofu_epoch_retire(ctofu_epoch_bin* bin, ctofu_retired* item, void (*reclaim)(ctofu_retired* item));
+
+/**
+ * Tries to advance the global epoch and reclaims what is safe to reclaim.
+ *
+ * @param bin The bin owned by the caller.
+ */
+void fscl_tofu_epoch_collect(ctofu_epoch_bin* bin);
+
+/**
+ * Reclaims every object of a bin at once.
+ *
+ * Only valid when no reader can still reach the objects, for example when the
+ * structure owning the bin is being destroyed.
+ *
+ * @param bin The bin owned by the caller.
+ */
+void fscl_tofu_epoch_drain(ctofu_epoch_bin* bin);
+
+#endif
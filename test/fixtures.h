@@ -0,0 +1,55 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FSCL_XTOFU_TEST_FIXTURES_H
+#define FSCL_XTOFU_TEST_FIXTURES_H
+
+#include "fossil/xtofu.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Fixtures
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Builds an integer value on the stack
+static inline ctofu fscl_tofu_test_int(int64_t number) {
+    ctofu value;
+    memset(&value, 0, sizeof(value));
+    value.type = TOFU_INT_TYPE;
+    value.data.int_type = number;
+    return value;
+}
+
+// Builds a string value on the stack, released with fscl_tofu_value_erase
+static inline ctofu fscl_tofu_test_string(const char* text) {
+    ctofu value;
+    memset(&value, 0, sizeof(value));
+    fscl_tofu_string_set(&value, text, strlen(text));
+    return value;
+}
+
+// Builds an array of size zeroed elements of one type, released with fscl_tofu_erase_array
+static inline ctofu fscl_tofu_test_array(ctofu_type type, size_t size) {
+    ctofu array;
+    memset(&array, 0, sizeof(array));
+    array.type = TOFU_ARRAY_TYPE;
+    array.data.array_type.elements = (ctofu*)calloc(size ? size : 1, sizeof(ctofu));
+    array.data.array_type.size = size;
+    for (size_t i = 0; i < size; ++i) {
+        array.data.array_type.elements[i].type = type;
+    }
+    return array;
+}
+
+#endif
@@ -0,0 +1,128 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/account.h" // lib source code
+#include "fossil/encode.h"
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_account_by_api_and_type) {
+    ctofu_alloc_stats before_create, before_array, before_copy, before_string, before_totals, stats;
+    fscl_tofu_account_enable(true);
+    TEST_ASSUME_EQUAL(true, fscl_tofu_account_enabled());
+    fscl_tofu_account_by_api(FSCL_TOFU_ALLOC_CREATE, &before_create);
+    fscl_tofu_account_by_api(FSCL_TOFU_ALLOC_CREATE_ARRAY, &before_array);
+    fscl_tofu_account_by_api(FSCL_TOFU_ALLOC_VALUE_COPY, &before_copy);
+    fscl_tofu_account_by_type(TOFU_STRING_TYPE, &before_string);
+    fscl_tofu_account_totals(&before_totals);
+
+    // A string value is its structure plus its text, both charged to create
+    ctofu* text = fscl_tofu_create(TOFU_STRING_TYPE, &(ctofu_data){.string_type = "accounted for"});
+    ctofu* array = fscl_tofu_create_array(TOFU_INT_TYPE, 3, 1, 2, 3);
+    TEST_ASSUME_NOT_CNULLPTR(text);
+    TEST_ASSUME_NOT_CNULLPTR(array);
+    ctofu copy;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_copy(array, &copy));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_account_by_api(FSCL_TOFU_ALLOC_CREATE, &stats));
+    TEST_ASSUME_EQUAL(before_create.live_objects + 2, stats.live_objects);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_account_by_type(TOFU_STRING_TYPE, &stats));
+    TEST_ASSUME_EQUAL(before_string.live_objects + 2, stats.live_objects);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_account_by_api(FSCL_TOFU_ALLOC_CREATE_ARRAY, &stats));
+    TEST_ASSUME_EQUAL(before_array.live_bytes + 4 * sizeof(ctofu), stats.live_bytes);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_account_by_api(FSCL_TOFU_ALLOC_VALUE_COPY, &stats));
+    TEST_ASSUME_EQUAL(before_copy.live_bytes + 3 * sizeof(ctofu), stats.live_bytes);
+    TEST_ASSUME_EQUAL(true, fscl_tofu_account_report(NULL) >= 5);
+
+    // Erasing releases every record, the peak remembers them
+    fscl_tofu_value_erase(&copy);
+    fscl_tofu_erase(array);
+    fscl_tofu_erase(text);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_account_totals(&stats));
+    TEST_ASSUME_EQUAL(before_totals.live_objects, stats.live_objects);
+    TEST_ASSUME_EQUAL(before_totals.live_bytes, stats.live_bytes);
+    TEST_ASSUME_EQUAL(before_totals.total_objects + 5, stats.total_objects);
+    TEST_ASSUME_EQUAL(true, stats.peak_bytes >= before_totals.live_bytes + 8 * sizeof(ctofu));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS, fscl_tofu_account_by_api(FSCL_TOFU_ALLOC_APIS, &stats));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_NULL_POINTER, fscl_tofu_account_totals(NULL));
+
+    // Turned off, nothing new is recorded
+    fscl_tofu_account_enable(false);
+    ctofu* value = fscl_tofu_create(TOFU_INT_TYPE, &(ctofu_data){.int_type = 1});
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_account_totals(&before_totals));
+    TEST_ASSUME_EQUAL(stats.total_objects, before_totals.total_objects);
+    fscl_tofu_erase(value);
+}
+
+XTEST(test_account_footprint) {
+    TEST_ASSUME_EQUAL(0, fscl_tofu_footprint(NULL));
+
+    ctofu* number = fscl_tofu_create(TOFU_INT_TYPE, &(ctofu_data){.int_type = 42});
+    ctofu* array = fscl_tofu_create_array(TOFU_INT_TYPE, 3, 1, 2, 3);
+    TEST_ASSUME_NOT_CNULLPTR(number);
+    TEST_ASSUME_NOT_CNULLPTR(array);
+    TEST_ASSUME_EQUAL(sizeof(ctofu), fscl_tofu_footprint(number));
+    TEST_ASSUME_EQUAL(4 * sizeof(ctofu), fscl_tofu_footprint(array));
+
+    // A map owns its key and value buffers and the text of its strings
+    ctofu map;
+    memset(&map, 0, sizeof(map));
+    map.type = TOFU_MAP_TYPE;
+    ctofu key;
+    ctofu value;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&key, "a key longer than inline text", 29));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_copy(array, &value));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_map_move_entry(&map, &key, &value));
+    TEST_ASSUME_EQUAL(sizeof(ctofu) + 2 * sizeof(ctofu) + 30 + 3 * sizeof(ctofu), fscl_tofu_footprint(&map));
+
+    fscl_tofu_value_erase(&map);
+    fscl_tofu_erase(array);
+    fscl_tofu_erase(number);
+}
+
+XTEST(test_account_encode_dictionary) {
+    ctofu* words = fscl_tofu_create_array(TOFU_STRING_TYPE, 6, "pear", "fig", "pear", "plum", "fig", "kiwi");
+    TEST_ASSUME_NOT_CNULLPTR(words);
+    ctofu_alloc_stats before, stats;
+    fscl_tofu_account_enable(true);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_account_totals(&before));
+
+    // The dictionary copies each distinct string once and releases them on erase
+    ctofu_encoded* encoded = NULL;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encode(words, TOFU_ENCODING_DICTIONARY, &encoded));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_account_by_api(FSCL_TOFU_ALLOC_STRDUP, &stats));
+    TEST_ASSUME_EQUAL(true, stats.live_objects >= 4);
+    fscl_tofu_encoded_erase(encoded);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_account_totals(&stats));
+    TEST_ASSUME_EQUAL(before.live_objects, stats.live_objects);
+    TEST_ASSUME_EQUAL(before.live_bytes, stats.live_bytes);
+
+    fscl_tofu_account_enable(false);
+    fscl_tofu_erase(words);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_account_group) {
+    XTEST_RUN_UNIT(test_account_by_api_and_type);
+    XTEST_RUN_UNIT(test_account_footprint);
+    XTEST_RUN_UNIT(test_account_encode_dictionary);
+} // end of tofu_account_group
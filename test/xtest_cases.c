@@ -11,9 +11,15 @@ Description:
 ==============================================================================
 */
 #include "fossil/xtofu.h" // lib source code
+#include "fossil/shared.h"
+#include "fossil/intern.h"
 
 #include <fossil/xtest.h>   // basic test tools
 #include <fossil/xassume.h> // extra asserts
+#include "fixtures.h"
+
+#include <stdlib.h>
+#include <string.h>
 
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Utilites
@@ -560,6 +566,216 @@ XTEST(test_partition) {
     fscl_tofu_erase_array(array);
 }
 
+XTEST(test_string_inline) {
+    // Short strings live inside the value itself
+    ctofu small;
+    ctofu copy;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&small, "inline key", 10));
+    TEST_ASSUME_EQUAL(TOFU_FLAG_INLINE, small.flags);
+    TEST_ASSUME_EQUAL(10, fscl_tofu_string_length(&small));
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_string_data(&small), "inline key"));
+
+    // Copies and comparisons work with plain heap strings
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_copy(&small, &copy));
+    TEST_ASSUME_EQUAL(TOFU_FLAG_INLINE, copy.flags);
+    ctofu* heap = fscl_tofu_create(TOFU_STRING_TYPE, &(ctofu_data){.string_type = "inline key"});
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compare(&copy, heap));
+    TEST_ASSUME_EQUAL(fscl_tofu_hash(&small), fscl_tofu_hash(heap));
+
+    // Strings longer than FSCL_TOFU_SMALL_STRING carry their length on the heap
+    ctofu large;
+    const char* text = "a string that is too long to fit";
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&large, text, strlen(text)));
+    TEST_ASSUME_EQUAL(TOFU_FLAG_SIZED, large.flags);
+    TEST_ASSUME_EQUAL(strlen(text), fscl_tofu_string_length(&large));
+    TEST_ASSUME_EQUAL(0, strcmp(large.data.string_type, text));
+
+    // Clean up
+    fscl_tofu_value_erase(&small);
+    fscl_tofu_value_erase(&copy);
+    fscl_tofu_value_erase(&large);
+    fscl_tofu_value_erase(heap);
+    fscl_tofu_erase(heap);
+}
+
+XTEST(test_string_inline_enabled) {
+    fscl_tofu_inline_strings_enable(true);
+    ctofu* small = fscl_tofu_create(TOFU_STRING_TYPE, &(ctofu_data){.string_type = "id"});
+    ctofu* large = fscl_tofu_create(TOFU_STRING_TYPE, &(ctofu_data){.string_type = "description of the item"});
+    fscl_tofu_inline_strings_enable(false);
+
+    TEST_ASSUME_EQUAL(TOFU_FLAG_INLINE, small->flags);
+    TEST_ASSUME_EQUAL(TOFU_FLAG_SIZED, large->flags);
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_value_getter(small).string_type, "id"));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_compare(small, large));
+
+    // Clean up
+    fscl_tofu_value_erase(small);
+    fscl_tofu_value_erase(large);
+    fscl_tofu_erase(small);
+    fscl_tofu_erase(large);
+}
+
+XTEST(test_string_reorder) {
+    // Inline, heap and interned strings keep their storage through reordering
+    const char* texts[] = {"id", "a string that is too long to fit", "an interned string in the pool", "ok"};
+    ctofu array = fscl_tofu_test_array(TOFU_STRING_TYPE, 4);
+    ctofu* elements = array.data.array_type.elements;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&elements[0], texts[0], strlen(texts[0])));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&elements[1], texts[1], strlen(texts[1])));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_intern_string(&elements[2], texts[2]));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&elements[3], texts[3], strlen(texts[3])));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_reverse(&array));
+    for (size_t i = 0; i < 4; ++i) {
+        TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_string_data(&elements[i]), texts[3 - i]));
+    }
+    TEST_ASSUME_EQUAL(TOFU_FLAG_INLINE, elements[3].flags);
+    TEST_ASSUME_EQUAL(TOFU_FLAG_SIZED, elements[2].flags);
+    TEST_ASSUME_EQUAL(true, (elements[1].flags & TOFU_FLAG_INTERNED) != 0);
+
+    // Every string still matches its length after shuffling
+    for (int round = 0; round < 8; ++round) {
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_shuffle(&array));
+        for (size_t i = 0; i < 4; ++i) {
+            TEST_ASSUME_EQUAL(strlen(fscl_tofu_string_data(&elements[i])), fscl_tofu_string_length(&elements[i]));
+        }
+    }
+
+    // Erasing frees each string the way it was stored
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_erase_array(&array));
+}
+
+XTEST(test_value_move) {
+    const char* text = "a string that is too long to fit";
+    ctofu source;
+    ctofu slot;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&source, text, strlen(text)));
+    const char* storage = fscl_tofu_string_data(&source);
+
+    // The array slot takes over the heap text and hands it back out
+    ctofu array;
+    memset(&array, 0, sizeof(array));
+    array.type = TOFU_ARRAY_TYPE;
+    array.data.array_type.size = 2;
+    array.data.array_type.elements = (ctofu*)calloc(2, sizeof(ctofu));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_array_move_in(&array, 1, &source));
+    TEST_ASSUME_EQUAL(TOFU_INT_TYPE, source.type);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_array_take(&array, 1, &slot));
+    TEST_ASSUME_EQUAL(true, fscl_tofu_string_data(&slot) == storage);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS, fscl_tofu_array_take(&array, 2, &slot));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_move(&slot, &source));
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_string_data(&source), text));
+
+    // Clean up
+    fscl_tofu_value_erase(&source);
+    fscl_tofu_value_erase(&array);
+}
+
+XTEST(test_map_move_entry) {
+    ctofu map;
+    ctofu key;
+    ctofu value;
+    memset(&map, 0, sizeof(map));
+    map.type = TOFU_MAP_TYPE;
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&key, "name", 4));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&value, "first", 5));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_map_move_entry(&map, &key, &value));
+    TEST_ASSUME_EQUAL(1, map.data.map_type.size);
+
+    // A present key only has its value replaced
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&key, "name", 4));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&value, "second", 6));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_map_move_entry(&map, &key, &value));
+    TEST_ASSUME_EQUAL(1, map.data.map_type.size);
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_string_data(&map.data.map_type.value[0]), "second"));
+
+    // Clean up
+    fscl_tofu_value_erase(&map);
+}
+
+XTEST(test_value_erase_nested) {
+    // Nest arrays and maps deeper than the erase walk keeps on the C stack
+    ctofu root;
+    memset(&root, 0, sizeof(root));
+    for (size_t depth = 0; depth < 100; ++depth) {
+        // Arrays hold [text, child], maps hold {text: child}
+        ctofu* slots = (ctofu*)calloc(2, sizeof(ctofu));
+        TEST_ASSUME_NOT_CNULLPTR(slots);
+        const char* text = "a string that is too long to fit";
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&slots[0], text, strlen(text)));
+        slots[1] = root;
+
+        memset(&root, 0, sizeof(root));
+        if (depth % 2 == 0) {
+            root.type = TOFU_ARRAY_TYPE;
+            root.data.array_type.elements = slots;
+            root.data.array_type.size = 2;
+        } else {
+            root.type = TOFU_MAP_TYPE;
+            root.data.map_type.key = slots;
+            root.data.map_type.value = (ctofu*)calloc(1, sizeof(ctofu));
+            TEST_ASSUME_NOT_CNULLPTR(root.data.map_type.value);
+            root.data.map_type.value[0] = slots[1];
+            memset(&slots[1], 0, sizeof(ctofu));
+            root.data.map_type.size = 1;
+            TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_share(&root));
+        }
+    }
+
+    // Erasing leaves a zeroed value behind, so a second erase is harmless
+    fscl_tofu_value_erase(&root);
+    TEST_ASSUME_EQUAL(TOFU_INT_TYPE, root.type);
+    fscl_tofu_value_erase(&root);
+
+    // Arrays own copies of their strings
+    ctofu* words = fscl_tofu_create_array(TOFU_STRING_TYPE, 2, "alpha", "a string that is too long to fit");
+    TEST_ASSUME_NOT_CNULLPTR(words);
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_string_data(&words->data.array_type.elements[1]), "a string that is too long to fit"));
+    fscl_tofu_erase(words);
+}
+
+static size_t logged_messages = 0;
+
+static void count_log(const ctofu_error_context* context, const char* message, void* user) {
+    (void)context;
+    (void)message;
+    *(size_t*)user += 1;
+}
+
+XTEST(test_error_context) {
+    fscl_tofu_clear_error();
+    ctofu* array = fscl_tofu_create_array(TOFU_INT_TYPE, 3, 1, 2, 3);
+    TEST_ASSUME_NOT_CNULLPTR(array);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_sort(array));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_last_error()->code);
+
+    // A failure names the element and type at fault
+    ctofu* key = fscl_tofu_create(TOFU_STRING_TYPE, &(ctofu_data){.string_type = "two"});
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_search(array, key));
+    const ctofu_error_context* context = fscl_tofu_last_error();
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, context->code);
+    TEST_ASSUME_EQUAL(0, context->index);
+    TEST_ASSUME_EQUAL(TOFU_INT_TYPE, context->type);
+    TEST_ASSUME_NOT_CNULLPTR(context->function);
+
+    // Diagnostics go to the sink instead of stdout
+    fscl_tofu_set_log_sink(count_log, &logged_messages);
+    ctofu_data data = fscl_tofu_value_getter(array);
+    fscl_tofu_set_log_sink(NULL, NULL);
+    TEST_ASSUME_EQUAL(0, data.int_type);
+    TEST_ASSUME_EQUAL(1, logged_messages);
+    TEST_ASSUME_EQUAL(TOFU_ARRAY_TYPE, fscl_tofu_last_error()->type);
+    TEST_ASSUME_EQUAL(SIZE_MAX, fscl_tofu_last_error()->index);
+
+    fscl_tofu_clear_error();
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_last_error()->code);
+    fscl_tofu_erase(key);
+    fscl_tofu_erase(array);
+}
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Pool
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -579,5 +795,12 @@ XTEST_DEFINE_POOL(tofu_type_group) {
     XTEST_RUN_UNIT(test_shuffle);
     XTEST_RUN_UNIT(test_for_each);
     XTEST_RUN_UNIT(test_partition);
+    XTEST_RUN_UNIT(test_string_inline);
+    XTEST_RUN_UNIT(test_string_inline_enabled);
+    XTEST_RUN_UNIT(test_string_reorder);
+    XTEST_RUN_UNIT(test_value_move);
+    XTEST_RUN_UNIT(test_map_move_entry);
+    XTEST_RUN_UNIT(test_value_erase_nested);
+    XTEST_RUN_UNIT(test_error_context);
 
 } // end of xdata_test_tofu_group
@@ -0,0 +1,145 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/compact.h" // lib source code
+#include "fossil/json.h"
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+static bool keep_odd(const ctofu_data* data) {
+    return data->int_type % 2 != 0;
+}
+
+static bool keep_long(const ctofu_data* data) {
+    return strlen(data->string_type) > 3;
+}
+
+static int triple(int value) {
+    return value * 3;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_compact_round_trip) {
+    const char* text = "{\"id\":42,\"name\":\"short\",\"tags\":[\"a somewhat longer tag\",1.5,true,null]}";
+    ctofu value;
+    ctofu back;
+    ctofu_compact compact;
+
+    TEST_ASSUME_EQUAL(16, sizeof(ctofu_compact));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_json_parse(text, strlen(text), &value));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_from(&value, &compact));
+    TEST_ASSUME_EQUAL(TOFU_MAP_TYPE, fscl_tofu_compact_type(&compact));
+    TEST_ASSUME_EQUAL(3, fscl_tofu_compact_size(&compact));
+
+    // Keys come first, the short name is stored inline
+    const ctofu_compact* entries = fscl_tofu_compact_elements(&compact);
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_compact_string(&entries[1]), "name"));
+    TEST_ASSUME_EQUAL(TOFU_FLAG_INLINE, entries[4].flags);
+    TEST_ASSUME_EQUAL(5, fscl_tofu_compact_string_length(&entries[4]));
+    TEST_ASSUME_EQUAL(4, fscl_tofu_compact_size(&entries[5]));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_to(&compact, &back));
+    char* json = fscl_tofu_json_stringify(&back, NULL);
+    TEST_ASSUME_NOT_CNULLPTR(json);
+    TEST_ASSUME_EQUAL(0, strcmp(json, text));
+
+    free(json);
+    fscl_tofu_value_erase(&value);
+    fscl_tofu_value_erase(&back);
+    fscl_tofu_compact_erase(&compact);
+}
+
+XTEST(test_compact_algorithms) {
+    ctofu_compact array;
+    ctofu_compact sum;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_array(TOFU_INT_TYPE, 6, &array));
+
+    ctofu_compact* elements = fscl_tofu_compact_elements(&array);
+    const int64_t input[6] = {5, -3, 8, 1, 7, 2};
+    for (size_t i = 0; i < 6; ++i) {
+        elements[i].data.int_type = input[i];
+    }
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_accumulate(&array, &sum));
+    TEST_ASSUME_EQUAL(TOFU_INT_TYPE, sum.type);
+    TEST_ASSUME_EQUAL(20, sum.data.int_type);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_sort(&array));
+    TEST_ASSUME_EQUAL(-3, elements[0].data.int_type);
+    TEST_ASSUME_EQUAL(8, elements[5].data.int_type);
+
+    ctofu_compact key;
+    size_t index = 0;
+    memset(&key, 0, sizeof(key));
+    key.type = TOFU_INT_TYPE;
+    key.data.int_type = 7;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_search(&array, &key, &index));
+    TEST_ASSUME_EQUAL(4, index);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_reverse(&array));
+    TEST_ASSUME_EQUAL(8, elements[0].data.int_type);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_transform(&array, triple));
+    TEST_ASSUME_EQUAL(24, elements[0].data.int_type);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_filter(&array, keep_odd));
+    TEST_ASSUME_EQUAL(4, fscl_tofu_compact_size(&array));
+    TEST_ASSUME_EQUAL(21, elements[0].data.int_type);
+
+    fscl_tofu_compact_erase(&array);
+}
+
+XTEST(test_compact_strings) {
+    ctofu_compact array;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_array(TOFU_STRING_TYPE, 3, &array));
+
+    // Build the array from ctofu strings
+    const char* words[3] = {"pear", "an apple from the orchard", "fig"};
+    ctofu_compact* elements = fscl_tofu_compact_elements(&array);
+    for (size_t i = 0; i < 3; ++i) {
+        ctofu word;
+        memset(&word, 0, sizeof(word));
+        word.type = TOFU_STRING_TYPE;
+        word.data.string_type = (char*)words[i];
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_from(&word, &elements[i]));
+    }
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_sort(&array));
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_compact_string(&elements[0]), "an apple from the orchard"));
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_compact_string(&elements[2]), "pear"));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compact_filter(&array, keep_long));
+    TEST_ASSUME_EQUAL(2, fscl_tofu_compact_size(&array));
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_compact_string(&elements[1]), "pear"));
+
+    fscl_tofu_compact_erase(&array);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_compact_group) {
+    XTEST_RUN_UNIT(test_compact_round_trip);
+    XTEST_RUN_UNIT(test_compact_algorithms);
+    XTEST_RUN_UNIT(test_compact_strings);
+} // end of tofu_compact_group
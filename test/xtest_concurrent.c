@@ -0,0 +1,90 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/concurrent.h" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include "fixtures.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_cmap_basic) {
+    ctofu_cmap* map = fscl_tofu_cmap_create();
+    TEST_ASSUME_NOT_CNULLPTR(map);
+
+    ctofu key = fscl_tofu_test_string("session");
+    ctofu value = fscl_tofu_test_string("a value long enough to live on the heap");
+    ctofu found;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_TYPE_MISMATCH, fscl_tofu_cmap_get(map, &key, NULL));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_cmap_set(map, &key, &value));
+    TEST_ASSUME_EQUAL(1, fscl_tofu_cmap_size(map));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_cmap_get(map, &key, &found));
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_string_data(&found), fscl_tofu_string_data(&value)));
+    fscl_tofu_value_erase(&found);
+
+    // Replacing keeps the size, removing drops it
+    ctofu other = fscl_tofu_test_int(7);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_cmap_set(map, &key, &other));
+    TEST_ASSUME_EQUAL(1, fscl_tofu_cmap_size(map));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_cmap_get(map, &key, &found));
+    TEST_ASSUME_EQUAL(7, found.data.int_type);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_cmap_remove(map, &key));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_TYPE_MISMATCH, fscl_tofu_cmap_remove(map, &key));
+    TEST_ASSUME_EQUAL(0, fscl_tofu_cmap_size(map));
+
+    fscl_tofu_value_erase(&key);
+    fscl_tofu_value_erase(&value);
+    fscl_tofu_cmap_erase(map);
+}
+
+XTEST(test_cmap_growth) {
+    ctofu_cmap* map = fscl_tofu_cmap_create();
+    TEST_ASSUME_NOT_CNULLPTR(map);
+
+    // Enough keys to grow every shard a few times
+    for (int64_t i = 0; i < 20000; ++i) {
+        ctofu key = fscl_tofu_test_int(i);
+        ctofu value = fscl_tofu_test_int(i * 3);
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_cmap_set(map, &key, &value));
+    }
+    TEST_ASSUME_EQUAL(20000, fscl_tofu_cmap_size(map));
+
+    for (int64_t i = 0; i < 20000; i += 2) {
+        ctofu key = fscl_tofu_test_int(i);
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_cmap_remove(map, &key));
+    }
+    TEST_ASSUME_EQUAL(10000, fscl_tofu_cmap_size(map));
+
+    ctofu key = fscl_tofu_test_int(12345);
+    ctofu found;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_cmap_get(map, &key, &found));
+    TEST_ASSUME_EQUAL(37035, found.data.int_type);
+    key = fscl_tofu_test_int(12344);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_TYPE_MISMATCH, fscl_tofu_cmap_get(map, &key, &found));
+
+    fscl_tofu_cmap_erase(map);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_concurrent_group) {
+    XTEST_RUN_UNIT(test_cmap_basic);
+    XTEST_RUN_UNIT(test_cmap_growth);
+} // end of tofu_concurrent_group
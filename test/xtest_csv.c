@@ -0,0 +1,145 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/csv.h" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_csv_typed_columns) {
+    const char* text = "-12345678901,0x1F,2.5,yes,tofu\n42,ff,-1e3,F,\n";
+    ctofu_type schema[] = { TOFU_INT_TYPE, TOFU_HEX_TYPE, TOFU_DOUBLE_TYPE, TOFU_BOOLEAN_TYPE, TOFU_STRING_TYPE };
+    ctofu columns[5];
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_csv_load_buffer(text, strlen(text), schema, 5, NULL, columns));
+    TEST_ASSUME_EQUAL(TOFU_ARRAY_TYPE, columns[0].type);
+    TEST_ASSUME_EQUAL(2, columns[0].data.array_type.size);
+    TEST_ASSUME_EQUAL(-12345678901LL, columns[0].data.array_type.elements[0].data.int_type);
+    TEST_ASSUME_EQUAL(42, columns[0].data.array_type.elements[1].data.int_type);
+    TEST_ASSUME_EQUAL(0x1F, columns[1].data.array_type.elements[0].data.hex_type);
+    TEST_ASSUME_EQUAL(0xFF, columns[1].data.array_type.elements[1].data.hex_type);
+    TEST_ASSUME_EQUAL(2.5, columns[2].data.array_type.elements[0].data.double_type);
+    TEST_ASSUME_EQUAL(-1000.0, columns[2].data.array_type.elements[1].data.double_type);
+    TEST_ASSUME_EQUAL(true, columns[3].data.array_type.elements[0].data.boolean_type);
+    TEST_ASSUME_EQUAL(false, columns[3].data.array_type.elements[1].data.boolean_type);
+    TEST_ASSUME_EQUAL(0, strcmp("tofu", columns[4].data.array_type.elements[0].data.string_type));
+    TEST_ASSUME_EQUAL(0, strcmp("", columns[4].data.array_type.elements[1].data.string_type));
+
+    for (size_t i = 0; i < 5; ++i) {
+        fscl_tofu_value_erase(&columns[i]);
+    }
+}
+
+XTEST(test_csv_quotes_and_header) {
+    const char* text = "id\tname\r\n1\t\"say \"\"hi\"\"\r\n\tthere\"\r\n\r\n2\tplain\r\n";
+    ctofu_type schema[] = { TOFU_UINT_TYPE, TOFU_STRING_TYPE };
+    ctofu_csv_options options = fscl_tofu_csv_options('\t');
+    options.header = true;
+    ctofu columns[2];
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_csv_load_buffer(text, strlen(text), schema, 2, &options, columns));
+    TEST_ASSUME_EQUAL(2, columns[0].data.array_type.size);
+    TEST_ASSUME_EQUAL(2, columns[0].data.array_type.elements[1].data.uint_type);
+    TEST_ASSUME_EQUAL(0, strcmp("say \"hi\"\r\n\tthere", columns[1].data.array_type.elements[0].data.string_type));
+    TEST_ASSUME_EQUAL(0, strcmp("plain", columns[1].data.array_type.elements[1].data.string_type));
+
+    fscl_tofu_value_erase(&columns[0]);
+    fscl_tofu_value_erase(&columns[1]);
+}
+
+XTEST(test_csv_threaded_file) {
+    // Enough rows for several slices, read back in chunks smaller than a record run
+    const size_t rows = 50000;
+    const char* path = "xtest_csv_threaded.csv";
+    FILE* file = fopen(path, "wb");
+    TEST_ASSUME_NOT_CNULLPTR(file);
+    for (size_t i = 0; i < rows; ++i) {
+        fprintf(file, "%zu,\"row, %zu\",%zu.25\n", i, i, i);
+    }
+    fclose(file);
+
+    ctofu_type schema[] = { TOFU_UINT_TYPE, TOFU_STRING_TYPE, TOFU_DOUBLE_TYPE };
+    ctofu_csv_options options = fscl_tofu_csv_options(',');
+    options.threads = 4;
+    options.chunk_size = 4093;
+    ctofu columns[3];
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_csv_load_file(path, schema, 3, &options, columns));
+    TEST_ASSUME_EQUAL(rows, columns[0].data.array_type.size);
+
+    size_t mismatches = 0;
+    char expected[64];
+    for (size_t i = 0; i < rows; ++i) {
+        snprintf(expected, sizeof(expected), "row, %zu", i);
+        mismatches += columns[0].data.array_type.elements[i].data.uint_type != i;
+        mismatches += strcmp(expected, columns[1].data.array_type.elements[i].data.string_type) != 0;
+        mismatches += columns[2].data.array_type.elements[i].data.double_type != (double)i + 0.25;
+    }
+    TEST_ASSUME_EQUAL(0, mismatches);
+
+    for (size_t i = 0; i < 3; ++i) {
+        fscl_tofu_value_erase(&columns[i]);
+    }
+
+    // The same text loaded from memory splits across threads in one pass
+    options.chunk_size = 0;
+    file = fopen(path, "rb");
+    TEST_ASSUME_NOT_CNULLPTR(file);
+    fseek(file, 0, SEEK_END);
+    size_t length = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = (char*)malloc(length);
+    TEST_ASSUME_EQUAL(length, fread(text, 1, length, file));
+    fclose(file);
+    remove(path);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_csv_load_buffer(text, length, schema, 3, &options, columns));
+    TEST_ASSUME_EQUAL(rows, columns[1].data.array_type.size);
+    TEST_ASSUME_EQUAL(0, strcmp("row, 49999", columns[1].data.array_type.elements[rows - 1].data.string_type));
+
+    free(text);
+    for (size_t i = 0; i < 3; ++i) {
+        fscl_tofu_value_erase(&columns[i]);
+    }
+}
+
+XTEST(test_csv_errors) {
+    ctofu_type schema[] = { TOFU_INT_TYPE, TOFU_INT_TYPE };
+    ctofu_type nested[] = { TOFU_INT_TYPE, TOFU_ARRAY_TYPE };
+    ctofu columns[2];
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_FORMAT, fscl_tofu_csv_load_buffer("1,2\n3\n", 6, schema, 2, NULL, columns));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_FORMAT, fscl_tofu_csv_load_buffer("1,2,3\n", 6, schema, 2, NULL, columns));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_FORMAT, fscl_tofu_csv_load_buffer("1,x\n", 4, schema, 2, NULL, columns));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_FORMAT, fscl_tofu_csv_load_buffer("1,\"2\n", 5, schema, 2, NULL, columns));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OVERFLOW_INT, fscl_tofu_csv_load_buffer("1,9223372036854775808\n", 22, schema, 2, NULL, columns));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_csv_load_buffer("1,2\n", 4, nested, 2, NULL, columns));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INSECURE_FILE_HANDLING, fscl_tofu_csv_load_file("xtest_csv_missing.csv", schema, 2, NULL, columns));
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_csv_group) {
+    XTEST_RUN_UNIT(test_csv_typed_columns);
+    XTEST_RUN_UNIT(test_csv_quotes_and_header);
+    XTEST_RUN_UNIT(test_csv_threaded_file);
+    XTEST_RUN_UNIT(test_csv_errors);
+} // end of tofu_csv_group
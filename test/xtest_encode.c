@@ -0,0 +1,231 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/encode.h" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include "fixtures.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+static bool keep_even(const ctofu_data* data) {
+    return data->int_type % 2 == 0;
+}
+
+static bool keep_short(const ctofu_data* data) {
+    return strlen(data->string_type) <= 3;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_encode_auto_choice) {
+    ctofu small = fscl_tofu_test_array(TOFU_INT_TYPE, 1000);
+    ctofu sorted = fscl_tofu_test_array(TOFU_UINT_TYPE, 1000);
+    ctofu steady = fscl_tofu_test_array(TOFU_INT_TYPE, 1000);
+    ctofu runs = fscl_tofu_test_array(TOFU_INT_TYPE, 1000);
+    ctofu_encoded* encoded = NULL;
+
+    for (size_t i = 0; i < 1000; ++i) {
+        small.data.array_type.elements[i].data.int_type = (int64_t)(i * 7919 % 200) - 100;
+        sorted.data.array_type.elements[i].data.uint_type = 1000000 + i * 3 + (i * 7 % 3);
+        steady.data.array_type.elements[i].data.int_type = 5000000000LL - (int64_t)i * 1000000007LL;
+        runs.data.array_type.elements[i].data.int_type = (int64_t)(i / 250) * 123456789LL;
+    }
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encode(&small, TOFU_ENCODING_AUTO, &encoded));
+    TEST_ASSUME_EQUAL(TOFU_ENCODING_PACKED, fscl_tofu_encoded_kind(encoded));
+    TEST_ASSUME_EQUAL(true, fscl_tofu_encoded_bytes(encoded) < 1000 * sizeof(ctofu) / 20);
+    fscl_tofu_encoded_erase(encoded);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encode(&sorted, TOFU_ENCODING_AUTO, &encoded));
+    TEST_ASSUME_EQUAL(TOFU_ENCODING_DELTA, fscl_tofu_encoded_kind(encoded));
+    fscl_tofu_encoded_erase(encoded);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encode(&steady, TOFU_ENCODING_AUTO, &encoded));
+    TEST_ASSUME_EQUAL(TOFU_ENCODING_DELTA_OF_DELTA, fscl_tofu_encoded_kind(encoded));
+    fscl_tofu_encoded_erase(encoded);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encode(&runs, TOFU_ENCODING_AUTO, &encoded));
+    TEST_ASSUME_EQUAL(TOFU_ENCODING_RUN_LENGTH, fscl_tofu_encoded_kind(encoded));
+    fscl_tofu_encoded_erase(encoded);
+
+    fscl_tofu_value_erase(&small);
+    fscl_tofu_value_erase(&sorted);
+    fscl_tofu_value_erase(&steady);
+    fscl_tofu_value_erase(&runs);
+}
+
+XTEST(test_encode_round_trip) {
+    const ctofu_encoding encodings[] = {
+        TOFU_ENCODING_PACKED, TOFU_ENCODING_DELTA_OF_DELTA, TOFU_ENCODING_RUN_LENGTH
+    };
+    ctofu source = fscl_tofu_test_array(TOFU_INT_TYPE, 300);
+    for (size_t i = 0; i < 300; ++i) {
+        source.data.array_type.elements[i].data.int_type = (i % 3 == 0) ? INT64_MIN + (int64_t)i : (int64_t)(i * i) - 40000;
+    }
+
+    for (size_t e = 0; e < 3; ++e) {
+        ctofu_encoded* encoded = NULL;
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encode(&source, encodings[e], &encoded));
+        TEST_ASSUME_EQUAL(encodings[e], fscl_tofu_encoded_kind(encoded));
+        TEST_ASSUME_EQUAL(300, fscl_tofu_encoded_size(encoded));
+
+        size_t mismatches = 0;
+        ctofu value;
+        ctofu_encoded_iterator iterator = fscl_tofu_encoded_iterator_start(encoded);
+        for (size_t i = 0; fscl_tofu_encoded_next(&iterator, &value); ++i) {
+            mismatches += value.data.int_type != source.data.array_type.elements[i].data.int_type;
+        }
+        TEST_ASSUME_EQUAL(0, mismatches);
+
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_get(encoded, 299, &value));
+        TEST_ASSUME_EQUAL(source.data.array_type.elements[299].data.int_type, value.data.int_type);
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS, fscl_tofu_encoded_get(encoded, 300, &value));
+
+        ctofu decoded;
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_decode(encoded, &decoded));
+        TEST_ASSUME_EQUAL(0, memcmp(source.data.array_type.elements, decoded.data.array_type.elements, 300 * sizeof(ctofu)));
+        fscl_tofu_value_erase(&decoded);
+        fscl_tofu_encoded_erase(encoded);
+    }
+
+    fscl_tofu_value_erase(&source);
+}
+
+XTEST(test_encode_algorithms) {
+    ctofu source = fscl_tofu_test_array(TOFU_INT_TYPE, 1000);
+    int64_t expected = 0;
+    for (size_t i = 0; i < 1000; ++i) {
+        source.data.array_type.elements[i].data.int_type = (int64_t)(i % 250) - 7;
+        expected += source.data.array_type.elements[i].data.int_type;
+    }
+
+    ctofu_encoded* encoded = NULL;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encode(&source, TOFU_ENCODING_PACKED, &encoded));
+
+    ctofu sum;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_accumulate(encoded, &sum));
+    TEST_ASSUME_EQUAL(TOFU_INT_TYPE, sum.type);
+    TEST_ASSUME_EQUAL(expected, sum.data.int_type);
+
+    ctofu key;
+    memset(&key, 0, sizeof(key));
+    key.type = TOFU_INT_TYPE;
+    key.data.int_type = 200;
+    size_t index = 0;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_search(encoded, &key, &index));
+    TEST_ASSUME_EQUAL(207, index);
+    key.data.int_type = 243;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_TYPE_MISMATCH, fscl_tofu_encoded_search(encoded, &key, &index));
+
+    ctofu even;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_filter(encoded, keep_even, &even));
+    TEST_ASSUME_EQUAL(500, even.data.array_type.size);
+    TEST_ASSUME_EQUAL(-6, even.data.array_type.elements[0].data.int_type);
+
+    fscl_tofu_value_erase(&even);
+    fscl_tofu_encoded_erase(encoded);
+    fscl_tofu_value_erase(&source);
+}
+
+XTEST(test_encode_dictionary) {
+    const char* words[] = { "tofu", "miso", "soy", "tempeh", "soy" };
+    ctofu source = fscl_tofu_test_array(TOFU_STRING_TYPE, 500);
+    for (size_t i = 0; i < 500; ++i) {
+        source.data.array_type.elements[i].data.string_type = fscl_tofu_strdup(words[i % 5]);
+    }
+
+    ctofu_encoded* encoded = NULL;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encode(&source, TOFU_ENCODING_AUTO, &encoded));
+    TEST_ASSUME_EQUAL(TOFU_ENCODING_DICTIONARY, fscl_tofu_encoded_kind(encoded));
+    TEST_ASSUME_EQUAL(TOFU_STRING_TYPE, fscl_tofu_encoded_type(encoded));
+
+    ctofu value;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_get(encoded, 498, &value));
+    TEST_ASSUME_EQUAL(0, strcmp("tempeh", value.data.string_type));
+
+    size_t index = 0;
+    value.data.string_type = "soy";
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_search(encoded, &value, &index));
+    TEST_ASSUME_EQUAL(2, index);
+
+    ctofu short_words;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_filter(encoded, keep_short, &short_words));
+    TEST_ASSUME_EQUAL(200, short_words.data.array_type.size);
+    TEST_ASSUME_EQUAL(0, strcmp("soy", short_words.data.array_type.elements[199].data.string_type));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_encoded_accumulate(encoded, &value));
+    ctofu_encoded* packed = NULL;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_encode(&source, TOFU_ENCODING_PACKED, &packed));
+
+    fscl_tofu_value_erase(&short_words);
+    fscl_tofu_encoded_erase(encoded);
+    fscl_tofu_value_erase(&source);
+}
+
+XTEST(test_encode_narrow) {
+    ctofu counters = fscl_tofu_test_array(TOFU_INT_TYPE, 1000);
+    ctofu ids = fscl_tofu_test_array(TOFU_HEX_TYPE, 1000);
+    for (size_t i = 0; i < 1000; ++i) {
+        counters.data.array_type.elements[i].data.int_type = (int64_t)(i % 200) - 100;
+        ids.data.array_type.elements[i].data.hex_type = 0x10000 + i;
+    }
+
+    ctofu_encoded* narrow = NULL;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_narrow(&counters, &narrow));
+    TEST_ASSUME_EQUAL(TOFU_ENCODING_NARROW, fscl_tofu_encoded_kind(narrow));
+    TEST_ASSUME_EQUAL(8, fscl_tofu_encoded_width(narrow));
+
+    ctofu value;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_get(narrow, 3, &value));
+    TEST_ASSUME_EQUAL(-97, value.data.int_type);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_accumulate(narrow, &value));
+    TEST_ASSUME_EQUAL(-500, value.data.int_type);
+
+    size_t index = 0;
+    value.type = TOFU_INT_TYPE;
+    value.data.int_type = -1;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_search(narrow, &value, &index));
+    TEST_ASSUME_EQUAL(99, index);
+    value.data.int_type = 255;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_TYPE_MISMATCH, fscl_tofu_encoded_search(narrow, &value, &index));
+    fscl_tofu_encoded_erase(narrow);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_narrow(&ids, &narrow));
+    TEST_ASSUME_EQUAL(32, fscl_tofu_encoded_width(narrow));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_encoded_get(narrow, 999, &value));
+    TEST_ASSUME_EQUAL(TOFU_HEX_TYPE, value.type);
+    TEST_ASSUME_EQUAL(0x10000 + 999, value.data.hex_type);
+    fscl_tofu_encoded_erase(narrow);
+
+    fscl_tofu_value_erase(&counters);
+    fscl_tofu_value_erase(&ids);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_encode_group) {
+    XTEST_RUN_UNIT(test_encode_auto_choice);
+    XTEST_RUN_UNIT(test_encode_round_trip);
+    XTEST_RUN_UNIT(test_encode_algorithms);
+    XTEST_RUN_UNIT(test_encode_dictionary);
+    XTEST_RUN_UNIT(test_encode_narrow);
+} // end of tofu_encode_group
@@ -0,0 +1,161 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/intern.h" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+static ctofu make_string(const char* text) {
+    ctofu value;
+    memset(&value, 0, sizeof(value));
+    value.type = TOFU_STRING_TYPE;
+    value.data.string_type = fscl_tofu_strdup(text);
+    return value;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_intern_handles) {
+    size_t base = fscl_tofu_intern_count();
+
+    const char* first = fscl_tofu_intern_acquire("alpha", 5);
+    const char* second = fscl_tofu_intern_acquire("alpha beta", 5);
+    const char* other = fscl_tofu_intern_acquire("beta", 4);
+    TEST_ASSUME_NOT_CNULLPTR(first);
+    TEST_ASSUME_EQUAL(true, first == second);
+    TEST_ASSUME_EQUAL(false, first == other);
+    TEST_ASSUME_EQUAL(0, strcmp(first, "alpha"));
+    TEST_ASSUME_EQUAL(5, fscl_tofu_intern_length(first));
+    TEST_ASSUME_EQUAL(base + 2, fscl_tofu_intern_count());
+
+    ctofu plain = make_string("alpha");
+    TEST_ASSUME_EQUAL(true, fscl_tofu_hash(&plain) == fscl_tofu_intern_hash(first));
+    fscl_tofu_value_erase(&plain);
+
+    fscl_tofu_intern_release(first);
+    TEST_ASSUME_EQUAL(base + 2, fscl_tofu_intern_count());
+    fscl_tofu_intern_release(second);
+    fscl_tofu_intern_release(other);
+    TEST_ASSUME_EQUAL(base, fscl_tofu_intern_count());
+}
+
+XTEST(test_intern_values) {
+    size_t base = fscl_tofu_intern_count();
+    ctofu left;
+    ctofu right;
+    ctofu copy;
+    memset(&copy, 0, sizeof(copy));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_intern_string(&left, "gamma"));
+    TEST_ASSUME_EQUAL(TOFU_FLAG_INTERNED, left.flags);
+
+    right = make_string("gamma");
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_intern(&right));
+    TEST_ASSUME_EQUAL(true, left.data.string_type == right.data.string_type);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_compare(&left, &right));
+
+    // Copying an interned value shares the handle
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_copy(&left, &copy));
+    TEST_ASSUME_EQUAL(true, copy.data.string_type == left.data.string_type);
+    TEST_ASSUME_EQUAL(base + 1, fscl_tofu_intern_count());
+
+    fscl_tofu_value_erase(&left);
+    fscl_tofu_value_erase(&right);
+    TEST_ASSUME_EQUAL(base + 1, fscl_tofu_intern_count());
+    TEST_ASSUME_EQUAL(0, strcmp(copy.data.string_type, "gamma"));
+    fscl_tofu_value_erase(&copy);
+    TEST_ASSUME_EQUAL(base, fscl_tofu_intern_count());
+}
+
+XTEST(test_intern_enabled) {
+    size_t base = fscl_tofu_intern_count();
+    ctofu_data data;
+    data.string_type = "delta";
+
+    fscl_tofu_intern_enable(true);
+    TEST_ASSUME_EQUAL(true, fscl_tofu_intern_enabled());
+
+    ctofu* first = fscl_tofu_create(TOFU_STRING_TYPE, &data);
+    ctofu* second = fscl_tofu_create(TOFU_STRING_TYPE, &data);
+    ctofu* array = fscl_tofu_create_array(TOFU_STRING_TYPE, 1, "epsilon");
+    TEST_ASSUME_NOT_CNULLPTR(first);
+    TEST_ASSUME_NOT_CNULLPTR(second);
+    TEST_ASSUME_NOT_CNULLPTR(array);
+    TEST_ASSUME_EQUAL(TOFU_FLAG_INTERNED, first->flags);
+    TEST_ASSUME_EQUAL(true, first->data.string_type == second->data.string_type);
+    TEST_ASSUME_EQUAL(TOFU_FLAG_INTERNED, array->data.array_type.elements[0].flags);
+    TEST_ASSUME_EQUAL(base + 2, fscl_tofu_intern_count());
+
+    // A plain string copied while interning is on lands in the pool
+    ctofu plain = make_string("epsilon");
+    ctofu copy;
+    memset(&copy, 0, sizeof(copy));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_copy(&plain, &copy));
+    TEST_ASSUME_EQUAL(true, copy.data.string_type == array->data.array_type.elements[0].data.string_type);
+
+    fscl_tofu_intern_enable(false);
+    TEST_ASSUME_EQUAL(false, fscl_tofu_intern_enabled());
+
+    fscl_tofu_value_erase(&plain);
+    fscl_tofu_value_erase(&copy);
+    fscl_tofu_value_erase(first);
+    fscl_tofu_value_erase(second);
+    fscl_tofu_erase(first);
+    fscl_tofu_erase(second);
+    fscl_tofu_erase_array(array);
+    fscl_tofu_erase(array);
+    TEST_ASSUME_EQUAL(base, fscl_tofu_intern_count());
+}
+
+XTEST(test_intern_hash) {
+    ctofu positive;
+    ctofu negative;
+    memset(&positive, 0, sizeof(positive));
+    memset(&negative, 0, sizeof(negative));
+    positive.type = TOFU_DOUBLE_TYPE;
+    positive.data.double_type = 0.0;
+    negative.type = TOFU_DOUBLE_TYPE;
+    negative.data.double_type = -0.0;
+    TEST_ASSUME_EQUAL(true, fscl_tofu_hash(&positive) == fscl_tofu_hash(&negative));
+
+    ctofu plain = make_string("zeta");
+    ctofu interned;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_intern_string(&interned, "zeta"));
+    TEST_ASSUME_EQUAL(true, fscl_tofu_hash(&plain) == fscl_tofu_hash(&interned));
+
+    ctofu other = make_string("eta");
+    TEST_ASSUME_EQUAL(false, fscl_tofu_hash(&plain) == fscl_tofu_hash(&other));
+
+    fscl_tofu_value_erase(&plain);
+    fscl_tofu_value_erase(&interned);
+    fscl_tofu_value_erase(&other);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_intern_group) {
+    XTEST_RUN_UNIT(test_intern_handles);
+    XTEST_RUN_UNIT(test_intern_values);
+    XTEST_RUN_UNIT(test_intern_enabled);
+    XTEST_RUN_UNIT(test_intern_hash);
+} // end of tofu_intern_group
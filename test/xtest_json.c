@@ -0,0 +1,118 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/json.h" // lib source code
+#include "fossil/account.h"
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_json_parse_document) {
+    const char* text = "{ \"name\": \"tofu\", \"tags\": [1, -2, 3.5, true, null], \"empty\": {} }";
+    ctofu document;
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_json_parse(text, strlen(text), &document));
+    TEST_ASSUME_EQUAL(TOFU_MAP_TYPE, document.type);
+    TEST_ASSUME_EQUAL(3, document.data.map_type.size);
+    TEST_ASSUME_EQUAL(0, strcmp("name", document.data.map_type.key[0].data.string_type));
+    TEST_ASSUME_EQUAL(0, strcmp("tofu", document.data.map_type.value[0].data.string_type));
+
+    ctofu* tags = &document.data.map_type.value[1];
+    TEST_ASSUME_EQUAL(TOFU_ARRAY_TYPE, tags->type);
+    TEST_ASSUME_EQUAL(5, tags->data.array_type.size);
+    TEST_ASSUME_EQUAL(TOFU_INT_TYPE, tags->data.array_type.elements[0].type);
+    TEST_ASSUME_EQUAL(-2, tags->data.array_type.elements[1].data.int_type);
+    TEST_ASSUME_EQUAL(TOFU_DOUBLE_TYPE, tags->data.array_type.elements[2].type);
+    TEST_ASSUME_EQUAL(3.5, tags->data.array_type.elements[2].data.double_type);
+    TEST_ASSUME_EQUAL(TOFU_BOOLEAN_TYPE, tags->data.array_type.elements[3].type);
+    TEST_ASSUME_EQUAL(TOFU_NULLPTR_TYPE, tags->data.array_type.elements[4].type);
+    TEST_ASSUME_EQUAL(0, document.data.map_type.value[2].data.map_type.size);
+
+    fscl_tofu_value_erase(&document);
+}
+
+XTEST(test_json_parse_chunked) {
+    // Feed one byte at a time so every token is split across chunks
+    const char* text = "[\"caf\\u00e9 \\ud83d\\ude00\", 18446744073709551615, 12345678901234567890123, 1e3]";
+    ctofu_json_parser* parser = fscl_tofu_json_parser_create();
+    TEST_ASSUME_NOT_CNULLPTR(parser);
+
+    for (size_t i = 0; text[i] != '\0'; ++i) {
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_json_parser_feed(parser, &text[i], 1));
+    }
+
+    ctofu document;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_json_parser_finish(parser, &document));
+    TEST_ASSUME_EQUAL(4, document.data.array_type.size);
+    TEST_ASSUME_EQUAL(0, strcmp("caf\xc3\xa9 \xf0\x9f\x98\x80", document.data.array_type.elements[0].data.string_type));
+    TEST_ASSUME_EQUAL(TOFU_UINT_TYPE, document.data.array_type.elements[1].type);
+    TEST_ASSUME_EQUAL(UINT64_MAX, document.data.array_type.elements[1].data.uint_type);
+    TEST_ASSUME_EQUAL(TOFU_DOUBLE_TYPE, document.data.array_type.elements[2].type);
+    TEST_ASSUME_EQUAL(1000.0, document.data.array_type.elements[3].data.double_type);
+
+    fscl_tofu_value_erase(&document);
+    fscl_tofu_json_parser_erase(parser);
+}
+
+XTEST(test_json_parse_errors) {
+    const char* broken[] = { "", "[1,]", "{\"a\" 1}", "01", "[1 2]", "tru", "\"open", "{} x" };
+    ctofu document;
+
+    for (size_t i = 0; i < sizeof(broken) / sizeof(broken[0]); ++i) {
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_FORMAT, fscl_tofu_json_parse(broken[i], strlen(broken[i]), &document));
+    }
+
+    // Trailing garbage after a complete document frees the tree built for it
+    ctofu_alloc_stats before, after;
+    const char* trailing = "{\"a\":[1,2],\"b\":\"a string too long to keep inline\"} x";
+    bool accounting = fscl_tofu_account_enabled();
+    fscl_tofu_account_enable(true);
+    fscl_tofu_account_totals(&before);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_FORMAT, fscl_tofu_json_parse(trailing, strlen(trailing), &document));
+    fscl_tofu_account_totals(&after);
+    TEST_ASSUME_EQUAL(before.live_objects, after.live_objects);
+    TEST_ASSUME_EQUAL(true, after.total_objects > before.total_objects);
+    fscl_tofu_account_enable(accounting);
+}
+
+XTEST(test_json_round_trip) {
+    const char* text = "{\"a\":[1,2.5,\"x\\ny\"],\"b\":false,\"c\":null}";
+    ctofu document;
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_json_parse(text, strlen(text), &document));
+
+    size_t length = 0;
+    char* written = fscl_tofu_json_stringify(&document, &length);
+    TEST_ASSUME_NOT_CNULLPTR(written);
+    TEST_ASSUME_EQUAL(strlen(text), length);
+    TEST_ASSUME_EQUAL(0, strcmp(text, written));
+
+    free(written);
+    fscl_tofu_value_erase(&document);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_json_group) {
+    XTEST_RUN_UNIT(test_json_parse_document);
+    XTEST_RUN_UNIT(test_json_parse_chunked);
+    XTEST_RUN_UNIT(test_json_parse_errors);
+    XTEST_RUN_UNIT(test_json_round_trip);
+} // end of tofu_json_group
@@ -0,0 +1,71 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/perf.h" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+static void sort_region(void* context) {
+    fscl_tofu_sort((ctofu*)context);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_perf_measure) {
+    ctofu_perf perf;
+    ctofu_perf_sample sample;
+    ctofu* array = fscl_tofu_create_array(TOFU_INT_TYPE, 5, 5, 3, 8, 1, 7);
+    TEST_ASSUME_NOT_CNULLPTR(array);
+
+    // Containers often forbid perf events, the region still runs without counters
+    ctofu_error opened = fscl_tofu_perf_open(&perf);
+    TEST_ASSUME_EQUAL(opened == FSCL_TOFU_ERROR_OK, perf.available != 0);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_perf_measure(&perf, sort_region, array, &sample));
+    TEST_ASSUME_EQUAL(1, array->data.array_type.elements[0].data.int_type);
+    TEST_ASSUME_EQUAL(0, sample.available & ~perf.available);
+
+    if (fscl_tofu_perf_has(&sample, FSCL_TOFU_PERF_INSTRUCTIONS)) {
+        TEST_ASSUME_EQUAL(true, sample.values[FSCL_TOFU_PERF_INSTRUCTIONS] > 0);
+    }
+
+    fscl_tofu_perf_close(&perf);
+    TEST_ASSUME_EQUAL(0, perf.available);
+    fscl_tofu_erase(array);
+}
+
+XTEST(test_perf_names) {
+    ctofu_perf_sample sample;
+    memset(&sample, 0, sizeof(sample));
+
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_perf_name(FSCL_TOFU_PERF_CYCLES), "cycles"));
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_perf_name(FSCL_TOFU_PERF_BRANCH_MISSES), "branch_misses"));
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_perf_name(FSCL_TOFU_PERF_EVENTS), "unknown"));
+    TEST_ASSUME_EQUAL(false, fscl_tofu_perf_has(&sample, FSCL_TOFU_PERF_CYCLES));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_NULL_POINTER, fscl_tofu_perf_open(NULL));
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_perf_group) {
+    XTEST_RUN_UNIT(test_perf_measure);
+    XTEST_RUN_UNIT(test_perf_names);
+} // end of tofu_perf_group
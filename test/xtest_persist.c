@@ -0,0 +1,160 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/persist.h" // lib source code
+#include "fossil/json.h"
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include "fixtures.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_pmap_versions) {
+    ctofu_pmap* versions[2001];
+    versions[0] = fscl_tofu_pmap_create();
+    TEST_ASSUME_NOT_CNULLPTR(versions[0]);
+
+    // Each version maps i to i * 2 for every key added so far
+    for (int64_t i = 0; i < 2000; ++i) {
+        ctofu key = fscl_tofu_test_int(i);
+        ctofu value = fscl_tofu_test_int(i * 2);
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pmap_set(versions[i], &key, &value, &versions[i + 1]));
+    }
+    TEST_ASSUME_EQUAL(2000, fscl_tofu_pmap_size(versions[2000]));
+    TEST_ASSUME_EQUAL(10, fscl_tofu_pmap_size(versions[10]));
+
+    ctofu key = fscl_tofu_test_int(1500);
+    TEST_ASSUME_EQUAL(3000, fscl_tofu_pmap_get(versions[2000], &key)->data.int_type);
+    TEST_ASSUME_CNULLPTR(fscl_tofu_pmap_get(versions[1500], &key));
+
+    // Overwriting and removing leave the older version untouched
+    ctofu_pmap* updated = NULL;
+    ctofu_pmap* removed = NULL;
+    ctofu value = fscl_tofu_test_int(-1);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pmap_set(versions[2000], &key, &value, &updated));
+    TEST_ASSUME_EQUAL(2000, fscl_tofu_pmap_size(updated));
+    TEST_ASSUME_EQUAL(-1, fscl_tofu_pmap_get(updated, &key)->data.int_type);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pmap_remove(updated, &key, &removed));
+    TEST_ASSUME_EQUAL(1999, fscl_tofu_pmap_size(removed));
+    TEST_ASSUME_CNULLPTR(fscl_tofu_pmap_get(removed, &key));
+    TEST_ASSUME_EQUAL(3000, fscl_tofu_pmap_get(versions[2000], &key)->data.int_type);
+
+    for (size_t i = 0; i <= 2000; ++i) {
+        fscl_tofu_pmap_release(versions[i]);
+    }
+
+    // Removing every key one by one ends with an empty map
+    for (int64_t i = 0; i < 2000; ++i) {
+        if (i == 1500) {
+            continue;
+        }
+        ctofu other = fscl_tofu_test_int(i);
+        ctofu_pmap* next = NULL;
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pmap_remove(removed, &other, &next));
+        fscl_tofu_pmap_release(removed);
+        removed = next;
+    }
+    TEST_ASSUME_EQUAL(0, fscl_tofu_pmap_size(removed));
+    fscl_tofu_pmap_release(removed);
+    fscl_tofu_pmap_release(updated);
+}
+
+XTEST(test_pvec_versions) {
+    ctofu_pvec* vector = fscl_tofu_pvec_create();
+    ctofu_pvec* small = NULL;
+    TEST_ASSUME_NOT_CNULLPTR(vector);
+
+    // Enough elements for a three level tree
+    for (int64_t i = 0; i < 1100; ++i) {
+        ctofu value = fscl_tofu_test_int(i);
+        ctofu_pvec* next = NULL;
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pvec_push(vector, &value, &next));
+        if (i == 40) {
+            small = fscl_tofu_pvec_retain(next);
+        }
+        fscl_tofu_pvec_release(vector);
+        vector = next;
+    }
+    TEST_ASSUME_EQUAL(1100, fscl_tofu_pvec_size(vector));
+    TEST_ASSUME_EQUAL(1057, fscl_tofu_pvec_get(vector, 1057)->data.int_type);
+    TEST_ASSUME_EQUAL(41, fscl_tofu_pvec_size(small));
+    TEST_ASSUME_CNULLPTR(fscl_tofu_pvec_get(small, 41));
+
+    ctofu_pvec* changed = NULL;
+    ctofu value = fscl_tofu_test_int(-7);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pvec_set(vector, 3, &value, &changed));
+    TEST_ASSUME_EQUAL(-7, fscl_tofu_pvec_get(changed, 3)->data.int_type);
+    TEST_ASSUME_EQUAL(3, fscl_tofu_pvec_get(vector, 3)->data.int_type);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS, fscl_tofu_pvec_set(vector, 1100, &value, &changed));
+
+    // Popping back down walks the tree back to a single leaf
+    for (size_t i = 1100; i > 1; --i) {
+        ctofu_pvec* next = NULL;
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pvec_pop(changed, &next));
+        fscl_tofu_pvec_release(changed);
+        changed = next;
+        int64_t last = (int64_t)i - 2;
+        TEST_ASSUME_EQUAL(last == 3 ? -7 : last, fscl_tofu_pvec_get(changed, i - 2)->data.int_type);
+    }
+    TEST_ASSUME_EQUAL(1, fscl_tofu_pvec_size(changed));
+    TEST_ASSUME_EQUAL(1099, fscl_tofu_pvec_get(vector, 1099)->data.int_type);
+
+    fscl_tofu_pvec_release(changed);
+    fscl_tofu_pvec_release(small);
+    fscl_tofu_pvec_release(vector);
+}
+
+XTEST(test_persist_round_trip) {
+    const char* text = "{\"name\":\"a string too long to be stored inline\",\"tags\":[\"x\",2,true]}";
+    ctofu parsed;
+    ctofu back;
+    ctofu_pmap* map = NULL;
+    ctofu_pvec* vector = NULL;
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_json_parse(text, strlen(text), &parsed));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pmap_from(&parsed, &map));
+    TEST_ASSUME_EQUAL(2, fscl_tofu_pmap_size(map));
+
+    const ctofu* tags = fscl_tofu_pmap_get(map, &parsed.data.map_type.key[1]);
+    TEST_ASSUME_NOT_CNULLPTR(tags);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pvec_from(tags, &vector));
+    TEST_ASSUME_EQUAL(3, fscl_tofu_pvec_size(vector));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pvec_to(vector, &back));
+    char* json = fscl_tofu_json_stringify(&back, NULL);
+    TEST_ASSUME_EQUAL(0, strcmp(json, "[\"x\",2,true]"));
+    free(json);
+    fscl_tofu_value_erase(&back);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_pmap_to(map, &back));
+    TEST_ASSUME_EQUAL(2, back.data.map_type.size);
+    fscl_tofu_value_erase(&back);
+
+    fscl_tofu_pvec_release(vector);
+    fscl_tofu_pmap_release(map);
+    fscl_tofu_value_erase(&parsed);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_persist_group) {
+    XTEST_RUN_UNIT(test_pmap_versions);
+    XTEST_RUN_UNIT(test_pvec_versions);
+    XTEST_RUN_UNIT(test_persist_round_trip);
+} // end of tofu_persist_group
@@ -0,0 +1,88 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/probe.h" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+typedef struct {
+    ctofu_probe_event events[8];
+    size_t count;
+} probe_log;
+
+static void record_event(const ctofu_probe_event* event, void* context) {
+    probe_log* log = (probe_log*)context;
+    if (log->count < sizeof(log->events) / sizeof(log->events[0])) {
+        log->events[log->count] = *event;
+    }
+    ++log->count;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_probe_hook_events) {
+    probe_log log = {0};
+    ctofu* array = fscl_tofu_create_array(TOFU_INT_TYPE, 3, 3, 1, 2);
+    TEST_ASSUME_NOT_CNULLPTR(array);
+
+    fscl_tofu_probe_set(record_event, &log);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_sort(array));
+    ctofu* key = fscl_tofu_create(TOFU_INT_TYPE, &(ctofu_data){.int_type = 9});
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_TYPE_MISMATCH, fscl_tofu_search(array, key));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_erase(array));
+    fscl_tofu_probe_set(NULL, NULL);
+
+    TEST_ASSUME_EQUAL(6, log.count);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_TELEMETRY_SORT, log.events[0].op);
+    TEST_ASSUME_EQUAL(false, log.events[0].exit);
+    TEST_ASSUME_EQUAL(TOFU_INT_TYPE, log.events[0].type);
+    TEST_ASSUME_EQUAL(3, log.events[0].elements);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_TELEMETRY_SORT, log.events[1].op);
+    TEST_ASSUME_EQUAL(true, log.events[1].exit);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_TELEMETRY_SEARCH, log.events[3].op);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_TYPE_MISMATCH, log.events[3].error);
+
+    // The exit of erase still knows what was erased
+    TEST_ASSUME_EQUAL(FSCL_TOFU_TELEMETRY_ERASE, log.events[5].op);
+    TEST_ASSUME_EQUAL(true, log.events[5].exit);
+    TEST_ASSUME_EQUAL(TOFU_INT_TYPE, log.events[5].type);
+    TEST_ASSUME_EQUAL(3, log.events[5].elements);
+
+    // Without a hook nothing is reported
+    fscl_tofu_erase(key);
+    TEST_ASSUME_EQUAL(6, log.count);
+}
+
+XTEST(test_probe_usdt_query) {
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+    TEST_ASSUME_EQUAL(true, fscl_tofu_probe_usdt());
+#else
+    TEST_ASSUME_EQUAL(false, fscl_tofu_probe_usdt());
+#endif
+#endif
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_probe_group) {
+    XTEST_RUN_UNIT(test_probe_hook_events);
+    XTEST_RUN_UNIT(test_probe_usdt_query);
+} // end of tofu_probe_group
@@ -0,0 +1,176 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/query.h" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include "fixtures.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+static ctofu make_numbers(size_t size) {
+    ctofu array = fscl_tofu_test_array(TOFU_INT_TYPE, size);
+    for (size_t i = 0; i < size; ++i) {
+        array.data.array_type.elements[i].data.int_type = (int64_t)((i * 7919) % 1000) - 500;
+    }
+    return array;
+}
+
+static bool keep_odd(const ctofu* element, void* context) {
+    (void)context;
+    return element->data.int_type % 2 != 0;
+}
+
+static ctofu_error square(const ctofu* element, ctofu* result, void* context) {
+    (void)context;
+    result->type = TOFU_INT_TYPE;
+    result->data.int_type = element->data.int_type * element->data.int_type;
+    return FSCL_TOFU_ERROR_OK;
+}
+
+static ctofu_error parity(const ctofu* element, ctofu* result, void* context) {
+    (void)context;
+    const char* text = element->data.int_type % 2 == 0 ? "even" : "odd";
+    return fscl_tofu_string_set(result, text, strlen(text));
+}
+
+static ctofu add(const ctofu* left, const ctofu* right) {
+    ctofu sum = *left;
+    sum.data.int_type += right->data.int_type;
+    return sum;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_query_fused_pipeline) {
+    ctofu numbers = make_numbers(100000);
+    ctofu zero = {TOFU_INT_TYPE, 0, {.int_type = 0}};
+    ctofu three = {TOFU_INT_TYPE, 0, {.int_type = 3}};
+
+    int64_t sum = 0;
+    uint64_t count = 0;
+    for (size_t i = 0; i < numbers.data.array_type.size; ++i) {
+        int64_t value = numbers.data.array_type.elements[i].data.int_type;
+        if (value > 0) {
+            sum += 3 * value;
+            count++;
+        }
+    }
+
+    // The same answer on one thread and on several
+    for (size_t threads = 1; threads <= 4; threads *= 2) {
+        ctofu_query* query = fscl_tofu_query_create(&numbers);
+        TEST_ASSUME_NOT_CNULLPTR(query);
+        fscl_tofu_query_threads(query, threads);
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_where(query, FSCL_TOFU_QUERY_GREATER, &zero));
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_apply(query, FSCL_TOFU_QUERY_MULTIPLY, &three));
+
+        ctofu result;
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_reduce(query, FSCL_TOFU_QUERY_SUM, &result));
+        TEST_ASSUME_EQUAL(sum, result.data.int_type);
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_reduce(query, FSCL_TOFU_QUERY_COUNT, &result));
+        TEST_ASSUME_EQUAL(count, result.data.uint_type);
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_reduce(query, FSCL_TOFU_QUERY_MAX, &result));
+        TEST_ASSUME_EQUAL(3 * 499, result.data.int_type);
+
+        ctofu folded;
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_fold(query, add, &folded));
+        TEST_ASSUME_EQUAL(sum, folded.data.int_type);
+        fscl_tofu_value_erase(&folded);
+
+        ctofu collected;
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_collect(query, &collected));
+        TEST_ASSUME_EQUAL(count, collected.data.array_type.size);
+        TEST_ASSUME_EQUAL(3 * numbers.data.array_type.elements[1].data.int_type,
+                          collected.data.array_type.elements[0].data.int_type);
+        fscl_tofu_value_erase(&collected);
+        fscl_tofu_query_erase(query);
+    }
+
+    // Skip and take stop early and keep array order
+    ctofu_query* query = fscl_tofu_query_create(&numbers);
+    fscl_tofu_query_threads(query, 4);
+    fscl_tofu_query_where(query, FSCL_TOFU_QUERY_GREATER, &zero);
+    fscl_tofu_query_skip(query, 2);
+    fscl_tofu_query_map(query, square, NULL);
+    fscl_tofu_query_take(query, 3);
+
+    ctofu collected;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_collect(query, &collected));
+    TEST_ASSUME_EQUAL(3, collected.data.array_type.size);
+    size_t seen = 0, taken = 0;
+    for (size_t i = 0; taken < 3; ++i) {
+        int64_t value = numbers.data.array_type.elements[i].data.int_type;
+        if (value > 0 && seen++ >= 2) {
+            TEST_ASSUME_EQUAL(value * value, collected.data.array_type.elements[taken++].data.int_type);
+        }
+    }
+    fscl_tofu_value_erase(&collected);
+    fscl_tofu_query_erase(query);
+
+    fscl_tofu_erase_array(&numbers);
+}
+
+XTEST(test_query_group_and_errors) {
+    ctofu numbers = make_numbers(1000);
+
+    // Group the odd numbers by parity of their square, which is always odd
+    ctofu_query* query = fscl_tofu_query_create(&numbers);
+    TEST_ASSUME_NOT_CNULLPTR(query);
+    fscl_tofu_query_filter(query, keep_odd, NULL);
+    fscl_tofu_query_map(query, square, NULL);
+
+    ctofu groups;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_group(query, parity, NULL, FSCL_TOFU_QUERY_COUNT, &groups));
+    TEST_ASSUME_EQUAL(1, groups.data.map_type.size);
+    TEST_ASSUME_EQUAL(500, groups.data.map_type.value[0].data.uint_type);
+    fscl_tofu_value_erase(&groups);
+
+    // Strings reaching a numeric reduction
+    fscl_tofu_query_map(query, parity, NULL);
+    ctofu result;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_TYPE_MISMATCH, fscl_tofu_query_reduce(query, FSCL_TOFU_QUERY_SUM, &result));
+    fscl_tofu_query_erase(query);
+
+    // Nothing comes out
+    ctofu above = {TOFU_INT_TYPE, 0, {.int_type = 1000}};
+    query = fscl_tofu_query_create(&numbers);
+    fscl_tofu_query_where(query, FSCL_TOFU_QUERY_GREATER_EQUAL, &above);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INDEX_OUT_OF_BOUNDS, fscl_tofu_query_reduce(query, FSCL_TOFU_QUERY_MIN, &result));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_reduce(query, FSCL_TOFU_QUERY_COUNT, &result));
+    TEST_ASSUME_EQUAL(0, result.data.uint_type);
+
+    // Bad stages are refused
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_query_filter(query, NULL, NULL));
+    ctofu text = {TOFU_CHAR_TYPE, 0, {.char_type = 'x'}};
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_query_apply(query, FSCL_TOFU_QUERY_ADD, &text));
+    fscl_tofu_query_erase(query);
+
+    TEST_ASSUME_CNULLPTR(fscl_tofu_query_create(&above));
+    fscl_tofu_erase_array(&numbers);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_query_group) {
+    XTEST_RUN_UNIT(test_query_fused_pipeline);
+    XTEST_RUN_UNIT(test_query_group_and_errors);
+} // end of tofu_query_group
@@ -0,0 +1,103 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/queue.h" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include "fixtures.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_queue_moves_values) {
+    ctofu_queue* queue = fscl_tofu_queue_create(FSCL_TOFU_QUEUE_SPSC, 3);
+    TEST_ASSUME_NOT_CNULLPTR(queue);
+    TEST_ASSUME_EQUAL(4, fscl_tofu_queue_capacity(queue));
+
+    // The heap string changes owner instead of being copied
+    ctofu text;
+    memset(&text, 0, sizeof(text));
+    const char* words = "a string that is far too long to be inline";
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_string_set(&text, words, strlen(words)));
+    const char* storage = fscl_tofu_string_data(&text);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_queue_try_push(queue, &text));
+    TEST_ASSUME_EQUAL(TOFU_INT_TYPE, text.type);
+
+    ctofu out;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_queue_pop(queue, &out));
+    TEST_ASSUME_EQUAL(true, fscl_tofu_string_data(&out) == storage);
+    fscl_tofu_value_erase(&out);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_BUFFER_UNDERFLOW, fscl_tofu_queue_try_pop(queue, &out));
+    fscl_tofu_queue_erase(queue);
+}
+
+XTEST(test_queue_batches) {
+    ctofu_queue_kind kinds[2] = {FSCL_TOFU_QUEUE_SPSC, FSCL_TOFU_QUEUE_MPMC};
+    for (size_t k = 0; k < 2; ++k) {
+        ctofu_queue* queue = fscl_tofu_queue_create(kinds[k], 8);
+        TEST_ASSUME_NOT_CNULLPTR(queue);
+
+        ctofu values[10];
+        for (size_t i = 0; i < 10; ++i) {
+            values[i] = fscl_tofu_test_int((int64_t)i);
+        }
+        TEST_ASSUME_EQUAL(8, fscl_tofu_queue_push_batch(queue, values, 10, false));
+        TEST_ASSUME_EQUAL(8, fscl_tofu_queue_size(queue));
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_BUFFER_OVERFLOW, fscl_tofu_queue_try_push(queue, &values[8]));
+
+        ctofu out[5];
+        TEST_ASSUME_EQUAL(5, fscl_tofu_queue_pop_batch(queue, out, 5, true));
+        TEST_ASSUME_EQUAL(0, out[0].data.int_type);
+        TEST_ASSUME_EQUAL(4, out[4].data.int_type);
+
+        // Wrapping around the ring keeps the order
+        TEST_ASSUME_EQUAL(2, fscl_tofu_queue_push_batch(queue, &values[8], 2, true));
+        TEST_ASSUME_EQUAL(5, fscl_tofu_queue_pop_batch(queue, out, 5, false));
+        TEST_ASSUME_EQUAL(5, out[0].data.int_type);
+        TEST_ASSUME_EQUAL(9, out[4].data.int_type);
+        TEST_ASSUME_EQUAL(0, fscl_tofu_queue_size(queue));
+
+        fscl_tofu_queue_erase(queue);
+    }
+}
+
+XTEST(test_queue_close) {
+    ctofu_queue* queue = fscl_tofu_queue_create(FSCL_TOFU_QUEUE_MPMC, 4);
+    ctofu value = fscl_tofu_test_int(1);
+    ctofu out;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_queue_push(queue, &value));
+    fscl_tofu_queue_close(queue);
+
+    // Closed queues refuse new values but still drain
+    value = fscl_tofu_test_int(2);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_queue_push(queue, &value));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_queue_pop(queue, &out));
+    TEST_ASSUME_EQUAL(1, out.data.int_type);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_BUFFER_UNDERFLOW, fscl_tofu_queue_pop(queue, &out));
+
+    fscl_tofu_queue_erase(queue);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_queue_group) {
+    XTEST_RUN_UNIT(test_queue_moves_values);
+    XTEST_RUN_UNIT(test_queue_batches);
+    XTEST_RUN_UNIT(test_queue_close);
+} // end of tofu_queue_group
@@ -0,0 +1,86 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/reclaim.h" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include "fixtures.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Builds an array of heap strings
+static ctofu make_words(size_t count) {
+    ctofu array = fscl_tofu_test_array(TOFU_STRING_TYPE, count);
+    const char* text = "a string that is too long to fit";
+    for (size_t i = 0; i < count; ++i) {
+        fscl_tofu_string_set(&array.data.array_type.elements[i], text, strlen(text));
+    }
+    return array;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_reclaim_erase_async) {
+    for (size_t i = 0; i < 100; ++i) {
+        ctofu words = make_words(50);
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_erase_async(&words, true));
+        TEST_ASSUME_EQUAL(TOFU_INT_TYPE, words.type);
+    }
+
+    // Scalars own nothing and never reach the reclaimer
+    ctofu number;
+    memset(&number, 0, sizeof(number));
+    number.type = TOFU_DOUBLE_TYPE;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_erase_async(&number, false));
+
+    fscl_tofu_reclaim_drain();
+    TEST_ASSUME_EQUAL(0, fscl_tofu_reclaim_pending());
+    fscl_tofu_reclaim_stop();
+}
+
+XTEST(test_reclaim_restart) {
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_reclaim_start(4));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_reclaim_start(4));
+
+    // Whatever is still queued gets erased on the way out
+    for (size_t i = 0; i < 8; ++i) {
+        ctofu words = make_words(3);
+        if (fscl_tofu_erase_async(&words, false) != FSCL_TOFU_ERROR_OK) {
+            fscl_tofu_value_erase(&words);
+        }
+    }
+    fscl_tofu_reclaim_stop();
+    TEST_ASSUME_EQUAL(0, fscl_tofu_reclaim_pending());
+
+    // Stopping twice is harmless, the next erase starts a new reclaimer
+    fscl_tofu_reclaim_stop();
+    ctofu words = make_words(2);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_erase_async(&words, true));
+    fscl_tofu_reclaim_stop();
+    TEST_ASSUME_EQUAL(0, fscl_tofu_reclaim_pending());
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_reclaim_group) {
+    XTEST_RUN_UNIT(test_reclaim_erase_async);
+    XTEST_RUN_UNIT(test_reclaim_restart);
+} // end of tofu_reclaim_group
@@ -0,0 +1,157 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/shared.h" // lib source code
+#include "fossil/json.h"
+#include "fossil/account.h"
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include "fixtures.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+static ctofu make_numbers(const int64_t* input, size_t size) {
+    ctofu value = fscl_tofu_test_array(TOFU_INT_TYPE, size);
+    for (size_t i = 0; i < size; ++i) {
+        value.data.array_type.elements[i].data.int_type = input[i];
+    }
+    return value;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_shared_copy_retains) {
+    const int64_t input[4] = {4, 1, 3, 2};
+    ctofu original = make_numbers(input, 4);
+    ctofu copy;
+    memset(&copy, 0, sizeof(copy));
+
+    TEST_ASSUME_EQUAL(1, fscl_tofu_references(&original));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_share(&original));
+    TEST_ASSUME_EQUAL(TOFU_FLAG_SHARED, original.flags);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_copy(&original, &copy));
+    TEST_ASSUME_EQUAL(2, fscl_tofu_references(&original));
+    TEST_ASSUME_EQUAL(true, copy.data.array_type.elements == original.data.array_type.elements);
+
+    fscl_tofu_value_erase(&copy);
+    TEST_ASSUME_EQUAL(1, fscl_tofu_references(&original));
+    fscl_tofu_value_erase(&original);
+}
+
+XTEST(test_shared_copy_on_write) {
+    const int64_t input[4] = {4, 1, 3, 2};
+    ctofu original = make_numbers(input, 4);
+    ctofu copy;
+    memset(&copy, 0, sizeof(copy));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_share(&original));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_copy(&original, &copy));
+
+    // The first write clones the copy and leaves the original alone
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_sort(&copy));
+    TEST_ASSUME_EQUAL(false, copy.data.array_type.elements == original.data.array_type.elements);
+    TEST_ASSUME_EQUAL(1, fscl_tofu_references(&original));
+    TEST_ASSUME_EQUAL(1, fscl_tofu_references(&copy));
+    TEST_ASSUME_EQUAL(1, copy.data.array_type.elements[0].data.int_type);
+    TEST_ASSUME_EQUAL(4, original.data.array_type.elements[0].data.int_type);
+
+    // A unique value is written in place
+    ctofu* elements = copy.data.array_type.elements;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_reverse(&copy));
+    TEST_ASSUME_EQUAL(true, copy.data.array_type.elements == elements);
+    TEST_ASSUME_EQUAL(4, copy.data.array_type.elements[0].data.int_type);
+
+    fscl_tofu_value_erase(&original);
+    fscl_tofu_value_erase(&copy);
+}
+
+XTEST(test_shared_nested) {
+    const char* text = "{\"name\":\"a string too long to be stored inline\",\"tags\":[\"x\",\"another rather long string\"]}";
+    ctofu value;
+    ctofu copy;
+    memset(&copy, 0, sizeof(copy));
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_json_parse(text, strlen(text), &value));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_share(&value));
+    TEST_ASSUME_EQUAL(TOFU_FLAG_SHARED, value.flags & TOFU_FLAG_SHARED);
+    TEST_ASSUME_EQUAL(TOFU_FLAG_SHARED, value.data.map_type.value[0].flags & TOFU_FLAG_SHARED);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_copy(&value, &copy));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_unique(&copy));
+    TEST_ASSUME_EQUAL(false, copy.data.map_type.key == value.data.map_type.key);
+
+    // Cloning the map only retained its nested values
+    TEST_ASSUME_EQUAL(2, fscl_tofu_references(&value.data.map_type.value[1]));
+    TEST_ASSUME_EQUAL(true, copy.data.map_type.value[1].data.array_type.elements == value.data.map_type.value[1].data.array_type.elements);
+
+    char* json = fscl_tofu_json_stringify(&copy, NULL);
+    TEST_ASSUME_NOT_CNULLPTR(json);
+    TEST_ASSUME_EQUAL(0, strcmp(json, text));
+
+    free(json);
+    fscl_tofu_value_erase(&value);
+    fscl_tofu_value_erase(&copy);
+}
+
+XTEST(test_shared_assign) {
+    const int64_t input[4] = {4, 1, 3, 2};
+    const int64_t other[4] = {8, 7, 6, 5};
+    ctofu_alloc_stats before, after;
+    bool accounting = fscl_tofu_account_enabled();
+    fscl_tofu_account_enable(true);
+    fscl_tofu_account_totals(&before);
+
+    ctofu original = make_numbers(input, 4);
+    ctofu source = make_numbers(other, 4);
+    ctofu copy;
+    memset(&copy, 0, sizeof(copy));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_share(&original));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_copy(&original, &copy));
+
+    // Assigning over a copy drops its reference and leaves the original alone
+    fscl_tofu_value_setter(&source, &copy);
+    TEST_ASSUME_EQUAL(0, copy.flags);
+    TEST_ASSUME_EQUAL(1, fscl_tofu_references(&original));
+    TEST_ASSUME_EQUAL(8, copy.data.array_type.elements[0].data.int_type);
+    TEST_ASSUME_EQUAL(4, original.data.array_type.elements[0].data.int_type);
+
+    // Assigning over the last owner frees the shared block
+    fscl_tofu_value_setter(&source, &original);
+    TEST_ASSUME_EQUAL(0, original.flags);
+    TEST_ASSUME_EQUAL(5, original.data.array_type.elements[3].data.int_type);
+
+    fscl_tofu_value_erase(&original);
+    fscl_tofu_value_erase(&copy);
+    fscl_tofu_value_erase(&source);
+    fscl_tofu_account_totals(&after);
+    TEST_ASSUME_EQUAL(before.live_objects, after.live_objects);
+    fscl_tofu_account_enable(accounting);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_shared_group) {
+    XTEST_RUN_UNIT(test_shared_copy_retains);
+    XTEST_RUN_UNIT(test_shared_copy_on_write);
+    XTEST_RUN_UNIT(test_shared_nested);
+    XTEST_RUN_UNIT(test_shared_assign);
+} // end of tofu_shared_group
@@ -0,0 +1,114 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/slab.h" // lib source code
+#include "fossil/query.h"
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include "fixtures.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Runs on query worker threads, leaving blocks in their thread caches
+static bool churn(const ctofu* element, void* context) {
+    (void)context;
+    ctofu* value = fscl_tofu_create(TOFU_INT_TYPE, &(ctofu_data){.int_type = element->data.int_type});
+    fscl_tofu_erase(value);
+    return true;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_slab_reuse) {
+    // Made before the allocator is on, so it comes from malloc
+    ctofu* before = fscl_tofu_create(TOFU_INT_TYPE, &(ctofu_data){.int_type = 1});
+    TEST_ASSUME_NOT_CNULLPTR(before);
+
+    fscl_tofu_slab_enable(true);
+    TEST_ASSUME_EQUAL(true, fscl_tofu_slab_enabled());
+
+    // An erased structure is handed straight back by the thread cache
+    ctofu* first = fscl_tofu_create(TOFU_INT_TYPE, &(ctofu_data){.int_type = 2});
+    TEST_ASSUME_NOT_CNULLPTR(first);
+    TEST_ASSUME_EQUAL(true, fscl_tofu_slab_count() > 0);
+    fscl_tofu_erase(first);
+    ctofu* second = fscl_tofu_create(TOFU_INT_TYPE, &(ctofu_data){.int_type = 3});
+    TEST_ASSUME_EQUAL(true, first == second);
+    TEST_ASSUME_EQUAL(3, second->data.int_type);
+
+    fscl_tofu_erase(before);
+    fscl_tofu_erase(second);
+    fscl_tofu_slab_enable(false);
+}
+
+XTEST(test_slab_arrays) {
+    fscl_tofu_slab_enable(true);
+
+    // Enough values to move batches through the depot and back
+    ctofu* arrays[200];
+    for (size_t i = 0; i < 200; ++i) {
+        arrays[i] = fscl_tofu_create_array(TOFU_INT_TYPE, 3, (int)i, 2, 3);
+        TEST_ASSUME_NOT_CNULLPTR(arrays[i]);
+    }
+    ctofu* words = fscl_tofu_create_array(TOFU_STRING_TYPE, 2, "pear", "a string that is too long to fit");
+    TEST_ASSUME_NOT_CNULLPTR(words);
+    for (size_t i = 0; i < 200; ++i) {
+        TEST_ASSUME_EQUAL((int64_t)i, arrays[i]->data.array_type.elements[0].data.int_type);
+        fscl_tofu_erase(arrays[i]);
+    }
+
+    // Slab memory stays valid after the allocator is turned off
+    fscl_tofu_slab_enable(false);
+    TEST_ASSUME_EQUAL(0, strcmp(fscl_tofu_string_data(&words->data.array_type.elements[1]), "a string that is too long to fit"));
+    fscl_tofu_erase(words);
+}
+
+XTEST(test_slab_thread_exit) {
+    fscl_tofu_slab_enable(true);
+    ctofu numbers = fscl_tofu_test_array(TOFU_INT_TYPE, 1 << 16);
+    ctofu_query* query = fscl_tofu_query_create(&numbers);
+    TEST_ASSUME_NOT_CNULLPTR(query);
+    fscl_tofu_query_threads(query, 4);
+    fscl_tofu_query_filter(query, churn, NULL);
+
+    // Every run starts new threads; the blocks they cache go back when they exit
+    ctofu count;
+    size_t slabs = 0;
+    for (size_t run = 0; run < 40; ++run) {
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_reduce(query, FSCL_TOFU_QUERY_COUNT, &count));
+        if (run == 1) {
+            slabs = fscl_tofu_slab_count();
+        }
+    }
+    TEST_ASSUME_EQUAL(slabs, fscl_tofu_slab_count());
+
+    fscl_tofu_query_erase(query);
+    fscl_tofu_erase_array(&numbers);
+    fscl_tofu_slab_enable(false);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_slab_group) {
+    XTEST_RUN_UNIT(test_slab_reuse);
+    XTEST_RUN_UNIT(test_slab_arrays);
+    XTEST_RUN_UNIT(test_slab_thread_exit);
+} // end of tofu_slab_group
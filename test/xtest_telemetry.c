@@ -0,0 +1,147 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/telemetry.h" // lib source code
+#include "fossil/query.h"
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include "fixtures.h"
+
+#include <string.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+static const ctofu* find_entry(const ctofu* map, const char* name) {
+    for (size_t i = 0; i < map->data.map_type.size; ++i) {
+        if (strcmp(fscl_tofu_string_data(&map->data.map_type.key[i]), name) == 0) {
+            return &map->data.map_type.value[i];
+        }
+    }
+    return NULL;
+}
+
+// Runs on query worker threads, so every run records from new threads
+static bool churn(const ctofu* element, void* context) {
+    (void)context;
+    ctofu* value = fscl_tofu_create(TOFU_INT_TYPE, &(ctofu_data){.int_type = element->data.int_type});
+    fscl_tofu_erase(value);
+    return true;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_telemetry_read) {
+    ctofu_telemetry_stats stats;
+    ctofu* array = fscl_tofu_create_array(TOFU_INT_TYPE, 4, 4, 2, 3, 1);
+    TEST_ASSUME_NOT_CNULLPTR(array);
+
+    fscl_tofu_telemetry_reset();
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_sort(array));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_sort(array));
+
+    // Builds without telemetry record nothing and say so
+    if (!fscl_tofu_telemetry_enabled()) {
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_telemetry_read(FSCL_TOFU_TELEMETRY_SORT, &stats));
+        TEST_ASSUME_EQUAL(0, stats.calls);
+        fscl_tofu_erase(array);
+        return;
+    }
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_telemetry_read(FSCL_TOFU_TELEMETRY_SORT, &stats));
+    TEST_ASSUME_EQUAL(2, stats.calls);
+    TEST_ASSUME_EQUAL(8, stats.elements);
+    TEST_ASSUME_EQUAL(true, stats.min_ns <= stats.p50_ns && stats.p50_ns <= stats.p999_ns);
+    TEST_ASSUME_EQUAL(true, stats.p999_ns <= stats.max_ns && stats.max_ns <= stats.total_ns);
+
+    // A deep copy counts the bytes of its element buffer
+    ctofu copy;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_value_copy(array, &copy));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_telemetry_read(FSCL_TOFU_TELEMETRY_VALUE_COPY, &stats));
+    TEST_ASSUME_EQUAL(1, stats.calls);
+    TEST_ASSUME_EQUAL(4 * sizeof(ctofu), stats.bytes);
+
+    fscl_tofu_telemetry_reset();
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_telemetry_read(FSCL_TOFU_TELEMETRY_SORT, &stats));
+    TEST_ASSUME_EQUAL(0, stats.calls);
+    TEST_ASSUME_EQUAL(0, stats.min_ns);
+
+    fscl_tofu_value_erase(&copy);
+    fscl_tofu_erase(array);
+}
+
+XTEST(test_telemetry_snapshot) {
+    ctofu snapshot;
+    if (!fscl_tofu_telemetry_enabled()) {
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_telemetry_snapshot(&snapshot));
+        return;
+    }
+
+    fscl_tofu_telemetry_reset();
+    ctofu* value = fscl_tofu_create(TOFU_INT_TYPE, &(ctofu_data){.int_type = 7});
+    TEST_ASSUME_NOT_CNULLPTR(value);
+    fscl_tofu_erase(value);
+
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_telemetry_snapshot(&snapshot));
+    TEST_ASSUME_EQUAL(TOFU_MAP_TYPE, snapshot.type);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_TELEMETRY_OPS, snapshot.data.map_type.size);
+
+    const ctofu* create = find_entry(&snapshot, "create");
+    TEST_ASSUME_NOT_CNULLPTR(create);
+    const ctofu* calls = find_entry(create, "calls");
+    TEST_ASSUME_NOT_CNULLPTR(calls);
+    TEST_ASSUME_EQUAL(TOFU_UINT_TYPE, calls->type);
+    TEST_ASSUME_EQUAL(1, calls->data.uint_type);
+    TEST_ASSUME_EQUAL(sizeof(ctofu), find_entry(create, "bytes")->data.uint_type);
+
+    fscl_tofu_value_erase(&snapshot);
+}
+
+XTEST(test_telemetry_thread_churn) {
+    if (!fscl_tofu_telemetry_enabled()) {
+        return;
+    }
+
+    ctofu numbers = fscl_tofu_test_array(TOFU_INT_TYPE, 1 << 16);
+    ctofu_query* query = fscl_tofu_query_create(&numbers);
+    TEST_ASSUME_NOT_CNULLPTR(query);
+    fscl_tofu_query_threads(query, 4);
+    fscl_tofu_query_filter(query, churn, NULL);
+
+    // Calls made on threads that have exited still count
+    fscl_tofu_telemetry_reset();
+    ctofu count;
+    for (size_t run = 0; run < 20; ++run) {
+        TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_query_reduce(query, FSCL_TOFU_QUERY_COUNT, &count));
+    }
+    ctofu_telemetry_stats stats;
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_telemetry_read(FSCL_TOFU_TELEMETRY_CREATE, &stats));
+    TEST_ASSUME_EQUAL(20 << 16, stats.calls);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_telemetry_read(FSCL_TOFU_TELEMETRY_ERASE, &stats));
+    TEST_ASSUME_EQUAL(20 << 16, stats.calls);
+
+    fscl_tofu_query_erase(query);
+    fscl_tofu_erase_array(&numbers);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_telemetry_group) {
+    XTEST_RUN_UNIT(test_telemetry_read);
+    XTEST_RUN_UNIT(test_telemetry_snapshot);
+    XTEST_RUN_UNIT(test_telemetry_thread_churn);
+} // end of tofu_telemetry_group
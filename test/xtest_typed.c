@@ -0,0 +1,78 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/typed.h" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+
+#include <stdlib.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_typed_kernels) {
+    int64_t numbers[] = {5, -2, 9, 1, 3};
+    TEST_ASSUME_EQUAL(16, fscl_tofu_typed_sum(numbers, 5));
+    TEST_ASSUME_EQUAL(2, fscl_tofu_typed_search(numbers, 5, 9));
+    TEST_ASSUME_EQUAL(SIZE_MAX, fscl_tofu_typed_search(numbers, 5, 4));
+    fscl_tofu_typed_sort(numbers, 5);
+    TEST_ASSUME_EQUAL(-2, numbers[0]);
+    TEST_ASSUME_EQUAL(9, numbers[4]);
+
+    float halves[] = {0.5f, 1.5f, 2.5f};
+    TEST_ASSUME_EQUAL(4.5, fscl_tofu_typed_sum(halves, 3));
+
+    // Large enough to go through partitioning, with many duplicates
+    size_t count = 5000;
+    double* reals = (double*)malloc(count * sizeof(double));
+    TEST_ASSUME_NOT_CNULLPTR(reals);
+    for (size_t i = 0; i < count; ++i) {
+        reals[i] = (double)((i * 7919) % 101);
+    }
+    fscl_tofu_typed_sort(reals, count);
+    bool ordered = true;
+    for (size_t i = 1; i < count; ++i) {
+        ordered = ordered && reals[i - 1] <= reals[i];
+    }
+    TEST_ASSUME_EQUAL(true, ordered);
+    free(reals);
+}
+
+XTEST(test_typed_pack_unpack) {
+    ctofu* array = fscl_tofu_create_array(TOFU_INT_TYPE, 4, 4, 3, 2, 1);
+    TEST_ASSUME_NOT_CNULLPTR(array);
+
+    int64_t values[4];
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_typed_unpack(array, values));
+    fscl_tofu_typed_sort(values, 4);
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_OK, fscl_tofu_typed_pack(array, values));
+    TEST_ASSUME_EQUAL(1, array->data.array_type.elements[0].data.int_type);
+    TEST_ASSUME_EQUAL(4, array->data.array_type.elements[3].data.int_type);
+
+    // The buffer type has to match the elements
+    double reals[4];
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_typed_unpack(array, reals));
+    TEST_ASSUME_EQUAL(FSCL_TOFU_ERROR_INVALID_OPERATION, fscl_tofu_typed_pack(array, reals));
+    TEST_ASSUME_EQUAL(1, array->data.array_type.elements[0].data.int_type);
+
+    fscl_tofu_erase(array);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_typed_group) {
+    XTEST_RUN_UNIT(test_typed_kernels);
+    XTEST_RUN_UNIT(test_typed_pack_unpack);
+} // end of tofu_typed_group
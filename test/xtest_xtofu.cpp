@@ -0,0 +1,84 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/xtofu.hpp" // lib source code
+
+#include <fossil/xtest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+using fossil::tofu::span;
+using fossil::tofu::value;
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+XTEST(test_cpp_value_ownership) {
+    value text = "a string too long to be stored inline";
+    value copy = text;
+    TEST_ASSUME_EQUAL(true, copy.str() == text.str());
+
+    value moved = std::move(copy);
+    TEST_ASSUME_EQUAL(TOFU_NULLPTR_TYPE, copy.type());
+    TEST_ASSUME_EQUAL(TOFU_STRING_TYPE, moved.type());
+
+    value number = 42;
+    TEST_ASSUME_EQUAL(42, number.as<int64_t>());
+    TEST_ASSUME_CNULLPTR(number.get_if<double>());
+    number = 2.5;
+    TEST_ASSUME_EQUAL(2.5, *number.get_if<double>());
+
+    value created = value::adopt(fscl_tofu_create_array(TOFU_INT_TYPE, 3, 1, 2, 3));
+    TEST_ASSUME_EQUAL(3u, created.elements().size());
+
+    value empty = value::array<double>({});
+    value empty_copy = empty;
+    TEST_ASSUME_EQUAL(true, empty_copy.elements().empty());
+}
+
+XTEST(test_cpp_span_algorithms) {
+    value numbers = value::array({5, -2, 9, 1, 3});
+    span<int64_t> items = numbers.span_of<int64_t>();
+    std::sort(items.begin(), items.end());
+    TEST_ASSUME_EQUAL(true, std::is_sorted(items.begin(), items.end()));
+    TEST_ASSUME_EQUAL(-2, items[0]);
+    TEST_ASSUME_EQUAL(16, std::accumulate(items.begin(), items.end(), int64_t{0}));
+
+    // Copies do not share writes with the original
+    value copy = numbers;
+    copy.span_of<int64_t>()[0] = 100;
+    TEST_ASSUME_EQUAL(-2, numbers.span_of<int64_t>()[0]);
+
+    const value& fixed = numbers;
+    span<const int64_t> read = fixed.span_of<int64_t>();
+    TEST_ASSUME_EQUAL(9, *std::max_element(read.begin(), read.end()));
+
+    bool mismatch = false;
+    try {
+        numbers.span_of<double>();
+    } catch (const fossil::tofu::error& error) {
+        mismatch = error.code() == FSCL_TOFU_ERROR_TYPE_MISMATCH;
+    }
+    TEST_ASSUME_EQUAL(true, mismatch);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+XTEST_DEFINE_POOL(tofu_cpp_group) {
+    XTEST_RUN_UNIT(test_cpp_value_ownership);
+    XTEST_RUN_UNIT(test_cpp_span_algorithms);
+} // end of tofu_cpp_group